@@ -0,0 +1,1471 @@
+// BenchMain.cpp - evh_bench: chain cost through the host render path
+#include "EnhancedVSTHost.h"
+#include "EVHNodes.h"
+#include "BenchReport.h"
+#include "SyntheticPlugins.h"
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <thread>
+
+using namespace EVH;
+using namespace EVH::Bench;
+
+namespace {
+    constexpr double BENCH_SAMPLE_RATE = 48000.0;
+    constexpr double PI = 3.14159265358979323846;
+    
+    const int CHAIN_LENGTHS[] = {1, 2, 4, 8, 16, 32, 64};
+    const int CHANNEL_COUNTS[] = {1, 2, 4, 8, 16, 32};
+    const int BUFFER_SIZES[] = {16, 32, 64, 128, 256, 512, 1024, 2048, 4096};
+    
+    struct Options {
+        std::vector<std::string> suites{"plugins", "chain", "channels", "buffers", "switch", "denormal", "fileio",
+                                        "convolution", "precision", "resampler", "srcquality", "capture",
+                                        "aggregate", "adaptive", "dispatch"};
+        Synthetic::Settings plugin;     // Kind used by the sweeps
+        std::string format{"json"};
+        std::string outputPath;
+        int warmupBlocks{32};
+        int measuredBlocks{2000};
+        int fileMegabytes{512};         // Size of each fileio test file
+        std::string fileDir;            // fileio scratch directory (default: system temp)
+        int64_t maxImpulseLength{10000000};   // Longest convolution impulse
+    };
+    
+    // What one sweep point runs
+    struct ChainConfig {
+        Synthetic::Settings plugin;
+        int chainLength{8};
+        int numChannels{2};
+        int bufferSize{256};
+    };
+    
+    // Planar block buffers, inputs filled with low-level noise
+    struct Buffers {
+        std::vector<std::vector<float>> inputs;
+        std::vector<std::vector<float>> outputs;
+        std::vector<const float*> inputPtrs;
+        std::vector<float*> outputPtrs;
+        
+        Buffers(int numChannels, int numFrames) {
+            std::mt19937 rng(1234);
+            std::uniform_real_distribution<float> noise(-0.25f, 0.25f);
+            
+            inputs.assign(numChannels, std::vector<float>(numFrames));
+            outputs.assign(numChannels, std::vector<float>(numFrames, 0.0f));
+            for (int ch = 0; ch < numChannels; ++ch) {
+                for (float& sample : inputs[ch]) {
+                    sample = noise(rng);
+                }
+                inputPtrs.push_back(inputs[ch].data());
+                outputPtrs.push_back(outputs[ch].data());
+            }
+        }
+    };
+    
+    std::vector<std::string> Split(const std::string& text, char separator) {
+        std::vector<std::string> parts;
+        std::stringstream stream(text);
+        std::string part;
+        while (std::getline(stream, part, separator)) {
+            if (!part.empty()) {
+                parts.push_back(part);
+            }
+        }
+        return parts;
+    }
+    
+    bool WantsSuite(const Options& options, const std::string& suite) {
+        return std::find(options.suites.begin(), options.suites.end(), suite) != options.suites.end();
+    }
+    
+    std::string PluginLabel(const Synthetic::Settings& plugin) {
+        std::string label = Synthetic::getKindName(plugin.kind);
+        if (plugin.kind == Synthetic::Kind::Fir) {
+            label += std::to_string(plugin.firTaps);
+        }
+        return label;
+    }
+    
+    // Loads chainLength processors into host and links them into the chain
+    bool BuildChain(EnhancedVSTHost& host, const Synthetic::Settings& plugin, int chainLength) {
+        for (int i = 0; i < chainLength; ++i) {
+            Synthetic::Settings settings = plugin;
+            settings.seed = plugin.seed + i;
+            int pluginId = host.loadProcessor(Synthetic::create(settings));
+            if (pluginId == 0) {
+                return false;
+            }
+            host.addPluginToChain(pluginId);
+        }
+        return true;
+    }
+    
+    // Times renderOffline() one block at a time on a fresh host
+    bool MeasureChain(const ChainConfig& config, const Options& options, TimingSummary& summary) {
+        EnhancedVSTHost host(HostMode::Headless);
+        host.setSampleRate(BENCH_SAMPLE_RATE);
+        host.setBufferSize(config.bufferSize);
+        
+        if (!BuildChain(host, config.plugin, config.chainLength) ||
+            !host.beginOfflineRender(config.numChannels)) {
+            return false;
+        }
+        
+        Buffers buffers(config.numChannels, config.bufferSize);
+        for (int i = 0; i < options.warmupBlocks; ++i) {
+            host.renderOffline(buffers.inputPtrs.data(), buffers.outputPtrs.data(), config.bufferSize);
+        }
+        
+        std::vector<double> timings;
+        timings.reserve(options.measuredBlocks);
+        for (int i = 0; i < options.measuredBlocks; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            host.renderOffline(buffers.inputPtrs.data(), buffers.outputPtrs.data(), config.bufferSize);
+            std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+            timings.push_back(elapsed.count());
+        }
+        
+        host.endOfflineRender();
+        summary = summarize(std::move(timings));
+        return true;
+    }
+    
+    void AddChainResult(std::vector<Result>& results, const std::string& suite, const ChainConfig& config,
+                        const TimingSummary& summary) {
+        const double blockUs = config.bufferSize * 1e6 / BENCH_SAMPLE_RATE;
+        
+        Result result;
+        result.suite = suite;
+        result.name = PluginLabel(config.plugin) + "_n" + std::to_string(config.chainLength) +
+                      "_ch" + std::to_string(config.numChannels) + "_b" + std::to_string(config.bufferSize);
+        result.params = {
+            {"plugin", PluginLabel(config.plugin)},
+            {"chain", std::to_string(config.chainLength)},
+            {"channels", std::to_string(config.numChannels)},
+            {"buffer", std::to_string(config.bufferSize)},
+            {"sample_rate", formatNumber(BENCH_SAMPLE_RATE)}
+        };
+        result.metrics = {
+            {"mean_us", summary.meanUs},
+            {"p50_us", summary.p50Us},
+            {"p99_us", summary.p99Us},
+            {"max_us", summary.maxUs},
+            {"ns_per_frame", summary.meanUs * 1000.0 / config.bufferSize},
+            {"load", summary.meanUs / blockUs}   // Fraction of the block's real time
+        };
+        results.push_back(std::move(result));
+    }
+    
+    void RunChainPoint(std::vector<Result>& results, const std::string& suite, const ChainConfig& config,
+                       const Options& options) {
+        TimingSummary summary;
+        if (!MeasureChain(config, options, summary)) {
+            std::cerr << "  " << suite << ": failed to set up " << PluginLabel(config.plugin) << std::endl;
+            return;
+        }
+        
+        AddChainResult(results, suite, config, summary);
+        std::cerr << "  " << suite << " " << results.back().name << ": "
+                  << formatNumber(summary.meanUs) << " us mean, " << formatNumber(summary.p99Us) << " us p99"
+                  << std::endl;
+    }
+    
+    // Every synthetic kind alone, so per-plugin overhead can be compared
+    void RunPluginsSuite(std::vector<Result>& results, const Options& options) {
+        for (Synthetic::Kind kind : Synthetic::ALL_KINDS) {
+            ChainConfig config;
+            config.plugin = options.plugin;
+            config.plugin.kind = kind;
+            config.chainLength = 1;
+            RunChainPoint(results, "plugins", config, options);
+        }
+    }
+    
+    void RunChainSuite(std::vector<Result>& results, const Options& options) {
+        for (int length : CHAIN_LENGTHS) {
+            ChainConfig config;
+            config.plugin = options.plugin;
+            config.chainLength = length;
+            config.numChannels = 2;
+            RunChainPoint(results, "chain", config, options);
+        }
+    }
+    
+    void RunChannelsSuite(std::vector<Result>& results, const Options& options) {
+        for (int channels : CHANNEL_COUNTS) {
+            ChainConfig config;
+            config.plugin = options.plugin;
+            config.numChannels = channels;
+            RunChainPoint(results, "channels", config, options);
+        }
+    }
+    
+    void RunBuffersSuite(std::vector<Result>& results, const Options& options) {
+        for (int bufferSize : BUFFER_SIZES) {
+            ChainConfig config;
+            config.plugin = options.plugin;
+            config.bufferSize = bufferSize;
+            RunChainPoint(results, "buffers", config, options);
+        }
+    }
+    
+    // Sample rate / buffer size changes on a running null engine
+    void RunSwitchSuite(std::vector<Result>& results, const Options& options) {
+        // Each step toggles one setting away from the 48 kHz / 256 baseline and back
+        struct Step {
+            const char* name;
+            bool changesRate;
+            double value;
+        };
+        const Step steps[] = {
+            {"buffer_256_to_512", false, 512.0},
+            {"buffer_256_to_128", false, 128.0},
+            {"rate_48k_to_44k1", true, 44100.0},
+            {"rate_48k_to_96k", true, 96000.0}
+        };
+        const int repeats = options.measuredBlocks >= 1000 ? 10 : 3;
+        
+        EnhancedVSTHost host(HostMode::Headless);
+        host.setSampleRate(48000.0);
+        host.setBufferSize(256);
+        
+        Synthetic::Settings plugin;
+        plugin.kind = Synthetic::Kind::Fir;
+        if (!BuildChain(host, plugin, 8) || !host.startAudio(AudioDriverType::Null)) {
+            std::cerr << "  switch: null engine did not start" << std::endl;
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        
+        for (const Step& step : steps) {
+            std::vector<double> prepareMs, switchMs, totalMs;
+            int failures = 0;
+            for (int r = 0; r < repeats; ++r) {
+                if (step.changesRate) {
+                    host.setSampleRate(step.value);
+                } else {
+                    host.setBufferSize(static_cast<int>(step.value));
+                }
+                
+                ReconfigureStats stats = host.getLastReconfigureStats();
+                if (stats.succeeded) {
+                    prepareMs.push_back(stats.prepareMs);
+                    switchMs.push_back(stats.switchMs);
+                    totalMs.push_back(stats.totalMs);
+                } else {
+                    ++failures;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                
+                // Back to the baseline for the next repeat
+                host.setSampleRate(48000.0);
+                host.setBufferSize(256);
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            }
+            
+            // Percentile helper works in any unit
+            TimingSummary total = summarize(totalMs);
+            Result result;
+            result.suite = "switch";
+            result.name = step.name;
+            result.params = {{"engine", "null"}, {"chain", "8"}, {"plugin", PluginLabel(plugin)}};
+            result.metrics = {
+                {"prepare_ms", summarize(prepareMs).meanUs},
+                {"switch_ms", summarize(switchMs).meanUs},
+                {"total_ms", total.meanUs},
+                {"total_max_ms", total.maxUs},
+                {"failures", static_cast<double>(failures)}
+            };
+            results.push_back(std::move(result));
+            std::cerr << "  switch " << step.name << ": " << formatNumber(total.meanUs) << " ms" << std::endl;
+        }
+        
+        host.stopAudio();
+    }
+    
+    // Duplex on the null engine: a generated sine captured in 256-frame
+    // packets on its own thread, through the input ring into the chain.
+    // Input latency is sampled as the host reports it while running.
+    void RunCaptureSuite(std::vector<Result>& results, const Options& options) {
+        const int bufferSizes[] = {64, 128, 256, 512, 1024};
+        const double seconds = options.measuredBlocks >= 1000 ? 2.0 : 0.5;
+        
+        for (int bufferSize : bufferSizes) {
+            EnhancedVSTHost host(HostMode::Headless);
+            host.setSampleRate(BENCH_SAMPLE_RATE);
+            host.setBufferSize(bufferSize);
+            
+            // Caller-configured, so the engine's own counters stay reachable
+            auto engine = std::make_unique<NullEngine>();
+            NullEngine* device = engine.get();
+            engine->setCaptureEnabled(true);
+            engine->setCaptureSource(std::make_shared<GeneratedCaptureSource>(GeneratedCaptureSource::Signal::Sine));
+            
+            int meterId = host.addMeter({MeterTap::Point::ChainInput});
+            if (!BuildChain(host, options.plugin, 4) || !host.startAudio(std::move(engine))) {
+                std::cerr << "  capture: null engine did not start" << std::endl;
+                return;
+            }
+            
+            std::vector<double> latency;
+            auto end = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+            while (std::chrono::steady_clock::now() < end) {
+                latency.push_back(host.getInputLatencySamples());
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+            
+            LatencyStats stats = host.getLatencyStats();
+            MeterSnapshot input;
+            host.readMeter(meterId, input);
+            const double underruns = static_cast<double>(device->getCaptureUnderruns());
+            const double xruns = static_cast<double>(device->getXrunCount());
+            host.stopAudio();
+            
+            TimingSummary frames = summarize(std::move(latency));
+            Result result;
+            result.suite = "capture";
+            result.name = "sine_b" + std::to_string(bufferSize);
+            result.params = {
+                {"engine", "null"},
+                {"buffer", std::to_string(bufferSize)},
+                {"capture_packet", "256"},
+                {"chain", "4"},
+                {"plugin", PluginLabel(options.plugin)}
+            };
+            result.metrics = {
+                {"input_latency_mean_frames", frames.meanUs},
+                {"input_latency_max_frames", frames.maxUs},
+                {"input_latency_mean_ms", frames.meanUs * 1000.0 / BENCH_SAMPLE_RATE},
+                {"capture_underruns", underruns},
+                {"xruns", xruns},
+                {"callback_mean_us", stats.callback.meanUs},
+                {"callback_p99_us", stats.callback.p99Us},
+                {"input_peak", input.peak[0]}
+            };
+            results.push_back(std::move(result));
+            std::cerr << "  capture " << results.back().name << ": " << formatNumber(frames.meanUs)
+                      << " frames input latency (max " << formatNumber(frames.maxUs) << "), " << underruns
+                      << " underruns" << std::endl;
+        }
+    }
+    
+    // One aggregate run: secondary drift sampled every 50 ms
+    struct AggregateRun {
+        double driftMean{0.0};
+        double driftMin{0.0};
+        double driftMax{0.0};
+        double convergedAt{-1.0};       // Seconds after which drift stayed within tolerance, if it did
+        AggregateEngine::DeviceStatus status{};
+        bool started{false};
+    };
+    
+    AggregateRun RunAggregateCase(const Options& options, double masterPpm, double secondaryPpm, double seconds,
+                                  double expectedPpm, double tolerancePpm) {
+        AggregateRun run;
+        
+        EnhancedVSTHost host(HostMode::Headless);
+        host.setSampleRate(BENCH_SAMPLE_RATE);
+        host.setBufferSize(256);
+        
+        auto master = std::make_unique<NullEngine>();
+        auto secondary = std::make_unique<NullEngine>();
+        master->setClockSkewPpm(masterPpm);
+        secondary->setClockSkewPpm(secondaryPpm);
+        auto engine = std::make_unique<AggregateEngine>();
+        AggregateEngine* aggregate = engine.get();
+        engine->addDevice(std::move(master));
+        engine->addDevice(std::move(secondary));
+        
+        if (!BuildChain(host, options.plugin, 2) || !host.startAudio(std::move(engine))) {
+            return run;
+        }
+        run.started = true;
+        
+        // The last third is the settled window
+        const double settledFrom = seconds * 2.0 / 3.0;
+        std::vector<double> settled;
+        auto start = std::chrono::steady_clock::now();
+        for (;;) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (elapsed >= seconds) {
+                break;
+            }
+            
+            double drift = aggregate->getDeviceStatus()[1].driftPpm;
+            if (std::abs(drift - expectedPpm) > tolerancePpm) {
+                run.convergedAt = -1.0;
+            } else if (run.convergedAt < 0.0) {
+                run.convergedAt = elapsed;
+            }
+            if (elapsed >= settledFrom) {
+                settled.push_back(drift);
+            }
+        }
+        
+        run.status = aggregate->getDeviceStatus()[1];
+        host.stopAudio();
+        
+        for (double value : settled) {
+            run.driftMean += value / settled.size();
+        }
+        auto [driftMin, driftMax] = std::minmax_element(settled.begin(), settled.end());
+        run.driftMin = settled.empty() ? 0.0 : *driftMin;
+        run.driftMax = settled.empty() ? 0.0 : *driftMax;
+        if (run.convergedAt > settledFrom) {
+            run.convergedAt = -1.0;
+        }
+        return run;
+    }
+    
+    // Aggregate of two null engines whose clocks are skewed apart by
+    // 2N ppm. The secondary's drift estimate has to settle on the relative
+    // skew while its FIFO never overflows, and never runs dry unless one of
+    // the devices itself missed a deadline (a gap the FIFO is re-centred after).
+    // Runs where the null engines gap more than once per 2 s say more about
+    // the machine than the aggregate: they are retried, then skipped.
+    void RunAggregateSuite(std::vector<Result>& results, const Options& options) {
+        struct Case {
+            const char* name;
+            double masterPpm;
+            double secondaryPpm;
+        };
+        const Case cases[] = {
+            {"skew_100", 100.0, -100.0},
+            {"skew_-100", -100.0, 100.0}
+        };
+        // The drift loop settles as a 6 s double pole
+        const double seconds = options.measuredBlocks >= 1000 ? 90.0 : 60.0;
+        const int maxAttempts = 3;
+        
+        for (const Case& c : cases) {
+            // The drift estimate reads positive when the secondary runs slow
+            const double expectedPpm = ((1.0 + c.masterPpm * 1e-6) / (1.0 + c.secondaryPpm * 1e-6) - 1.0) * 1e6;
+            const double tolerancePpm = std::max(10.0, std::abs(expectedPpm) * 0.1);
+            
+            AggregateRun run;
+            int attempts = 0;
+            bool quiet = false;
+            while (attempts < maxAttempts && !quiet) {
+                ++attempts;
+                run = RunAggregateCase(options, c.masterPpm, c.secondaryPpm, seconds, expectedPpm, tolerancePpm);
+                if (!run.started) {
+                    std::cerr << "  aggregate: null engines did not start" << std::endl;
+                    return;
+                }
+                quiet = run.status.gaps <= seconds / 2.0;
+            }
+            
+            const AggregateEngine::DeviceStatus& status = run.status;
+            // Converged: the settled window averages within tolerance
+            const bool converged = std::abs(run.driftMean - expectedPpm) <= tolerancePpm;
+            const bool pass = converged && status.overruns == 0 && (status.underruns == 0 || status.gaps > 0);
+            
+            Result result;
+            result.suite = "aggregate";
+            result.name = c.name;
+            result.params = {
+                {"engine", "aggregate-null-null"},
+                {"master_ppm", formatNumber(c.masterPpm)},
+                {"secondary_ppm", formatNumber(c.secondaryPpm)},
+                {"buffer", "256"},
+                {"seconds", formatNumber(seconds)}
+            };
+            result.metrics = {
+                {"expected_drift_ppm", expectedPpm},
+                {"drift_ppm", run.driftMean},
+                {"drift_min_ppm", run.driftMin},
+                {"drift_max_ppm", run.driftMax},
+                {"tolerance_ppm", tolerancePpm},
+                {"converged_s", run.convergedAt},
+                {"fill_frames", status.fillFrames},
+                {"underruns", static_cast<double>(status.underruns)},
+                {"overruns", static_cast<double>(status.overruns)},
+                {"gaps", static_cast<double>(status.gaps)},
+                {"attempts", static_cast<double>(attempts)}
+            };
+            if (quiet) {
+                result.metrics.emplace_back("pass", pass ? 1.0 : 0.0);
+            }
+            results.push_back(std::move(result));
+            std::cerr << "  aggregate " << c.name << ": drift " << formatNumber(run.driftMean) << " ppm (expected "
+                      << formatNumber(expectedPpm) << "), converged at " << formatNumber(run.convergedAt) << " s, "
+                      << status.underruns << " underruns, " << status.overruns << " overruns, " << status.gaps
+                      << " gaps" << (!quiet ? " SKIPPED (devices kept missing deadlines)" : pass ? "" : " FAILED")
+                      << std::endl;
+        }
+    }
+    
+    // Adaptive buffer sizing under load spikes injected into the null
+    // engine. A burst must grow the buffer at least until the spike fits a
+    // period, growth must stay inside the configured range one doubling at a
+    // time, and xruns that return right after a shrink must double the
+    // shrink hold-off each time.
+    void RunAdaptiveSuite(std::vector<Result>& results, const Options& options) {
+        AdaptiveBufferSettings settings;
+        settings.minBufferSize = 128;
+        settings.maxBufferSize = 2048;
+        settings.xrunsToGrow = 2;
+        settings.growWindowSeconds = 2.0;
+        settings.quietSecondsToShrink = 2.0;
+        settings.pollIntervalMs = 20.0;
+        
+        const double burstSpikeMs = 6.0;      // Fits a 512-frame period (10.7 ms), not a 256-frame one
+        const double ceilingSpikeMs = 60.0;   // Longer than the largest period (42.7 ms)
+        const int fitSize = 512;
+        
+        EnhancedVSTHost host(HostMode::Headless);
+        host.setSampleRate(BENCH_SAMPLE_RATE);
+        host.setBufferSize(settings.minBufferSize);
+        
+        auto engine = std::make_unique<NullEngine>();
+        NullEngine* device = engine.get();
+        if (!BuildChain(host, options.plugin, 2) || !host.startAudio(std::move(engine))) {
+            std::cerr << "  adaptive: null engine did not start" << std::endl;
+            return;
+        }
+        host.setAdaptiveBufferSize(true, settings);
+        
+        // Every size the controller picks must stay inside the configured range
+        int smallestSize = settings.minBufferSize;
+        int largestSize = settings.minBufferSize;
+        auto poll = [&](double seconds, const std::function<bool()>& done, double spikeMs) {
+            auto end = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+            while (std::chrono::steady_clock::now() < end && !(done && done())) {
+                if (spikeMs > 0.0) {
+                    device->injectLoadSpike(spikeMs, 16);
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                AdaptiveBufferStats stats = host.getAdaptiveBufferStats();
+                smallestSize = std::min(smallestSize, stats.bufferSize);
+                largestSize = std::max(largestSize, stats.bufferSize);
+            }
+            device->injectLoadSpike(0.0, 0);
+        };
+        
+        auto addCheck = [&](const std::string& name, const AdaptiveBufferStats& stats, double expected,
+                            double measured, bool pass) {
+            Result result;
+            result.suite = "adaptive";
+            result.name = name;
+            result.params = {
+                {"engine", "null"},
+                {"min_buffer", std::to_string(settings.minBufferSize)},
+                {"max_buffer", std::to_string(settings.maxBufferSize)},
+                {"quiet_s", formatNumber(settings.quietSecondsToShrink)}
+            };
+            result.metrics = {
+                {"expected", expected},
+                {"measured", measured},
+                {"buffer_size", static_cast<double>(stats.bufferSize)},
+                {"steps_up", static_cast<double>(stats.stepsUp)},
+                {"steps_down", static_cast<double>(stats.stepsDown)},
+                {"shrink_hold_s", stats.shrinkHoldSeconds},
+                {"xruns", static_cast<double>(stats.xruns)},
+                {"pass", pass ? 1.0 : 0.0}
+            };
+            results.push_back(std::move(result));
+            std::cerr << "  adaptive " << name << ": " << formatNumber(measured) << " (expected "
+                      << formatNumber(expected) << "), buffer " << stats.bufferSize << ", " << stats.stepsUp
+                      << " up / " << stats.stepsDown << " down" << (pass ? "" : " FAILED") << std::endl;
+        };
+        
+        // Each step doubles or halves the size, so the net step count
+        // follows from it
+        auto netSteps = [&](int size) {
+            return static_cast<int>(std::lround(std::log2(static_cast<double>(size) / settings.minBufferSize)));
+        };
+        
+        // Burst: spikes that fit a 512-frame period grow 128 -> 512. Stray
+        // xruns of the machine may take it further, never past the maximum.
+        poll(1.5, nullptr, burstSpikeMs);
+        poll(0.5, nullptr, 0.0);
+        AdaptiveBufferStats burst = host.getAdaptiveBufferStats();
+        addCheck("burst_size", burst, fitSize, burst.bufferSize,
+                 burst.bufferSize >= fitSize && burst.bufferSize <= settings.maxBufferSize &&
+                 burst.stepsUp - burst.stepsDown == netSteps(burst.bufferSize));
+        
+        // Ceiling: spikes longer than any period grow to the maximum, no further
+        poll(3.0, [&] { return host.getAdaptiveBufferStats().bufferSize >= settings.maxBufferSize; }, ceilingSpikeMs);
+        poll(1.0, nullptr, ceilingSpikeMs);
+        AdaptiveBufferStats ceiling = host.getAdaptiveBufferStats();
+        addCheck("ceiling_size", ceiling, settings.maxBufferSize, largestSize,
+                 ceiling.bufferSize == settings.maxBufferSize && largestSize == settings.maxBufferSize &&
+                 smallestSize >= settings.minBufferSize &&
+                 ceiling.stepsUp - ceiling.stepsDown == netSteps(settings.maxBufferSize));
+        
+        // Relapses: wait out the hold-off for a shrink, then spike straight
+        // away. Each relapse must grow back and double the hold-off.
+        for (int relapse = 1; relapse <= 2; ++relapse) {
+            AdaptiveBufferStats before = host.getAdaptiveBufferStats();
+            poll(before.shrinkHoldSeconds * 2.0 + 10.0,
+                 [&] { return host.getAdaptiveBufferStats().stepsDown > before.stepsDown; }, 0.0);
+            AdaptiveBufferStats shrunk = host.getAdaptiveBufferStats();
+            
+            poll(2.0, [&] { return host.getAdaptiveBufferStats().stepsUp > shrunk.stepsUp; }, ceilingSpikeMs);
+            poll(0.2, nullptr, 0.0);
+            AdaptiveBufferStats after = host.getAdaptiveBufferStats();
+            
+            const bool shrank = shrunk.stepsDown > before.stepsDown;
+            const bool grew = after.stepsUp > shrunk.stepsUp;
+            addCheck("relapse_" + std::to_string(relapse) + "_hold", after, shrunk.shrinkHoldSeconds * 2.0,
+                     after.shrinkHoldSeconds,
+                     shrank && grew && after.shrinkHoldSeconds == shrunk.shrinkHoldSeconds * 2.0);
+        }
+        
+        host.setAdaptiveBufferSize(false);
+        host.stopAudio();
+    }
+    
+    // Resonant float IIRs ringing in the subnormal range, with and without
+    // FTZ/DAZ. The audible row is the baseline cost of the same chain.
+    void RunDenormalSuite(std::vector<Result>& results, const Options& options) {
+        struct Case {
+            const char* name;
+            float level;     // Impulse at the start of every block
+            bool protection;
+        };
+        const Case cases[] = {
+            {"audible", 0.1f, false},
+            {"subnormal_unprotected", 1e-38f, false},
+            {"subnormal_protected", 1e-38f, true}
+        };
+        
+        const int bufferSize = 256;
+        const int numChannels = 2;
+        const int chainLength = 8;
+        
+        Synthetic::Settings plugin;
+        plugin.kind = Synthetic::Kind::Iir;
+        plugin.iirCutoffHz = 200.0;
+        plugin.iirQ = 20.0;
+        
+        for (const Case& c : cases) {
+            EnhancedVSTHost host(HostMode::Headless);
+            host.setSampleRate(BENCH_SAMPLE_RATE);
+            host.setBufferSize(bufferSize);
+            host.setDenormalProtection(c.protection);
+            if (!BuildChain(host, plugin, chainLength) || !host.beginOfflineRender(numChannels)) {
+                std::cerr << "  denormal: failed to set up chain" << std::endl;
+                return;
+            }
+            
+            Buffers buffers(numChannels, bufferSize);
+            for (auto& channel : buffers.inputs) {
+                std::fill(channel.begin(), channel.end(), 0.0f);
+                channel[0] = c.level;
+            }
+            
+            std::vector<double> timings;
+            for (int i = 0; i < options.warmupBlocks + options.measuredBlocks; ++i) {
+                auto start = std::chrono::steady_clock::now();
+                host.renderOffline(buffers.inputPtrs.data(), buffers.outputPtrs.data(), bufferSize);
+                std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+                if (i >= options.warmupBlocks) {
+                    timings.push_back(elapsed.count());
+                }
+            }
+            host.endOfflineRender();
+            
+            ChainConfig config;
+            config.plugin = plugin;
+            config.chainLength = chainLength;
+            config.numChannels = numChannels;
+            config.bufferSize = bufferSize;
+            TimingSummary summary = summarize(std::move(timings));
+            AddChainResult(results, "denormal", config, summary);
+            results.back().name = c.name;
+            results.back().params.push_back({"protection", c.protection ? "on" : "off"});
+            std::cerr << "  denormal " << c.name << ": " << formatNumber(summary.meanUs) << " us mean" << std::endl;
+        }
+    }
+    
+    // Sequential audio file throughput: encode + asynchronous write, then
+    // mapped read + decode, and the zero-copy view for float files. Reads
+    // follow the writes, so they mostly come from the page cache and measure
+    // the mapping and conversion cost rather than the disk.
+    void RunFileSuite(std::vector<Result>& results, const Options& options) {
+        struct Case {
+            const char* name;
+            SampleFormat format;
+            AudioContainer container;
+        };
+        const Case cases[] = {
+            {"f32_wav", SampleFormat::Float32, AudioContainer::Wav},
+            {"pcm24_wav", SampleFormat::Pcm24, AudioContainer::Wav},
+            {"pcm16_wav", SampleFormat::Pcm16, AudioContainer::Wav},
+            {"f32_w64", SampleFormat::Float32, AudioContainer::W64}
+        };
+        
+        const int numChannels = 2;
+        const int blockFrames = 4096;
+        std::error_code error;
+        std::filesystem::path dir = options.fileDir.empty() ? std::filesystem::temp_directory_path(error)
+                                                            : std::filesystem::path(options.fileDir);
+        Buffers buffers(numChannels, blockFrames);
+        std::vector<float*> readPtrs = buffers.outputPtrs;
+        
+        for (const Case& c : cases) {
+            const int64_t fileBytes = static_cast<int64_t>(options.fileMegabytes) << 20;
+            const int64_t totalFrames = fileBytes / (getBytesPerSample(c.format) * numChannels);
+            const std::filesystem::path path = dir / (std::string("evh_bench_") + c.name + ".tmp");
+            
+            auto addResult = [&](const char* op, double seconds) {
+                const double megabytes = totalFrames * getBytesPerSample(c.format) * numChannels / 1048576.0;
+                Result result;
+                result.suite = "fileio";
+                result.name = std::string(op) + "_" + c.name;
+                result.params = {{"op", op}, {"file", c.name}, {"channels", std::to_string(numChannels)},
+                                 {"megabytes", std::to_string(options.fileMegabytes)}};
+                result.metrics = {
+                    {"mb_per_s", megabytes / seconds},
+                    {"x_realtime", totalFrames / BENCH_SAMPLE_RATE / seconds}
+                };
+                results.push_back(std::move(result));
+                std::cerr << "  fileio " << results.back().name << ": " << formatNumber(megabytes / seconds)
+                          << " MB/s" << std::endl;
+            };
+            
+            // Write, including the close() that drains the queue
+            auto start = std::chrono::steady_clock::now();
+            AudioFileWriter writer;
+            bool ok = writer.create(path.wstring(), numChannels, BENCH_SAMPLE_RATE, c.format, c.container);
+            for (int64_t done = 0; ok && done < totalFrames; done += blockFrames) {
+                int frames = static_cast<int>(std::min<int64_t>(blockFrames, totalFrames - done));
+                ok = writer.write(buffers.inputPtrs.data(), frames);
+            }
+            ok = writer.close() && ok;
+            if (!ok) {
+                std::wcerr << L"  fileio: " << writer.getLastError() << std::endl;
+                std::filesystem::remove(path, error);
+                return;
+            }
+            addResult("write", std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+            
+            // The checksum keeps the reads from being optimised away
+            volatile float sink = 0.0f;
+            start = std::chrono::steady_clock::now();
+            AudioFileReader reader;
+            if (reader.open(path.wstring())) {
+                float sum = 0.0f;
+                while (int frames = reader.read(readPtrs.data(), blockFrames)) {
+                    sum += readPtrs[0][frames - 1];
+                }
+                sink = sum;
+                addResult("read", std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+            }
+            
+            if (reader.seek(0) && reader.canView()) {
+                start = std::chrono::steady_clock::now();
+                float sum = 0.0f;
+                const float* interleaved = nullptr;
+                while (int frames = reader.view(&interleaved, blockFrames)) {
+                    for (int i = 0; i < frames * numChannels; ++i) {
+                        sum += interleaved[i];
+                    }
+                }
+                sink = sum;
+                addResult("view", std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+            }
+            (void)sink;
+            
+            reader.close();
+            std::filesystem::remove(path, error);
+        }
+    }
+    
+    std::string LengthLabel(int64_t length) {
+        if (length >= 1000000 && length % 1000000 == 0) {
+            return std::to_string(length / 1000000) + "M";
+        }
+        if (length >= 1000 && length % 1000 == 0) {
+            return std::to_string(length / 1000) + "k";
+        }
+        return std::to_string(length);
+    }
+    
+    // The partitioned convolver node against a direct-form FIR of the same
+    // impulse length (1k to 10M taps). Offline renders wait for the
+    // convolver's tail workers, so its timings include them. Long direct
+    // FIRs take seconds per block and stop after a time budget.
+    void RunConvolutionSuite(std::vector<Result>& results, const Options& options) {
+        const int bufferSize = 256;
+        const int numChannels = 2;
+        const double directBudgetSeconds = 2.0;
+        const double blockUs = bufferSize * 1e6 / BENCH_SAMPLE_RATE;
+        std::mt19937 rng(99);
+        std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+        
+        for (int64_t length = 1000; length <= options.maxImpulseLength; length *= 10) {
+            std::vector<float> impulse(static_cast<size_t>(length));
+            for (int64_t i = 0; i < length; ++i) {
+                impulse[i] = noise(rng) * static_cast<float>(std::exp(-6.0 * i / length));
+            }
+            
+            for (bool direct : {false, true}) {
+                const char* method = direct ? "direct" : "partitioned";
+                EnhancedVSTHost host(HostMode::Headless);
+                host.setSampleRate(BENCH_SAMPLE_RATE);
+                host.setBufferSize(bufferSize);
+                
+                std::unique_ptr<AudioProcessor> processor;
+                if (direct) {
+                    Synthetic::Settings fir;
+                    fir.kind = Synthetic::Kind::Fir;
+                    fir.firTaps = static_cast<int>(length);
+                    processor = Synthetic::create(fir);
+                } else {
+                    auto convolver = std::make_unique<Nodes::ConvolverNode>();
+                    convolver->setImpulseResponse({impulse}, BENCH_SAMPLE_RATE);
+                    processor = std::move(convolver);
+                }
+                
+                int pluginId = host.loadProcessor(std::move(processor));
+                if (pluginId != 0) {
+                    host.addPluginToChain(pluginId);
+                }
+                if (pluginId == 0 || !host.beginOfflineRender(numChannels)) {
+                    std::cerr << "  convolution: failed to set up " << method << std::endl;
+                    return;
+                }
+                
+                // The largest partitions only come round every 256 blocks
+                Buffers buffers(numChannels, bufferSize);
+                const int warmup = direct ? 0 : options.warmupBlocks;
+                const int blocks = direct ? options.measuredBlocks : std::max(options.measuredBlocks, 2048);
+                std::vector<double> timings;
+                auto suiteStart = std::chrono::steady_clock::now();
+                for (int i = 0; i < warmup + blocks; ++i) {
+                    auto start = std::chrono::steady_clock::now();
+                    host.renderOffline(buffers.inputPtrs.data(), buffers.outputPtrs.data(), bufferSize);
+                    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+                    if (i >= warmup) {
+                        timings.push_back(elapsed.count());
+                    }
+                    
+                    std::chrono::duration<double> total = std::chrono::steady_clock::now() - suiteStart;
+                    if (direct && timings.size() >= 3 && total.count() > directBudgetSeconds) {
+                        break;
+                    }
+                }
+                host.endOfflineRender();
+                
+                const size_t measured = timings.size();
+                TimingSummary summary = summarize(std::move(timings));
+                Result result;
+                result.suite = "convolution";
+                result.name = std::string(method) + "_" + LengthLabel(length);
+                result.params = {
+                    {"method", method},
+                    {"ir_length", std::to_string(length)},
+                    {"channels", std::to_string(numChannels)},
+                    {"buffer", std::to_string(bufferSize)},
+                    {"blocks", std::to_string(measured)}
+                };
+                result.metrics = {
+                    {"mean_us", summary.meanUs},
+                    {"p50_us", summary.p50Us},
+                    {"p99_us", summary.p99Us},
+                    {"max_us", summary.maxUs},
+                    {"load", summary.meanUs / blockUs},
+                    {"x_realtime", blockUs / summary.meanUs}
+                };
+                results.push_back(std::move(result));
+                std::cerr << "  convolution " << results.back().name << ": " << formatNumber(summary.meanUs)
+                          << " us mean, " << formatNumber(blockUs / summary.meanUs) << " x realtime" << std::endl;
+            }
+        }
+    }
+    
+    // Utility nodes that all have a 64-bit path; mixed adds a 32-bit
+    // synthetic gain after every other one, each converted both ways in a
+    // double chain
+    int BuildPrecisionChain(EnhancedVSTHost& host, bool mixed) {
+        auto routing = std::make_unique<Nodes::RoutingNode>(2);
+        routing->setGain(0, 1, 0.5f);
+        auto polarity = std::make_unique<Nodes::PolarityNode>(1u);
+        
+        std::vector<std::unique_ptr<AudioProcessor>> nodes;
+        nodes.push_back(std::make_unique<Nodes::GainNode>(-3.0f));
+        nodes.push_back(std::move(polarity));
+        nodes.push_back(std::move(routing));
+        nodes.push_back(std::make_unique<Nodes::PanNode>(0.2f));
+        nodes.push_back(std::make_unique<Nodes::GainNode>(3.0f));
+        nodes.push_back(std::make_unique<Nodes::MeterNode>());
+        
+        int count = 0;
+        for (auto& node : nodes) {
+            int pluginId = host.loadProcessor(std::move(node));
+            if (pluginId == 0) {
+                return 0;
+            }
+            host.addPluginToChain(pluginId);
+            ++count;
+            
+            if (mixed && count % 2 == 1) {
+                Synthetic::Settings gain;
+                gain.kind = Synthetic::Kind::Gain;
+                pluginId = host.loadProcessor(Synthetic::create(gain));
+                if (pluginId == 0) {
+                    return 0;
+                }
+                host.addPluginToChain(pluginId);
+                ++count;
+            }
+        }
+        return count;
+    }
+    
+    // Single against double precision over the same chain. The largest
+    // points (32 channels of 4096 frames, 1 MB per chain buffer in double)
+    // no longer fit in L2, so the double/single ratio there shows the
+    // memory-bandwidth cost as well as the arithmetic. gb_per_s counts each
+    // node reading and writing the whole chain buffer once.
+    void RunPrecisionSuite(std::vector<Result>& results, const Options& options) {
+        const int channelCounts[] = {2, 8, 32};
+        const int bufferSizes[] = {64, 512, 4096};
+        
+        for (bool mixed : {false, true}) {
+            const char* chainName = mixed ? "mixed" : "native";
+            for (int channels : channelCounts) {
+                for (int bufferSize : bufferSizes) {
+                    double singleMeanUs = 0.0;
+                    for (ProcessPrecision precision : {ProcessPrecision::Single, ProcessPrecision::Double}) {
+                        const bool isDouble = precision == ProcessPrecision::Double;
+                        EnhancedVSTHost host(HostMode::Headless);
+                        host.setSampleRate(BENCH_SAMPLE_RATE);
+                        host.setBufferSize(bufferSize);
+                        host.setProcessPrecision(precision);
+                        
+                        const int nodes = BuildPrecisionChain(host, mixed);
+                        if (nodes == 0 || !host.beginOfflineRender(channels)) {
+                            std::cerr << "  precision: failed to set up " << chainName << std::endl;
+                            return;
+                        }
+                        
+                        Buffers buffers(channels, bufferSize);
+                        for (int i = 0; i < options.warmupBlocks; ++i) {
+                            host.renderOffline(buffers.inputPtrs.data(), buffers.outputPtrs.data(), bufferSize);
+                        }
+                        
+                        std::vector<double> timings;
+                        timings.reserve(options.measuredBlocks);
+                        for (int i = 0; i < options.measuredBlocks; ++i) {
+                            auto start = std::chrono::steady_clock::now();
+                            host.renderOffline(buffers.inputPtrs.data(), buffers.outputPtrs.data(), bufferSize);
+                            std::chrono::duration<double, std::micro> elapsed =
+                                std::chrono::steady_clock::now() - start;
+                            timings.push_back(elapsed.count());
+                        }
+                        host.endOfflineRender();
+                        
+                        TimingSummary summary = summarize(std::move(timings));
+                        const double blockUs = bufferSize * 1e6 / BENCH_SAMPLE_RATE;
+                        const double bufferBytes =
+                            static_cast<double>(channels) * bufferSize * (isDouble ? sizeof(double) : sizeof(float));
+                        if (!isDouble) {
+                            singleMeanUs = summary.meanUs;
+                        }
+                        
+                        Result result;
+                        result.suite = "precision";
+                        result.name = std::string(chainName) + (isDouble ? "_f64" : "_f32") + "_ch" +
+                                      std::to_string(channels) + "_b" + std::to_string(bufferSize);
+                        result.params = {
+                            {"chain", chainName},
+                            {"precision", isDouble ? "double" : "single"},
+                            {"nodes", std::to_string(nodes)},
+                            {"channels", std::to_string(channels)},
+                            {"buffer", std::to_string(bufferSize)}
+                        };
+                        result.metrics = {
+                            {"mean_us", summary.meanUs},
+                            {"p99_us", summary.p99Us},
+                            {"ns_per_frame", summary.meanUs * 1000.0 / bufferSize},
+                            {"x_realtime", blockUs / summary.meanUs},
+                            {"buffer_bytes", bufferBytes},
+                            {"gb_per_s", 2.0 * nodes * bufferBytes / (summary.meanUs * 1000.0)},
+                            {"vs_single", summary.meanUs / singleMeanUs}
+                        };
+                        results.push_back(std::move(result));
+                        std::cerr << "  precision " << results.back().name << ": " << formatNumber(summary.meanUs)
+                                  << " us mean, " << formatNumber(summary.meanUs / singleMeanUs) << " x single"
+                                  << std::endl;
+                    }
+                }
+            }
+        }
+    }
+    
+    const char* QualityName(ResamplerQuality quality) {
+        switch (quality) {
+            case ResamplerQuality::Draft:     return "draft";
+            case ResamplerQuality::Normal:    return "normal";
+            case ResamplerQuality::High:      return "high";
+            case ResamplerQuality::Mastering: return "mastering";
+        }
+        return "high";
+    }
+    
+    constexpr ResamplerQuality ALL_QUALITIES[] = {
+        ResamplerQuality::Draft, ResamplerQuality::Normal, ResamplerQuality::High, ResamplerQuality::Mastering
+    };
+    
+    // SampleRateConverter cost per channel at each preset, up and down
+    // between 44.1 and 48 kHz, one 512-frame input block per call
+    void RunResamplerSuite(std::vector<Result>& results, const Options& options) {
+        const int blockSize = 512;
+        const int channelCounts[] = {1, 2, 8, 32};
+        const std::pair<double, double> rates[] = {{44100.0, 48000.0}, {48000.0, 44100.0}};
+        
+        for (ResamplerQuality quality : ALL_QUALITIES) {
+            for (const auto& [inputRate, outputRate] : rates) {
+                for (int channels : channelCounts) {
+                    SampleRateConverter converter(channels, inputRate, outputRate, quality, blockSize);
+                    Buffers buffers(channels, blockSize);
+                    const int maxOutput = converter.getMaxOutputFrames(blockSize);
+                    std::vector<std::vector<float>> outputs(channels, std::vector<float>(maxOutput));
+                    std::vector<float*> outputPtrs;
+                    for (auto& channel : outputs) {
+                        outputPtrs.push_back(channel.data());
+                    }
+                    
+                    for (int i = 0; i < options.warmupBlocks; ++i) {
+                        converter.process(buffers.inputPtrs.data(), blockSize, outputPtrs.data(), maxOutput);
+                    }
+                    
+                    std::vector<double> timings;
+                    timings.reserve(options.measuredBlocks);
+                    for (int i = 0; i < options.measuredBlocks; ++i) {
+                        auto start = std::chrono::steady_clock::now();
+                        converter.process(buffers.inputPtrs.data(), blockSize, outputPtrs.data(), maxOutput);
+                        std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+                        timings.push_back(elapsed.count());
+                    }
+                    
+                    TimingSummary summary = summarize(std::move(timings));
+                    const double blockUs = blockSize * 1e6 / inputRate;
+                    const std::string direction = formatNumber(inputRate) + "_to_" + formatNumber(outputRate);
+                    
+                    Result result;
+                    result.suite = "resampler";
+                    result.name = std::string(QualityName(quality)) + "_" + direction + "_ch" +
+                                  std::to_string(channels);
+                    result.params = {
+                        {"quality", QualityName(quality)},
+                        {"taps", std::to_string(converter.getNumTaps())},
+                        {"input_rate", formatNumber(inputRate)},
+                        {"output_rate", formatNumber(outputRate)},
+                        {"channels", std::to_string(channels)},
+                        {"buffer", std::to_string(blockSize)}
+                    };
+                    result.metrics = {
+                        {"mean_us", summary.meanUs},
+                        {"p99_us", summary.p99Us},
+                        {"ns_per_frame", summary.meanUs * 1000.0 / blockSize},
+                        {"ns_per_channel_frame", summary.meanUs * 1000.0 / (blockSize * channels)},
+                        {"x_realtime", blockUs / summary.meanUs}
+                    };
+                    results.push_back(std::move(result));
+                    std::cerr << "  resampler " << results.back().name << ": " << formatNumber(summary.meanUs)
+                              << " us mean, " << formatNumber(summary.meanUs * 1000.0 / (blockSize * channels))
+                              << " ns per channel frame" << std::endl;
+                }
+            }
+        }
+    }
+    
+    // What each preset has to reach: ripple up to flatFraction of the lower
+    // Nyquist, alias rejection of tones from stopStartHz up when decimating
+    // 96 kHz to 44.1 kHz, and THD+N of a -1 dBFS 997 Hz tone
+    struct ResamplerTarget {
+        ResamplerQuality quality;
+        double flatFraction;
+        double maxRippleDb;
+        double stopStartHz;
+        double minRejectionDb;
+        double maxThdNDb;
+    };
+    
+    const ResamplerTarget RESAMPLER_TARGETS[] = {
+        {ResamplerQuality::Draft,     0.45, 0.05, 30000.0,  55.0,  -65.0},
+        {ResamplerQuality::Normal,    0.68, 0.05, 30000.0,  80.0,  -90.0},
+        {ResamplerQuality::High,      0.80, 0.01, 26000.0,  95.0, -105.0},
+        {ResamplerQuality::Mastering, 0.86, 0.01, 24000.0, 115.0, -130.0}
+    };
+    
+    // Skipped at the start of every converted tone so the filter has settled
+    constexpr int TONE_SETTLE_FRAMES = 2048;
+    constexpr int TONE_ANALYSIS_FRAMES = 32768;
+    
+    // Mono sine through a fresh converter, settle frames included
+    std::vector<float> ResampleTone(ResamplerQuality quality, double inputRate, double outputRate,
+                                    double frequency, double amplitude) {
+        const int blockSize = 512;
+        const int wanted = TONE_SETTLE_FRAMES + TONE_ANALYSIS_FRAMES;
+        SampleRateConverter converter(1, inputRate, outputRate, quality, blockSize);
+        std::vector<float> input(blockSize);
+        std::vector<float> block(converter.getMaxOutputFrames(blockSize));
+        std::vector<float> output;
+        output.reserve(wanted + block.size());
+        
+        int64_t position = 0;
+        while (static_cast<int>(output.size()) < wanted) {
+            for (float& sample : input) {
+                sample = static_cast<float>(amplitude * std::sin(2.0 * PI * frequency * position++ / inputRate));
+            }
+            const float* inputPtr = input.data();
+            float* outputPtr = block.data();
+            int produced = converter.process(&inputPtr, blockSize, &outputPtr, static_cast<int>(block.size()));
+            output.insert(output.end(), block.begin(), block.begin() + produced);
+        }
+        output.resize(wanted);
+        return output;
+    }
+    
+    // Kaiser window with beta 20: sidelobes far below the -130 dB targets,
+    // so a strong tone does not leak into the measurement of a weak one
+    std::vector<double> AnalysisWindow() {
+        auto besselI0 = [](double x) {
+            double sum = 1.0;
+            double term = 1.0;
+            for (int k = 1; k < 200 && term > sum * 1e-17; ++k) {
+                term *= (x / (2.0 * k)) * (x / (2.0 * k));
+                sum += term;
+            }
+            return sum;
+        };
+        
+        const double beta = 20.0;
+        std::vector<double> window(TONE_ANALYSIS_FRAMES);
+        for (int i = 0; i < TONE_ANALYSIS_FRAMES; ++i) {
+            double r = 2.0 * i / (TONE_ANALYSIS_FRAMES - 1) - 1.0;
+            window[i] = besselI0(beta * std::sqrt(std::max(0.0, 1.0 - r * r))) / besselI0(beta);
+        }
+        return window;
+    }
+    
+    // Amplitude and phase of the component at frequency (windowed DFT bin)
+    double ToneAmplitude(const float* data, double frequency, double rate, const std::vector<double>& window,
+                         double* phase = nullptr) {
+        double re = 0.0;
+        double im = 0.0;
+        double weight = 0.0;
+        for (int i = 0; i < TONE_ANALYSIS_FRAMES; ++i) {
+            double angle = 2.0 * PI * frequency * i / rate;
+            re += window[i] * data[i] * std::cos(angle);
+            im += window[i] * data[i] * std::sin(angle);
+            weight += window[i];
+        }
+        if (phase) {
+            *phase = std::atan2(re, im);
+        }
+        return 2.0 * std::sqrt(re * re + im * im) / weight;
+    }
+    
+    void AddQualityCheck(std::vector<Result>& results, ResamplerQuality quality, const std::string& check,
+                         double inputRate, double outputRate, double value, double limit, bool lowerIsBetter) {
+        const bool pass = lowerIsBetter ? value <= limit : value >= limit;
+        
+        Result result;
+        result.suite = "srcquality";
+        result.name = std::string(QualityName(quality)) + "_" + check + "_" + formatNumber(inputRate) + "_to_" +
+                      formatNumber(outputRate);
+        result.params = {
+            {"quality", QualityName(quality)},
+            {"check", check},
+            {"input_rate", formatNumber(inputRate)},
+            {"output_rate", formatNumber(outputRate)}
+        };
+        result.metrics = {
+            {"value_db", value},
+            {"limit_db", limit},
+            {"pass", pass ? 1.0 : 0.0}
+        };
+        results.push_back(std::move(result));
+        std::cerr << "  srcquality " << results.back().name << ": " << formatNumber(value) << " dB (limit "
+                  << formatNumber(limit) << ")" << (pass ? "" : " FAILED") << std::endl;
+    }
+    
+    // Passband ripple, alias rejection and THD+N per preset. Failed checks
+    // are marked pass = 0 and make evh_bench exit non-zero.
+    void RunResamplerQualitySuite(std::vector<Result>& results, const Options&) {
+        const std::vector<double> window = AnalysisWindow();
+        const std::pair<double, double> rates[] = {{44100.0, 48000.0}, {48000.0, 44100.0}};
+        const double amplitude = std::pow(10.0, -1.0 / 20.0);
+        
+        for (const ResamplerTarget& target : RESAMPLER_TARGETS) {
+            for (const auto& [inputRate, outputRate] : rates) {
+                // Gain at 20 Hz and eight tones spread up to the edge of the flat band
+                const double flatEdge = target.flatFraction * std::min(inputRate, outputRate) / 2.0;
+                double ripple = 0.0;
+                for (int k = 0; k <= 8; ++k) {
+                    const double frequency = k == 0 ? 20.0 : flatEdge * k / 8.0;
+                    std::vector<float> tone = ResampleTone(target.quality, inputRate, outputRate, frequency,
+                                                           amplitude);
+                    double gain = ToneAmplitude(tone.data() + TONE_SETTLE_FRAMES, frequency, outputRate, window) /
+                                  amplitude;
+                    ripple = std::max(ripple, std::abs(20.0 * std::log10(gain)));
+                }
+                AddQualityCheck(results, target.quality, "ripple", inputRate, outputRate, ripple,
+                                target.maxRippleDb, true);
+                
+                // Everything that is not the fundamental: noise, distortion and images
+                std::vector<float> tone = ResampleTone(target.quality, inputRate, outputRate, 997.0, amplitude);
+                const float* data = tone.data() + TONE_SETTLE_FRAMES;
+                double phase = 0.0;
+                double fitted = ToneAmplitude(data, 997.0, outputRate, window, &phase);
+                double residual = 0.0;
+                double signal = 0.0;
+                for (int i = 0; i < TONE_ANALYSIS_FRAMES; ++i) {
+                    double sine = fitted * std::sin(2.0 * PI * 997.0 * i / outputRate + phase);
+                    residual += window[i] * (data[i] - sine) * (data[i] - sine);
+                    signal += window[i] * sine * sine;
+                }
+                AddQualityCheck(results, target.quality, "thdn", inputRate, outputRate,
+                                10.0 * std::log10(residual / signal + 1e-30), target.maxThdNDb, true);
+            }
+            
+            // Tones above the output Nyquist fold back to |f - 44.1k|
+            const double inputRate = 96000.0;
+            const double outputRate = 44100.0;
+            double worst = HUGE_VAL;
+            for (double frequency = target.stopStartHz; frequency < inputRate / 2.0; frequency += 1000.0) {
+                std::vector<float> tone = ResampleTone(target.quality, inputRate, outputRate, frequency, amplitude);
+                const double alias = std::abs(frequency - outputRate * std::round(frequency / outputRate));
+                double level = ToneAmplitude(tone.data() + TONE_SETTLE_FRAMES, alias, outputRate, window) / amplitude;
+                worst = std::min(worst, -20.0 * std::log10(level + 1e-30));
+            }
+            AddQualityCheck(results, target.quality, "rejection", inputRate, outputRate, worst,
+                            target.minRejectionDb, false);
+        }
+    }
+    
+    // Render target as cheap as an engine callback gets: stereo gain
+    struct DispatchTarget {
+        float gain{0.5f};
+        
+        void render(const float** inputs, float** outputs, int numSamples, const ProcessContext&) {
+            for (int ch = 0; ch < 2; ++ch) {
+                for (int i = 0; i < numSamples; ++i) {
+                    outputs[ch][i] = inputs[ch][i] * gain;
+                }
+            }
+        }
+    };
+    
+    // One batch of calls through a callable, in microseconds. The callable
+    // is read through a volatile pointer each call, as an engine reads its
+    // callback member, so the compiler cannot bind it at the call site.
+    template<typename Callable>
+    double TimeDispatchBatch(Callable& callable, Buffers& buffers, int numSamples, int calls) {
+        Callable* volatile target = &callable;
+        const ProcessContext context;
+        
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < calls; ++i) {
+            (*target)(buffers.inputPtrs.data(), buffers.outputPtrs.data(), numSamples, context);
+        }
+        std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count();
+    }
+    
+    // Engine-to-host callback cost at the smallest blocks, where dispatch
+    // is a measurable share of the work: RenderCallback against the
+    // std::function it replaced, with a direct member call as the floor
+    void RunDispatchSuite(std::vector<Result>& results, const Options& options) {
+        const int blockSizes[] = {16, 32};
+        const int callsPerBatch = 1000;
+        
+        using Function = std::function<void(const float**, float**, int, const ProcessContext&)>;
+        
+        for (int blockSize : blockSizes) {
+            DispatchTarget target;
+            Buffers buffers(2, blockSize);
+            
+            RenderCallback renderCallback = RenderCallback::bind<&DispatchTarget::render>(&target);
+            Function function = [&target](const float** inputs, float** outputs, int numSamples,
+                                          const ProcessContext& context) {
+                target.render(inputs, outputs, numSamples, context);
+            };
+            auto direct = [&target](const float** inputs, float** outputs, int numSamples,
+                                    const ProcessContext& context) {
+                target.render(inputs, outputs, numSamples, context);
+            };
+            
+            // Batches interleaved so all three see the same machine state
+            const char* names[] = {"direct", "render_callback", "std_function"};
+            std::vector<double> timings[3];
+            for (int b = -options.warmupBlocks; b < options.measuredBlocks; ++b) {
+                double batch[] = {
+                    TimeDispatchBatch(direct, buffers, blockSize, callsPerBatch),
+                    TimeDispatchBatch(renderCallback, buffers, blockSize, callsPerBatch),
+                    TimeDispatchBatch(function, buffers, blockSize, callsPerBatch)
+                };
+                for (int k = 0; b >= 0 && k < 3; ++k) {
+                    timings[k].push_back(batch[k]);
+                }
+            }
+            
+            // Microseconds per batch of 1000 calls read as nanoseconds per call
+            const double directNs = summarize(timings[0]).meanUs * 1000.0 / callsPerBatch;
+            for (int k = 0; k < 3; ++k) {
+                const std::string name = names[k];
+                TimingSummary summary = summarize(timings[k]);
+                const double ns = summary.meanUs * 1000.0 / callsPerBatch;
+                
+                Result result;
+                result.suite = "dispatch";
+                result.name = name + "_b" + std::to_string(blockSize);
+                result.params = {
+                    {"callable", name},
+                    {"buffer", std::to_string(blockSize)},
+                    {"channels", "2"},
+                    {"calls", std::to_string(static_cast<int64_t>(options.measuredBlocks) * callsPerBatch)}
+                };
+                result.metrics = {
+                    {"ns_per_call", ns},
+                    {"p50_ns_per_call", summary.p50Us * 1000.0 / callsPerBatch},
+                    {"p99_ns_per_call", summary.p99Us * 1000.0 / callsPerBatch},
+                    {"overhead_ns", ns - directNs}
+                };
+                results.push_back(std::move(result));
+                std::cerr << "  dispatch " << results.back().name << ": " << formatNumber(ns) << " ns per call ("
+                          << formatNumber(ns - directNs) << " ns over direct)" << std::endl;
+            }
+        }
+    }
+    
+    void PrintUsage() {
+        std::cerr <<
+            "Usage: evh_bench [options]\n"
+            "  --suite a,b,...     plugins, chain, channels, buffers, switch, denormal, fileio, convolution,\n"
+            "                      precision, resampler, srcquality, capture, aggregate, adaptive, dispatch\n"
+            "                      (default: all)\n"
+            "  --plugin KIND       Processor used by the sweeps: passthrough, gain, fir, iir, alloc, jitter\n"
+            "  --fir-taps N        FIR length (default 64)\n"
+            "  --blocks N          Measured blocks per point (default 2000)\n"
+            "  --quick             200 blocks per point, 64 MB fileio files, impulses up to 1M\n"
+            "  --file-mb N         Size of each fileio test file (default 512)\n"
+            "  --file-dir DIR      Where fileio writes its test files (default: system temp)\n"
+            "  --ir-max N          Longest convolution impulse in frames (default 10000000)\n"
+            "  --format json|csv   Output format (default json)\n"
+            "  --output FILE       Write results to FILE instead of stdout\n";
+    }
+    
+    bool ParseOptions(int argc, char* argv[], Options& options) {
+        options.plugin.kind = Synthetic::Kind::Gain;
+        
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto value = [&]() -> std::string { return (i + 1 < argc) ? argv[++i] : std::string(); };
+            
+            if (arg == "--suite") {
+                options.suites = Split(value(), ',');
+            } else if (arg == "--plugin") {
+                if (!Synthetic::parseKind(value(), options.plugin.kind)) {
+                    std::cerr << "Unknown plugin kind" << std::endl;
+                    return false;
+                }
+            } else if (arg == "--fir-taps") {
+                options.plugin.firTaps = std::max(1, std::atoi(value().c_str()));
+            } else if (arg == "--blocks") {
+                options.measuredBlocks = std::max(1, std::atoi(value().c_str()));
+            } else if (arg == "--quick") {
+                options.measuredBlocks = 200;
+                options.warmupBlocks = 8;
+                options.fileMegabytes = 64;
+                options.maxImpulseLength = 1000000;
+            } else if (arg == "--format") {
+                options.format = value();
+                if (options.format != "json" && options.format != "csv") {
+                    std::cerr << "Format must be json or csv" << std::endl;
+                    return false;
+                }
+            } else if (arg == "--output") {
+                options.outputPath = value();
+            } else if (arg == "--file-mb") {
+                options.fileMegabytes = std::max(1, std::atoi(value().c_str()));
+            } else if (arg == "--file-dir") {
+                options.fileDir = value();
+            } else if (arg == "--ir-max") {
+                options.maxImpulseLength = std::max<int64_t>(1000, std::atoll(value().c_str()));
+            } else {
+                PrintUsage();
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        return 2;
+    }
+    
+    std::vector<Result> results;
+    const std::pair<const char*, void (*)(std::vector<Result>&, const Options&)> suites[] = {
+        {"plugins", RunPluginsSuite},
+        {"chain", RunChainSuite},
+        {"channels", RunChannelsSuite},
+        {"buffers", RunBuffersSuite},
+        {"switch", RunSwitchSuite},
+        {"capture", RunCaptureSuite},
+        {"aggregate", RunAggregateSuite},
+        {"adaptive", RunAdaptiveSuite},
+        {"denormal", RunDenormalSuite},
+        {"fileio", RunFileSuite},
+        {"convolution", RunConvolutionSuite},
+        {"precision", RunPrecisionSuite},
+        {"resampler", RunResamplerSuite},
+        {"srcquality", RunResamplerQualitySuite},
+        {"dispatch", RunDispatchSuite}
+    };
+    
+    for (const auto& [name, run] : suites) {
+        if (WantsSuite(options, name)) {
+            std::cerr << "Running " << name << std::endl;
+            run(results, options);
+        }
+    }
+    
+    std::FILE* out = stdout;
+    if (!options.outputPath.empty()) {
+        out = std::fopen(options.outputPath.c_str(), "w");
+        if (!out) {
+            std::cerr << "Cannot open " << options.outputPath << std::endl;
+            return 1;
+        }
+    }
+    
+    if (options.format == "csv") {
+        writeCsv(out, results);
+    } else {
+        writeJson(out, results);
+    }
+    
+    if (out != stdout) {
+        std::fclose(out);
+    }
+    
+    // Suites with pass/fail checks mark their results with a "pass" metric
+    int failedChecks = 0;
+    for (const Result& result : results) {
+        for (const auto& [metric, value] : result.metrics) {
+            failedChecks += metric == "pass" && value == 0.0;
+        }
+    }
+    if (failedChecks > 0) {
+        std::cerr << failedChecks << " check(s) failed" << std::endl;
+        return 1;
+    }
+    return results.empty() ? 1 : 0;
+}
\ No newline at end of file
@@ -0,0 +1,161 @@
+// BenchReport.h - Result records and JSON/CSV output for evh_bench
+#pragma once
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace EVH {
+namespace Bench {
+    
+    // One measured point: the parameters that define it and what was measured
+    struct Result {
+        std::string suite;
+        std::string name;
+        std::vector<std::pair<std::string, std::string>> params;
+        std::vector<std::pair<std::string, double>> metrics;
+    };
+    
+    // Percentile summary of per-block timings, in microseconds
+    struct TimingSummary {
+        double meanUs{0.0};
+        double p50Us{0.0};
+        double p99Us{0.0};
+        double maxUs{0.0};
+    };
+    
+    inline TimingSummary summarize(std::vector<double> samples) {
+        TimingSummary summary;
+        if (samples.empty()) {
+            return summary;
+        }
+        
+        std::sort(samples.begin(), samples.end());
+        double total = 0.0;
+        for (double s : samples) {
+            total += s;
+        }
+        
+        auto at = [&](double q) {
+            size_t index = static_cast<size_t>(q * (samples.size() - 1) + 0.5);
+            return samples[std::min(index, samples.size() - 1)];
+        };
+        
+        summary.meanUs = total / samples.size();
+        summary.p50Us = at(0.50);
+        summary.p99Us = at(0.99);
+        summary.maxUs = samples.back();
+        return summary;
+    }
+    
+    inline std::string escapeJson(const std::string& text) {
+        std::string out;
+        for (char c : text) {
+            switch (c) {
+                case '"':  out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\t': out += "\\t"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        char code[8];
+                        std::snprintf(code, sizeof(code), "\\u%04x", c);
+                        out += code;
+                    } else {
+                        out += c;
+                    }
+            }
+        }
+        return out;
+    }
+    
+    // RFC 4180: fields with a separator, quote or line break are quoted
+    inline std::string escapeCsv(const std::string& text) {
+        if (text.find_first_of(",\"\r\n") == std::string::npos) {
+            return text;
+        }
+        std::string out = "\"";
+        for (char c : text) {
+            out += c;
+            if (c == '"') {
+                out += '"';
+            }
+        }
+        return out + "\"";
+    }
+    
+    inline std::string formatNumber(double value) {
+        char text[32];
+        std::snprintf(text, sizeof(text), "%.6g", value);
+        return text;
+    }
+    
+    inline void writeJson(std::FILE* out, const std::vector<Result>& results) {
+        std::fprintf(out, "{\n  \"version\": 1,\n  \"results\": [");
+        for (size_t r = 0; r < results.size(); ++r) {
+            const Result& result = results[r];
+            std::fprintf(out, "%s\n    {\"suite\": \"%s\", \"name\": \"%s\", \"params\": {",
+                         r ? "," : "", escapeJson(result.suite).c_str(), escapeJson(result.name).c_str());
+            for (size_t i = 0; i < result.params.size(); ++i) {
+                std::fprintf(out, "%s\"%s\": \"%s\"", i ? ", " : "",
+                             escapeJson(result.params[i].first).c_str(),
+                             escapeJson(result.params[i].second).c_str());
+            }
+            std::fprintf(out, "}, \"metrics\": {");
+            for (size_t i = 0; i < result.metrics.size(); ++i) {
+                std::fprintf(out, "%s\"%s\": %s", i ? ", " : "",
+                             escapeJson(result.metrics[i].first).c_str(),
+                             formatNumber(result.metrics[i].second).c_str());
+            }
+            std::fprintf(out, "}}");
+        }
+        std::fprintf(out, "\n  ]\n}\n");
+    }
+    
+    // One row per result; columns are the union of all params and metrics
+    inline void writeCsv(std::FILE* out, const std::vector<Result>& results) {
+        std::vector<std::string> paramColumns;
+        std::vector<std::string> metricColumns;
+        auto addColumn = [](std::vector<std::string>& columns, const std::string& name) {
+            if (std::find(columns.begin(), columns.end(), name) == columns.end()) {
+                columns.push_back(name);
+            }
+        };
+        
+        for (const Result& result : results) {
+            for (const auto& [key, value] : result.params) {
+                addColumn(paramColumns, key);
+            }
+            for (const auto& [key, value] : result.metrics) {
+                addColumn(metricColumns, key);
+            }
+        }
+        
+        std::fprintf(out, "suite,name");
+        for (const auto& column : paramColumns) {
+            std::fprintf(out, ",%s", escapeCsv(column).c_str());
+        }
+        for (const auto& column : metricColumns) {
+            std::fprintf(out, ",%s", escapeCsv(column).c_str());
+        }
+        std::fprintf(out, "\n");
+        
+        for (const Result& result : results) {
+            std::fprintf(out, "%s,%s", escapeCsv(result.suite).c_str(), escapeCsv(result.name).c_str());
+            for (const auto& column : paramColumns) {
+                auto it = std::find_if(result.params.begin(), result.params.end(),
+                                       [&](const auto& p) { return p.first == column; });
+                std::fprintf(out, ",%s", it != result.params.end() ? escapeCsv(it->second).c_str() : "");
+            }
+            for (const auto& column : metricColumns) {
+                auto it = std::find_if(result.metrics.begin(), result.metrics.end(),
+                                       [&](const auto& m) { return m.first == column; });
+                std::fprintf(out, ",%s", it != result.metrics.end() ? formatNumber(it->second).c_str() : "");
+            }
+            std::fprintf(out, "\n");
+        }
+    }
+}
+}
\ No newline at end of file
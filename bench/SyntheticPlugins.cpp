@@ -0,0 +1,238 @@
+// SyntheticPlugins.cpp - Synthetic processors for the benchmark suite
+#include "SyntheticPlugins.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+namespace EVH {
+namespace Synthetic {
+
+namespace {
+    constexpr double PI = 3.14159265358979323846;
+    
+    class PassThroughProcessor : public AudioProcessor {
+    public:
+        std::wstring getName() const override { return L"PassThrough"; }
+        std::unique_ptr<AudioProcessor> clone() const override { return std::make_unique<PassThroughProcessor>(); }
+        bool prepare(const ProcessSetup&) override { return true; }
+        void process(float**, int, int, const ProcessContext&) override {}
+    };
+    
+    class GainProcessor : public AudioProcessor {
+    public:
+        explicit GainProcessor(float gain) : gain(gain) {}
+        
+        std::wstring getName() const override { return L"Gain"; }
+        std::unique_ptr<AudioProcessor> clone() const override { return std::make_unique<GainProcessor>(gain); }
+        bool prepare(const ProcessSetup&) override { return true; }
+        
+        void process(float** channels, int numChannels, int numSamples, const ProcessContext&) override {
+            for (int ch = 0; ch < numChannels; ++ch) {
+                float* data = channels[ch];
+                for (int i = 0; i < numSamples; ++i) {
+                    data[i] *= gain;
+                }
+            }
+        }
+    
+    private:
+        float gain;
+    };
+    
+    // Windowed-sinc lowpass; history and block share one linear buffer so
+    // every output is a single contiguous dot product
+    class FirProcessor : public AudioProcessor {
+    public:
+        explicit FirProcessor(int taps) : numTaps(std::max(1, taps)) {
+            coefficients.resize(numTaps);
+            const double cutoff = 0.25;   // Of the sample rate
+            const double centre = (numTaps - 1) * 0.5;
+            for (int k = 0; k < numTaps; ++k) {
+                double x = k - centre;
+                double sinc = (x == 0.0) ? 2.0 * cutoff : std::sin(2.0 * PI * cutoff * x) / (PI * x);
+                double window = 0.5 - 0.5 * std::cos(2.0 * PI * (k + 0.5) / numTaps);
+                // Stored reversed for the forward dot product
+                coefficients[numTaps - 1 - k] = static_cast<float>(sinc * window);
+            }
+        }
+        
+        std::wstring getName() const override { return L"Fir" + std::to_wstring(numTaps); }
+        std::unique_ptr<AudioProcessor> clone() const override { return std::make_unique<FirProcessor>(numTaps); }
+        
+        bool prepare(const ProcessSetup& setup) override {
+            lines.resize(setup.numChannels);
+            for (auto& line : lines) {
+                line.resize(numTaps - 1 + setup.maxBlockSize, 0.0f);
+            }
+            return true;
+        }
+        
+        void process(float** channels, int numChannels, int numSamples, const ProcessContext&) override {
+            const int history = numTaps - 1;
+            for (int ch = 0; ch < numChannels; ++ch) {
+                float* line = lines[ch].data();
+                float* data = channels[ch];
+                std::copy_n(data, numSamples, line + history);
+                for (int i = 0; i < numSamples; ++i) {
+                    data[i] = Simd::dotProduct(line + i, coefficients.data(), numTaps);
+                }
+                std::copy_n(line + numSamples, history, line);
+            }
+        }
+    
+    private:
+        int numTaps;
+        std::vector<float> coefficients;
+        std::vector<std::vector<float>> lines;
+    };
+    
+    // RBJ lowpass, transposed direct form II with float state
+    class IirProcessor : public AudioProcessor {
+    public:
+        IirProcessor(double cutoffHz, double q) : cutoffHz(cutoffHz), q(q) {}
+        
+        std::wstring getName() const override { return L"Iir"; }
+        std::unique_ptr<AudioProcessor> clone() const override { return std::make_unique<IirProcessor>(cutoffHz, q); }
+        
+        bool prepare(const ProcessSetup& setup) override {
+            double w0 = 2.0 * PI * std::min(cutoffHz, setup.sampleRate * 0.45) / setup.sampleRate;
+            double alpha = std::sin(w0) / (2.0 * q);
+            double a0 = 1.0 + alpha;
+            double cosW0 = std::cos(w0);
+            b0 = static_cast<float>((1.0 - cosW0) * 0.5 / a0);
+            b1 = static_cast<float>((1.0 - cosW0) / a0);
+            b2 = b0;
+            a1 = static_cast<float>(-2.0 * cosW0 / a0);
+            a2 = static_cast<float>((1.0 - alpha) / a0);
+            state.resize(setup.numChannels, {0.0f, 0.0f});
+            return true;
+        }
+        
+        void process(float** channels, int numChannels, int numSamples, const ProcessContext&) override {
+            for (int ch = 0; ch < numChannels; ++ch) {
+                float s1 = state[ch][0];
+                float s2 = state[ch][1];
+                float* data = channels[ch];
+                for (int i = 0; i < numSamples; ++i) {
+                    float x = data[i];
+                    float y = b0 * x + s1;
+                    s1 = b1 * x - a1 * y + s2;
+                    s2 = b2 * x - a2 * y;
+                    data[i] = y;
+                }
+                state[ch] = {s1, s2};
+            }
+        }
+    
+    private:
+        double cutoffHz;
+        double q;
+        float b0{1.0f}, b1{0.0f}, b2{0.0f}, a1{0.0f}, a2{0.0f};
+        std::vector<std::array<float, 2>> state;
+    };
+    
+    // Allocates scratch per block the way careless plugins do
+    class AllocHeavyProcessor : public AudioProcessor {
+    public:
+        explicit AllocHeavyProcessor(int allocations) : allocations(std::max(1, allocations)) {}
+        
+        std::wstring getName() const override { return L"AllocHeavy"; }
+        
+        std::unique_ptr<AudioProcessor> clone() const override {
+            return std::make_unique<AllocHeavyProcessor>(allocations);
+        }
+        bool prepare(const ProcessSetup&) override { return true; }
+        
+        void process(float** channels, int numChannels, int numSamples, const ProcessContext&) override {
+            for (int n = 0; n < allocations; ++n) {
+                std::vector<float> scratch(channels[n % numChannels], channels[n % numChannels] + numSamples);
+                float* data = channels[n % numChannels];
+                for (int i = 0; i < numSamples; ++i) {
+                    data[i] = scratch[i] * 0.999f;
+                }
+            }
+        }
+    
+    private:
+        int allocations;
+    };
+    
+    // Busy-waits like a plugin with data-dependent cost
+    class JitteryProcessor : public AudioProcessor {
+    public:
+        JitteryProcessor(double meanUs, double spikeUs, uint32_t seed)
+            : meanUs(meanUs), spikeUs(spikeUs), seed(seed), rngState(seed ? seed : 1) {}
+        
+        std::wstring getName() const override { return L"Jittery"; }
+        
+        std::unique_ptr<AudioProcessor> clone() const override {
+            return std::make_unique<JitteryProcessor>(meanUs, spikeUs, seed);
+        }
+        bool prepare(const ProcessSetup&) override { return true; }
+        
+        void process(float**, int, int, const ProcessContext&) override {
+            double waitUs = -meanUs * std::log(1.0 - nextUniform());
+            if (nextUniform() < 0.01) {
+                waitUs += spikeUs;
+            }
+            
+            auto until = std::chrono::steady_clock::now() + std::chrono::duration<double, std::micro>(waitUs);
+            while (std::chrono::steady_clock::now() < until) {
+            }
+        }
+    
+    private:
+        double meanUs;
+        double spikeUs;
+        uint32_t seed;
+        uint32_t rngState;
+        
+        double nextUniform() {
+            // xorshift32
+            rngState ^= rngState << 13;
+            rngState ^= rngState >> 17;
+            rngState ^= rngState << 5;
+            return (rngState >> 8) * (1.0 / 16777216.0);
+        }
+    };
+}
+
+std::unique_ptr<AudioProcessor> create(const Settings& settings) {
+    switch (settings.kind) {
+        case Kind::PassThrough: return std::make_unique<PassThroughProcessor>();
+        case Kind::Gain:        return std::make_unique<GainProcessor>(settings.gain);
+        case Kind::Fir:         return std::make_unique<FirProcessor>(settings.firTaps);
+        case Kind::Iir:         return std::make_unique<IirProcessor>(settings.iirCutoffHz, settings.iirQ);
+        case Kind::AllocHeavy:  return std::make_unique<AllocHeavyProcessor>(settings.allocationsPerBlock);
+        case Kind::Jittery:     return std::make_unique<JitteryProcessor>(settings.jitterMeanUs,
+                                                                          settings.jitterSpikeUs, settings.seed);
+    }
+    return nullptr;
+}
+
+const char* getKindName(Kind kind) {
+    switch (kind) {
+        case Kind::PassThrough: return "passthrough";
+        case Kind::Gain:        return "gain";
+        case Kind::Fir:         return "fir";
+        case Kind::Iir:         return "iir";
+        case Kind::AllocHeavy:  return "alloc";
+        case Kind::Jittery:     return "jitter";
+    }
+    return "unknown";
+}
+
+bool parseKind(const std::string& name, Kind& kind) {
+    for (Kind candidate : ALL_KINDS) {
+        if (name == getKindName(candidate)) {
+            kind = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+}
+}
\ No newline at end of file
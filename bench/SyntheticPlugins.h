@@ -0,0 +1,41 @@
+// SyntheticPlugins.h - In-tree processors with known cost profiles for benchmarking
+#pragma once
+
+#include "EnhancedVSTHost.h"
+#include <memory>
+#include <string>
+
+namespace EVH {
+namespace Synthetic {
+    
+    enum class Kind {
+        PassThrough,   // Touches nothing; measures host overhead
+        Gain,          // One multiply per sample
+        Fir,           // Direct-form FIR, firTaps taps
+        Iir,           // Biquad lowpass with float state (denormal-prone tails)
+        AllocHeavy,    // Heap allocations on every block
+        Jittery        // Busy-waits a random time per block
+    };
+    
+    struct Settings {
+        Kind kind{Kind::Gain};
+        float gain{0.5f};
+        int firTaps{64};
+        double iirCutoffHz{1000.0};
+        double iirQ{0.707};
+        int allocationsPerBlock{16};
+        double jitterMeanUs{5.0};      // Exponentially distributed busy-wait...
+        double jitterSpikeUs{200.0};   // ...plus this spike on 1 block in 100
+        uint32_t seed{1};
+    };
+    
+    std::unique_ptr<AudioProcessor> create(const Settings& settings);
+    
+    const char* getKindName(Kind kind);
+    bool parseKind(const std::string& name, Kind& kind);
+    
+    constexpr Kind ALL_KINDS[] = {
+        Kind::PassThrough, Kind::Gain, Kind::Fir, Kind::Iir, Kind::AllocHeavy, Kind::Jittery
+    };
+}
+}
\ No newline at end of file
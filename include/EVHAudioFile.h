@@ -0,0 +1,153 @@
+// EVHAudioFile.h - WAV/RF64/W64 reading and writing to and from planar float
+#pragma once
+
+#include "EVHPlatform.h"
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace EVH {
+
+    // Sample encodings on disk
+    enum class SampleFormat {
+        Pcm16,
+        Pcm24,
+        Pcm32,
+        Float32
+    };
+
+    // File layouts. Wav output switches to RF64 on close when the data
+    // passes the 4 GB RIFF limit.
+    enum class AudioContainer {
+        Wav,
+        Rf64,
+        W64
+    };
+
+    int getBytesPerSample(SampleFormat format);
+
+    struct AudioFileInfo {
+        int numChannels{0};
+        double sampleRate{0.0};
+        int64_t lengthFrames{0};
+        SampleFormat format{SampleFormat::Float32};
+        AudioContainer container{AudioContainer::Wav};
+    };
+
+    // Streaming reader over a memory-mapped file (PCM 16/24/32-bit and
+    // 32-bit float, plain or WAVE_FORMAT_EXTENSIBLE). Pages are requested a
+    // window ahead of the read position and released behind it, so long
+    // files do not stay resident.
+    class AudioFileReader {
+    public:
+        static constexpr uint64_t READ_AHEAD_BYTES = 8u << 20;
+
+        AudioFileReader() = default;
+        ~AudioFileReader() { close(); }
+
+        AudioFileReader(const AudioFileReader&) = delete;
+        AudioFileReader& operator=(const AudioFileReader&) = delete;
+
+        bool open(const std::wstring& path);
+        void close();
+        bool isOpen() const { return map.isOpen(); }
+
+        const AudioFileInfo& getInfo() const { return info; }
+        int64_t getPosition() const { return position; }
+        bool seek(int64_t frame);
+        const std::wstring& getLastError() const { return lastError; }
+
+        // Up to numFrames frames into info.numChannels planar channels;
+        // returns the frames read, 0 at the end
+        int read(float** dest, int numFrames);
+
+        // Zero-copy read for 32-bit float files: points *interleaved into
+        // the mapping, valid until close(). Returns 0 when not available.
+        bool canView() const;
+        int view(const float** interleaved, int numFrames);
+
+    private:
+        MappedFile map;
+        AudioFileInfo info;
+        uint64_t dataOffset{0};
+        int64_t position{0};
+        uint64_t advisedUntil{0};    // Bytes into the data already requested
+        uint64_t releasedUntil{0};   // Bytes into the data already dropped
+        std::wstring lastError;
+
+        bool parseRiff();
+        bool parseW64();
+        bool parseFormat(const uint8_t* fmt, uint64_t size);
+        void advance(int numFrames);
+        bool fail(const std::wstring& message);
+    };
+
+    // Streaming writer. Samples are encoded on the caller's thread into
+    // large page-aligned blocks that a background thread writes, so write()
+    // only blocks when the disk falls behind by the whole pool. Sizes are
+    // patched into the header on close().
+    class AudioFileWriter {
+    public:
+        static constexpr size_t WRITE_BLOCK_BYTES = 1u << 20;
+        static constexpr int WRITE_BLOCKS = 4;
+
+        AudioFileWriter() = default;
+        ~AudioFileWriter() { close(); }
+
+        AudioFileWriter(const AudioFileWriter&) = delete;
+        AudioFileWriter& operator=(const AudioFileWriter&) = delete;
+
+        bool create(const std::wstring& path, int numChannels, double sampleRate,
+                    SampleFormat format = SampleFormat::Float32, AudioContainer container = AudioContainer::Wav);
+        bool write(const float* const* source, int numFrames);
+        bool close();
+        bool isOpen() const { return file != nullptr; }
+
+        int64_t getLengthFrames() const { return lengthFrames; }
+        const std::wstring& getLastError() const { return lastError; }
+
+    private:
+        struct AlignedDelete {
+            void operator()(uint8_t* block) const;
+        };
+        using Block = std::unique_ptr<uint8_t, AlignedDelete>;
+
+        struct PendingBlock {
+            Block block;
+            size_t bytes;
+        };
+
+        FILE* file{nullptr};
+        int numChannels{0};
+        SampleFormat format{SampleFormat::Float32};
+        AudioContainer container{AudioContainer::Wav};
+        int64_t lengthFrames{0};
+        size_t dataHeaderOffset{0};   // Where the data chunk header starts
+        std::vector<uint8_t> scratch;
+        std::wstring lastError;
+
+        // Block being filled on the caller's thread
+        Block current;
+        size_t currentBytes{0};
+
+        // Hand-over to the write thread
+        std::thread writeThread;
+        std::mutex queueMutex;
+        std::condition_variable queueCv;
+        std::deque<PendingBlock> pending;
+        std::vector<Block> freeBlocks;
+        bool closing{false};
+        bool writeFailed{false};
+
+        void append(const uint8_t* bytes, size_t size);
+        bool submitCurrent();
+        void writeThreadFunc();
+        bool patchHeader(uint64_t dataBytes);
+    };
+}
@@ -0,0 +1,255 @@
+// EVHDsp.h - DSP building blocks (SIMD kernels, FFT, oversampling, resampling, drift control)
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+namespace EVH {
+
+    // Vectorised inner loops (SSE/AVX on x86, NEON on ARM, scalar otherwise)
+    namespace Simd {
+        float dotProduct(const float* a, const float* b, int n);
+
+        // In place: data[i] *= gain, or by a gain stepping from start
+        void multiply(float* data, float gain, int n);
+        void multiplyRamp(float* data, float start, float step, int n);
+
+        // dest[i] += source[i] * gain
+        void multiplyAdd(float* dest, const float* source, float gain, int n);
+
+        // Largest absolute sample
+        float peakAbs(const float* data, int n);
+
+        // Split-complex acc[i] += a[i] * b[i]
+        void complexMultiplyAdd(float* accRe, float* accIm, const float* aRe, const float* aIm,
+                                const float* bRe, const float* bIm, int n);
+
+        // Double-precision versions for the 64-bit processing mode
+        double dotProduct(const double* a, const double* b, int n);
+        void multiply(double* data, double gain, int n);
+        void multiplyRamp(double* data, double start, double step, int n);
+        void multiplyAdd(double* dest, const double* source, double gain, int n);
+        double peakAbs(const double* data, int n);
+
+        // Precision boundary (device I/O, 32-bit plugins, taps)
+        void convert(const float* source, double* dest, int n);
+        void convert(const double* source, float* dest, int n);
+    }
+
+    // Real FFT of a power-of-two size (>= 4) to and from split spectra of
+    // size / 2 + 1 bins. Unnormalised: inverse(forward(x)) is size * x.
+    // Holds scratch, so one instance per thread.
+    class RealFft {
+    public:
+        explicit RealFft(int size = 0);
+
+        void setSize(int size);   // Allocates
+        int getSize() const { return size; }
+        int getNumBins() const { return size / 2 + 1; }
+
+        void forward(const float* input, float* re, float* im);
+        void inverse(const float* re, const float* im, float* output);
+
+    private:
+        int size{0};
+        int half{0};                       // Length of the inner complex FFT
+        std::vector<int> bitReverse;
+        std::vector<float> twiddleRe;      // Per stage, half - 1 in all
+        std::vector<float> twiddleIm;
+        std::vector<float> splitCos;       // cos/sin(2 pi k / size), k <= half
+        std::vector<float> splitSin;
+        std::vector<float> workRe;
+        std::vector<float> workIm;
+
+        void transform();   // In place on work, bit-reversed input
+    };
+
+    // 2x, 4x or 8x oversampling as a cascade of 2x polyphase half-band FIR
+    // stages. Every other tap of a half-band filter is zero, so each stage's
+    // up and down paths are one short FIR branch plus a pure delay, run as
+    // Simd multiply-adds across the block. Linear phase; all buffers are
+    // allocated in prepare().
+    class Oversampler {
+    public:
+        // factor 2, 4 or 8; false otherwise
+        bool prepare(int numChannels, int maxBlockSize, int factor);
+        void reset();   // Clears the filter history
+
+        int getFactor() const { return factor; }
+        int getNumChannels() const { return numChannels; }
+
+        // Round-trip delay in base-rate frames, rounded to whole frames
+        int getLatencySamples() const { return latency; }
+
+        // numSamples base-rate frames up to numSamples * factor frames in
+        // the returned planar buffers, which may be processed in place.
+        // numChannels and numSamples are at most what was prepared.
+        float** upsample(const float* const* input, int numChannels, int numSamples);
+
+        // The buffers upsample() returned back down into numSamples frames
+        void downsample(float** output, int numChannels, int numSamples);
+
+    private:
+        struct Stage {
+            int halfTaps{0};                              // T: the branch has 2T taps
+            std::vector<float> branch;                    // Half-band taps h[2k], k < 2T
+            std::vector<std::vector<float>> upLine;       // Per channel: 2T - 1 history + input
+            std::vector<std::vector<float>> evenLine;     // Per channel: 2T - 1 history + even inputs
+            std::vector<std::vector<float>> oddLine;      // Per channel: T history + odd inputs
+            std::vector<std::vector<float>> buffers;      // Per channel, at the stage's output rate
+            std::vector<float*> bufferPtrs;
+        };
+
+        int numChannels{0};
+        int maxBlockSize{0};
+        int factor{0};
+        int latency{0};
+        std::vector<Stage> stages;
+        std::vector<float> scratch;
+
+        void upStage(Stage& stage, const float* const* input, int channels, int numSamples);
+        void downStage(Stage& stage, float** output, int channels, int numSamples);
+    };
+
+    // Resampler quality presets (filter length / phase resolution / stopband)
+    enum class ResamplerQuality {
+        Draft,      // 16 taps, ~60 dB
+        Normal,     // 32 taps, ~80 dB
+        High,       // 64 taps, ~100 dB
+        Mastering   // 128 taps, ~120 dB
+    };
+
+    // Streaming polyphase windowed-sinc sample rate converter for planar
+    // float audio. Arbitrary ratio; intermediate phases are interpolated
+    // linearly between the two nearest filter branches.
+    class SampleRateConverter {
+    public:
+        SampleRateConverter(int numChannels, double inputRate, double outputRate,
+                            ResamplerQuality quality = ResamplerQuality::High,
+                            int maxInputBlock = 4096);
+
+        // Consumes all numInput frames, writes at most maxOutput frames and
+        // returns how many were written. maxOutput should be at least
+        // getMaxOutputFrames(numInput) or input is held back.
+        int process(const float* const* inputs, int numInput, float** outputs, int maxOutput);
+
+        int getMaxOutputFrames(int numInput) const;
+        int getInputFramesNeeded(int numOutput) const;
+        double getLatencyFrames() const;  // In input frames
+
+        double getInputRate() const { return inputRate; }
+        double getOutputRate() const { return outputRate; }
+        int getNumTaps() const { return numTaps; }
+        int getNumChannels() const { return numChannels; }
+
+        // Fine ratio trim for clock drift correction (1.0 = nominal). Values
+        // above 1 consume input faster. Safe to change between process calls.
+        void setRatioAdjust(double factor) { step = nominalStep * factor; }
+
+        void reset();
+
+    private:
+        int numChannels;
+        double inputRate;
+        double outputRate;
+        double nominalStep;   // Input frames per output frame
+        double step;          // nominalStep with drift trim applied
+        int numTaps;
+        int numPhases;
+        int capacity;         // History frames per channel
+
+        std::vector<float> coefficients;   // (numPhases + 1) rows of numTaps
+        std::vector<std::vector<float>> history;
+        int numBuffered{0};
+        double position{0.0};              // Read position in history
+
+        void designFilter(double cutoff, double beta);
+        const float* phaseRow(int phase) const { return coefficients.data() + phase * numTaps; }
+    };
+
+    // PI loop that estimates the clock drift between a producer and a
+    // consumer from the fill level of the FIFO between them, and returns the
+    // resampling ratio that holds the fill at its target.
+    class DriftController {
+    public:
+        DriftController(double targetFill = 0.0, double timeConstantSeconds = 3.0,
+                        double maxDeviationPpm = 1000.0);
+
+        void setTargetFill(double frames) { targetFill = frames; }
+        void reset();
+
+        // Call once per consumer block with the current fill level
+        double update(double fillFrames, int elapsedFrames, double sampleRate);
+
+        double getRatio() const { return ratio; }
+        double getDriftPpm() const { return integral * 1e6; }
+        double getSmoothedFill() const { return smoothedFill; }
+
+    private:
+        double targetFill;
+        double timeConstant;
+        double maxDeviation;
+        double smoothedFill{0.0};
+        double integral{0.0};
+        double ratio{1.0};
+        bool primed{false};
+    };
+
+    // Runs a fixed-rate session between a device at another rate. Device
+    // input is converted to the session rate, the chain is rendered in
+    // session-sized blocks and the result converted back to the device rate.
+    class ResamplingAdapter {
+    public:
+        ResamplingAdapter(int numChannels, double sessionRate, double deviceRate,
+                          int sessionBlockSize, int maxDeviceBlockSize,
+                          ResamplerQuality quality = ResamplerQuality::High);
+
+        // render(const float** inputs, float** outputs, int numSamples) is
+        // called zero or more times at the session rate.
+        template<typename RenderFn>
+        void process(const float** deviceInputs, float** deviceOutputs, int numDeviceFrames, RenderFn&& render) {
+            pushInput(deviceInputs, numDeviceFrames);
+
+            while (outputFifoFrames < numDeviceFrames) {
+                pullSessionInput();
+                clearSessionOutput();
+                render(sessionInputPtrs.data(), sessionOutputPtrs.data(), sessionBlockSize);
+                pushSessionOutput();
+            }
+
+            popOutput(deviceOutputs, numDeviceFrames);
+        }
+
+        double getSessionRate() const { return outputConverter.getInputRate(); }
+        double getDeviceRate() const { return outputConverter.getOutputRate(); }
+        int getLatencyFrames() const;  // Added round-trip latency in device frames
+
+    private:
+        int numChannels;
+        int sessionBlockSize;
+        int maxDeviceBlockSize;
+
+        SampleRateConverter inputConverter;    // Device -> session
+        SampleRateConverter outputConverter;   // Session -> device
+
+        // Linear FIFOs, compacted after each read (single threaded)
+        std::vector<std::vector<float>> inputFifo;
+        std::vector<std::vector<float>> outputFifo;
+        int inputFifoFrames{0};
+        int outputFifoFrames{0};
+
+        std::vector<std::vector<float>> sessionInput;
+        std::vector<std::vector<float>> sessionOutput;
+        std::vector<const float*> sessionInputPtrs;
+        std::vector<float*> sessionOutputPtrs;
+        std::vector<float*> fifoWritePtrs;
+
+        void pushInput(const float** deviceInputs, int numFrames);
+        void pullSessionInput();
+        void clearSessionOutput();
+        void pushSessionOutput();
+        void popOutput(float** deviceOutputs, int numFrames);
+    };
+}
@@ -0,0 +1,299 @@
+// EVHNodes.h - Built-in processors (gain, pan, polarity, routing, mute, meter, convolver, oversampling)
+#pragma once
+
+#include "EnhancedVSTHost.h"
+#include <array>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Loaded with EnhancedVSTHost::loadProcessor() and hosted like any other
+// chain node, without a plugin module behind them. Nodes that loop over the
+// channels branch once per block on the count into a loop compiled for it
+// (mono, stereo, 5.1, 7.1, or any width) over the Simd kernels. Setters are
+// atomic and may be called from any thread while the chain runs. The
+// utility nodes also run on 64-bit buffers; the convolver and oversampler
+// stay float and are converted at their boundary in a double chain.
+namespace EVH {
+namespace Nodes {
+
+    // Gain in dB, ramped across one block when it changes
+    class GainNode : public AudioProcessor {
+    public:
+        explicit GainNode(float gainDb = 0.0f);
+
+        std::wstring getName() const override { return L"Gain"; }
+        bool prepare(const ProcessSetup& setup) override;
+        void process(float** channels, int numChannels, int numSamples, const ProcessContext& context) override;
+        void processDouble(double** channels, int numChannels, int numSamples, const ProcessContext& context) override;
+        bool supportsDoublePrecision() const override { return true; }
+        std::unique_ptr<AudioProcessor> clone() const override;
+
+        int getParameterCount() const override { return 1; }
+        float getParameter(int index) const override;
+        void setParameter(int index, float value) override;
+        std::wstring getParameterName(int index) const override;
+
+        void setGainDb(float gainDb);
+        float getGainDb() const { return targetDb.load(std::memory_order_relaxed); }
+
+    private:
+        template <typename T>
+        void render(T** channels, int numChannels, int numSamples);
+
+        std::atomic<float> targetDb;
+        std::atomic<float> targetGain;
+        float currentGain;
+    };
+
+    // Stereo balance on channels 0 and 1, -1 (left) to +1 (right). The
+    // centre is unity; the opposite side fades on a quarter-cosine.
+    class PanNode : public AudioProcessor {
+    public:
+        explicit PanNode(float pan = 0.0f);
+
+        std::wstring getName() const override { return L"Pan"; }
+        bool prepare(const ProcessSetup& setup) override;
+        void process(float** channels, int numChannels, int numSamples, const ProcessContext& context) override;
+        void processDouble(double** channels, int numChannels, int numSamples, const ProcessContext& context) override;
+        bool supportsDoublePrecision() const override { return true; }
+        std::unique_ptr<AudioProcessor> clone() const override;
+
+        int getParameterCount() const override { return 1; }
+        float getParameter(int index) const override;
+        void setParameter(int index, float value) override;
+        std::wstring getParameterName(int index) const override;
+
+        void setPan(float pan);
+        float getPan() const { return targetPan.load(std::memory_order_relaxed); }
+
+    private:
+        template <typename T>
+        void render(T** channels, int numChannels, int numSamples);
+
+        std::atomic<float> targetPan;
+        float currentLeft{1.0f};
+        float currentRight{1.0f};
+    };
+
+    // Per-channel polarity inversion; parameter i is channel i (0 or 1)
+    class PolarityNode : public AudioProcessor {
+    public:
+        PolarityNode() = default;
+        explicit PolarityNode(uint32_t invertedMask) : inverted(invertedMask) {}
+
+        std::wstring getName() const override { return L"Polarity"; }
+        bool prepare(const ProcessSetup& setup) override;
+        void process(float** channels, int numChannels, int numSamples, const ProcessContext& context) override;
+        void processDouble(double** channels, int numChannels, int numSamples, const ProcessContext& context) override;
+        bool supportsDoublePrecision() const override { return true; }
+        std::unique_ptr<AudioProcessor> clone() const override;
+
+        int getParameterCount() const override { return MAX_CHANNELS; }
+        float getParameter(int index) const override;
+        void setParameter(int index, float value) override;
+        std::wstring getParameterName(int index) const override;
+
+        void setInverted(int channel, bool invert);
+        bool isInverted(int channel) const;
+
+    private:
+        template <typename T>
+        void render(T** channels, int numChannels, int numSamples);
+
+        std::atomic<uint32_t> inverted{0};   // Bit per channel
+    };
+
+    // Mixing matrix over the first `width` channels, starting as identity.
+    // Parameter (output * width + input) is the linear gain from input to
+    // output. Changes apply at the next block boundary, unramped.
+    class RoutingNode : public AudioProcessor {
+    public:
+        explicit RoutingNode(int width = 2);
+
+        std::wstring getName() const override { return L"Routing"; }
+        bool prepare(const ProcessSetup& setup) override;
+        void process(float** channels, int numChannels, int numSamples, const ProcessContext& context) override;
+        void processDouble(double** channels, int numChannels, int numSamples, const ProcessContext& context) override;
+        bool supportsDoublePrecision() const override { return true; }
+        std::unique_ptr<AudioProcessor> clone() const override;
+
+        int getParameterCount() const override { return width * width; }
+        float getParameter(int index) const override;
+        void setParameter(int index, float value) override;
+        std::wstring getParameterName(int index) const override;
+
+        int getWidth() const { return width; }
+        void setGain(int output, int input, float gain);
+        float getGain(int output, int input) const;
+
+        // Output takes only this input at unity (-1: silent)
+        void route(int output, int input);
+
+    private:
+        template <typename T>
+        void render(T** channels, int numChannels, int numSamples);
+
+        const int width;
+        std::unique_ptr<std::atomic<float>[]> matrix;
+        std::vector<std::vector<float>> inputCopies;
+        std::vector<std::vector<double>> doubleInputCopies;   // Only in a double-precision chain
+    };
+
+    // Mute with a one-block fade either way so toggling never clicks
+    class MuteNode : public AudioProcessor {
+    public:
+        explicit MuteNode(bool muted = false);
+
+        std::wstring getName() const override { return L"Mute"; }
+        bool prepare(const ProcessSetup& setup) override;
+        void process(float** channels, int numChannels, int numSamples, const ProcessContext& context) override;
+        void processDouble(double** channels, int numChannels, int numSamples, const ProcessContext& context) override;
+        bool supportsDoublePrecision() const override { return true; }
+        std::unique_ptr<AudioProcessor> clone() const override;
+
+        int getParameterCount() const override { return 1; }
+        float getParameter(int index) const override;
+        void setParameter(int index, float value) override;
+        std::wstring getParameterName(int index) const override;
+
+        void setMuted(bool mute) { muted.store(mute, std::memory_order_relaxed); }
+        bool isMuted() const { return muted.load(std::memory_order_relaxed); }
+
+    private:
+        template <typename T>
+        void render(T** channels, int numChannels, int numSamples);
+
+        std::atomic<bool> muted;
+        float currentGain;
+    };
+
+    // Passes audio through and publishes per-channel levels of the last
+    // block, plus a peak held until takePeak() reads it
+    class MeterNode : public AudioProcessor {
+    public:
+        MeterNode() = default;
+
+        std::wstring getName() const override { return L"Meter"; }
+        bool prepare(const ProcessSetup& setup) override;
+        void process(float** channels, int numChannels, int numSamples, const ProcessContext& context) override;
+        void processDouble(double** channels, int numChannels, int numSamples, const ProcessContext& context) override;
+        bool supportsDoublePrecision() const override { return true; }
+        std::unique_ptr<AudioProcessor> clone() const override { return std::make_unique<MeterNode>(); }
+
+        int getNumChannels() const { return numChannels.load(std::memory_order_relaxed); }
+        float getPeak(int channel) const;
+        float getRms(int channel) const;
+        float takePeak(int channel);
+
+    private:
+        template <typename T>
+        void render(T** channels, int numChannels, int numSamples);
+
+        std::atomic<int> numChannels{0};
+        std::array<std::atomic<float>, MAX_CHANNELS> blockPeak{};
+        std::array<std::atomic<float>, MAX_CHANNELS> blockRms{};
+        std::array<std::atomic<float>, MAX_CHANNELS> heldPeak{};
+    };
+    struct ConvolverSettings {
+        int headSize{0};              // Direct-form taps before the first partition; 0 = block size (64-1024)
+        int maxPartitionSize{65536};  // Largest partition; its FFT is twice this
+        bool backgroundTail{true};    // Partitions past the first level on worker threads
+    };
+
+    // Zero-latency non-uniformly partitioned convolution. The first
+    // headSize taps run as a direct-form FIR, the next ones as FFT partitions
+    // of headSize on the audio thread, and the rest in levels of partitions
+    // four times larger each. A level of partition P starts 2P taps in, so
+    // its worker has a whole period of P frames to deliver each block.
+    //
+    // One impulse channel per chain channel; a shorter impulse repeats its
+    // last channel. Impulses at another rate are resampled in prepare().
+    class ConvolverNode : public AudioProcessor {
+    public:
+        explicit ConvolverNode(const ConvolverSettings& settings = {});
+        ~ConvolverNode() override;
+
+        // Read through AudioFileReader's mapping; either takes effect at the
+        // next prepare(). Without an impulse the node passes audio through.
+        bool loadImpulseResponse(const std::wstring& path);
+        void setImpulseResponse(std::vector<std::vector<float>> channels, double sampleRate);
+        const std::wstring& getLastError() const { return lastError; }
+
+        std::wstring getName() const override { return L"Convolver"; }
+        bool prepare(const ProcessSetup& setup) override;
+        void process(float** channels, int numChannels, int numSamples, const ProcessContext& context) override;
+        std::unique_ptr<AudioProcessor> clone() const override;
+
+        // Impulse length at the prepared rate and partition levels in use
+        int64_t getImpulseLength() const { return impulseLength; }
+        int getNumLevels() const { return static_cast<int>(levels.size()); }
+
+        // Tail blocks a worker delivered after their deadline; each was
+        // played as silence. Offline renders wait instead.
+        uint64_t getLateBlocks() const { return lateBlocks.load(std::memory_order_relaxed); }
+
+    private:
+        struct Impulse {
+            std::vector<std::vector<float>> channels;
+            double sampleRate{0.0};
+        };
+        struct Level;
+
+        ConvolverSettings settings;
+        std::shared_ptr<const Impulse> impulse;   // Shared by clones
+        std::wstring lastError;
+
+        int headSize{0};
+        int preparedChannels{0};
+        int64_t impulseLength{0};
+        int64_t position{0};                          // Frames since prepare()
+        std::vector<int> impulseChannel;              // Chain channel -> impulse channel
+        std::vector<std::vector<float>> headTaps;     // Per impulse channel, reversed
+        std::vector<std::vector<float>> headLines;    // Per chain channel: history + chunk
+        std::vector<std::unique_ptr<Level>> levels;
+        std::atomic<uint64_t> lateBlocks{0};
+
+        void releaseLevels();
+        void processChunk(float** channels, int numChannels, int offset, int numSamples);
+        void completeFrame(Level& level, bool offline);
+    };
+
+    // Runs one native processor, or a plugin instance, at 2x, 4x or 8x the
+    // chain rate between the Oversampler's half-band stages, so nonlinear
+    // processing does not alias. The wrapped processor is prepared for the
+    // higher rate and block size; parameters pass straight through. Adds
+    // getLatencySamples() frames of delay (the filters plus the wrapped
+    // processor's own latency at the base rate).
+    class OversamplingNode : public AudioProcessor {
+    public:
+        OversamplingNode(std::unique_ptr<AudioProcessor> processor, int factor = 2);
+
+        // A plugin is loaded here if it is not already
+        OversamplingNode(std::unique_ptr<PluginInstance> plugin, int factor = 2);
+        ~OversamplingNode() override;
+
+        std::wstring getName() const override;
+        bool prepare(const ProcessSetup& setup) override;
+        void process(float** channels, int numChannels, int numSamples, const ProcessContext& context) override;
+        std::unique_ptr<AudioProcessor> clone() const override;
+
+        int getParameterCount() const override;
+        float getParameter(int index) const override;
+        void setParameter(int index, float value) override;
+        std::wstring getParameterName(int index) const override;
+
+        int getLatencySamples() const override;
+        int getFactor() const { return factor; }
+
+    private:
+        std::unique_ptr<AudioProcessor> processor;
+        std::unique_ptr<PluginInstance> plugin;
+        const int factor;
+        Oversampler oversampler;
+        bool prepared{false};
+    };
+}
+}
@@ -0,0 +1,123 @@
+// EVHPlatform.h - OS layer under the portable core (modules, processes, strings)
+#pragma once
+
+#include <string>
+#include <ctime>
+#include <cstdint>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/types.h>
+#endif
+
+// Guard around calls into plugin code: structured exceptions on MSVC so
+// access violations are caught, C++ exceptions elsewhere
+#if defined(_MSC_VER)
+#define EVH_PLUGIN_TRY __try
+#define EVH_PLUGIN_CATCH __except(EXCEPTION_EXECUTE_HANDLER)
+#else
+#define EVH_PLUGIN_TRY try
+#define EVH_PLUGIN_CATCH catch (...)
+#endif
+
+namespace EVH {
+
+    // Native handles used by the host API
+#ifdef _WIN32
+    using WindowHandle = HWND;
+    using ProcessHandle = HANDLE;
+    using PipeHandle = HANDLE;
+#else
+    using WindowHandle = void*;    // Editors are not hosted off Windows yet
+    using ProcessHandle = pid_t;
+    using PipeHandle = int;
+#endif
+
+    // Plugin module extension on this platform (besides .vst3)
+#ifdef _WIN32
+    constexpr const wchar_t* NATIVE_MODULE_EXTENSION = L".dll";
+#elif defined(__APPLE__)
+    constexpr const wchar_t* NATIVE_MODULE_EXTENSION = L".dylib";
+#else
+    constexpr const wchar_t* NATIVE_MODULE_EXTENSION = L".so";
+#endif
+
+    // Shared library loaded with LoadLibraryW / dlopen
+    class DynamicLibrary {
+    public:
+        DynamicLibrary() = default;
+        ~DynamicLibrary() { close(); }
+
+        DynamicLibrary(const DynamicLibrary&) = delete;
+        DynamicLibrary& operator=(const DynamicLibrary&) = delete;
+
+        bool open(const std::wstring& path);
+        void close();
+        bool isOpen() const { return handle != nullptr; }
+
+        void* getSymbol(const char* name) const;
+        const std::wstring& getLastError() const { return lastError; }
+
+    private:
+        void* handle{nullptr};
+        std::wstring lastError;
+    };
+
+    // Whole file mapped read-only (CreateFileMapping / mmap). The advise
+    // calls are paging hints and do nothing where the OS has no equivalent.
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        ~MappedFile() { close(); }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool open(const std::wstring& path);
+        void close();
+        bool isOpen() const { return data != nullptr; }
+
+        const uint8_t* getData() const { return data; }
+        uint64_t getSize() const { return size; }
+        const std::wstring& getLastError() const { return lastError; }
+
+        void adviseSequential();
+        void adviseWillNeed(uint64_t offset, uint64_t length);
+        void adviseDontNeed(uint64_t offset, uint64_t length);
+
+    private:
+        const uint8_t* data{nullptr};
+        uint64_t size{0};
+#ifdef _WIN32
+        HANDLE mapping{nullptr};
+#endif
+        std::wstring lastError;
+
+        void advise(uint64_t offset, uint64_t length, int advice);
+    };
+
+    // True when path is a module image for this platform, checked without
+    // running any of its code
+    bool isLoadableModule(const std::wstring& path);
+
+    // VST3 bundle directory -> the module inside it; other paths unchanged
+    std::wstring resolvePluginModulePath(const std::wstring& path);
+
+    // Message for the calling thread's last OS error (GetLastError / errno)
+    std::wstring getLastErrorMessage();
+
+    std::string toUtf8(const std::wstring& text);
+    std::wstring fromUtf8(const std::string& text);
+
+    // Thread-safe localtime
+    std::tm localTime(std::time_t time);
+
+    // Memory held by this process; 0 where the OS does not report it
+    struct ProcessMemory {
+        uint64_t residentBytes{0};   // Working set / RSS
+        uint64_t virtualBytes{0};    // Committed private bytes on Windows
+    };
+
+    ProcessMemory getProcessMemory();
+}
\ No newline at end of file
@@ -0,0 +1,539 @@
+// EVHRealtime.h - Lock-free primitives, timing and thread setup for audio and worker threads
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <mutex>
+#include <type_traits>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define EVH_DENORMALS_SSE 1
+#elif defined(__aarch64__)
+#define EVH_DENORMALS_AARCH64 1
+#endif
+
+namespace EVH {
+
+    // Single-producer/single-consumer ring of planar float audio. One thread
+    // writes, one thread reads; neither blocks nor allocates after allocate().
+    class SpscAudioRing {
+    public:
+        SpscAudioRing() = default;
+
+        // Not thread-safe: call before producer/consumer start
+        void allocate(int channels, int minCapacityFrames) {
+            int cap = 1;
+            while (cap < minCapacityFrames) {
+                cap <<= 1;
+            }
+            numChannels = channels;
+            capacity = cap;
+            mask = cap - 1;
+            data.assign(static_cast<size_t>(channels) * cap, 0.0f);
+            reset();
+        }
+
+        void reset() {
+            writeIndex.store(0, std::memory_order_relaxed);
+            readIndex.store(0, std::memory_order_relaxed);
+        }
+
+        int getCapacity() const { return capacity; }
+        int getNumChannels() const { return numChannels; }
+
+        int getNumReady() const {
+            return static_cast<int>(writeIndex.load(std::memory_order_acquire) -
+                                    readIndex.load(std::memory_order_acquire));
+        }
+
+        int getFreeSpace() const { return capacity - getNumReady(); }
+
+        // Producer: planar source, null channel pointers write silence
+        int write(const float* const* src, int numFrames) {
+            uint64_t w = writeIndex.load(std::memory_order_relaxed);
+            uint64_t r = readIndex.load(std::memory_order_acquire);
+            int n = std::min(numFrames, capacity - static_cast<int>(w - r));
+            if (n <= 0) {
+                return 0;
+            }
+
+            int start = static_cast<int>(w & mask);
+            int first = std::min(n, capacity - start);
+            for (int ch = 0; ch < numChannels; ++ch) {
+                float* dest = channel(ch);
+                if (src && src[ch]) {
+                    std::memcpy(dest + start, src[ch], first * sizeof(float));
+                    std::memcpy(dest, src[ch] + first, (n - first) * sizeof(float));
+                } else {
+                    std::memset(dest + start, 0, first * sizeof(float));
+                    std::memset(dest, 0, (n - first) * sizeof(float));
+                }
+            }
+
+            writeIndex.store(w + n, std::memory_order_release);
+            return n;
+        }
+
+        // Consumer: planar destination
+        int read(float* const* dest, int numFrames) {
+            uint64_t r = readIndex.load(std::memory_order_relaxed);
+            uint64_t w = writeIndex.load(std::memory_order_acquire);
+            int n = std::min(numFrames, static_cast<int>(w - r));
+            if (n <= 0) {
+                return 0;
+            }
+
+            int start = static_cast<int>(r & mask);
+            int first = std::min(n, capacity - start);
+            for (int ch = 0; ch < numChannels; ++ch) {
+                const float* src = channel(ch);
+                std::memcpy(dest[ch], src + start, first * sizeof(float));
+                std::memcpy(dest[ch] + first, src, (n - first) * sizeof(float));
+            }
+
+            readIndex.store(r + n, std::memory_order_release);
+            return n;
+        }
+
+        // Consumer: drop the oldest frames
+        int discard(int numFrames) {
+            uint64_t r = readIndex.load(std::memory_order_relaxed);
+            uint64_t w = writeIndex.load(std::memory_order_acquire);
+            int n = std::min(numFrames, static_cast<int>(w - r));
+            if (n > 0) {
+                readIndex.store(r + n, std::memory_order_release);
+            }
+            return std::max(n, 0);
+        }
+
+    private:
+        std::vector<float> data;
+        int numChannels{0};
+        int capacity{0};
+        int mask{0};
+
+        alignas(64) std::atomic<uint64_t> writeIndex{0};
+        alignas(64) std::atomic<uint64_t> readIndex{0};
+
+        float* channel(int ch) { return data.data() + static_cast<size_t>(ch) * capacity; }
+        const float* channel(int ch) const { return data.data() + static_cast<size_t>(ch) * capacity; }
+    };
+
+    // Second-order delay-locked loop that turns jittery block wakeup times
+    // into a smooth timeline and measures the device clock against the host
+    // clock (F. Adriaensen, "Using a DLL to filter time"). Works per frame,
+    // so blocks may vary in size.
+    class ClockDll {
+    public:
+        void reset(double sampleRate, double bandwidthHz = 0.3) {
+            nominalPeriod = 1.0 / sampleRate;
+            secondsPerFrame = nominalPeriod;
+            bandwidth = bandwidthHz;
+            primed = false;
+        }
+
+        // wakeupSeconds: host time the block was requested, position: its first frame
+        void update(double wakeupSeconds, int64_t position) {
+            if (primed) {
+                double frames = static_cast<double>(position - lastPosition);
+                double predicted = filteredTime + frames * secondsPerFrame;
+                double error = wakeupSeconds - predicted;
+
+                // A stall (xrun, debugger) is not clock drift: start over
+                if (frames > 0.0 && std::abs(error) < 0.1) {
+                    double omega = std::min(1.0, 2.0 * 3.14159265358979323846 * bandwidth * frames * secondsPerFrame);
+                    filteredTime = predicted + 1.41421356237309505 * omega * error;
+                    secondsPerFrame += omega * omega * error / frames;
+                    lastPosition = position;
+                    return;
+                }
+            }
+
+            filteredTime = wakeupSeconds;
+            secondsPerFrame = nominalPeriod;
+            lastPosition = position;
+            primed = true;
+        }
+
+        double getTime() const { return filteredTime; }   // Filtered time of the last block
+        double getRatio() const { return nominalPeriod / secondsPerFrame; }  // > 1: device runs fast
+
+    private:
+        double nominalPeriod{1.0 / 44100.0};
+        double secondsPerFrame{1.0 / 44100.0};
+        double bandwidth{0.3};
+        double filteredTime{0.0};
+        int64_t lastPosition{0};
+        bool primed{false};
+    };
+
+    // Quantiles of one histogram window, in microseconds
+    struct LatencySummary {
+        uint64_t count{0};
+        double meanUs{0.0};
+        double p50Us{0.0};
+        double p99Us{0.0};
+        double p999Us{0.0};
+        double maxUs{0.0};
+    };
+
+    // Log-linear (HDR-style) histogram of durations in nanoseconds: 32 linear
+    // sub-buckets per power of two, so quantiles are within ~3% of the
+    // recorded values up to ~18 minutes. Fixed memory. record() is wait-free
+    // from any thread; one reader at a time summarizes or starts a new
+    // window without stopping the writers.
+    class LatencyHistogram {
+    public:
+        static constexpr int SUB_BUCKET_BITS = 5;
+        static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+        static constexpr int MAX_EXPONENT = 40;
+        static constexpr int NUM_BUCKETS = (MAX_EXPONENT - SUB_BUCKET_BITS + 2) * SUB_BUCKETS;
+
+        LatencyHistogram() {
+            for (auto& count : counts) {
+                count.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        LatencyHistogram(const LatencyHistogram&) = delete;
+        LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+        void record(uint64_t nanoseconds) {
+            counts[bucketIndex(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+            totalCount.fetch_add(1, std::memory_order_relaxed);
+            totalNs.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+            uint64_t previous = windowMaxNs.load(std::memory_order_relaxed);
+            while (nanoseconds > previous &&
+                   !windowMaxNs.compare_exchange_weak(previous, nanoseconds, std::memory_order_relaxed)) {
+            }
+        }
+
+        // Counts are never cleared: a window is the difference to the
+        // counts at its start
+        void resetWindow() {
+            for (int i = 0; i < NUM_BUCKETS; ++i) {
+                windowStart[i] = counts[i].load(std::memory_order_relaxed);
+            }
+            windowStartCount = totalCount.load(std::memory_order_relaxed);
+            windowStartNs = totalNs.load(std::memory_order_relaxed);
+            windowMaxNs.store(0, std::memory_order_relaxed);
+        }
+
+        LatencySummary summarize() const {
+            LatencySummary summary;
+            uint64_t window[NUM_BUCKETS];
+            for (int i = 0; i < NUM_BUCKETS; ++i) {
+                window[i] = counts[i].load(std::memory_order_relaxed) - windowStart[i];
+                summary.count += window[i];
+            }
+            if (summary.count == 0) {
+                return summary;
+            }
+
+            // Sum and max are read separately from the buckets; close enough
+            // while writers run
+            uint64_t sumNs = totalNs.load(std::memory_order_relaxed) - windowStartNs;
+            uint64_t sumCount = totalCount.load(std::memory_order_relaxed) - windowStartCount;
+            double maxNs = static_cast<double>(windowMaxNs.load(std::memory_order_relaxed));
+
+            auto quantile = [&](double q) {
+                uint64_t rank = static_cast<uint64_t>(std::ceil(q * summary.count));
+                uint64_t seen = 0;
+                for (int i = 0; i < NUM_BUCKETS; ++i) {
+                    seen += window[i];
+                    if (window[i] > 0 && seen >= std::max<uint64_t>(rank, 1)) {
+                        return std::min(bucketMidpoint(i), maxNs) * 1e-3;
+                    }
+                }
+                return maxNs * 1e-3;
+            };
+
+            summary.meanUs = sumCount ? sumNs * 1e-3 / sumCount : 0.0;
+            summary.p50Us = quantile(0.5);
+            summary.p99Us = quantile(0.99);
+            summary.p999Us = quantile(0.999);
+            summary.maxUs = maxNs * 1e-3;
+            return summary;
+        }
+
+        // Lifetime totals, unaffected by windows (monotonic, for scrapers)
+        uint64_t getTotalCount() const { return totalCount.load(std::memory_order_relaxed); }
+        uint64_t getTotalNs() const { return totalNs.load(std::memory_order_relaxed); }
+
+        // Lifetime count of values in buckets up to each bound (ascending),
+        // so within bucket precision of "<= bound"
+        void cumulativeCounts(const uint64_t* boundsNs, int numBounds, uint64_t* result) const {
+            uint64_t running = 0;
+            int next = 0;
+            for (int i = 0; i < NUM_BUCKETS && next < numBounds; ++i) {
+                while (next < numBounds && bucketIndex(boundsNs[next]) < i) {
+                    result[next++] = running;
+                }
+                running += counts[i].load(std::memory_order_relaxed);
+            }
+            while (next < numBounds) {
+                result[next++] = running;
+            }
+        }
+
+        static int bucketIndex(uint64_t value) {
+            if (value < static_cast<uint64_t>(SUB_BUCKETS)) {
+                return static_cast<int>(value);
+            }
+
+            int exponent = 63;
+            while (!(value >> exponent)) {
+                --exponent;
+            }
+            if (exponent > MAX_EXPONENT) {
+                return NUM_BUCKETS - 1;
+            }
+
+            // Top SUB_BUCKET_BITS + 1 bits: [SUB_BUCKETS, 2 * SUB_BUCKETS)
+            int shift = exponent - SUB_BUCKET_BITS;
+            int group = shift + 1;
+            int sub = static_cast<int>(value >> shift) - SUB_BUCKETS;
+            return group * SUB_BUCKETS + sub;
+        }
+
+        static double bucketMidpoint(int index) {
+            if (index < SUB_BUCKETS) {
+                return index;
+            }
+            int shift = index / SUB_BUCKETS - 1;
+            double lower = static_cast<double>(static_cast<uint64_t>(SUB_BUCKETS + index % SUB_BUCKETS) << shift);
+            return lower + static_cast<double>(uint64_t(1) << shift) * 0.5;
+        }
+
+    private:
+        std::atomic<uint64_t> counts[NUM_BUCKETS];
+        std::atomic<uint64_t> totalCount{0};
+        std::atomic<uint64_t> totalNs{0};
+        std::atomic<uint64_t> windowMaxNs{0};
+
+        // Reader side
+        uint64_t windowStart[NUM_BUCKETS] = {};
+        uint64_t windowStartCount{0};
+        uint64_t windowStartNs{0};
+    };
+
+    // Latest value of a trivially copyable T from one writer to any number
+    // of readers. publish() never waits; read() retries while a publish is
+    // in progress, so it may spin briefly but never blocks the writer. The
+    // value is copied through relaxed atomic words, so a torn copy is only
+    // ever discarded, never undefined.
+    template<typename T>
+    class Seqlock {
+        static_assert(std::is_trivially_copyable_v<T>, "Seqlock holds trivially copyable values");
+
+    public:
+        Seqlock() { publish(T{}); }
+
+        // Single writer
+        void publish(const T& value) {
+            uint64_t buffer[NUM_WORDS] = {};
+            std::memcpy(buffer, &value, sizeof(T));
+
+            const uint32_t s = sequence.load(std::memory_order_relaxed);
+            sequence.store(s + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            for (int i = 0; i < NUM_WORDS; ++i) {
+                words[i].store(buffer[i], std::memory_order_relaxed);
+            }
+            sequence.store(s + 2, std::memory_order_release);
+        }
+
+        T read() const {
+            uint64_t buffer[NUM_WORDS];
+            for (;;) {
+                const uint32_t before = sequence.load(std::memory_order_acquire);
+                if (before & 1) {
+                    continue;
+                }
+                for (int i = 0; i < NUM_WORDS; ++i) {
+                    buffer[i] = words[i].load(std::memory_order_relaxed);
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (sequence.load(std::memory_order_relaxed) == before) {
+                    break;
+                }
+            }
+
+            T value;
+            std::memcpy(&value, buffer, sizeof(T));
+            return value;
+        }
+
+        // Bumped by every publish(), so readers can skip unchanged values
+        uint32_t getVersion() const { return sequence.load(std::memory_order_acquire) / 2; }
+
+    private:
+        static constexpr int NUM_WORDS = static_cast<int>((sizeof(T) + 7) / 8);
+
+        std::atomic<uint32_t> sequence{0};
+        std::atomic<uint64_t> words[NUM_WORDS];
+    };
+
+    // Latest value of a T too large to copy through a Seqlock (frames of
+    // vectors), from one writer to any number of readers. The writer fills
+    // the back slot and swaps it in without waiting; readers take the
+    // newest slot under a mutex of their own that the writer never touches.
+    template<typename T>
+    class TripleBuffer {
+    public:
+        // Writer: the back slot holds stale contents and is overwritten whole
+        T& back() { return slots[backIndex]; }
+
+        void publish() {
+            backIndex = latest.exchange(backIndex | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+        }
+
+        // Readers: false until the first publish()
+        bool read(T& value) const {
+            std::lock_guard<std::mutex> lock(readMutex);
+            if (latest.load(std::memory_order_acquire) & FRESH) {
+                frontIndex = latest.exchange(frontIndex, std::memory_order_acq_rel) & INDEX_MASK;
+                hasValue = true;
+            }
+            if (!hasValue) {
+                return false;
+            }
+            value = slots[frontIndex];
+            return true;
+        }
+
+    private:
+        static constexpr int INDEX_MASK = 3;
+        static constexpr int FRESH = 4;
+
+        T slots[3];
+        int backIndex{0};
+        mutable int frontIndex{1};
+        mutable std::atomic<int> latest{2};
+        mutable bool hasValue{false};
+        mutable std::mutex readMutex;
+    };
+
+    // Flush-to-zero and denormals-are-zero for the current thread while in
+    // scope; the previous mode is restored on exit. Keeps decaying tails
+    // from dropping the FPU into its slow denormal path.
+    class ScopedDenormalDisable {
+    public:
+        explicit ScopedDenormalDisable(bool enable = true) : active(enable && isSupported()) {
+            if (active) {
+                saved = readMode();
+                writeMode(saved | flushBits);
+            }
+        }
+
+        ~ScopedDenormalDisable() {
+            if (active) {
+                writeMode(saved);
+            }
+        }
+
+        ScopedDenormalDisable(const ScopedDenormalDisable&) = delete;
+        ScopedDenormalDisable& operator=(const ScopedDenormalDisable&) = delete;
+
+        static constexpr bool isSupported() {
+#if defined(EVH_DENORMALS_SSE) || defined(EVH_DENORMALS_AARCH64)
+            return true;
+#else
+            return false;
+#endif
+        }
+
+    private:
+#if defined(EVH_DENORMALS_SSE)
+        static constexpr uint64_t flushBits = 0x8040;           // MXCSR FTZ | DAZ
+        static uint64_t readMode() { return _mm_getcsr(); }
+        static void writeMode(uint64_t mode) { _mm_setcsr(static_cast<unsigned int>(mode)); }
+#elif defined(EVH_DENORMALS_AARCH64)
+        static constexpr uint64_t flushBits = uint64_t(1) << 24; // FPCR FZ
+        static uint64_t readMode() {
+            uint64_t mode;
+            asm volatile("mrs %0, fpcr" : "=r"(mode));
+            return mode;
+        }
+        static void writeMode(uint64_t mode) { asm volatile("msr fpcr, %0" : : "r"(mode)); }
+#else
+        static constexpr uint64_t flushBits = 0;
+        static uint64_t readMode() { return 0; }
+        static void writeMode(uint64_t) {}
+#endif
+
+        bool active;
+        uint64_t saved{0};
+    };
+
+    // Marks the calling thread as doing realtime audio work while in scope.
+    // Only a thread-local counter; evh_rtcheck reads it to decide which
+    // allocations, locks and blocking calls are violations.
+    class ScopedRealtimeSection {
+    public:
+        explicit ScopedRealtimeSection(bool enable = true) : active(enable) { depth() += active; }
+        ~ScopedRealtimeSection() { depth() -= active; }
+
+        ScopedRealtimeSection(const ScopedRealtimeSection&) = delete;
+        ScopedRealtimeSection& operator=(const ScopedRealtimeSection&) = delete;
+
+        static bool isActive() { return depth() > 0; }
+
+    private:
+        static int& depth() {
+            static thread_local int value = 0;
+            return value;
+        }
+
+        bool active;
+    };
+
+    // Scheduling and placement requested for an audio or DSP thread
+    struct ThreadPolicy {
+        enum class Scheduling {
+            Normal,     // Leave the thread as created
+            Fifo,       // SCHED_FIFO at priority (Windows: time-critical priority)
+            Deadline    // SCHED_DEADLINE, falls back to Fifo
+        };
+
+        Scheduling scheduling{Scheduling::Normal};
+        int priority{70};              // SCHED_FIFO, 1-99
+        uint64_t runtimeNs{0};         // SCHED_DEADLINE; 0 = engines derive from the block period
+        uint64_t periodNs{0};
+        std::vector<int> cpus;         // Affinity; empty = any CPU
+        bool prefaultStack{true};
+    };
+
+    // What actually took effect. Unprivileged processes get as much as the
+    // system allows; notes say what was refused and why.
+    struct ThreadPolicyResult {
+        bool attempted{false};
+        bool schedulingApplied{false};
+        bool affinityApplied{false};
+        bool stackPrefaulted{false};
+        std::wstring scheduling{L"default"};   // Policy in effect, e.g. "SCHED_FIFO 70"
+        std::vector<std::wstring> notes;
+    };
+
+    struct MemoryLockResult {
+        bool locked{false};
+        std::wstring note;
+    };
+
+    // Applies to the calling thread
+    ThreadPolicyResult applyThreadPolicy(const ThreadPolicy& policy);
+
+    // mlockall(current and future) and keep freed heap mapped, so the audio
+    // path never page-faults on memory the process already owns
+    MemoryLockResult lockProcessMemory();
+
+    // Touch every page of a buffer so its first use does not fault
+    void prefaultBuffer(void* data, size_t bytes);
+}
\ No newline at end of file
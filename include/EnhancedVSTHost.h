@@ -1,437 +1,1592 @@
-// EnhancedVSTHost.h - Main header file
-#pragma once
-
-#include <windows.h>
-#include <memory>
-#include <vector>
-#include <string>
-#include <unordered_map>
-#include <unordered_set>
-#include <atomic>
-#include <thread>
-#include <mutex>
-#include <condition_variable>
-#include <queue>
-#include <exception>
-#include <filesystem>
-#include <functional>
-
-// Audio APIs
-#include <mmdeviceapi.h>
-#include <audioclient.h>
-#include <audiopolicy.h>
-#include <wrl/client.h>
-
-// Forward declarations
-class PluginScanner;
-class AudioEngine;
-class PluginHost;
-class PluginInstance;
-class WASAPIEngine;
-class PluginBridge32;
-class NotificationManager;
-class ErrorLogger;
-
-namespace EVH {
-    
-    // Constants
-    constexpr int MAX_CHANNELS = 32;
-    constexpr int DEFAULT_SAMPLE_RATE = 44100;
-    constexpr int DEFAULT_BUFFER_SIZE = 512;
-    constexpr int MAX_PLUGIN_SCAN_TIME_MS = 5000;
-    
-    // Plugin types
-    enum class PluginType {
-        VST3,
-        VST2,    // Legacy support
-        Unknown
-    };
-    
-    // Audio driver types
-    enum class AudioDriverType {
-        WASAPI,
-        DirectSound,
-        Unknown
-    };
-    
-    // Plugin state
-    enum class PluginState {
-        Unloaded,
-        Loading,
-        Loaded,
-        Active,
-        Bypassed,
-        Error,
-        Crashed
-    };
-    
-    // Plugin info structure
-    struct PluginInfo {
-        std::wstring path;
-        std::wstring name;
-        std::wstring vendor;
-        PluginType type;
-        bool is64Bit;
-        bool hasCustomEditor;
-        int numInputs;
-        int numOutputs;
-        std::vector<std::wstring> categories;
-        uint32_t uniqueId;
-        bool isInstrument;
-        bool validated;
-        std::wstring errorMsg;
-    };
-    
-    // Audio buffer structure
-    template<typename T>
-    class AudioBuffer {
-    public:
-        AudioBuffer(int channels, int samples)
-            : numChannels(channels), numSamples(samples) {
-            
-            channelData.resize(channels);
-            writePointers.resize(channels);
-            
-            for (int ch = 0; ch < channels; ++ch) {
-                channelData[ch].resize(samples);
-                writePointers[ch] = channelData[ch].data();
-            }
-        }
-        
-        ~AudioBuffer() = default;
-        
-        T** getWritePointer() { return writePointers.data(); }
-        const T** getReadPointer() const { return const_cast<const T**>(writePointers.data()); }
-        
-        void clear() {
-            for (auto& channel : channelData) {
-                std::fill(channel.begin(), channel.end(), T(0));
-            }
-        }
-        
-        void applyGain(float gain) {
-            for (auto& channel : channelData) {
-                for (auto& sample : channel) {
-                    sample *= gain;
-                }
-            }
-        }
-        
-    private:
-        std::vector<std::vector<T>> channelData;
-        std::vector<T*> writePointers;
-        int numChannels;
-        int numSamples;
-    };
-    
-    // Exception classes
-    class PluginException : public std::exception {
-    public:
-        PluginException(const std::string& msg) : message(msg) {}
-        const char* what() const noexcept override { return message.c_str(); }
-    private:
-        std::string message;
-    };
-    
-    class AudioException : public std::exception {
-    public:
-        AudioException(const std::string& msg) : message(msg) {}
-        const char* what() const noexcept override { return message.c_str(); }
-    private:
-        std::string message;
-    };
-}
-
-// Main VST Host class
-class EnhancedVSTHost {
-public:
-    EnhancedVSTHost();
-    ~EnhancedVSTHost();
-    
-    // Initialization
-    bool initialize(HWND parentWindow);
-    void shutdown();
-    
-    // Plugin management
-    void scanPlugins(const std::vector<std::wstring>& searchPaths);
-    bool loadPlugin(const std::wstring& path);
-    void unloadPlugin(int pluginId);
-    void unloadAllPlugins();
-    
-    // Audio engine control
-    bool startAudio(EVH::AudioDriverType driverType);
-    void stopAudio();
-    bool isAudioRunning() const { return audioRunning.load(); }
-    
-    // Plugin chain management
-    void addPluginToChain(int pluginId);
-    void removePluginFromChain(int pluginId);
-    void movePluginInChain(int pluginId, int newPosition);
-    void bypassPlugin(int pluginId, bool bypass);
-    
-    // Settings
-    void setSampleRate(double rate);
-    void setBufferSize(int size);
-    void setAudioDriver(EVH::AudioDriverType type);
-    
-    // Blacklist/Whitelist
-    void addToBlacklist(const std::wstring& pluginPath);
-    void removeFromBlacklist(const std::wstring& pluginPath);
-    bool isBlacklisted(const std::wstring& pluginPath) const;
-    
-    // Error handling
-    std::vector<std::wstring> getRecentErrors() const;
-    void clearErrors();
-    
-    // Plugin info
-    std::vector<EVH::PluginInfo> getAvailablePlugins() const;
-    EVH::PluginInfo getPluginInfo(int pluginId) const;
-    
-    // Callbacks
-    using ScanProgressCallback = std::function<void(int current, int total, const std::wstring& currentPlugin)>;
-    using ErrorCallback = std::function<void(const std::wstring& error)>;
-    using CrashCallback = std::function<void(int pluginId, const std::wstring& pluginName)>;
-    
-    void setScanProgressCallback(ScanProgressCallback cb) { scanProgressCb = cb; }
-    void setErrorCallback(ErrorCallback cb) { errorCb = cb; }
-    void setCrashCallback(CrashCallback cb) { crashCb = cb; }
-    
-private:
-    // Core components
-    std::unique_ptr<PluginScanner> scanner;
-    std::unique_ptr<AudioEngine> audioEngine;
-    std::unique_ptr<PluginHost> pluginHost;
-    std::unique_ptr<NotificationManager> notificationMgr;
-    std::unique_ptr<ErrorLogger> errorLogger;
-    std::unique_ptr<PluginBridge32> bridge32;
-    
-    // Plugin management
-    std::unordered_map<int, std::unique_ptr<PluginInstance>> loadedPlugins;
-    std::vector<int> pluginChain;
-    std::mutex pluginMutex;
-    std::atomic<int> nextPluginId{1};
-    
-    // Blacklist
-    std::unordered_set<std::wstring> blacklistedPlugins;
-    mutable std::mutex blacklistMutex;
-    
-    // Audio state
-    std::atomic<bool> audioRunning{false};
-    double currentSampleRate{EVH::DEFAULT_SAMPLE_RATE};
-    int currentBufferSize{EVH::DEFAULT_BUFFER_SIZE};
-    EVH::AudioDriverType currentDriverType{EVH::AudioDriverType::WASAPI};
-    
-    // Window handling
-    HWND parentWindow{nullptr};
-    bool highDpiAware{false};
-    
-    // Callbacks
-    ScanProgressCallback scanProgressCb;
-    ErrorCallback errorCb;
-    CrashCallback crashCb;
-    
-    // Helper methods
-    void setupHighDPI();
-    void handlePluginCrash(int pluginId);
-    void logError(const std::wstring& error);
-    bool validatePlugin(const std::wstring& path);
-    std::unique_ptr<PluginInstance> createPluginInstance(const EVH::PluginInfo& info);
-};
-
-// Plugin Scanner with crash isolation
-class PluginScanner {
-public:
-    PluginScanner();
-    ~PluginScanner();
-    
-    void scanDirectory(const std::wstring& path, 
-                      std::function<void(const EVH::PluginInfo&)> onPluginFound,
-                      std::function<void(int, int, const std::wstring&)> onProgress);
-    
-    bool scanPluginInProcess(const std::wstring& path, EVH::PluginInfo& info);
-    
-private:
-    struct ScanJob {
-        std::wstring path;
-        HANDLE processHandle;
-        HANDLE pipeHandle;
-        std::chrono::steady_clock::time_point startTime;
-    };
-    
-    std::vector<ScanJob> activeJobs;
-    std::mutex jobMutex;
-    
-    bool launchScannerProcess(const std::wstring& pluginPath, ScanJob& job);
-    bool readScanResult(HANDLE pipe, EVH::PluginInfo& info);
-    void terminateHungProcesses();
-};
-
-// Audio Engine base class
-class AudioEngine {
-public:
-    virtual ~AudioEngine() = default;
-    
-    virtual bool initialize(double sampleRate, int bufferSize) = 0;
-    virtual void shutdown() = 0;
-    virtual bool start() = 0;
-    virtual void stop() = 0;
-    
-    virtual std::vector<std::wstring> getDeviceList() const = 0;
-    virtual bool selectDevice(const std::wstring& deviceName) = 0;
-    
-    using AudioCallback = std::function<void(const float**, float**, int numSamples)>;
-    void setAudioCallback(AudioCallback cb) { audioCallback = cb; }
-    
-protected:
-    AudioCallback audioCallback;
-    double sampleRate;
-    int bufferSize;
-};
-
-// WASAPI implementation
-class WASAPIEngine : public AudioEngine {
-public:
-    WASAPIEngine();
-    ~WASAPIEngine() override;
-    
-    bool initialize(double sampleRate, int bufferSize) override;
-    void shutdown() override;
-    bool start() override;
-    void stop() override;
-    
-    std::vector<std::wstring> getDeviceList() const override;
-    bool selectDevice(const std::wstring& deviceName) override;
-    
-private:
-    Microsoft::WRL::ComPtr<IMMDeviceEnumerator> deviceEnumerator;
-    Microsoft::WRL::ComPtr<IMMDevice> audioDevice;
-    Microsoft::WRL::ComPtr<IAudioClient> audioClient;
-    Microsoft::WRL::ComPtr<IAudioRenderClient> renderClient;
-    
-    std::thread audioThread;
-    std::atomic<bool> shouldStop{false};
-    HANDLE bufferEvent{nullptr};
-    
-    void audioThreadFunc();
-};
-
-// Plugin Instance wrapper
-class PluginInstance {
-public:
-    PluginInstance(const EVH::PluginInfo& info);
-    ~PluginInstance();
-    
-    bool load();
-    void unload();
-    
-    void process(const float** inputs, float** outputs, int numSamples);
-    void processReplacing(float** inputs, float** outputs, int numSamples);
-    
-    void suspend();
-    void resume();
-    
-    void openEditor(HWND parentWindow);
-    void closeEditor();
-    bool hasEditor() const { return info.hasCustomEditor; }
-    
-    void setBypass(bool bypass) { bypassed = bypass; }
-    bool isBypassed() const { return bypassed; }
-    
-    EVH::PluginState getState() const { return state.load(); }
-    const EVH::PluginInfo& getInfo() const { return info; }
-    
-    // Parameter management
-    int getParameterCount() const;
-    float getParameter(int index) const;
-    void setParameter(int index, float value);
-    std::wstring getParameterName(int index) const;
-    std::wstring getParameterLabel(int index) const;
-    std::wstring getParameterDisplay(int index) const;
-    
-private:
-    EVH::PluginInfo info;
-    std::atomic<EVH::PluginState> state{EVH::PluginState::Unloaded};
-    bool bypassed{false};
-    
-    // Module handle
-    HMODULE moduleHandle{nullptr};
-    
-    // VST3 specific
-    void* component{nullptr};  // Would be Steinberg::IPtr<Steinberg::Vst::IComponent>
-    void* processor{nullptr};  // Would be Steinberg::IPtr<Steinberg::Vst::IAudioProcessor>
-    
-    // Editor
-    HWND editorWindow{nullptr};
-    
-    // Thread safety
-    mutable std::mutex processMutex;
-    
-    // Helper methods
-    bool loadVST3();
-};
-
-// 32-bit plugin bridge
-class PluginBridge32 {
-public:
-    PluginBridge32();
-    ~PluginBridge32();
-    
-    bool initialize();
-    void shutdown();
-    
-    bool loadPlugin32(const std::wstring& path, EVH::PluginInfo& info);
-    void unloadPlugin32(const std::wstring& path);
-    
-    void process32(const std::wstring& pluginPath, 
-                   const float** inputs, float** outputs, 
-                   int numSamples);
-    
-private:
-    HANDLE bridgeProcess{nullptr};
-    HANDLE commandPipe{nullptr};
-    HANDLE dataPipe{nullptr};
-    std::mutex bridgeMutex;
-    
-    bool sendCommand(const std::string& cmd);
-    bool receiveResponse(std::string& response);
-};
-
-// Windows notification manager
-class NotificationManager {
-public:
-    NotificationManager(HWND parentWindow);
-    ~NotificationManager();
-    
-    void showNotification(const std::wstring& title, const std::wstring& message);
-    void showErrorNotification(const std::wstring& error);
-    void showPluginCrashNotification(const std::wstring& pluginName);
-    
-private:
-    HWND parentWindow;
-    bool useToastNotifications;
-    
-    void initializeToastNotifications();
-    void showLegacyNotification(const std::wstring& title, const std::wstring& message);
-};
-
-// Error logger
-class ErrorLogger {
-public:
-    ErrorLogger(const std::wstring& logPath);
-    ~ErrorLogger();
-    
-    void logError(const std::wstring& error);
-    void logPluginCrash(const std::wstring& pluginName, const std::wstring& details);
-    void logAudioError(const std::wstring& error);
-    
-    std::vector<std::wstring> getRecentErrors(int count = 100) const;
-    void clearLog();
-    
-private:
-    std::wstring logFilePath;
-    mutable std::mutex logMutex;
-    std::queue<std::wstring> recentErrors;
-    std::wofstream logFile;
-    
-    std::wstring getCurrentTimestamp() const;
+// EnhancedVSTHost.h - Main header file
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <queue>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <cmath>
+
+// Audio APIs
+#ifdef _WIN32
+#include <mmdeviceapi.h>
+#include <audioclient.h>
+#include <audiopolicy.h>
+#include <wrl/client.h>
+#endif
+
+#include "EVHPlatform.h"
+#include "EVHDsp.h"
+#include "EVHRealtime.h"
+#include "EVHAudioFile.h"
+
+// Forward declarations
+class PluginScanner;
+class AudioEngine;
+class PluginInstance;
+class WASAPIEngine;
+class NullEngine;
+class AggregateEngine;
+class PluginBridge32;
+class NotificationManager;
+class MetricsServer;
+class BatchRenderer;
+class ErrorLogger;
+
+namespace EVH {
+    
+    // Constants
+    constexpr int MAX_CHANNELS = 32;
+    constexpr int DEFAULT_SAMPLE_RATE = 44100;
+    constexpr int DEFAULT_BUFFER_SIZE = 512;
+    constexpr int MAX_PLUGIN_SCAN_TIME_MS = 5000;
+    
+    // Plugin types
+    enum class PluginType {
+        VST3,
+        VST2,    // Legacy support
+        Unknown
+    };
+    
+    // Audio driver types
+    enum class AudioDriverType {
+        WASAPI,
+        DirectSound,
+        Null,    // Timer-driven engine without a device (testing/measurement)
+        Aggregate,    // Several WASAPI endpoints, first one is the clock master
+        Unknown
+    };
+    
+#ifdef _WIN32
+    constexpr AudioDriverType DEFAULT_AUDIO_DRIVER = AudioDriverType::WASAPI;
+#else
+    constexpr AudioDriverType DEFAULT_AUDIO_DRIVER = AudioDriverType::Null;
+#endif
+    
+    // Plugin state
+    enum class PluginState {
+        Unloaded,
+        Loading,
+        Loaded,
+        Active,
+        Bypassed,
+        Error,
+        Crashed
+    };
+    
+    // Plugin info structure
+    struct PluginInfo {
+        std::wstring path;
+        std::wstring name;
+        std::wstring vendor;
+        PluginType type;
+        bool is64Bit;
+        bool hasCustomEditor;
+        int numInputs;
+        int numOutputs;
+        std::vector<std::wstring> categories;
+        uint32_t uniqueId;
+        bool isInstrument;
+        bool validated;
+        std::wstring errorMsg;
+    };
+    
+    // How an aggregate device maps the chain outputs onto its members
+    enum class AggregateRouting {
+        Mirror,   // Every device plays the same stereo output
+        Spread    // Logical channels 2k, 2k+1 go to device k
+    };
+    
+    // Sample format the chain runs in between the device and plugin boundaries
+    enum class ProcessPrecision {
+        Single,   // 32-bit float throughout
+        Double    // 64-bit buffers, summing and native nodes
+    };
+    
+    // Processing setup a plugin is prepared for
+    struct ProcessSetup {
+        double sampleRate{DEFAULT_SAMPLE_RATE};
+        int maxBlockSize{DEFAULT_BUFFER_SIZE};
+        int numChannels{2};   // Chain width
+        ProcessPrecision precision{ProcessPrecision::Single};
+    };
+    
+    // Timing of the block passed with every audio callback
+    struct ProcessContext {
+        int64_t samplePosition{0};      // Frames since the stream started
+        int64_t hostTimeNs{0};          // Smoothed steady_clock time of the block
+        double sampleRate{DEFAULT_SAMPLE_RATE};
+        int outputLatencySamples{0};    // Until the block's first frame is audible
+        double clockRatio{1.0};         // Device clock / host clock (> 1: device fast)
+        bool offline{false};            // renderOffline(): no deadline, background work may be waited for
+    };
+    
+    // Audio callback as an object pointer plus a plain function pointer.
+    // Copying never allocates, and bind<&T::method>() instantiates a thunk
+    // per target so the member call is inlined into a single indirect call.
+    class RenderCallback {
+    public:
+        using Thunk = void (*)(void* target, const float** inputs, float** outputs,
+                               int numSamples, const ProcessContext& context);
+        
+        RenderCallback() = default;
+        
+        template<auto Method, typename T>
+        static RenderCallback bind(T* target) {
+            return RenderCallback(target, [](void* t, const float** inputs, float** outputs,
+                                             int numSamples, const ProcessContext& context) {
+                (static_cast<T*>(t)->*Method)(inputs, outputs, numSamples, context);
+            });
+        }
+        
+        void operator()(const float** inputs, float** outputs, int numSamples, const ProcessContext& context) const {
+            thunk(target, inputs, outputs, numSamples, context);
+        }
+        
+        explicit operator bool() const { return thunk != nullptr; }
+        
+    private:
+        RenderCallback(void* target, Thunk thunk) : target(target), thunk(thunk) {}
+        
+        void* target{nullptr};
+        Thunk thunk{nullptr};
+    };
+    
+    // In-process processor hosted in the chain like a plugin (built-in and
+    // synthetic nodes). prepare() may allocate and never runs concurrently
+    // with process(); during a reconfiguration the setup covers both the
+    // current and the pending configuration.
+    class AudioProcessor {
+    public:
+        virtual ~AudioProcessor() = default;
+        
+        virtual std::wstring getName() const = 0;
+        virtual bool prepare(const ProcessSetup& setup) = 0;
+        
+        // In place on numChannels planar channels, numSamples <= maxBlockSize
+        virtual void process(float** channels, int numChannels, int numSamples,
+                             const ProcessContext& context) = 0;
+        
+        // Unprepared copy with the same parameters (batch workers), or null
+        // when not supported. May run while another thread is in process().
+        virtual std::unique_ptr<AudioProcessor> clone() const { return nullptr; }
+        
+        // Plain-valued parameters, set from control threads while process()
+        // runs; clones and chain copies carry them over
+        virtual int getParameterCount() const { return 0; }
+        virtual float getParameter(int index) const { return 0.0f; }
+        virtual void setParameter(int index, float value) {}
+        virtual std::wstring getParameterName(int index) const { return L""; }
+        
+        // Frames the output lags the input by, for delay compensation;
+        // read after prepare()
+        virtual int getLatencySamples() const { return 0; }
+        
+        // 64-bit processing, used instead of process() when the setup asks
+        // for ProcessPrecision::Double. Others get converted float blocks.
+        virtual bool supportsDoublePrecision() const { return false; }
+        virtual void processDouble(double** channels, int numChannels, int numSamples,
+                                   const ProcessContext& context) {}
+    };
+    
+    // Timings of the last sample rate / buffer size / driver change
+    struct ReconfigureStats {
+        bool succeeded{false};
+        bool deviceRestarted{false};   // Engine could not switch in place
+        int pluginsPrepared{0};
+        double prepareMs{0.0};         // Parallel plugin preparation (old config still playing)
+        double switchMs{0.0};          // Prepared -> first block boundary on the new config
+        double totalMs{0.0};
+    };
+    
+    // Adaptive buffer size: grow the device buffer when xruns cluster,
+    // shrink it again after a quiet period
+    struct AdaptiveBufferSettings {
+        int minBufferSize{64};
+        int maxBufferSize{2048};
+        int xrunsToGrow{2};                // Within growWindowSeconds
+        double growWindowSeconds{2.0};
+        double quietSecondsToShrink{20.0}; // Doubles when a shrink brings xruns back
+        double pollIntervalMs{50.0};
+    };
+    
+    struct AdaptiveBufferStats {
+        bool enabled{false};
+        int bufferSize{0};
+        uint64_t xruns{0};                 // Reported by the engine
+        uint64_t callbackOverruns{0};      // Callbacks that took longer than their block
+        int stepsUp{0};
+        int stepsDown{0};
+        double shrinkHoldSeconds{0.0};
+    };
+    
+    // Blocks whose chain cost jumped while the output was near silence,
+    // the signature of plugins processing denormal tails
+    struct DenormalStats {
+        bool protectionEnabled{false};
+        bool diagnosticsEnabled{false};
+        uint64_t quietBlocks{0};
+        uint64_t suspectBlocks{0};
+        double baselineUsPerFrame{0.0};   // Smoothed chain cost of audible blocks
+        double worstQuietRatio{0.0};      // Highest quiet-block cost / baseline
+    };
+    
+    // Time one plugin spent in process() per block
+    struct PluginLatency {
+        int pluginId{0};
+        std::wstring name;
+        LatencySummary duration;
+    };
+    
+    // Latency quantiles since the window started (audio start, offline
+    // render start or resetLatencyStats())
+    struct LatencyStats {
+        double windowSeconds{0.0};
+        LatencySummary wakeupLateness;      // Device callback start after one block period from the last
+        LatencySummary callback;            // Whole device callback
+        std::vector<PluginLatency> plugins; // Chain order
+    };
+    
+    // Fill telemetry of the render-ahead FIFO
+    struct RenderAheadStats {
+        bool active{false};
+        int depthBlocks{0};
+        int targetFrames{0};          // depthBlocks device blocks
+        int fillFrames{0};
+        int minFillFrames{0};         // Low-water mark since the previous query
+        uint64_t blocksRendered{0};
+        uint64_t underruns{0};        // Device found the FIFO short
+        uint64_t silentFrames{0};     // Played while refilling after an underrun
+    };
+    
+    // Scrape endpoint serving the Prometheus text format. Listens on
+    // 127.0.0.1 unless a Unix domain socket path is given (POSIX only).
+    struct MetricsServerSettings {
+        int port{9464};               // 0 picks a free port
+        std::string unixSocketPath;
+    };
+    
+    // Control call captured by the session recorder
+    struct SessionEvent {
+        enum class Type {
+            Load,              // path: plugin path, or "processor:<name>" for native processors
+            Unload,
+            UnloadAll,
+            AddToChain,
+            RemoveFromChain,
+            Move,              // value: new chain position
+            Bypass,            // value: 1 bypassed, 0 active
+            SetSampleRate,     // rate
+            SetBufferSize      // value: frames
+        };
+        
+        Type type{Type::Load};
+        int64_t samplePosition{0};   // Frames through the chain since recording started
+        int pluginId{0};             // As numbered when recorded
+        int value{0};
+        double rate{0.0};
+        std::wstring path;
+    };
+    
+    struct SessionPluginState {
+        int pluginId{0};
+        std::wstring path;
+        bool bypassed{false};
+    };
+    
+    // Host state when recording started plus every control call after it.
+    // Chain edits are stamped with the first frame rendered after them.
+    struct SessionRecording {
+        double sampleRate{DEFAULT_SAMPLE_RATE};
+        int bufferSize{DEFAULT_BUFFER_SIZE};
+        int numChannels{2};
+        std::vector<SessionPluginState> plugins;
+        std::vector<int> chain;
+        std::vector<SessionEvent> events;
+        int64_t lengthFrames{0};
+        
+        // Tab-separated UTF-8 text, one line per plugin or event
+        bool save(const std::wstring& path) const;
+        bool load(const std::wstring& path);
+    };
+    
+    const char* getSessionEventName(SessionEvent::Type type);
+    
+    // Headless hosts (tools, benchmarks, render workers) keep errors in
+    // memory and never touch VSTHost.log or blacklist.txt
+    enum class HostMode {
+        Application,
+        Headless
+    };
+    
+    // Offline rendering of many files through copies of one chain
+    struct BatchSettings {
+        int numWorkers{0};                // 0 = one per hardware thread
+        int blockSize{0};                 // 0 = the template host's buffer size
+        int readAheadFrames{1 << 17};     // Decoded ahead of the chain, per worker
+        int writeBehindFrames{1 << 17};   // Rendered and waiting for the writer, per worker
+        int tailFrames{0};                // Rendered past the input on top of the chain latency
+        SampleFormat outputFormat{SampleFormat::Float32};
+    };
+    
+    struct BatchJob {
+        std::wstring inputPath;
+        std::wstring outputPath;
+    };
+    
+    struct BatchFileResult {
+        std::wstring inputPath;
+        bool succeeded{false};
+        std::wstring error;
+        int worker{0};
+        int64_t frames{0};
+        double audioSeconds{0.0};
+        double wallSeconds{0.0};       // Open to output closed
+        double realtimeFactor{0.0};    // Audio seconds per wall second
+    };
+    
+    struct BatchReport {
+        std::vector<BatchFileResult> files;   // Job order
+        int numWorkers{0};
+        int failed{0};
+        double audioSeconds{0.0};
+        double wallSeconds{0.0};
+        double realtimeFactor{0.0};           // All audio over the whole run
+    };
+    
+    // Chain freeze: the chain's output for one input file, cached on disk
+    struct FreezeSettings {
+        std::wstring cacheDirectory;   // Empty = <temp>/evh_freeze
+        bool loop{true};               // Playback wraps at the end of the render
+        int tailFrames{0};             // Reverb and delay tails rendered past the input and latency
+    };
+    
+    struct FreezeStats {
+        bool frozen{false};
+        bool cacheHit{false};          // Played from an earlier render
+        std::wstring cachePath;
+        int64_t lengthFrames{0};
+        double renderSeconds{0.0};     // 0 on a cache hit
+        double realtimeFactor{0.0};    // Of the render
+        uint64_t underruns{0};         // Blocks the streaming thread was late for
+    };
+    
+    // Audio buffer structure
+    template<typename T>
+    class AudioBuffer {
+    public:
+        AudioBuffer(int channels, int samples)
+            : numChannels(channels), numSamples(samples) {
+            
+            channelData.resize(channels);
+            writePointers.resize(channels);
+            
+            for (int ch = 0; ch < channels; ++ch) {
+                channelData[ch].resize(samples);
+                writePointers[ch] = channelData[ch].data();
+            }
+        }
+        
+        ~AudioBuffer() = default;
+        
+        T** getWritePointer() { return writePointers.data(); }
+        const T** getReadPointer() const { return const_cast<const T**>(writePointers.data()); }
+        int getNumChannels() const { return numChannels; }
+        int getNumSamples() const { return numSamples; }
+        
+        void clear() {
+            for (auto& channel : channelData) {
+                std::fill(channel.begin(), channel.end(), T(0));
+            }
+        }
+        
+        void applyGain(float gain) {
+            for (auto& channel : channelData) {
+                for (auto& sample : channel) {
+                    sample *= gain;
+                }
+            }
+        }
+        
+    private:
+        std::vector<std::vector<T>> channelData;
+        std::vector<T*> writePointers;
+        int numChannels;
+        int numSamples;
+    };
+    
+    // Exception classes
+    class PluginException : public std::exception {
+    public:
+        PluginException(const std::string& msg) : message(msg) {}
+        const char* what() const noexcept override { return message.c_str(); }
+    private:
+        std::string message;
+    };
+    
+    class AudioException : public std::exception {
+    public:
+        AudioException(const std::string& msg) : message(msg) {}
+        const char* what() const noexcept override { return message.c_str(); }
+    private:
+        std::string message;
+    };
+    
+    // Input signal for engines without capture hardware (null engine)
+    class CaptureSource {
+    public:
+        virtual ~CaptureSource() = default;
+        
+        virtual void prepare(double sampleRate) {}
+        
+        // Fill numFrames planar frames; called from the capture thread
+        virtual void read(float** dest, int numChannels, int numFrames) = 0;
+    };
+    
+    // Generated test signal
+    class GeneratedCaptureSource : public CaptureSource {
+    public:
+        enum class Signal { Silence, Sine, Noise, Impulse };
+        
+        GeneratedCaptureSource(Signal signal, double frequency = 1000.0, float level = 0.5f);
+        
+        void prepare(double sampleRate) override;
+        void read(float** dest, int numChannels, int numFrames) override;
+        
+    private:
+        Signal signal;
+        double frequency;
+        float level;
+        double phase{0.0};
+        double phaseIncrement{0.0};
+        uint32_t noiseState{0x12345678};
+        int64_t framesUntilImpulse{0};
+        int64_t impulsePeriod{0};
+    };
+    
+    // Raw interleaved 32-bit float file, looped at the end
+    class FileCaptureSource : public CaptureSource {
+    public:
+        FileCaptureSource(const std::wstring& path, int fileChannels);
+        ~FileCaptureSource() override;
+        
+        bool isOpen() const { return file != nullptr; }
+        void read(float** dest, int numChannels, int numFrames) override;
+        
+    private:
+        FILE* file{nullptr};
+        int fileChannels;
+        std::vector<float> interleaved;
+    };
+    
+    // Plays a frozen render on the audio thread. A streaming thread keeps a
+    // ring filled ahead of playback, so the audio thread never touches disk.
+    class FreezePlayer {
+    public:
+        static constexpr int STREAM_CHUNK_FRAMES = 4096;
+        
+        FreezePlayer() = default;
+        ~FreezePlayer() { stop(); }
+        
+        FreezePlayer(const FreezePlayer&) = delete;
+        FreezePlayer& operator=(const FreezePlayer&) = delete;
+        
+        // Prefills the ring before returning
+        bool start(const std::wstring& path, bool loop);
+        void stop();
+        
+        // Audio thread: numFrames frames into numChannels outputs, silence
+        // past the end or when the stream falls behind
+        void read(float** outputs, int numChannels, int numFrames);
+        
+        const AudioFileInfo& getInfo() const { return info; }
+        uint64_t getUnderruns() const { return underruns.load(); }
+        const std::wstring& getLastError() const { return reader.getLastError(); }
+        
+    private:
+        AudioFileReader reader;
+        AudioFileInfo info;
+        SpscAudioRing ring;
+        bool loop{true};
+        std::vector<std::vector<float>> streamBuffers;   // Streaming thread
+        std::vector<float*> streamPtrs;
+        std::vector<std::vector<float>> drainBuffers;    // Audio thread, channels it cannot output
+        std::thread streamThread;
+        std::atomic<bool> running{false};
+        std::atomic<bool> finished{false};               // Whole file in the ring (no loop)
+        std::atomic<uint64_t> underruns{0};
+        
+        bool streamChunk();
+        void streamThreadFunc();
+    };
+    
+    // Where a meter or spectrum analyzer reads the chain
+    struct MeterTap {
+        enum class Point {
+            ChainInput,    // After the input is copied in, before the first plugin
+            AfterPlugin,   // After pluginId's slot (bypassed or not)
+            ChainOutput    // After the last plugin (or the frozen render)
+        };
+        Point point{Point::ChainOutput};
+        int pluginId{0};
+    };
+    
+    // One published set of meter values. Levels are linear; loudness is in
+    // LUFS and -infinity until the window holds any signal.
+    struct MeterSnapshot {
+        int numChannels{0};
+        uint64_t blocks{0};                    // Blocks metered since the meter was added
+        float peak[MAX_CHANNELS]{};            // Sample peak, falling at 20 dB/s
+        float peakHold[MAX_CHANNELS]{};        // Highest since the last resetHolds()
+        float rms[MAX_CHANNELS]{};             // 300 ms exponential average
+        float truePeak[MAX_CHANNELS]{};        // 4x oversampled (BS.1770), falling at 20 dB/s
+        float truePeakHold[MAX_CHANNELS]{};
+        float momentaryLufs{-HUGE_VALF};       // EBU R128, 400 ms window
+        float shortTermLufs{-HUGE_VALF};       // EBU R128, 3 s window
+        float maxMomentaryLufs{-HUGE_VALF};    // Since the last resetHolds()
+    };
+    
+    // Peak, RMS, true-peak and K-weighted loudness of planar blocks. The
+    // audio thread calls process() and publishes a snapshot per block
+    // through a seqlock; read() is safe from any thread at any rate and
+    // never makes the audio thread wait. No allocation after construction.
+    class LevelMeter {
+    public:
+        LevelMeter();
+        
+        LevelMeter(const LevelMeter&) = delete;
+        LevelMeter& operator=(const LevelMeter&) = delete;
+        
+        // Audio thread. A new rate or channel count restarts the meter.
+        void process(const float* const* channels, int numChannels, int numSamples, double sampleRate);
+        
+        MeterSnapshot read() const { return published.read(); }
+        uint32_t getVersion() const { return published.getVersion(); }
+        
+        // Any thread; takes effect at the next block
+        void resetHolds() { resetRequested.store(true, std::memory_order_relaxed); }
+        
+        static float toDecibels(float level) { return level > 0.0f ? 20.0f * std::log10(level) : -HUGE_VALF; }
+        
+    private:
+        static constexpr int TRUE_PEAK_PHASES = 4;
+        static constexpr int TRUE_PEAK_TAPS = 12;            // Per phase
+        static constexpr int TRUE_PEAK_CHUNK = 256;
+        static constexpr int LOUDNESS_STEPS = 30;            // 100 ms each
+        
+        struct Biquad {
+            double b0{1.0}, b1{0.0}, b2{0.0}, a1{0.0}, a2{0.0};
+        };
+        
+        struct ChannelState {
+            double shelfZ1{0.0}, shelfZ2{0.0};
+            double highPassZ1{0.0}, highPassZ2{0.0};
+            double stepEnergy{0.0};                          // K-weighted sum of squares this step
+            double meanSquare{0.0};
+            float peak{0.0f};
+            float peakHold{0.0f};
+            float truePeak{0.0f};
+            float truePeakHold{0.0f};
+            float history[TRUE_PEAK_TAPS - 1]{};             // Last input samples, oldest first
+        };
+        
+        Seqlock<MeterSnapshot> published;
+        std::atomic<bool> resetRequested{false};
+        
+        // Audio thread
+        double sampleRate{0.0};
+        int numChannels{0};
+        uint64_t blocks{0};
+        Biquad shelf;
+        Biquad highPass;
+        float truePeakTaps[TRUE_PEAK_PHASES][TRUE_PEAK_TAPS]{};
+        ChannelState state[MAX_CHANNELS];
+        float channelWeight[MAX_CHANNELS]{};
+        int stepFrames{0};
+        int stepPosition{0};
+        double stepEnergies[LOUDNESS_STEPS]{};              // Channel-weighted, ring
+        int stepIndex{0};
+        float momentaryLufs{-HUGE_VALF};
+        float shortTermLufs{-HUGE_VALF};
+        float maxMomentaryLufs{-HUGE_VALF};
+        float weighted[TRUE_PEAK_CHUNK]{};
+        float line[TRUE_PEAK_TAPS - 1 + TRUE_PEAK_CHUNK]{};
+        float upsampled[TRUE_PEAK_CHUNK]{};
+        
+        void restart(int channels, double rate);
+        void meterChunk(const float* const* channels, int offset, int numSamples);
+        void finishStep();
+    };
+    
+    struct SpectrumSettings {
+        int fftSize{4096};          // Power of two, 256 to 32768
+        int overlap{4};             // Frames per fftSize of input; the hop is fftSize / overlap
+        float smoothing{0.7f};      // Share of the previous frame's power kept (0 = none)
+        int maxChannels{8};         // Chain channels past this are not analyzed
+    };
+    
+    // Smoothed magnitude spectrum of every analyzed channel. A full-scale
+    // sine centred on a bin reads 1.0 there; bin k is k * sampleRate / fftSize.
+    struct SpectrumFrame {
+        int numChannels{0};
+        int numBins{0};               // fftSize / 2 + 1
+        double sampleRate{0.0};
+        uint64_t frameIndex{0};       // FFT frames since the analyzer was added
+        std::vector<float> magnitudes;   // numChannels rows of numBins
+        
+        const float* channel(int ch) const { return magnitudes.data() + static_cast<size_t>(ch) * numBins; }
+    };
+    
+    // Windowed, overlapped FFTs of a tap point. The audio thread only copies
+    // each block into an SPSC ring (dropping it when the ring is full); a
+    // worker drains the ring, runs the FFTs and publishes frames through a
+    // triple buffer for any thread to read.
+    class SpectrumAnalyzer {
+    public:
+        explicit SpectrumAnalyzer(const SpectrumSettings& settings = {});
+        
+        SpectrumAnalyzer(const SpectrumAnalyzer&) = delete;
+        SpectrumAnalyzer& operator=(const SpectrumAnalyzer&) = delete;
+        
+        // Audio thread
+        void push(const float* const* channels, int numChannels, int numSamples, double sampleRate);
+        
+        // Worker: analyzes every complete hop in the ring; true if a frame was published
+        bool analyze();
+        
+        // Any thread; false until the first frame
+        bool read(SpectrumFrame& frame) const { return published.read(frame); }
+        
+        const SpectrumSettings& getSettings() const { return settings; }
+        uint64_t getDroppedFrames() const { return droppedFrames.load(std::memory_order_relaxed); }
+        
+    private:
+        SpectrumSettings settings;
+        int hopSize{0};
+        int numBins{0};
+        
+        // Audio thread
+        SpscAudioRing ring;
+        const float* pushPointers[MAX_CHANNELS]{};
+        std::atomic<int> activeChannels{0};
+        std::atomic<double> activeSampleRate{0.0};
+        std::atomic<uint64_t> droppedFrames{0};
+        
+        // Worker
+        RealFft fft;
+        std::vector<float> window;
+        float magnitudeScale{1.0f};
+        std::vector<std::vector<float>> history;   // Per channel, the last fftSize frames
+        std::vector<float*> hopPointers;
+        std::vector<float> windowed;
+        std::vector<float> spectrumRe;
+        std::vector<float> spectrumIm;
+        std::vector<float> smoothedPower;           // maxChannels rows of numBins
+        int analyzedChannels{0};
+        double analyzedRate{0.0};
+        uint64_t frameIndex{0};
+        
+        TripleBuffer<SpectrumFrame> published;
+    };
+}
+
+// Main VST Host class
+class EnhancedVSTHost {
+public:
+    explicit EnhancedVSTHost(EVH::HostMode mode = EVH::HostMode::Application);
+    ~EnhancedVSTHost();
+    
+    // Initialization
+    bool initialize(EVH::WindowHandle parentWindow = nullptr);
+    void shutdown();
+    
+    // Plugin management
+    void scanPlugins(const std::vector<std::wstring>& searchPaths);
+    bool loadPlugin(const std::wstring& path);
+    int loadProcessor(std::unique_ptr<EVH::AudioProcessor> processor);  // Plugin id, 0 on failure
+    void unloadPlugin(int pluginId);
+    void unloadAllPlugins();
+    
+    // Audio engine control
+    bool startAudio(EVH::AudioDriverType driverType);
+    bool startAudio(std::unique_ptr<AudioEngine> engine);  // Caller-configured engine
+    void stopAudio();
+    bool isAudioRunning() const { return audioRunning.load(); }
+    
+    // Offline rendering: runs the chain on caller buffers without an audio
+    // engine, as fast as the CPU allows (headless batch jobs). Uses the
+    // session rate and buffer size, which must not change until
+    // endOfflineRender(). inputs may be null; otherwise both arrays hold
+    // numChannels channels. Not available while audio is running.
+    bool beginOfflineRender(int numChannels = 2);
+    int renderOffline(const float** inputs, float** outputs, int numFrames);
+    void endOfflineRender();
+    bool isOfflineRendering() const { return offlineRendering.load(); }
+    
+    // Plugin chain management
+    void addPluginToChain(int pluginId);
+    void removePluginFromChain(int pluginId);
+    void movePluginInChain(int pluginId, int newPosition);
+    void bypassPlugin(int pluginId, bool bypass);
+    
+    // Loads a copy of the chain into an idle host (batch workers): native
+    // processors are cloned, plugins reloaded with their parameter values
+    bool cloneChainInto(EnhancedVSTHost& target) const;
+    
+    // Double runs the chain on 64-bit buffers; device I/O, taps and plugins
+    // without 64-bit support are converted at their boundary. Only while
+    // neither audio nor an offline render is running.
+    bool setProcessPrecision(EVH::ProcessPrecision precision);
+    EVH::ProcessPrecision getProcessPrecision() const { return processPrecision; }
+    
+    // Settings
+    void setSampleRate(double rate);
+    void setBufferSize(int size);
+    void setAudioDriver(EVH::AudioDriverType type);
+    
+    // Blacklist/Whitelist
+    void addToBlacklist(const std::wstring& pluginPath);
+    void removeFromBlacklist(const std::wstring& pluginPath);
+    bool isBlacklisted(const std::wstring& pluginPath) const;
+    
+    // Error handling
+    std::vector<std::wstring> getRecentErrors() const;
+    void clearErrors();
+    
+    // Plugin info
+    std::vector<EVH::PluginInfo> getAvailablePlugins() const;
+    EVH::PluginInfo getPluginInfo(int pluginId) const;
+    int getPluginLatencySamples(int pluginId) const;
+    int getChainLatencySamples() const;   // Active plugins in the chain
+    
+    // Reconfiguration
+    EVH::ReconfigureStats getLastReconfigureStats() const;
+    
+    // Live input (off by default; engines without hardware use the capture source)
+    void setInputEnabled(bool enable) { inputEnabled = enable; }
+    void setCaptureSource(std::shared_ptr<EVH::CaptureSource> source) { captureSource = std::move(source); }
+    int getInputLatencySamples() const;
+    
+    // Sample rate conversion between the session and the device
+    void setResamplerQuality(EVH::ResamplerQuality quality);
+    double getSessionSampleRate() const { return currentSampleRate; }
+    int getBufferSize() const { return currentBufferSize; }
+    double getDeviceSampleRate() const;
+    
+    // Render-ahead: a worker thread renders up to N device blocks ahead into
+    // a FIFO and the device thread only copies out. Trades N blocks of
+    // latency for headroom; live input is not available in this mode.
+    // 0 renders inside the device callback.
+    void setRenderAheadBlocks(int blocks);
+    int getRenderAheadBlocks() const { return renderAheadBlocks; }
+    EVH::RenderAheadStats getRenderAheadStats() const;
+    
+    // Adaptive buffer size, stepped through setBufferSize() by a control thread
+    void setAdaptiveBufferSize(bool enable, const EVH::AdaptiveBufferSettings& settings = {});
+    EVH::AdaptiveBufferStats getAdaptiveBufferStats() const;
+    uint64_t getXrunCount() const;
+    
+    // Realtime setup. The audio policy applies to engine threads, the worker
+    // policy to DSP workers (render-ahead); both take effect as threads start.
+    void setThreadPolicy(const EVH::ThreadPolicy& audioPolicy, const EVH::ThreadPolicy& workerPolicy = {});
+    EVH::ThreadPolicyResult getAudioThreadPolicyResult() const;
+    EVH::ThreadPolicyResult getWorkerThreadPolicyResult() const;
+    EVH::MemoryLockResult lockMemory();
+    
+    // FTZ/DAZ around every callback and worker block (on by default). The
+    // diagnostic mode times the chain and counts suspect quiet blocks.
+    void setDenormalProtection(bool enable) { denormalProtection = enable; }
+    void setDenormalDiagnostics(bool enable);
+    EVH::DenormalStats getDenormalStats() const;
+    
+    // HDR histograms recorded on the audio thread; reading never blocks it
+    EVH::LatencyStats getLatencyStats() const;
+    void resetLatencyStats();
+    
+    // Metrics endpoint (off by default). Scrapes read the counters and
+    // histograms the audio thread publishes and never take its locks.
+    bool startMetricsServer(const EVH::MetricsServerSettings& settings = {});
+    void stopMetricsServer();
+    std::string getMetricsAddress() const;   // "127.0.0.1:port" or the socket path
+    std::string getMetricsText() const;
+    
+    // Session recording for deterministic offline replay (evh_replay)
+    void startSessionRecording();
+    EVH::SessionRecording stopSessionRecording();
+    bool isRecordingSession() const;
+    
+    // Chain freeze: renders inputPath through a copy of the chain, faster
+    // than realtime, into a disk cache keyed by the chain configuration and
+    // the input file, then plays the render in place of the chain with its
+    // plugins suspended. The render runs on past the input by the chain
+    // latency plus settings.tailFrames. Chain edits made while frozen take effect after
+    // unfreezeChain(), which resumes the same plugin instances.
+    bool freezeChain(const std::wstring& inputPath, const EVH::FreezeSettings& settings = {});
+    void unfreezeChain();
+    bool isChainFrozen() const { return chainFrozen.load(); }
+    EVH::FreezeStats getFreezeStats() const;
+    
+    // Level and loudness meters at chain tap points, metered on the audio
+    // thread every block. A meter's read() never waits on the audio thread;
+    // one after a plugin that leaves the chain stops updating.
+    int addMeter(const EVH::MeterTap& tap);   // Meter id
+    void removeMeter(int meterId);
+    std::shared_ptr<EVH::LevelMeter> getMeter(int meterId) const;
+    bool readMeter(int meterId, EVH::MeterSnapshot& snapshot) const;
+    
+    // Spectrum analyzers at tap points. The audio thread copies each block
+    // into the analyzer's ring; a shared worker thread runs the FFTs.
+    int addSpectrumAnalyzer(const EVH::MeterTap& tap, const EVH::SpectrumSettings& settings = {});
+    void removeSpectrumAnalyzer(int analyzerId);
+    std::shared_ptr<EVH::SpectrumAnalyzer> getSpectrumAnalyzer(int analyzerId) const;
+    bool readSpectrum(int analyzerId, EVH::SpectrumFrame& frame) const;
+    
+    // Devices used by AudioDriverType::Aggregate (empty name = default endpoint)
+    void setAggregateDevices(const std::vector<std::wstring>& deviceNames,
+                             EVH::AggregateRouting routing = EVH::AggregateRouting::Mirror);
+    int getNumOutputChannels() const { return numChainChannels; }
+    
+    // Callbacks
+    using ScanProgressCallback = std::function<void(int current, int total, const std::wstring& currentPlugin)>;
+    using ErrorCallback = std::function<void(const std::wstring& error)>;
+    using CrashCallback = std::function<void(int pluginId, const std::wstring& pluginName)>;
+    
+    void setScanProgressCallback(ScanProgressCallback cb) { scanProgressCb = cb; }
+    void setErrorCallback(ErrorCallback cb) { errorCb = cb; }
+    void setCrashCallback(CrashCallback cb) { crashCb = cb; }
+    
+private:
+    EVH::HostMode hostMode;
+    
+    // Core components
+    std::unique_ptr<PluginScanner> scanner;
+    std::unique_ptr<AudioEngine> audioEngine;
+    std::unique_ptr<NotificationManager> notificationMgr;
+    std::unique_ptr<ErrorLogger> errorLogger;
+    std::unique_ptr<PluginBridge32> bridge32;
+    std::unique_ptr<MetricsServer> metricsServer;
+    
+    // Plugin management
+    std::unordered_map<int, std::unique_ptr<PluginInstance>> loadedPlugins;
+    std::vector<int> pluginChain;
+    mutable std::mutex pluginMutex;
+    mutable std::mutex reconfigureMutex;  // Serialises reconfiguration against plugin load/unload
+    std::atomic<int> nextPluginId{1};
+    
+    // Blacklist
+    std::unordered_set<std::wstring> blacklistedPlugins;
+    bool blacklistLoaded{false};   // By initialize(); shutdown() saves only then
+    mutable std::mutex blacklistMutex;
+    
+    // Audio state
+    std::atomic<bool> audioRunning{false};
+    std::atomic<bool> offlineRendering{false};
+    std::vector<const float*> offlineInputPtrs;
+    std::vector<float*> offlineOutputPtrs;
+    // Written on the audio thread by a hot switch, read by control threads
+    std::atomic<double> currentSampleRate{EVH::DEFAULT_SAMPLE_RATE};
+    std::atomic<int> currentBufferSize{EVH::DEFAULT_BUFFER_SIZE};
+    EVH::AudioDriverType currentDriverType{EVH::DEFAULT_AUDIO_DRIVER};
+    EVH::ReconfigureStats lastReconfigureStats;
+    mutable std::mutex statsMutex;
+    
+    // Session <-> device rate conversion (only when the rates differ)
+    std::unique_ptr<EVH::ResamplingAdapter> resampler;
+    int numChainChannels{2};
+    int64_t chainPosition{0};   // Session-rate frames rendered since start
+    std::atomic<int64_t> framesProcessed{0};   // Never reset; timestamps session events
+    std::atomic<double> deviceClockRatio{1.0};
+    
+    // Double-precision chain buffers, sized when audio or a render starts;
+    // longer blocks are processed in pieces. The float scratch feeds
+    // 32-bit plugins and the taps.
+    EVH::ProcessPrecision processPrecision{EVH::ProcessPrecision::Single};
+    std::unique_ptr<EVH::AudioBuffer<double>> doubleChain;
+    std::unique_ptr<EVH::AudioBuffer<float>> floatScratch;
+    
+    // Render-ahead FIFO, swapped only at a block boundary or while stopped
+    struct RenderAheadFifo {
+        EVH::SpscAudioRing ring;
+        std::vector<std::vector<float>> scratch;
+        std::vector<float*> scratchPtrs;
+        std::atomic<int> targetFrames{0};
+        std::atomic<bool> recovering{true};   // Silent until refilled to target
+        mutable std::atomic<int> minFill{0};
+        std::atomic<uint64_t> blocksRendered{0};
+        std::atomic<uint64_t> underruns{0};
+        std::atomic<uint64_t> silentFrames{0};
+    };
+    
+    int renderAheadBlocks{0};
+    std::unique_ptr<RenderAheadFifo> renderAhead;
+    std::thread renderAheadThread;
+    std::atomic<bool> renderAheadStop{false};
+    
+    // Denormal protection and diagnostics
+    std::atomic<bool> denormalProtection{true};
+    std::atomic<bool> denormalDiagnostics{false};
+    std::atomic<uint64_t> quietBlocks{0};
+    std::atomic<uint64_t> denormalSuspectBlocks{0};
+    std::atomic<double> chainBaselineUsPerFrame{0.0};
+    std::atomic<double> worstQuietRatio{0.0};
+    
+    // Latency histograms (reads and window resets under latencyMutex)
+    EVH::LatencyHistogram wakeupHistogram;
+    EVH::LatencyHistogram callbackHistogram;
+    int64_t expectedDevicePosition{-1};   // Audio thread only
+    int64_t expectedWakeupNs{0};
+    std::chrono::steady_clock::time_point latencyWindowStart{std::chrono::steady_clock::now()};
+    mutable std::mutex latencyMutex;
+    
+    // Session recording (sessionMutex is taken after pluginMutex, never by audio)
+    std::unique_ptr<EVH::SessionRecording> sessionRecording;
+    int64_t sessionStartFrame{0};
+    mutable std::mutex sessionMutex;
+    
+    // Chain freeze; the player is swapped under reconfigureMutex + pluginMutex
+    std::unique_ptr<EVH::FreezePlayer> freezePlayer;
+    std::vector<int> frozenPluginIds;   // Suspended by the freeze
+    EVH::FreezeStats freezeStats;
+    std::atomic<bool> chainFrozen{false};
+    
+    // Meters; the audio thread's list changes under pluginMutex, lookups
+    // by id take only meterMutex
+    struct ChainMeter {
+        int id;
+        EVH::MeterTap tap;
+        std::shared_ptr<EVH::LevelMeter> meter;
+    };
+    std::vector<ChainMeter> chainMeters;
+    std::unordered_map<int, std::shared_ptr<EVH::LevelMeter>> meterLookup;
+    mutable std::mutex meterMutex;
+    std::atomic<int> nextMeterId{1};
+    
+    // Spectrum analyzers: the audio list like the meters', the rest under
+    // spectrumMutex; the worker analyzes a copy of the list outside it
+    struct ChainSpectrum {
+        int id;
+        EVH::MeterTap tap;
+        std::shared_ptr<EVH::SpectrumAnalyzer> analyzer;
+    };
+    std::vector<ChainSpectrum> chainSpectra;
+    std::unordered_map<int, std::shared_ptr<EVH::SpectrumAnalyzer>> spectrumLookup;
+    std::vector<std::shared_ptr<EVH::SpectrumAnalyzer>> spectrumWork;   // Worker thread
+    mutable std::mutex spectrumMutex;
+    std::condition_variable spectrumCv;
+    std::thread spectrumThread;
+    bool spectrumStop{false};
+    std::atomic<int> nextSpectrumId{1};
+    
+    // Scan progress, published for the metrics endpoint
+    std::atomic<bool> scanRunning{false};
+    std::atomic<int> scanPosition{0};      // Within the current directory
+    std::atomic<int> scanDirectoryFiles{0};
+    std::atomic<uint64_t> scannedFiles{0};
+    std::atomic<uint64_t> scanPluginsFound{0};
+    std::atomic<double> scanSeconds{0.0};
+    std::atomic<double> lastScanFilesPerSecond{0.0};
+    
+    // Thread policies
+    EVH::ThreadPolicy audioThreadPolicy;
+    EVH::ThreadPolicy workerThreadPolicy;
+    EVH::ThreadPolicyResult workerPolicyResult;
+    mutable std::mutex policyMutex;
+    
+    // Adaptive buffer size control
+    EVH::AdaptiveBufferSettings adaptiveSettings;
+    std::thread adaptiveThread;
+    std::mutex adaptiveMutex;
+    std::condition_variable adaptiveCv;
+    bool adaptiveStop{false};
+    std::atomic<uint64_t> callbackOverruns{0};
+    std::atomic<int> adaptiveStepsUp{0};
+    std::atomic<int> adaptiveStepsDown{0};
+    std::atomic<double> adaptiveShrinkHold{0.0};
+    
+    // Aggregate device members
+    std::vector<std::wstring> aggregateDevices;
+    EVH::AggregateRouting aggregateRouting{EVH::AggregateRouting::Mirror};
+    
+    // Input
+    bool inputEnabled{false};
+    std::shared_ptr<EVH::CaptureSource> captureSource;
+    EVH::ResamplerQuality resamplerQuality{EVH::ResamplerQuality::High};
+    
+    // Window handling
+    EVH::WindowHandle parentWindow{nullptr};
+    bool highDpiAware{false};
+    
+    // Callbacks
+    ScanProgressCallback scanProgressCb;
+    ErrorCallback errorCb;
+    CrashCallback crashCb;
+    
+    // Helper methods
+    void setupHighDPI();
+    void handlePluginCrash(int pluginId);
+    void logError(const std::wstring& error);
+    bool validatePlugin(const std::wstring& path);
+    int loadPluginFile(const std::wstring& path);   // Plugin id, 0 on failure
+    std::unique_ptr<PluginInstance> createPluginInstance(const EVH::PluginInfo& info);
+    std::unique_ptr<AudioEngine> createAudioEngine(EVH::AudioDriverType driverType);
+    void installAudioCallback(AudioEngine& engine);
+    void handleAudioBlock(const float** inputs, float** outputs, int numSamples, const EVH::ProcessContext& context);
+    void processChain(const float** inputs, float** outputs, int numSamples, const EVH::ProcessContext& context);
+    void processChainSingle(const float** inputs, float** outputs, int numSamples,
+                            const EVH::ProcessContext& context);
+    void processChainDouble(const float** inputs, float** outputs, int numSamples,
+                            const EVH::ProcessContext& context);
+    void allocatePrecisionBuffers(int maxBlockSize);
+    void renderDeviceBlock(const float** inputs, float** outputs, int numSamples, const EVH::ProcessContext& context);
+    std::unique_ptr<RenderAheadFifo> createRenderAheadFifo(int blockSize) const;
+    void startRenderAhead();
+    void stopRenderAhead();
+    void renderAheadThreadFunc();
+    void pullRenderAhead(RenderAheadFifo& fifo, float** outputs, int numSamples);
+    void adaptiveBufferThreadFunc();
+    void updateDenormalDiagnostics(float** outputs, int numSamples, double microseconds);
+    void runTaps(EVH::MeterTap::Point point, int pluginId, float** buffers, int numSamples);
+    bool hasTap(EVH::MeterTap::Point point, int pluginId) const;
+    void stopSpectrumThread();
+    void spectrumThreadFunc();
+    void resetLatencyWindow();   // Caller holds reconfigureMutex
+    void recordSessionEvent(EVH::SessionEvent event);
+    std::string describeChain() const;   // Caller holds pluginMutex
+    std::unique_ptr<EVH::ResamplingAdapter> createResampler(const AudioEngine& engine);
+    bool reconfigureAudio(double rate, int size);
+    bool switchAudioDriver(EVH::AudioDriverType type);
+    int preparePluginsInParallel(const EVH::ProcessSetup& setup);
+    void commitPreparedPlugins();
+};
+
+// Plugin Scanner with crash isolation
+class PluginScanner {
+public:
+    PluginScanner();
+    ~PluginScanner();
+    
+    void scanDirectory(const std::wstring& path, 
+                      std::function<void(const EVH::PluginInfo&)> onPluginFound,
+                      std::function<void(int, int, const std::wstring&)> onProgress);
+    
+    bool scanPluginInProcess(const std::wstring& path, EVH::PluginInfo& info);
+    
+private:
+    struct ScanJob {
+        std::wstring path;
+        EVH::ProcessHandle processHandle;
+        EVH::PipeHandle pipeHandle;
+        std::chrono::steady_clock::time_point startTime;
+    };
+    
+    std::vector<ScanJob> activeJobs;
+    std::mutex jobMutex;
+    
+    bool launchScannerProcess(const std::wstring& pluginPath, ScanJob& job);
+    bool readScanResult(EVH::PipeHandle pipe, EVH::PluginInfo& info);
+    void terminateHungProcesses();
+};
+
+// Audio Engine base class
+class AudioEngine {
+public:
+    virtual ~AudioEngine() = default;
+    
+    virtual bool initialize(double sampleRate, int bufferSize) = 0;
+    virtual void shutdown() = 0;
+    virtual bool start() = 0;
+    virtual void stop() = 0;
+    
+    virtual std::vector<std::wstring> getDeviceList() const = 0;
+    virtual bool selectDevice(const std::wstring& deviceName) = 0;
+    
+    // Change rate/size while running. onSwitch runs at the block boundary
+    // where the new configuration takes effect. The default restarts the
+    // device; engines that can switch in place override this.
+    virtual bool reconfigure(double newSampleRate, int newBufferSize, std::function<void()> onSwitch);
+    virtual bool supportsHotReconfigure() const { return false; }
+    
+    double getSampleRate() const { return sampleRate; }
+    int getBufferSize() const { return bufferSize; }
+    virtual int getNumOutputChannels() const { return 2; }
+    
+    // Duplex input. Set before initialize(). Captured audio goes through a
+    // lock-free ring that the render thread reads in step with its blocks.
+    void setCaptureEnabled(bool enable) { captureEnabled = enable; }
+    void setCaptureSource(std::shared_ptr<EVH::CaptureSource> source) { captureSource = std::move(source); }
+    virtual bool isCaptureActive() const { return captureActive; }
+    virtual int getInputLatencySamples() const;
+    uint64_t getCaptureUnderruns() const { return captureUnderruns.load(); }
+    
+    // Blocks the device needed before the callback delivered them
+    virtual uint64_t getXrunCount() const { return xrunCount.load(); }
+    
+    // Set while the engine is stopped
+    void setAudioCallback(EVH::RenderCallback cb) { audioCallback = cb; }
+    
+    // Scheduling/affinity for the engine's threads, applied as they start.
+    // SCHED_DEADLINE without runtime/period uses half of one block per block.
+    void setThreadPolicy(const EVH::ThreadPolicy& policy) { threadPolicy = policy; }
+    virtual EVH::ThreadPolicyResult getThreadPolicyResult() const;
+    
+protected:
+    EVH::RenderCallback audioCallback;
+    double sampleRate{EVH::DEFAULT_SAMPLE_RATE};
+    int bufferSize{EVH::DEFAULT_BUFFER_SIZE};
+    
+    // Capture state shared by the engines
+    bool captureEnabled{false};
+    bool captureActive{false};
+    std::shared_ptr<EVH::CaptureSource> captureSource;
+    EVH::SpscAudioRing captureRing;
+    std::atomic<int> captureDeviceLatency{0};
+    std::atomic<uint64_t> captureUnderruns{0};
+    int capturePacketFrames{0};   // Largest chunk the capture side delivers at once
+    std::atomic<uint64_t> xrunCount{0};
+    
+    EVH::ThreadPolicy threadPolicy;
+    EVH::ThreadPolicyResult threadPolicyResult;   // Of the render thread
+    mutable std::mutex threadPolicyMutex;
+    
+    EVH::ThreadPolicyResult applyEngineThreadPolicy(EVH::ThreadPolicy policy);
+    void setThreadPolicyResult(const EVH::ThreadPolicyResult& result);
+    
+    // Timing passed to the callback; engines call beginBlock() per block
+    EVH::ProcessContext processContext;
+    EVH::ClockDll clockDll;
+    int64_t nextSamplePosition{0};
+    
+    void resetProcessContext();
+    const EVH::ProcessContext& beginBlock(int numFrames, int outputLatencyFrames);
+    
+    void prepareCaptureRing(int numChannels);
+    int getCaptureTargetFrames() const;
+    int readCapturedInput(float* const* dest, int numFrames);
+};
+
+#ifdef _WIN32
+// WASAPI implementation
+class WASAPIEngine : public AudioEngine {
+public:
+    WASAPIEngine();
+    ~WASAPIEngine() override;
+    
+    bool initialize(double sampleRate, int bufferSize) override;
+    void shutdown() override;
+    bool start() override;
+    void stop() override;
+    
+    std::vector<std::wstring> getDeviceList() const override;
+    bool selectDevice(const std::wstring& deviceName) override;
+    
+private:
+    Microsoft::WRL::ComPtr<IMMDeviceEnumerator> deviceEnumerator;
+    Microsoft::WRL::ComPtr<IMMDevice> audioDevice;
+    Microsoft::WRL::ComPtr<IAudioClient> audioClient;
+    Microsoft::WRL::ComPtr<IAudioRenderClient> renderClient;
+    
+    // Capture stream, polled on each render wakeup
+    Microsoft::WRL::ComPtr<IMMDevice> captureDevice;
+    Microsoft::WRL::ComPtr<IAudioClient> captureClient;
+    Microsoft::WRL::ComPtr<IAudioCaptureClient> captureService;
+    std::unique_ptr<EVH::SampleRateConverter> captureConverter;
+    std::vector<std::vector<float>> captureScratch;
+    std::vector<std::vector<float>> captureConverted;
+    int captureChannels{0};
+    
+    std::thread audioThread;
+    std::atomic<bool> shouldStop{false};
+    HANDLE bufferEvent{nullptr};
+    int deviceChannels{2};
+    int renderStreamLatency{0};   // Frames, excluding what is queued in the buffer
+    std::wstring requestedDeviceName;
+    
+    bool initializeCapture();
+    void drainCapture();
+    void audioThreadFunc();
+};
+#endif
+
+// Device-less engine that runs the callback on a timer thread at the
+// configured rate. Switches rate/size in place at a block boundary.
+class NullEngine : public AudioEngine {
+public:
+    NullEngine();
+    ~NullEngine() override;
+    
+    bool initialize(double sampleRate, int bufferSize) override;
+    void shutdown() override;
+    bool start() override;
+    void stop() override;
+    
+    std::vector<std::wstring> getDeviceList() const override;
+    bool selectDevice(const std::wstring& deviceName) override;
+    
+    bool reconfigure(double newSampleRate, int newBufferSize, std::function<void()> onSwitch) override;
+    bool supportsHotReconfigure() const override { return true; }
+    
+    uint64_t getBlocksProcessed() const { return blocksProcessed.load(); }
+    
+    // Simulated clock error so drift handling can be exercised without
+    // hardware: positive values run the device fast
+    void setClockSkewPpm(double ppm) { clockSkewPpm = ppm; }
+    
+    // Simulated CPU load: busy-waits this long after each of the next
+    // numBlocks callbacks
+    void injectLoadSpike(double milliseconds, int numBlocks = 1);
+    
+private:
+    struct BlockBuffers {
+        std::vector<std::vector<float>> inputs;
+        std::vector<std::vector<float>> outputs;
+        std::vector<const float*> inputPtrs;
+        std::vector<float*> inputWritePtrs;
+        std::vector<float*> outputPtrs;
+        
+        void allocate(int numChannels, int numFrames);
+    };
+    
+    static constexpr int numChannels = 2;
+    static constexpr int capturePeriodFrames = 256;   // Independent of the render block size
+    
+    BlockBuffers buffers;
+    std::thread audioThread;
+    std::thread captureThread;
+    std::atomic<double> captureRate{EVH::DEFAULT_SAMPLE_RATE};
+    std::atomic<double> clockSkewPpm{0.0};
+    std::atomic<double> spikeMs{0.0};
+    std::atomic<int> spikeBlocks{0};
+    std::atomic<bool> shouldStop{false};
+    std::atomic<bool> running{false};
+    std::atomic<uint64_t> blocksProcessed{0};
+    
+    // Pending reconfiguration, applied by the audio thread between blocks
+    std::mutex reconfigMutex;
+    std::condition_variable reconfigCv;
+    std::atomic<bool> reconfigPending{false};
+    bool reconfigDone{false};
+    double pendingSampleRate{0.0};
+    int pendingBufferSize{0};
+    BlockBuffers pendingBuffers;
+    std::function<void()> pendingSwitch;
+    
+    void audioThreadFunc();
+    void captureThreadFunc();
+    void applyPendingReconfigure();
+};
+
+// Several engines presented as one logical device. The first device is
+// the clock master and drives the callback; each other device is fed from
+// a FIFO through a resampler whose ratio tracks that device's clock drift.
+class AggregateEngine : public AudioEngine {
+public:
+    using Routing = EVH::AggregateRouting;
+    
+    struct DeviceStatus {
+        int index;
+        double driftPpm;
+        double ratio;
+        double fillFrames;
+        uint64_t underruns;
+        uint64_t overruns;
+        uint64_t gaps;        // Member-device xruns the FIFO was re-centred after
+    };
+    
+    explicit AggregateEngine(Routing routing = Routing::Mirror);
+    ~AggregateEngine() override;
+    
+    // Add before initialize(); the first device added is the clock master
+    void addDevice(std::unique_ptr<AudioEngine> engine);
+    
+    bool initialize(double sampleRate, int bufferSize) override;
+    void shutdown() override;
+    bool start() override;
+    void stop() override;
+    
+    std::vector<std::wstring> getDeviceList() const override;
+    bool selectDevice(const std::wstring& deviceName) override;
+    
+    int getNumOutputChannels() const override;
+    bool isCaptureActive() const override;
+    int getInputLatencySamples() const override;
+    uint64_t getXrunCount() const override;
+    EVH::ThreadPolicyResult getThreadPolicyResult() const override;
+    
+    std::vector<DeviceStatus> getDeviceStatus() const;
+    
+private:
+    struct Secondary {
+        std::unique_ptr<AudioEngine> engine;
+        EVH::SpscAudioRing ring;
+        std::unique_ptr<EVH::SampleRateConverter> converter;
+        EVH::DriftController drift;
+        
+        // Resampled frames waiting for the device callback
+        std::vector<std::vector<float>> chunk;
+        std::vector<std::vector<float>> fifo;
+        std::vector<float*> chunkPtrs;
+        std::vector<float*> fifoPtrs;
+        int fifoFrames{0};
+        uint64_t seenXruns{0};
+        bool synced{false};   // Fill re-centred once the master is running
+        int settleBlocks{0};  // Loop held until the devices settle after a gap
+        
+        std::atomic<int64_t> lastWriteNs{0};
+        std::atomic<uint64_t> underruns{0};
+        std::atomic<uint64_t> overruns{0};
+        std::atomic<uint64_t> gaps{0};
+        std::atomic<double> ratio{1.0};
+        std::atomic<double> driftPpm{0.0};
+        std::atomic<double> fillFrames{0.0};
+        
+        AggregateEngine* owner{nullptr};
+        void render(const float**, float** outputs, int numSamples, const EVH::ProcessContext&) {
+            owner->processSecondary(*this, outputs, numSamples);
+        }
+    };
+    
+    Routing routing;
+    std::vector<std::unique_ptr<AudioEngine>> pendingDevices;
+    std::unique_ptr<AudioEngine> master;
+    std::vector<std::unique_ptr<Secondary>> secondaries;
+    
+    std::vector<std::vector<float>> logicalOutputs;
+    std::vector<float*> logicalPtrs;
+    std::vector<const float*> logicalInputPtrs;  // Master input, null beyond its channels
+    
+    void processMaster(const float** inputs, float** outputs, int numSamples, const EVH::ProcessContext& context);
+    void processSecondary(Secondary& device, float** outputs, int numSamples);
+};
+
+// Plugin Instance wrapper
+class PluginInstance {
+public:
+    PluginInstance(const EVH::PluginInfo& info);
+    PluginInstance(const EVH::PluginInfo& info, std::unique_ptr<EVH::AudioProcessor> nativeProcessor);
+    ~PluginInstance();
+    
+    bool load();
+    void unload();
+    
+    void process(const float** inputs, float** outputs, int numSamples);
+    void processReplacing(float** inputs, float** outputs, int numSamples);
+    
+    // In place on the chain's 64-bit buffers; only when supportsDoublePrecision()
+    void processReplacingDouble(double** channels, int numSamples);
+    bool supportsDoublePrecision() const;
+    
+    void suspend();
+    void resume();
+    
+    // Two-phase setup change: prepare() may allocate and runs off the audio
+    // thread while the current setup keeps processing; commitPreparedSetup()
+    // is cheap and is called at the block boundary of the switch.
+    bool prepare(const EVH::ProcessSetup& newSetup);
+    void commitPreparedSetup();
+    const EVH::ProcessSetup& getProcessSetup() const { return setup; }
+    
+    // Timing of the next process call, set by the host from the audio thread
+    void setProcessContext(const EVH::ProcessContext& context) { processContext = context; }
+    const EVH::ProcessContext& getProcessContext() const { return processContext; }
+    
+    void openEditor(EVH::WindowHandle parentWindow);
+    void closeEditor();
+    bool hasEditor() const { return info.hasCustomEditor; }
+    
+    void setBypass(bool bypass) { bypassed = bypass; }
+    bool isBypassed() const { return bypassed; }
+    
+    EVH::PluginState getState() const { return state.load(); }
+    const EVH::PluginInfo& getInfo() const { return info; }
+    
+    bool isNative() const { return nativeProcessor != nullptr; }
+    std::unique_ptr<EVH::AudioProcessor> cloneProcessor() const {
+        std::lock_guard<std::mutex> lock(processorMutex);
+        return nativeProcessor ? nativeProcessor->clone() : nullptr;
+    }
+    
+    // process() durations, recorded by the host's chain
+    EVH::LatencyHistogram& getProcessHistogram() { return processHistogram; }
+    
+    // Parameter management
+    int getParameterCount() const;
+    float getParameter(int index) const;
+    void setParameter(int index, float value);
+    std::wstring getParameterName(int index) const;
+    std::wstring getParameterLabel(int index) const;
+    std::wstring getParameterDisplay(int index) const;
+    
+    // Processing delay reported by the processor at the current setup
+    int getLatencySamples() const;
+    
+private:
+    EVH::PluginInfo info;
+    std::atomic<EVH::PluginState> state{EVH::PluginState::Unloaded};
+    bool bypassed{false};
+    
+    // Processing setup
+    EVH::ProcessSetup setup;
+    EVH::ProcessSetup preparedSetup;
+    std::atomic<bool> hasPreparedSetup{false};
+    EVH::ProcessContext processContext;
+    
+    // Plugin module
+    EVH::DynamicLibrary module;
+    
+    // In-process processor instead of a module, with the clone prepared for
+    // the next setup and the one it replaced, freed off the audio thread
+    std::unique_ptr<EVH::AudioProcessor> nativeProcessor;
+    std::unique_ptr<EVH::AudioProcessor> standbyProcessor;
+    std::unique_ptr<EVH::AudioProcessor> retiredProcessor;
+    
+    EVH::LatencyHistogram processHistogram;
+    
+    // VST3 specific
+    void* component{nullptr};  // Would be Steinberg::IPtr<Steinberg::Vst::IComponent>
+    void* processor{nullptr};  // Would be Steinberg::IPtr<Steinberg::Vst::IAudioProcessor>
+    
+    // Editor
+    EVH::WindowHandle editorWindow{nullptr};
+    
+    // Thread safety; processorMutex guards the processor pointers against
+    // the swap and is only held briefly
+    mutable std::mutex processMutex;
+    mutable std::mutex processorMutex;
+    
+    // Helper methods
+    bool loadVST3();
+    void processNative(const float** inputs, float** outputs, int numSamples);
+};
+
+// 32-bit plugin bridge
+class PluginBridge32 {
+public:
+    PluginBridge32();
+    ~PluginBridge32();
+    
+    bool initialize();
+    void shutdown();
+    
+    bool loadPlugin32(const std::wstring& path, EVH::PluginInfo& info);
+    void unloadPlugin32(const std::wstring& path);
+    
+    void process32(const std::wstring& pluginPath, 
+                   const float** inputs, float** outputs, 
+                   int numSamples);
+    
+private:
+    EVH::ProcessHandle bridgeProcess{};
+    EVH::PipeHandle commandPipe{};
+    EVH::PipeHandle dataPipe{};
+    std::mutex bridgeMutex;
+    
+    bool sendCommand(const std::string& cmd);
+    bool receiveResponse(std::string& response);
+};
+
+// Desktop notifications (tray balloons on Windows, stderr elsewhere)
+class NotificationManager {
+public:
+    NotificationManager(EVH::WindowHandle parentWindow);
+    ~NotificationManager();
+    
+    void showNotification(const std::wstring& title, const std::wstring& message);
+    void showErrorNotification(const std::wstring& error);
+    void showPluginCrashNotification(const std::wstring& pluginName);
+    
+private:
+    EVH::WindowHandle parentWindow;
+    bool useToastNotifications;
+    
+    void initializeToastNotifications();
+    void showLegacyNotification(const std::wstring& title, const std::wstring& message);
+};
+
+// Error logger
+class ErrorLogger {
+public:
+    ErrorLogger(const std::wstring& logPath);   // Empty = no log file
+    ~ErrorLogger();
+    
+    void logError(const std::wstring& error);
+    void logPluginCrash(const std::wstring& pluginName, const std::wstring& details);
+    void logAudioError(const std::wstring& error);
+    
+    std::vector<std::wstring> getRecentErrors(int count = 100) const;
+    void clearLog();
+    
+    // Read without logMutex (monitoring)
+    uint64_t getErrorCount() const { return errorCount.load(); }
+    size_t getQueueDepth() const { return queueDepth.load(); }
+    
+private:
+    std::wstring logFilePath;
+    mutable std::mutex logMutex;
+    std::queue<std::wstring> recentErrors;
+    std::atomic<uint64_t> errorCount{0};
+    std::atomic<size_t> queueDepth{0};
+    std::wofstream logFile;
+    
+    std::wstring getCurrentTimestamp() const;
+};
+
+// Minimal HTTP server answering GET /metrics from its own thread, one
+// connection at a time; render is called there for every scrape
+class MetricsServer {
+public:
+    using RenderCallback = std::function<std::string()>;
+    
+    MetricsServer() = default;
+    ~MetricsServer();
+    
+    bool start(const EVH::MetricsServerSettings& settings, RenderCallback render);
+    void stop();
+    bool isRunning() const { return serverThread.joinable(); }
+    
+    const std::string& getAddress() const { return address; }
+    const std::wstring& getLastError() const { return lastError; }
+    uint64_t getScrapeCount() const { return scrapeCount.load(); }
+    
+private:
+    std::intptr_t listenSocket{-1};   // SOCKET on Windows
+    std::string address;
+    std::string unixSocketPath;
+    std::wstring lastError;
+    RenderCallback render;
+    std::thread serverThread;
+    std::atomic<bool> stopRequested{false};
+    std::atomic<uint64_t> scrapeCount{0};
+    
+    bool fail(const std::wstring& what);
+    void serverThreadFunc();
+    void serveConnection(std::intptr_t connection);
+};
+
+// Renders files through copies of a host's chain, one worker thread per
+// copy. Each worker streams its file through a read-ahead thread and hands
+// rendered audio to a writer thread, so the chain never waits on disk.
+class BatchRenderer {
+public:
+    using FileDoneCallback = std::function<void(const EVH::BatchFileResult& result)>;   // From workers
+    
+    BatchRenderer(const EnhancedVSTHost& templateHost, const EVH::BatchSettings& settings = {});
+    
+    // Largest files start first so the last worker is not left with a long one
+    EVH::BatchReport run(const std::vector<EVH::BatchJob>& jobs, FileDoneCallback onFileDone = nullptr);
+    
+private:
+    const EnhancedVSTHost& templateHost;
+    EVH::BatchSettings settings;
 };
\ No newline at end of file
@@ -0,0 +1,343 @@
+// AggregateEngine.cpp - Multiple devices as one logical engine
+#include "EnhancedVSTHost.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace {
+    // Frames pulled from the FIFO per resampler call on the device side
+    constexpr int CHUNK_FRAMES = 64;
+
+    // Device blocks to wait after a gap before re-centring the FIFO: a
+    // device that woke late catches up with back-to-back callbacks first
+    constexpr int GAP_SETTLE_BLOCKS = 4;
+
+    int64_t NowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+// Aggregate Engine Implementation
+AggregateEngine::AggregateEngine(Routing routing)
+    : routing(routing) {
+}
+
+AggregateEngine::~AggregateEngine() {
+    shutdown();
+}
+
+void AggregateEngine::addDevice(std::unique_ptr<AudioEngine> engine) {
+    if (engine) {
+        pendingDevices.push_back(std::move(engine));
+    }
+}
+
+bool AggregateEngine::initialize(double sampleRate, int bufferSize) {
+    this->sampleRate = sampleRate;
+    this->bufferSize = bufferSize;
+
+    // Re-initialisation keeps the same set of devices
+    if (master) {
+        pendingDevices.insert(pendingDevices.begin(), std::move(master));
+        for (size_t i = 0; i < secondaries.size(); ++i) {
+            pendingDevices.insert(pendingDevices.begin() + 1 + i, std::move(secondaries[i]->engine));
+        }
+        secondaries.clear();
+    }
+
+    if (pendingDevices.empty()) {
+        return false;
+    }
+
+    // Master: its clock drives the callback; live input comes from it only
+    master = std::move(pendingDevices.front());
+    master->setCaptureEnabled(captureEnabled);
+    master->setCaptureSource(captureSource);
+    master->setThreadPolicy(threadPolicy);
+    if (!master->initialize(sampleRate, bufferSize)) {
+        return false;
+    }
+    this->sampleRate = master->getSampleRate();
+    this->bufferSize = master->getBufferSize();
+
+    for (size_t i = 1; i < pendingDevices.size(); ++i) {
+        auto device = std::make_unique<Secondary>();
+        device->engine = std::move(pendingDevices[i]);
+        device->engine->setThreadPolicy(threadPolicy);
+        if (!device->engine->initialize(sampleRate, bufferSize)) {
+            return false;
+        }
+
+        const int deviceBlock = device->engine->getBufferSize();
+
+        // Nominal ratio covers devices that opened at another rate; the
+        // drift controller trims it around that
+        device->converter = std::make_unique<EVH::SampleRateConverter>(
+            2, this->sampleRate, device->engine->getSampleRate(), EVH::ResamplerQuality::Normal, CHUNK_FRAMES);
+
+        // Hold one master block plus one device block in flight, plus what
+        // the converter holds back and a chunk of margin: the fill counts
+        // the master block still in flight, which is not readable yet
+        double targetFill = this->bufferSize + deviceBlock + device->converter->getNumTaps() + CHUNK_FRAMES;
+        device->ring.allocate(2, static_cast<int>(targetFill) * 4 + 4096);
+        device->ring.write(nullptr, static_cast<int>(targetFill));
+        device->drift = EVH::DriftController(targetFill);
+        device->drift.reset();
+
+        // Room to pad back up to the target after a gap
+        int fifoCapacity = static_cast<int>(targetFill) + deviceBlock +
+                           device->converter->getMaxOutputFrames(CHUNK_FRAMES);
+        device->chunk.assign(2, std::vector<float>(CHUNK_FRAMES, 0.0f));
+        device->fifo.assign(2, std::vector<float>(fifoCapacity, 0.0f));
+        device->chunkPtrs = { device->chunk[0].data(), device->chunk[1].data() };
+        device->fifoPtrs.resize(2);
+        device->fifoFrames = 0;
+
+        device->owner = this;
+        device->engine->setAudioCallback(EVH::RenderCallback::bind<&Secondary::render>(device.get()));
+
+        secondaries.push_back(std::move(device));
+    }
+    pendingDevices.clear();
+
+    // Logical output buffers the host renders into
+    logicalOutputs.assign(getNumOutputChannels(), std::vector<float>(this->bufferSize, 0.0f));
+    logicalPtrs.resize(logicalOutputs.size());
+    logicalInputPtrs.assign(logicalOutputs.size(), nullptr);
+    for (size_t ch = 0; ch < logicalOutputs.size(); ++ch) {
+        logicalPtrs[ch] = logicalOutputs[ch].data();
+    }
+
+    master->setAudioCallback(EVH::RenderCallback::bind<&AggregateEngine::processMaster>(this));
+
+    return true;
+}
+
+void AggregateEngine::shutdown() {
+    stop();
+
+    if (master) {
+        master->shutdown();
+    }
+    for (auto& device : secondaries) {
+        device->engine->shutdown();
+    }
+}
+
+bool AggregateEngine::start() {
+    if (!master) {
+        return false;
+    }
+
+    // Secondaries first: their FIFOs are pre-filled, so they play silence
+    // until the master starts feeding them
+    for (auto& device : secondaries) {
+        if (!device->engine->start()) {
+            stop();
+            return false;
+        }
+    }
+
+    return master->start();
+}
+
+void AggregateEngine::stop() {
+    if (master) {
+        master->stop();
+    }
+    for (auto& device : secondaries) {
+        device->engine->stop();
+    }
+}
+
+std::vector<std::wstring> AggregateEngine::getDeviceList() const {
+    std::vector<std::wstring> devices;
+
+    auto append = [&devices](const AudioEngine& engine) {
+        auto names = engine.getDeviceList();
+        devices.push_back(names.empty() ? L"Unknown" : names.front());
+    };
+
+    if (master) {
+        append(*master);
+    }
+    for (const auto& device : secondaries) {
+        append(*device->engine);
+    }
+    for (const auto& engine : pendingDevices) {
+        append(*engine);
+    }
+
+    return devices;
+}
+
+bool AggregateEngine::selectDevice(const std::wstring& deviceName) {
+    // Membership is fixed through addDevice()
+    return false;
+}
+
+int AggregateEngine::getNumOutputChannels() const {
+    if (routing == Routing::Mirror) {
+        return 2;
+    }
+
+    size_t numDevices = master ? 1 + secondaries.size() : pendingDevices.size();
+    return static_cast<int>(std::max<size_t>(1, numDevices)) * 2;
+}
+
+bool AggregateEngine::isCaptureActive() const {
+    return master && master->isCaptureActive();
+}
+
+int AggregateEngine::getInputLatencySamples() const {
+    return master ? master->getInputLatencySamples() : 0;
+}
+
+uint64_t AggregateEngine::getXrunCount() const {
+    uint64_t total = master ? master->getXrunCount() : 0;
+    for (const auto& device : secondaries) {
+        total += device->engine->getXrunCount();
+    }
+    return total;
+}
+
+EVH::ThreadPolicyResult AggregateEngine::getThreadPolicyResult() const {
+    return master ? master->getThreadPolicyResult() : EVH::ThreadPolicyResult{};
+}
+
+std::vector<AggregateEngine::DeviceStatus> AggregateEngine::getDeviceStatus() const {
+    std::vector<DeviceStatus> status;
+
+    if (master) {
+        status.push_back({0, 0.0, 1.0, 0.0, 0, 0, 0});
+    }
+
+    int index = 1;
+    for (const auto& device : secondaries) {
+        status.push_back({
+            index++,
+            device->driftPpm.load(),
+            device->ratio.load(),
+            device->fillFrames.load(),
+            device->underruns.load(),
+            device->overruns.load(),
+            device->gaps.load()
+        });
+    }
+
+    return status;
+}
+
+void AggregateEngine::processMaster(const float** inputs, float** outputs, int numSamples,
+                                    const EVH::ProcessContext& context) {
+    numSamples = std::min(numSamples, static_cast<int>(logicalOutputs[0].size()));
+
+    for (auto& channel : logicalOutputs) {
+        std::fill_n(channel.data(), numSamples, 0.0f);
+    }
+
+    // Input keeps the logical width so per-channel consumers stay in bounds
+    if (inputs) {
+        logicalInputPtrs[0] = inputs[0];
+        logicalInputPtrs[1] = inputs[1];
+    }
+
+    if (audioCallback) {
+        // Timing follows the master clock
+        audioCallback(inputs ? logicalInputPtrs.data() : nullptr, logicalPtrs.data(), numSamples, context);
+    }
+
+    // Master plays logical channels 0/1
+    for (int ch = 0; ch < 2; ++ch) {
+        std::copy_n(logicalPtrs[ch], numSamples, outputs[ch]);
+    }
+
+    // Hand the rest to the other devices' FIFOs
+    int64_t now = NowNs();
+    for (size_t i = 0; i < secondaries.size(); ++i) {
+        Secondary& device = *secondaries[i];
+        size_t first = (routing == Routing::Spread) ? 2 * (i + 1) : 0;
+        const float* source[2] = { logicalPtrs[first], logicalPtrs[first + 1] };
+
+        if (device.ring.write(source, numSamples) < numSamples) {
+            device.overruns.fetch_add(1, std::memory_order_relaxed);
+        }
+        device.lastWriteNs.store(now, std::memory_order_release);
+    }
+}
+
+void AggregateEngine::processSecondary(Secondary& device, float** outputs, int numSamples) {
+    // Fill level as if the master wrote continuously rather than in blocks;
+    // removes the block-rate sawtooth that would otherwise alias into the loop
+    const int64_t lastWrite = device.lastWriteNs.load(std::memory_order_acquire);
+    double elapsed = (NowNs() - lastWrite) * 1e-9;
+    double inFlight = std::clamp(elapsed * sampleRate, 0.0, static_cast<double>(bufferSize));
+    double fill = device.ring.getNumReady() + inFlight + device.fifoFrames;
+
+    // The start-up phase between the devices and a gap on either of them
+    // step the fill. That is not drift: hold the loop, then put the fill back
+    // where the loop last saw it (the target, at start-up) instead of
+    // letting the integrator chase the step
+    const uint64_t xruns = master->getXrunCount() + device.engine->getXrunCount();
+    if (lastWrite != 0 && (!device.synced || xruns != device.seenXruns)) {
+        if (device.synced) {
+            device.gaps.fetch_add(1, std::memory_order_relaxed);
+        }
+        device.synced = true;
+        device.seenXruns = xruns;
+        device.settleBlocks = GAP_SETTLE_BLOCKS;
+    }
+
+    if (device.settleBlocks > 0 && --device.settleBlocks == 0) {
+        int excess = static_cast<int>(std::lround(fill - device.drift.getSmoothedFill()));
+        if (excess > 0) {
+            fill -= device.ring.discard(excess);
+        } else if (excess < 0) {
+            // The device plays the missing frames as silence after what is queued
+            int pad = std::min(-excess, static_cast<int>(device.fifo[0].size()) - device.fifoFrames);
+            for (auto& channel : device.fifo) {
+                std::fill_n(channel.data() + device.fifoFrames, pad, 0.0f);
+            }
+            device.fifoFrames += pad;
+            fill += pad;
+        }
+    }
+
+    double ratio = device.drift.getRatio();
+    if (device.synced && device.settleBlocks == 0) {
+        ratio = device.drift.update(fill, numSamples, device.engine->getSampleRate());
+        device.converter->setRatioAdjust(ratio);
+    }
+
+    // Resample from the FIFO until the device block is covered
+    while (device.fifoFrames < numSamples) {
+        int got = device.ring.read(device.chunkPtrs.data(), CHUNK_FRAMES);
+        if (got == 0) {
+            break;
+        }
+
+        device.fifoPtrs[0] = device.fifo[0].data() + device.fifoFrames;
+        device.fifoPtrs[1] = device.fifo[1].data() + device.fifoFrames;
+        int capacity = static_cast<int>(device.fifo[0].size()) - device.fifoFrames;
+        device.fifoFrames += device.converter->process(device.chunkPtrs.data(), got,
+                                                       device.fifoPtrs.data(), capacity);
+    }
+
+    int available = std::min(device.fifoFrames, numSamples);
+    if (available < numSamples) {
+        device.underruns.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    for (int ch = 0; ch < 2; ++ch) {
+        std::copy_n(device.fifo[ch].data(), available, outputs[ch]);
+        std::fill(outputs[ch] + available, outputs[ch] + numSamples, 0.0f);
+        std::copy(device.fifo[ch].begin() + available, device.fifo[ch].begin() + device.fifoFrames,
+                  device.fifo[ch].begin());
+    }
+    device.fifoFrames -= available;
+
+    device.ratio.store(ratio, std::memory_order_relaxed);
+    device.driftPpm.store(device.drift.getDriftPpm(), std::memory_order_relaxed);
+    device.fillFrames.store(fill, std::memory_order_relaxed);
+}
@@ -1,385 +1,437 @@
-// AudioEngines.cpp - WASAPI implementation
-#include "EnhancedVSTHost.h"
-#include <mmdeviceapi.h>
-#include <audioclient.h>
-#include <functiondiscoverykeys_devpkey.h>
-#include <avrt.h>
-#include <algorithm>
-
-#pragma comment(lib, "avrt.lib")
-
-// WASAPI Engine Implementation
-WASAPIEngine::WASAPIEngine() {
-    CoInitializeEx(nullptr, COINIT_MULTITHREADED);
-}
-
-WASAPIEngine::~WASAPIEngine() {
-    shutdown();
-    CoUninitialize();
-}
-
-bool WASAPIEngine::initialize(double sampleRate, int bufferSize) {
-    this->sampleRate = sampleRate;
-    this->bufferSize = bufferSize;
-    
-    HRESULT hr;
-    
-    // Create device enumerator
-    hr = CoCreateInstance(__uuidof(MMDeviceEnumerator), nullptr,
-                         CLSCTX_ALL, __uuidof(IMMDeviceEnumerator),
-                         (void**)&deviceEnumerator);
-    if (FAILED(hr)) {
-        return false;
-    }
-    
-    // Get default audio endpoint
-    hr = deviceEnumerator->GetDefaultAudioEndpoint(eRender, eConsole, &audioDevice);
-    if (FAILED(hr)) {
-        return false;
-    }
-    
-    // Activate audio client
-    hr = audioDevice->Activate(__uuidof(IAudioClient), CLSCTX_ALL,
-                              nullptr, (void**)&audioClient);
-    if (FAILED(hr)) {
-        return false;
-    }
-    
-    // Get mix format
-    WAVEFORMATEX* pWaveformat = nullptr;
-    hr = audioClient->GetMixFormat(&pWaveformat);
-    if (FAILED(hr)) {
-        return false;
-    }
-    
-    // Set up our desired format
-    WAVEFORMATEXTENSIBLE waveFormat = {};
-    waveFormat.Format.wFormatTag = WAVE_FORMAT_EXTENSIBLE;
-    waveFormat.Format.nChannels = 2;
-    waveFormat.Format.nSamplesPerSec = static_cast<DWORD>(sampleRate);
-    waveFormat.Format.wBitsPerSample = 32;
-    waveFormat.Format.nBlockAlign = waveFormat.Format.nChannels * waveFormat.Format.wBitsPerSample / 8;
-    waveFormat.Format.nAvgBytesPerSec = waveFormat.Format.nSamplesPerSec * waveFormat.Format.nBlockAlign;
-    waveFormat.Format.cbSize = sizeof(WAVEFORMATEXTENSIBLE) - sizeof(WAVEFORMATEX);
-    waveFormat.Samples.wValidBitsPerSample = 32;
-    waveFormat.dwChannelMask = SPEAKER_FRONT_LEFT | SPEAKER_FRONT_RIGHT;
-    waveFormat.SubFormat = KSDATAFORMAT_SUBTYPE_IEEE_FLOAT;
-    
-    // Calculate buffer duration (in 100-nanosecond units)
-    REFERENCE_TIME requestedDuration = static_cast<REFERENCE_TIME>(
-        (double)bufferSize / sampleRate * 10000000.0
-    );
-    
-    // Initialize audio client
-    hr = audioClient->Initialize(
-        AUDCLNT_SHAREMODE_SHARED,
-        AUDCLNT_STREAMFLAGS_EVENTCALLBACK | AUDCLNT_STREAMFLAGS_NOPERSIST,
-        requestedDuration,
-        0,
-        (WAVEFORMATEX*)&waveFormat,
-        nullptr
-    );
-    
-    if (FAILED(hr)) {
-        // Try with the mix format if our format failed
-        hr = audioClient->Initialize(
-            AUDCLNT_SHAREMODE_SHARED,
-            AUDCLNT_STREAMFLAGS_EVENTCALLBACK | AUDCLNT_STREAMFLAGS_NOPERSIST,
-            requestedDuration,
-            0,
-            pWaveformat,
-            nullptr
-        );
-    }
-    
-    CoTaskMemFree(pWaveformat);
-    
-    if (FAILED(hr)) {
-        return false;
-    }
-    
-    // Create event for buffer notification
-    bufferEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
-    if (!bufferEvent) {
-        return false;
-    }
-    
-    hr = audioClient->SetEventHandle(bufferEvent);
-    if (FAILED(hr)) {
-        CloseHandle(bufferEvent);
-        bufferEvent = nullptr;
-        return false;
-    }
-    
-    // Get render client
-    hr = audioClient->GetService(__uuidof(IAudioRenderClient), (void**)&renderClient);
-    if (FAILED(hr)) {
-        CloseHandle(bufferEvent);
-        bufferEvent = nullptr;
-        return false;
-    }
-    
-    // Get actual buffer size
-    UINT32 bufferFrameCount;
-    hr = audioClient->GetBufferSize(&bufferFrameCount);
-    if (FAILED(hr)) {
-        CloseHandle(bufferEvent);
-        bufferEvent = nullptr;
-        return false;
-    }
-    
-    this->bufferSize = bufferFrameCount;
-    
-    return true;
-}
-
-void WASAPIEngine::shutdown() {
-    stop();
-    
-    if (bufferEvent) {
-        CloseHandle(bufferEvent);
-        bufferEvent = nullptr;
-    }
-    
-    renderClient.Reset();
-    audioClient.Reset();
-    audioDevice.Reset();
-    deviceEnumerator.Reset();
-}
-
-bool WASAPIEngine::start() {
-    if (!audioClient) {
-        return false;
-    }
-    
-    // Start audio thread
-    shouldStop = false;
-    audioThread = std::thread(&WASAPIEngine::audioThreadFunc, this);
-    
-    // Start audio client
-    HRESULT hr = audioClient->Start();
-    if (FAILED(hr)) {
-        shouldStop = true;
-        if (audioThread.joinable()) {
-            audioThread.join();
-        }
-        return false;
-    }
-    
-    return true;
-}
-
-void WASAPIEngine::stop() {
-    if (audioClient) {
-        audioClient->Stop();
-    }
-    
-    shouldStop = true;
-    if (audioThread.joinable()) {
-        audioThread.join();
-    }
-}
-
-std::vector<std::wstring> WASAPIEngine::getDeviceList() const {
-    std::vector<std::wstring> devices;
-    
-    if (!deviceEnumerator) {
-        return devices;
-    }
-    
-    IMMDeviceCollection* pCollection = nullptr;
-    HRESULT hr = deviceEnumerator->EnumAudioEndpoints(
-        eRender, DEVICE_STATE_ACTIVE, &pCollection
-    );
-    
-    if (SUCCEEDED(hr)) {
-        UINT count;
-        hr = pCollection->GetCount(&count);
-        
-        if (SUCCEEDED(hr)) {
-            for (UINT i = 0; i < count; i++) {
-                IMMDevice* pDevice = nullptr;
-                hr = pCollection->Item(i, &pDevice);
-                
-                if (SUCCEEDED(hr)) {
-                    IPropertyStore* pProps = nullptr;
-                    hr = pDevice->OpenPropertyStore(STGM_READ, &pProps);
-                    
-                    if (SUCCEEDED(hr)) {
-                        PROPVARIANT varName;
-                        PropVariantInit(&varName);
-                        
-                        hr = pProps->GetValue(PKEY_Device_FriendlyName, &varName);
-                        if (SUCCEEDED(hr) && varName.vt == VT_LPWSTR) {
-                            devices.push_back(varName.pwszVal);
-                            PropVariantClear(&varName);
-                        }
-                        
-                        pProps->Release();
-                    }
-                    
-                    pDevice->Release();
-                }
-            }
-        }
-        
-        pCollection->Release();
-    }
-    
-    return devices;
-}
-
-bool WASAPIEngine::selectDevice(const std::wstring& deviceName) {
-    if (!deviceEnumerator) {
-        return false;
-    }
-    
-    // Stop current audio if running
-    bool wasRunning = (audioClient != nullptr);
-    if (wasRunning) {
-        stop();
-    }
-    
-    // Find and select the device
-    IMMDeviceCollection* pCollection = nullptr;
-    HRESULT hr = deviceEnumerator->EnumAudioEndpoints(
-        eRender, DEVICE_STATE_ACTIVE, &pCollection
-    );
-    
-    if (SUCCEEDED(hr)) {
-        UINT count;
-        hr = pCollection->GetCount(&count);
-        
-        if (SUCCEEDED(hr)) {
-            for (UINT i = 0; i < count; i++) {
-                IMMDevice* pDevice = nullptr;
-                hr = pCollection->Item(i, &pDevice);
-                
-                if (SUCCEEDED(hr)) {
-                    IPropertyStore* pProps = nullptr;
-                    hr = pDevice->OpenPropertyStore(STGM_READ, &pProps);
-                    
-                    if (SUCCEEDED(hr)) {
-                        PROPVARIANT varName;
-                        PropVariantInit(&varName);
-                        
-                        hr = pProps->GetValue(PKEY_Device_FriendlyName, &varName);
-                        if (SUCCEEDED(hr) && varName.vt == VT_LPWSTR) {
-                            if (deviceName == varName.pwszVal) {
-                                // Found the device
-                                audioDevice.Reset();
-                                audioDevice = pDevice;
-                                pDevice = nullptr;  // Don't release since we're keeping it
-                                
-                                PropVariantClear(&varName);
-                                pProps->Release();
-                                
-                                // Re-initialize with new device
-                                if (wasRunning) {
-                                    initialize(sampleRate, bufferSize);
-                                    start();
-                                }
-                                
-                                pCollection->Release();
-                                return true;
-                            }
-                            PropVariantClear(&varName);
-                        }
-                        
-                        pProps->Release();
-                    }
-                    
-                    if (pDevice) {
-                        pDevice->Release();
-                    }
-                }
-            }
-        }
-        
-        pCollection->Release();
-    }
-    
-    return false;
-}
-
-void WASAPIEngine::audioThreadFunc() {
-    // Set thread priority
-    DWORD taskIndex = 0;
-    HANDLE hTask = AvSetMmThreadCharacteristics(L"Pro Audio", &taskIndex);
-    
-    if (hTask) {
-        AvSetMmThreadPriority(hTask, AVRT_PRIORITY_HIGH);
-    }
-    
-    // Prepare buffers
-    const int numChannels = 2;
-    std::vector<float> interleavedBuffer(bufferSize * numChannels, 0.0f);
-    std::vector<std::vector<float>> inputBuffers(numChannels, std::vector<float>(bufferSize, 0.0f));
-    std::vector<std::vector<float>> outputBuffers(numChannels, std::vector<float>(bufferSize, 0.0f));
-    
-    std::vector<const float*> inputPtrs(numChannels);
-    std::vector<float*> outputPtrs(numChannels);
-    
-    for (int ch = 0; ch < numChannels; ++ch) {
-        inputPtrs[ch] = inputBuffers[ch].data();
-        outputPtrs[ch] = outputBuffers[ch].data();
-    }
-    
-    while (!shouldStop) {
-        // Wait for buffer event
-        DWORD waitResult = WaitForSingleObject(bufferEvent, 2000);
-        if (waitResult != WAIT_OBJECT_0) {
-            if (waitResult == WAIT_TIMEOUT) {
-                continue;
-            }
-            break;  // Error occurred
-        }
-        
-        // Get buffer
-        UINT32 numFramesAvailable;
-        HRESULT hr = audioClient->GetCurrentPadding(&numFramesAvailable);
-        if (FAILED(hr)) {
-            continue;
-        }
-        
-        UINT32 numFramesToWrite = bufferSize - numFramesAvailable;
-        if (numFramesToWrite == 0) {
-            continue;
-        }
-        
-        BYTE* pData;
-        hr = renderClient->GetBuffer(numFramesToWrite, &pData);
-        if (FAILED(hr)) {
-            continue;
-        }
-        
-        // Call audio callback
-        if (audioCallback) {
-            // Clear output buffers
-            for (auto& buffer : outputBuffers) {
-                std::fill(buffer.begin(), buffer.begin() + numFramesToWrite, 0.0f);
-            }
-            
-            // Process audio
-            audioCallback(inputPtrs.data(), outputPtrs.data(), numFramesToWrite);
-            
-            // Interleave output
-            float* pOut = reinterpret_cast<float*>(pData);
-            for (UINT32 frame = 0; frame < numFramesToWrite; ++frame) {
-                for (int ch = 0; ch < numChannels; ++ch) {
-                    *pOut++ = outputBuffers[ch][frame];
-                }
-            }
-        } else {
-            // Fill with silence
-            memset(pData, 0, numFramesToWrite * numChannels * sizeof(float));
-        }
-        
-        // Release buffer
-        hr = renderClient->ReleaseBuffer(numFramesToWrite, 0);
-    }
-    
-    if (hTask) {
-        AvRevertMmThreadCharacteristics(hTask);
-    }
+// AudioEngines.cpp - Engine base and null engine implementations
+#include "EnhancedVSTHost.h"
+#include <algorithm>
+#include <cmath>
+
+// AudioEngine default reconfiguration: short device restart
+bool AudioEngine::reconfigure(double newSampleRate, int newBufferSize, std::function<void()> onSwitch) {
+    stop();
+    shutdown();
+    
+    bool success = initialize(newSampleRate, newBufferSize);
+    
+    // The switch happens while the device is stopped
+    if (onSwitch) {
+        onSwitch();
+    }
+    
+    return success && start();
+}
+
+// Thread policy shared by the engines
+EVH::ThreadPolicyResult AudioEngine::getThreadPolicyResult() const {
+    std::lock_guard<std::mutex> lock(threadPolicyMutex);
+    return threadPolicyResult;
+}
+
+EVH::ThreadPolicyResult AudioEngine::applyEngineThreadPolicy(EVH::ThreadPolicy policy) {
+    if (policy.scheduling == EVH::ThreadPolicy::Scheduling::Deadline && policy.runtimeNs == 0) {
+        policy.periodNs = static_cast<uint64_t>(bufferSize / sampleRate * 1e9);
+        policy.runtimeNs = policy.periodNs / 2;
+    }
+    return EVH::applyThreadPolicy(policy);
+}
+
+void AudioEngine::setThreadPolicyResult(const EVH::ThreadPolicyResult& result) {
+    std::lock_guard<std::mutex> lock(threadPolicyMutex);
+    threadPolicyResult = result;
+}
+
+// Block timing shared by the engines
+void AudioEngine::resetProcessContext() {
+    processContext = EVH::ProcessContext{};
+    processContext.sampleRate = sampleRate;
+    clockDll.reset(sampleRate);
+    nextSamplePosition = 0;
+}
+
+const EVH::ProcessContext& AudioEngine::beginBlock(int numFrames, int outputLatencyFrames) {
+    if (processContext.sampleRate != sampleRate) {
+        // Rate changed in place: positions continue, the clock estimate restarts
+        processContext.sampleRate = sampleRate;
+        clockDll.reset(sampleRate);
+    }
+    
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    clockDll.update(std::chrono::duration<double>(now).count(), nextSamplePosition);
+    
+    processContext.samplePosition = nextSamplePosition;
+    processContext.hostTimeNs = static_cast<int64_t>(clockDll.getTime() * 1e9);
+    processContext.outputLatencySamples = outputLatencyFrames;
+    processContext.clockRatio = clockDll.getRatio();
+    
+    nextSamplePosition += numFrames;
+    return processContext;
+}
+
+// Capture ring shared by the engines
+void AudioEngine::prepareCaptureRing(int numChannels) {
+    // Generous headroom so in-place buffer size changes never outgrow it
+    captureRing.allocate(numChannels, std::max(65536, bufferSize * 8));
+    captureUnderruns = 0;
+    
+    // Start one block behind the render clock
+    captureRing.write(nullptr, getCaptureTargetFrames());
+}
+
+// One block of input ahead of the render position, or one capture packet
+// when those are larger: a packet that lands just after a read must not
+// leave the next one short
+int AudioEngine::getCaptureTargetFrames() const {
+    int target = std::max(bufferSize, capturePacketFrames);
+    return captureRing.getCapacity() > 0 ? std::min(target, captureRing.getCapacity() / 2) : target;
+}
+
+int AudioEngine::readCapturedInput(float* const* dest, int numFrames) {
+    const int numChannels = captureRing.getNumChannels();
+    
+    // Keep the fill level at the target ahead of the render position; drop
+    // the oldest input if the capture clock has run ahead
+    int ready = captureRing.getNumReady();
+    int excess = ready - (numFrames + getCaptureTargetFrames());
+    if (excess > 0) {
+        captureRing.discard(excess);
+    }
+    
+    int got = captureRing.read(dest, numFrames);
+    if (got < numFrames) {
+        for (int ch = 0; ch < numChannels; ++ch) {
+            std::fill(dest[ch] + got, dest[ch] + numFrames, 0.0f);
+        }
+        captureUnderruns.fetch_add(1, std::memory_order_relaxed);
+    }
+    
+    return got;
+}
+
+int AudioEngine::getInputLatencySamples() const {
+    if (!captureActive) {
+        return 0;
+    }
+    return captureRing.getNumReady() + captureDeviceLatency.load();
+}
+
+// Generated Capture Source Implementation
+EVH::GeneratedCaptureSource::GeneratedCaptureSource(Signal signal, double frequency, float level)
+    : signal(signal), frequency(frequency), level(level) {
+}
+
+void EVH::GeneratedCaptureSource::prepare(double sampleRate) {
+    phase = 0.0;
+    phaseIncrement = 2.0 * 3.14159265358979323846 * frequency / sampleRate;
+    impulsePeriod = std::max<int64_t>(1, static_cast<int64_t>(sampleRate));  // One click per second
+    framesUntilImpulse = 0;
+}
+
+void EVH::GeneratedCaptureSource::read(float** dest, int numChannels, int numFrames) {
+    for (int i = 0; i < numFrames; ++i) {
+        float value = 0.0f;
+        
+        switch (signal) {
+            case Signal::Sine:
+                value = level * static_cast<float>(std::sin(phase));
+                phase += phaseIncrement;
+                if (phase > 2.0 * 3.14159265358979323846) {
+                    phase -= 2.0 * 3.14159265358979323846;
+                }
+                break;
+            case Signal::Noise:
+                // xorshift32 white noise
+                noiseState ^= noiseState << 13;
+                noiseState ^= noiseState >> 17;
+                noiseState ^= noiseState << 5;
+                value = level * (static_cast<float>(noiseState) / 2147483648.0f - 1.0f);
+                break;
+            case Signal::Impulse:
+                if (framesUntilImpulse-- <= 0) {
+                    value = level;
+                    framesUntilImpulse = impulsePeriod - 1;
+                }
+                break;
+            case Signal::Silence:
+                break;
+        }
+        
+        for (int ch = 0; ch < numChannels; ++ch) {
+            dest[ch][i] = value;
+        }
+    }
+}
+
+// File Capture Source Implementation
+EVH::FileCaptureSource::FileCaptureSource(const std::wstring& path, int fileChannels)
+    : fileChannels(std::max(1, fileChannels)) {
+    file = std::fopen(std::filesystem::path(path).string().c_str(), "rb");
+}
+
+EVH::FileCaptureSource::~FileCaptureSource() {
+    if (file) {
+        std::fclose(file);
+    }
+}
+
+void EVH::FileCaptureSource::read(float** dest, int numChannels, int numFrames) {
+    if (interleaved.size() < static_cast<size_t>(numFrames) * fileChannels) {
+        interleaved.resize(static_cast<size_t>(numFrames) * fileChannels);
+    }
+    
+    int framesRead = 0;
+    bool rewound = false;
+    while (file && framesRead < numFrames) {
+        size_t got = std::fread(interleaved.data() + static_cast<size_t>(framesRead) * fileChannels,
+                                sizeof(float) * fileChannels, numFrames - framesRead, file);
+        framesRead += static_cast<int>(got);
+        
+        if (framesRead < numFrames) {
+            // Loop; give up on empty files
+            if (rewound && got == 0) {
+                break;
+            }
+            std::fseek(file, 0, SEEK_SET);
+            rewound = true;
+        }
+    }
+    
+    for (int ch = 0; ch < numChannels; ++ch) {
+        int srcCh = std::min(ch, fileChannels - 1);
+        for (int i = 0; i < numFrames; ++i) {
+            dest[ch][i] = (i < framesRead) ? interleaved[static_cast<size_t>(i) * fileChannels + srcCh] : 0.0f;
+        }
+    }
+}
+
+// Null Engine Implementation
+void NullEngine::BlockBuffers::allocate(int channels, int frames) {
+    inputs.assign(channels, std::vector<float>(frames, 0.0f));
+    outputs.assign(channels, std::vector<float>(frames, 0.0f));
+    inputPtrs.resize(channels);
+    inputWritePtrs.resize(channels);
+    outputPtrs.resize(channels);
+    
+    for (int ch = 0; ch < channels; ++ch) {
+        inputPtrs[ch] = inputs[ch].data();
+        inputWritePtrs[ch] = inputs[ch].data();
+        outputPtrs[ch] = outputs[ch].data();
+    }
+}
+
+NullEngine::NullEngine() {
+    capturePacketFrames = capturePeriodFrames;
+}
+
+NullEngine::~NullEngine() {
+    shutdown();
+}
+
+bool NullEngine::initialize(double sampleRate, int bufferSize) {
+    if (sampleRate <= 0.0 || bufferSize <= 0) {
+        return false;
+    }
+    
+    this->sampleRate = sampleRate;
+    this->bufferSize = bufferSize;
+    buffers.allocate(numChannels, bufferSize);
+    
+    // Input comes from the capture source, if one was given
+    captureActive = (captureSource != nullptr);
+    if (captureActive) {
+        captureRate = sampleRate;
+        captureSource->prepare(sampleRate);
+        prepareCaptureRing(numChannels);
+    }
+    
+    return true;
+}
+
+void NullEngine::shutdown() {
+    stop();
+}
+
+bool NullEngine::start() {
+    if (running.load()) {
+        return true;
+    }
+    
+    shouldStop = false;
+    running = true;
+    resetProcessContext();
+    audioThread = std::thread(&NullEngine::audioThreadFunc, this);
+    
+    if (captureActive) {
+        captureThread = std::thread(&NullEngine::captureThreadFunc, this);
+    }
+    
+    return true;
+}
+
+void NullEngine::stop() {
+    shouldStop = true;
+    if (audioThread.joinable()) {
+        audioThread.join();
+    }
+    if (captureThread.joinable()) {
+        captureThread.join();
+    }
+    
+    {
+        // Release a reconfigure() that is waiting for a block boundary
+        std::lock_guard<std::mutex> lock(reconfigMutex);
+        running = false;
+    }
+    reconfigCv.notify_all();
+}
+
+std::vector<std::wstring> NullEngine::getDeviceList() const {
+    return { L"Null Device" };
+}
+
+bool NullEngine::selectDevice(const std::wstring& deviceName) {
+    return deviceName == L"Null Device";
+}
+
+void NullEngine::injectLoadSpike(double milliseconds, int numBlocks) {
+    spikeMs = milliseconds;
+    spikeBlocks = numBlocks;
+}
+
+bool NullEngine::reconfigure(double newSampleRate, int newBufferSize, std::function<void()> onSwitch) {
+    if (newSampleRate <= 0.0 || newBufferSize <= 0) {
+        return false;
+    }
+    
+    std::unique_lock<std::mutex> lock(reconfigMutex);
+    
+    if (!running.load()) {
+        sampleRate = newSampleRate;
+        bufferSize = newBufferSize;
+        buffers.allocate(numChannels, newBufferSize);
+        if (onSwitch) {
+            onSwitch();
+        }
+        return true;
+    }
+    
+    // Allocate here so the audio thread only swaps at the boundary
+    pendingSampleRate = newSampleRate;
+    pendingBufferSize = newBufferSize;
+    pendingBuffers.allocate(numChannels, newBufferSize);
+    pendingSwitch = std::move(onSwitch);
+    reconfigDone = false;
+    reconfigPending.store(true, std::memory_order_release);
+    
+    reconfigCv.wait(lock, [this] { return reconfigDone || !running.load(); });
+    
+    bool switched = reconfigDone;
+    reconfigPending.store(false, std::memory_order_relaxed);
+    pendingSwitch = nullptr;
+    pendingBuffers = BlockBuffers();  // Free the old configuration's buffers here
+    return switched;
+}
+
+void NullEngine::applyPendingReconfigure() {
+    {
+        std::lock_guard<std::mutex> lock(reconfigMutex);
+        
+        sampleRate = pendingSampleRate;
+        bufferSize = pendingBufferSize;
+        captureRate = pendingSampleRate;
+        std::swap(buffers, pendingBuffers);
+        
+        if (pendingSwitch) {
+            pendingSwitch();
+        }
+        
+        reconfigPending.store(false, std::memory_order_relaxed);
+        reconfigDone = true;
+    }
+    reconfigCv.notify_all();
+}
+
+void NullEngine::audioThreadFunc() {
+    using Clock = std::chrono::steady_clock;
+    
+    setThreadPolicyResult(applyEngineThreadPolicy(threadPolicy));
+    
+    auto nextWakeup = Clock::now();
+    
+    while (!shouldStop) {
+        // Block boundary: apply a pending rate/size change first
+        if (reconfigPending.load(std::memory_order_acquire)) {
+            applyPendingReconfigure();
+            nextWakeup = Clock::now();
+        }
+        
+        const int numFrames = bufferSize;
+        
+        if (captureActive) {
+            readCapturedInput(buffers.inputWritePtrs.data(), numFrames);
+        }
+        
+        // Played out over the following period
+        const auto& context = beginBlock(numFrames, numFrames);
+        
+        if (audioCallback) {
+            for (auto& buffer : buffers.outputs) {
+                std::fill(buffer.begin(), buffer.end(), 0.0f);
+            }
+            
+            audioCallback(buffers.inputPtrs.data(), buffers.outputPtrs.data(), numFrames, context);
+        }
+        
+        if (spikeBlocks.load(std::memory_order_relaxed) > 0) {
+            auto spikeEnd = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double, std::milli>(spikeMs.load()));
+            while (Clock::now() < spikeEnd) {
+                // Busy, like a plugin that ran long
+            }
+            spikeBlocks.fetch_sub(1, std::memory_order_relaxed);
+        }
+        
+        blocksProcessed.fetch_add(1, std::memory_order_relaxed);
+        
+        // Pace like a device consuming one buffer per period
+        nextWakeup += std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(numFrames / (sampleRate * (1.0 + clockSkewPpm.load() * 1e-6))));
+        
+        // Past the point the device needed the next block: it played a gap
+        // and carries on from now rather than catching up
+        auto now = Clock::now();
+        if (now > nextWakeup) {
+            xrunCount.fetch_add(1, std::memory_order_relaxed);
+            nextWakeup = now;
+        }
+        std::this_thread::sleep_until(nextWakeup);
+    }
+}
+
+void NullEngine::captureThreadFunc() {
+    using Clock = std::chrono::steady_clock;
+    
+    applyEngineThreadPolicy(threadPolicy);
+    
+    // Simulated device capture period
+    constexpr int captureFrames = capturePeriodFrames;
+    std::vector<std::vector<float>> scratch(numChannels, std::vector<float>(captureFrames, 0.0f));
+    std::vector<float*> scratchPtrs(numChannels);
+    for (int ch = 0; ch < numChannels; ++ch) {
+        scratchPtrs[ch] = scratch[ch].data();
+    }
+    
+    double preparedRate = captureRate.load();
+    auto nextWakeup = Clock::now();
+    
+    while (!shouldStop) {
+        double rate = captureRate.load();
+        if (rate != preparedRate) {
+            captureSource->prepare(rate);
+            preparedRate = rate;
+        }
+        
+        captureSource->read(scratchPtrs.data(), numChannels, captureFrames);
+        captureRing.write(scratchPtrs.data(), captureFrames);
+        
+        nextWakeup += std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(captureFrames / (rate * (1.0 + clockSkewPpm.load() * 1e-6))));
+        std::this_thread::sleep_until(nextWakeup);
+    }
 }
\ No newline at end of file
@@ -0,0 +1,616 @@
+// AudioFile.cpp - WAV/RF64/W64 parsing, writing and sample conversion
+#include "EVHAudioFile.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <new>
+
+namespace {
+    constexpr uint16_t WAVE_FORMAT_PCM = 0x0001;
+    constexpr uint16_t WAVE_FORMAT_IEEE_FLOAT = 0x0003;
+    constexpr uint16_t WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+    
+    // Sony Wave64 chunk ids; every W64 chunk starts with a GUID and a
+    // 64-bit size that includes the 24-byte chunk header
+    constexpr uint8_t W64_RIFF[16] = {0x72, 0x69, 0x66, 0x66, 0x2E, 0x91, 0xCF, 0x11,
+                                      0xA5, 0xD6, 0x28, 0xDB, 0x04, 0xC1, 0x00, 0x00};
+    constexpr uint8_t W64_WAVE[16] = {0x77, 0x61, 0x76, 0x65, 0xF3, 0xAC, 0xD3, 0x11,
+                                      0x8C, 0xD1, 0x00, 0xC0, 0x4F, 0x8E, 0xDB, 0x8A};
+    constexpr uint8_t W64_FMT[16] = {0x66, 0x6D, 0x74, 0x20, 0xF3, 0xAC, 0xD3, 0x11,
+                                     0x8C, 0xD1, 0x00, 0xC0, 0x4F, 0x8E, 0xDB, 0x8A};
+    constexpr uint8_t W64_DATA[16] = {0x64, 0x61, 0x74, 0x61, 0xF3, 0xAC, 0xD3, 0x11,
+                                      0x8C, 0xD1, 0x00, 0xC0, 0x4F, 0x8E, 0xDB, 0x8A};
+    
+    // Header layouts written by AudioFileWriter. The WAV header carries a
+    // JUNK chunk the size of ds64, so it can become RF64 in place.
+    constexpr size_t WAV_HEADER_BYTES = 80;
+    constexpr size_t WAV_DS64_OFFSET = 12;
+    constexpr size_t WAV_DATA_HEADER_OFFSET = 72;
+    constexpr size_t W64_HEADER_BYTES = 104;
+    constexpr size_t W64_DATA_HEADER_OFFSET = 80;
+    
+    constexpr size_t WRITE_BLOCK_ALIGNMENT = 4096;
+    
+    uint16_t ReadLe16(const uint8_t* p) {
+        return static_cast<uint16_t>(p[0] | (p[1] << 8));
+    }
+    
+    uint32_t ReadLe32(const uint8_t* p) {
+        return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+               (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+    
+    uint64_t ReadLe64(const uint8_t* p) {
+        return static_cast<uint64_t>(ReadLe32(p)) | (static_cast<uint64_t>(ReadLe32(p + 4)) << 32);
+    }
+    
+    void WriteLe16(uint8_t* p, uint16_t value) {
+        p[0] = static_cast<uint8_t>(value);
+        p[1] = static_cast<uint8_t>(value >> 8);
+    }
+    
+    void WriteLe32(uint8_t* p, uint32_t value) {
+        for (int i = 0; i < 4; ++i) {
+            p[i] = static_cast<uint8_t>(value >> (8 * i));
+        }
+    }
+    
+    void WriteLe64(uint8_t* p, uint64_t value) {
+        for (int i = 0; i < 8; ++i) {
+            p[i] = static_cast<uint8_t>(value >> (8 * i));
+        }
+    }
+    
+    FILE* OpenFile(const std::wstring& path, const char* mode) {
+        return std::fopen(std::filesystem::path(path).string().c_str(), mode);
+    }
+    
+    // The 16-byte WAVEFORMAT body shared by WAV and W64
+    void WriteFormat(uint8_t* p, EVH::SampleFormat format, int numChannels, double sampleRate) {
+        const uint16_t bytes = static_cast<uint16_t>(EVH::getBytesPerSample(format));
+        WriteLe16(p, format == EVH::SampleFormat::Float32 ? WAVE_FORMAT_IEEE_FLOAT : WAVE_FORMAT_PCM);
+        WriteLe16(p + 2, static_cast<uint16_t>(numChannels));
+        WriteLe32(p + 4, static_cast<uint32_t>(sampleRate));
+        WriteLe32(p + 8, static_cast<uint32_t>(sampleRate) * bytes * numChannels);
+        WriteLe16(p + 12, static_cast<uint16_t>(bytes * numChannels));
+        WriteLe16(p + 14, static_cast<uint16_t>(bytes * 8));
+    }
+    
+    // Interleaved file samples -> planar float
+    void Decode(const uint8_t* src, EVH::SampleFormat format, int numChannels, float** dest, int numFrames) {
+        if (format == EVH::SampleFormat::Float32 && numChannels == 1 && std::endian::native == std::endian::little) {
+            std::memcpy(dest[0], src, static_cast<size_t>(numFrames) * sizeof(float));
+            return;
+        }
+        
+        const int bytes = EVH::getBytesPerSample(format);
+        for (int ch = 0; ch < numChannels; ++ch) {
+            const uint8_t* p = src + ch * bytes;
+            float* out = dest[ch];
+            const size_t stride = static_cast<size_t>(bytes) * numChannels;
+            
+            switch (format) {
+                case EVH::SampleFormat::Pcm16:
+                    for (int i = 0; i < numFrames; ++i, p += stride) {
+                        out[i] = static_cast<int16_t>(ReadLe16(p)) * (1.0f / 32768.0f);
+                    }
+                    break;
+                case EVH::SampleFormat::Pcm24:
+                    for (int i = 0; i < numFrames; ++i, p += stride) {
+                        uint32_t bits = (static_cast<uint32_t>(p[0]) << 8) | (static_cast<uint32_t>(p[1]) << 16) |
+                                        (static_cast<uint32_t>(p[2]) << 24);
+                        int32_t value = static_cast<int32_t>(bits) >> 8;
+                        out[i] = value * (1.0f / 8388608.0f);
+                    }
+                    break;
+                case EVH::SampleFormat::Pcm32:
+                    for (int i = 0; i < numFrames; ++i, p += stride) {
+                        out[i] = static_cast<float>(static_cast<int32_t>(ReadLe32(p)) * (1.0 / 2147483648.0));
+                    }
+                    break;
+                case EVH::SampleFormat::Float32:
+                    for (int i = 0; i < numFrames; ++i, p += stride) {
+                        uint32_t bits = ReadLe32(p);
+                        std::memcpy(&out[i], &bits, sizeof(float));
+                    }
+                    break;
+            }
+        }
+    }
+    
+    // Planar float -> interleaved file samples, clipped for integer formats.
+    // Scaled like Decode() so integer files round-trip exactly
+    void Encode(const float* const* src, EVH::SampleFormat format, int numChannels, uint8_t* dest, int numFrames) {
+        const int bytes = EVH::getBytesPerSample(format);
+        for (int ch = 0; ch < numChannels; ++ch) {
+            uint8_t* p = dest + ch * bytes;
+            const float* in = src[ch];
+            const size_t stride = static_cast<size_t>(bytes) * numChannels;
+            
+            switch (format) {
+                case EVH::SampleFormat::Pcm16:
+                    for (int i = 0; i < numFrames; ++i, p += stride) {
+                        float value = std::clamp(in[i] * 32768.0f, -32768.0f, 32767.0f);
+                        WriteLe16(p, static_cast<uint16_t>(static_cast<int16_t>(std::lrint(value))));
+                    }
+                    break;
+                case EVH::SampleFormat::Pcm24:
+                    for (int i = 0; i < numFrames; ++i, p += stride) {
+                        float value = std::clamp(in[i] * 8388608.0f, -8388608.0f, 8388607.0f);
+                        int32_t bits = static_cast<int32_t>(std::lrint(value));
+                        p[0] = static_cast<uint8_t>(bits);
+                        p[1] = static_cast<uint8_t>(bits >> 8);
+                        p[2] = static_cast<uint8_t>(bits >> 16);
+                    }
+                    break;
+                case EVH::SampleFormat::Pcm32:
+                    for (int i = 0; i < numFrames; ++i, p += stride) {
+                        double value = std::clamp(in[i] * 2147483648.0, -2147483648.0, 2147483647.0);
+                        WriteLe32(p, static_cast<uint32_t>(static_cast<int32_t>(std::llrint(value))));
+                    }
+                    break;
+                case EVH::SampleFormat::Float32:
+                    for (int i = 0; i < numFrames; ++i, p += stride) {
+                        uint32_t bits;
+                        std::memcpy(&bits, &in[i], sizeof(float));
+                        WriteLe32(p, bits);
+                    }
+                    break;
+            }
+        }
+    }
+}
+
+namespace EVH {
+
+int getBytesPerSample(SampleFormat format) {
+    switch (format) {
+        case SampleFormat::Pcm16: return 2;
+        case SampleFormat::Pcm24: return 3;
+        case SampleFormat::Pcm32: return 4;
+        case SampleFormat::Float32: return 4;
+    }
+    return 4;
+}
+
+// Reader
+bool AudioFileReader::open(const std::wstring& path) {
+    close();
+    lastError.clear();
+    
+    if (!map.open(path)) {
+        return fail(L"Cannot open " + path + L": " + map.getLastError());
+    }
+    
+    const uint8_t* data = map.getData();
+    bool parsed = false;
+    if (map.getSize() >= 12 && (std::memcmp(data, "RIFF", 4) == 0 || std::memcmp(data, "RF64", 4) == 0 ||
+                                std::memcmp(data, "BW64", 4) == 0)) {
+        parsed = parseRiff();
+    } else if (map.getSize() >= 40 && std::memcmp(data, W64_RIFF, 16) == 0) {
+        parsed = parseW64();
+    } else {
+        return fail(L"Not a WAV file: " + path);
+    }
+    if (!parsed) {
+        return false;
+    }
+    
+    map.adviseSequential();
+    advisedUntil = releasedUntil = 0;
+    advance(0);
+    return true;
+}
+
+bool AudioFileReader::parseRiff() {
+    const uint8_t* data = map.getData();
+    const uint64_t size = map.getSize();
+    if (std::memcmp(data + 8, "WAVE", 4) != 0) {
+        return fail(L"Not a WAVE file");
+    }
+    
+    info.container = std::memcmp(data, "RIFF", 4) == 0 ? AudioContainer::Wav : AudioContainer::Rf64;
+    
+    // Walk the chunks until fmt and data are both known. In RF64 the real
+    // data size lives in ds64 and the data chunk holds 0xFFFFFFFF.
+    bool haveFormat = false;
+    uint64_t ds64DataBytes = 0;
+    uint64_t pos = 12;
+    while (pos + 8 <= size) {
+        const uint8_t* chunk = data + pos;
+        const uint64_t chunkBytes = ReadLe32(chunk + 4);
+        const uint64_t available = size - pos - 8;
+        
+        if (std::memcmp(chunk, "ds64", 4) == 0 && chunkBytes >= 24 && available >= 24) {
+            ds64DataBytes = ReadLe64(chunk + 16);
+        } else if (std::memcmp(chunk, "fmt ", 4) == 0) {
+            if (!parseFormat(chunk + 8, std::min(chunkBytes, available))) {
+                return false;
+            }
+            haveFormat = true;
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            if (!haveFormat) {
+                return fail(L"Data before format chunk");
+            }
+            
+            uint64_t dataBytes = chunkBytes;
+            if (chunkBytes == 0xFFFFFFFFull && ds64DataBytes > 0) {
+                dataBytes = ds64DataBytes;
+            } else if (chunkBytes == 0 || chunkBytes == 0xFFFFFFFFull) {
+                dataBytes = available;   // Never finalised: take what is there
+            }
+            
+            dataOffset = pos + 8;
+            dataBytes = std::min(dataBytes, available);
+            info.lengthFrames = static_cast<int64_t>(
+                dataBytes / (static_cast<uint64_t>(getBytesPerSample(info.format)) * info.numChannels));
+            position = 0;
+            return true;
+        }
+        pos += 8 + chunkBytes + (chunkBytes & 1);
+    }
+    
+    return fail(L"No data chunk");
+}
+
+bool AudioFileReader::parseW64() {
+    const uint8_t* data = map.getData();
+    const uint64_t size = map.getSize();
+    if (std::memcmp(data + 24, W64_WAVE, 16) != 0) {
+        return fail(L"Not a Wave64 file");
+    }
+    
+    info.container = AudioContainer::W64;
+    bool haveFormat = false;
+    uint64_t pos = 40;
+    while (pos + 24 <= size) {
+        const uint8_t* chunk = data + pos;
+        const uint64_t chunkBytes = ReadLe64(chunk + 16);
+        const uint64_t available = size - pos - 24;
+        if (chunkBytes < 24) {
+            return fail(L"Corrupt Wave64 chunk");
+        }
+        
+        if (std::memcmp(chunk, W64_FMT, 16) == 0) {
+            if (!parseFormat(chunk + 24, std::min(chunkBytes - 24, available))) {
+                return false;
+            }
+            haveFormat = true;
+        } else if (std::memcmp(chunk, W64_DATA, 16) == 0) {
+            if (!haveFormat) {
+                return fail(L"Data before format chunk");
+            }
+            
+            dataOffset = pos + 24;
+            uint64_t dataBytes = std::min(chunkBytes - 24, available);
+            info.lengthFrames = static_cast<int64_t>(
+                dataBytes / (static_cast<uint64_t>(getBytesPerSample(info.format)) * info.numChannels));
+            position = 0;
+            return true;
+        }
+        pos += (chunkBytes + 7) & ~7ull;   // Chunks are 8-byte aligned
+    }
+    
+    return fail(L"No data chunk");
+}
+
+bool AudioFileReader::parseFormat(const uint8_t* fmt, uint64_t size) {
+    if (size < 16) {
+        return fail(L"Truncated format chunk");
+    }
+    
+    uint16_t tag = ReadLe16(fmt);
+    if (tag == WAVE_FORMAT_EXTENSIBLE && size >= 40) {
+        tag = ReadLe16(fmt + 24);   // First bytes of the subformat GUID
+    }
+    info.numChannels = ReadLe16(fmt + 2);
+    info.sampleRate = ReadLe32(fmt + 4);
+    int bits = ReadLe16(fmt + 14);
+    
+    if (tag == WAVE_FORMAT_IEEE_FLOAT && bits == 32) {
+        info.format = SampleFormat::Float32;
+    } else if (tag == WAVE_FORMAT_PCM && bits == 16) {
+        info.format = SampleFormat::Pcm16;
+    } else if (tag == WAVE_FORMAT_PCM && bits == 24) {
+        info.format = SampleFormat::Pcm24;
+    } else if (tag == WAVE_FORMAT_PCM && bits == 32) {
+        info.format = SampleFormat::Pcm32;
+    } else {
+        return fail(L"Unsupported sample format");
+    }
+    if (info.numChannels <= 0 || info.sampleRate <= 0.0) {
+        return fail(L"Invalid format chunk");
+    }
+    return true;
+}
+
+void AudioFileReader::close() {
+    map.close();
+    info = AudioFileInfo();
+    dataOffset = 0;
+    position = 0;
+}
+
+bool AudioFileReader::seek(int64_t frame) {
+    if (!isOpen() || frame < 0 || frame > info.lengthFrames) {
+        return false;
+    }
+    
+    position = frame;
+    advisedUntil = releasedUntil = static_cast<uint64_t>(position) * getBytesPerSample(info.format) * info.numChannels;
+    advance(0);
+    return true;
+}
+
+int AudioFileReader::read(float** dest, int numFrames) {
+    numFrames = static_cast<int>(std::min<int64_t>(numFrames, info.lengthFrames - position));
+    if (!isOpen() || numFrames <= 0) {
+        return 0;
+    }
+    
+    const uint64_t frameBytes = static_cast<uint64_t>(getBytesPerSample(info.format)) * info.numChannels;
+    Decode(map.getData() + dataOffset + position * frameBytes, info.format, info.numChannels, dest, numFrames);
+    advance(numFrames);
+    return numFrames;
+}
+
+bool AudioFileReader::canView() const {
+    // The mapping is page aligned, so only the data offset matters
+    return isOpen() && info.format == SampleFormat::Float32 && dataOffset % alignof(float) == 0 &&
+           std::endian::native == std::endian::little;
+}
+
+int AudioFileReader::view(const float** interleaved, int numFrames) {
+    numFrames = static_cast<int>(std::min<int64_t>(numFrames, info.lengthFrames - position));
+    if (!canView() || numFrames <= 0) {
+        return 0;
+    }
+    
+    const uint64_t frameBytes = sizeof(float) * static_cast<uint64_t>(info.numChannels);
+    *interleaved = reinterpret_cast<const float*>(map.getData() + dataOffset + position * frameBytes);
+    advance(numFrames);
+    return numFrames;
+}
+
+void AudioFileReader::advance(int numFrames) {
+    position += numFrames;
+    const uint64_t consumed = static_cast<uint64_t>(position) * getBytesPerSample(info.format) * info.numChannels;
+    
+    // Keep a window requested ahead, and drop windows once they are a full
+    // window behind so the page cache can reuse them
+    if (consumed + READ_AHEAD_BYTES / 2 >= advisedUntil) {
+        map.adviseWillNeed(dataOffset + consumed, READ_AHEAD_BYTES);
+        advisedUntil = consumed + READ_AHEAD_BYTES;
+    }
+    while (consumed >= releasedUntil + 2 * READ_AHEAD_BYTES) {
+        map.adviseDontNeed(dataOffset + releasedUntil, READ_AHEAD_BYTES);
+        releasedUntil += READ_AHEAD_BYTES;
+    }
+}
+
+bool AudioFileReader::fail(const std::wstring& message) {
+    lastError = message;
+    close();
+    return false;
+}
+
+// Writer
+void AudioFileWriter::AlignedDelete::operator()(uint8_t* block) const {
+    ::operator delete[](block, std::align_val_t(WRITE_BLOCK_ALIGNMENT));
+}
+
+bool AudioFileWriter::create(const std::wstring& path, int channels, double sampleRate, SampleFormat sampleFormat,
+                             AudioContainer fileContainer) {
+    close();
+    lastError.clear();
+    
+    file = OpenFile(path, "wb");
+    if (!file) {
+        lastError = L"Cannot create " + path;
+        return false;
+    }
+    std::setvbuf(file, nullptr, _IONBF, 0);   // Blocks are already large
+    
+    numChannels = std::max(1, channels);
+    format = sampleFormat;
+    container = fileContainer;
+    lengthFrames = 0;
+    
+    for (int i = 0; i < WRITE_BLOCKS; ++i) {
+        void* block = ::operator new[](WRITE_BLOCK_BYTES, std::align_val_t(WRITE_BLOCK_ALIGNMENT));
+        freeBlocks.emplace_back(static_cast<uint8_t*>(block));
+    }
+    current = std::move(freeBlocks.back());
+    freeBlocks.pop_back();
+    currentBytes = 0;
+    
+    // Headers go through the blocks too, so every write starts on a block
+    // boundary. Sizes stay zero until close().
+    if (container == AudioContainer::W64) {
+        uint8_t header[W64_HEADER_BYTES] = {};
+        std::memcpy(header, W64_RIFF, 16);
+        std::memcpy(header + 24, W64_WAVE, 16);
+        std::memcpy(header + 40, W64_FMT, 16);
+        WriteLe64(header + 56, 24 + 16);
+        WriteFormat(header + 64, format, numChannels, sampleRate);
+        std::memcpy(header + W64_DATA_HEADER_OFFSET, W64_DATA, 16);
+        dataHeaderOffset = W64_DATA_HEADER_OFFSET;
+        append(header, sizeof(header));
+    } else {
+        const bool rf64 = container == AudioContainer::Rf64;
+        uint8_t header[WAV_HEADER_BYTES] = {};
+        std::memcpy(header, rf64 ? "RF64" : "RIFF", 4);
+        std::memcpy(header + 8, "WAVE", 4);
+        std::memcpy(header + WAV_DS64_OFFSET, rf64 ? "ds64" : "JUNK", 4);
+        WriteLe32(header + WAV_DS64_OFFSET + 4, 28);
+        std::memcpy(header + 48, "fmt ", 4);
+        WriteLe32(header + 52, 16);
+        WriteFormat(header + 56, format, numChannels, sampleRate);
+        std::memcpy(header + WAV_DATA_HEADER_OFFSET, "data", 4);
+        dataHeaderOffset = WAV_DATA_HEADER_OFFSET;
+        append(header, sizeof(header));
+    }
+    
+    writeThread = std::thread(&AudioFileWriter::writeThreadFunc, this);
+    return true;
+}
+
+bool AudioFileWriter::write(const float* const* source, int numFrames) {
+    if (!file || numFrames <= 0) {
+        return file != nullptr;
+    }
+    
+    const size_t frameBytes = static_cast<size_t>(getBytesPerSample(format)) * numChannels;
+    scratch.resize(frameBytes * numFrames);
+    Encode(source, format, numChannels, scratch.data(), numFrames);
+    
+    // current is dropped once the write thread has failed
+    append(scratch.data(), scratch.size());
+    if (!current) {
+        return false;
+    }
+    lengthFrames += numFrames;
+    return true;
+}
+
+void AudioFileWriter::append(const uint8_t* bytes, size_t size) {
+    while (size > 0 && current) {
+        size_t chunk = std::min(size, WRITE_BLOCK_BYTES - currentBytes);
+        std::memcpy(current.get() + currentBytes, bytes, chunk);
+        currentBytes += chunk;
+        bytes += chunk;
+        size -= chunk;
+        
+        if (currentBytes == WRITE_BLOCK_BYTES) {
+            submitCurrent();
+        }
+    }
+}
+
+// Queues the filled part of the current block and takes a free one,
+// waiting while the whole pool is in flight
+bool AudioFileWriter::submitCurrent() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    if (currentBytes > 0) {
+        pending.push_back({std::move(current), currentBytes});
+        currentBytes = 0;
+        queueCv.notify_all();
+    }
+    
+    queueCv.wait(lock, [this] { return !freeBlocks.empty() || writeFailed; });
+    if (writeFailed) {
+        current.reset();
+        return false;
+    }
+    if (!current) {
+        current = std::move(freeBlocks.back());
+        freeBlocks.pop_back();
+    }
+    return true;
+}
+
+void AudioFileWriter::writeThreadFunc() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    while (true) {
+        queueCv.wait(lock, [this] { return !pending.empty() || closing; });
+        if (pending.empty()) {
+            return;
+        }
+        
+        PendingBlock item = std::move(pending.front());
+        pending.pop_front();
+        const bool skip = writeFailed;
+        lock.unlock();
+        
+        bool written = skip || std::fwrite(item.block.get(), 1, item.bytes, file) == item.bytes;
+        
+        lock.lock();
+        if (!written) {
+            writeFailed = true;
+            lastError = L"Write failed";
+        }
+        freeBlocks.push_back(std::move(item.block));
+        queueCv.notify_all();
+    }
+}
+
+bool AudioFileWriter::close() {
+    if (!file) {
+        return true;
+    }
+    
+    // Chunks end on a word (WAV) or 8-byte (W64) boundary
+    const uint64_t dataBytes = static_cast<uint64_t>(lengthFrames) * getBytesPerSample(format) * numChannels;
+    const uint8_t padding[8] = {};
+    if (container == AudioContainer::W64) {
+        append(padding, static_cast<size_t>((8 - dataBytes % 8) % 8));
+    } else {
+        append(padding, static_cast<size_t>(dataBytes & 1));
+    }
+    if (current) {
+        submitCurrent();
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        closing = true;
+    }
+    queueCv.notify_all();
+    writeThread.join();
+    
+    bool ok = !writeFailed && patchHeader(dataBytes);
+    ok = (std::fclose(file) == 0) && ok;
+    if (!ok && lastError.empty()) {
+        lastError = L"Write failed";
+    }
+    
+    file = nullptr;
+    current.reset();
+    currentBytes = 0;
+    pending.clear();
+    freeBlocks.clear();
+    closing = false;
+    writeFailed = false;
+    return ok;
+}
+
+bool AudioFileWriter::patchHeader(uint64_t dataBytes) {
+    auto put = [this](size_t offset, const void* bytes, size_t size) {
+        return std::fseek(file, static_cast<long>(offset), SEEK_SET) == 0 &&
+               std::fwrite(bytes, 1, size, file) == size;
+    };
+    
+    uint8_t field[8];
+    if (container == AudioContainer::W64) {
+        WriteLe64(field, W64_HEADER_BYTES + ((dataBytes + 7) & ~7ull));
+        bool ok = put(16, field, 8);
+        WriteLe64(field, 24 + dataBytes);
+        return put(dataHeaderOffset + 16, field, 8) && ok;
+    }
+    
+    // Plain RIFF sizes are 32-bit; past that the JUNK chunk becomes ds64
+    const uint64_t riffBytes = WAV_HEADER_BYTES - 8 + dataBytes + (dataBytes & 1);
+    if (container == AudioContainer::Wav && riffBytes <= 0xFFFFFFFFull) {
+        WriteLe32(field, static_cast<uint32_t>(riffBytes));
+        bool ok = put(4, field, 4);
+        WriteLe32(field, static_cast<uint32_t>(dataBytes));
+        return put(dataHeaderOffset + 4, field, 4) && ok;
+    }
+    
+    uint8_t ds64[36] = {};
+    std::memcpy(ds64, "ds64", 4);
+    WriteLe32(ds64 + 4, 28);
+    WriteLe64(ds64 + 8, riffBytes);
+    WriteLe64(ds64 + 16, dataBytes);
+    WriteLe64(ds64 + 24, static_cast<uint64_t>(lengthFrames));
+    
+    WriteLe32(field, 0xFFFFFFFFu);
+    bool ok = put(0, "RF64", 4) && put(4, field, 4) && put(WAV_DS64_OFFSET, ds64, sizeof(ds64));
+    ok = put(dataHeaderOffset + 4, field, 4) && ok;
+    container = AudioContainer::Rf64;
+    return ok;
+}
+
+}
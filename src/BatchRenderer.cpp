@@ -0,0 +1,265 @@
+// BatchRenderer.cpp - Multi-file offline rendering across worker threads
+#include "EnhancedVSTHost.h"
+#include <algorithm>
+#include <deque>
+
+using namespace EVH;
+
+namespace {
+    // Planar audio passed between the reader, the chain and the writer
+    struct Chunk {
+        std::vector<std::vector<float>> channels;
+        std::vector<float*> ptrs;
+        int frames{0};
+        
+        Chunk(int numChannels, int capacity) : channels(numChannels, std::vector<float>(capacity)) {
+            for (auto& channel : channels) {
+                ptrs.push_back(channel.data());
+            }
+        }
+    };
+    
+    // Blocking hand-over between two threads. Chunks circulate between a
+    // free queue and a filled one, so memory stays fixed per file.
+    class ChunkQueue {
+    public:
+        void push(std::unique_ptr<Chunk> chunk) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                chunks.push_back(std::move(chunk));
+            }
+            cv.notify_one();
+        }
+        
+        // Null once closed and drained
+        std::unique_ptr<Chunk> pop() {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [this] { return !chunks.empty() || closed; });
+            if (chunks.empty()) {
+                return nullptr;
+            }
+            auto chunk = std::move(chunks.front());
+            chunks.pop_front();
+            return chunk;
+        }
+        
+        void close() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                closed = true;
+            }
+            cv.notify_all();
+        }
+    
+    private:
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<std::unique_ptr<Chunk>> chunks;
+        bool closed{false};
+    };
+    
+    struct FileSettings {
+        int blockSize;
+        int chunkFrames;
+        int readChunks;
+        int writeChunks;
+        int tailFrames;
+        SampleFormat outputFormat;
+    };
+    
+    // One file through one worker's chain
+    void RenderFile(EnhancedVSTHost& host, const BatchJob& job, const FileSettings& settings,
+                    BatchFileResult& result) {
+        auto start = std::chrono::steady_clock::now();
+        result.inputPath = job.inputPath;
+        
+        AudioFileReader reader;
+        if (!reader.open(job.inputPath)) {
+            result.error = reader.getLastError();
+            return;
+        }
+        
+        const AudioFileInfo& info = reader.getInfo();
+        const int numChannels = std::min(info.numChannels, MAX_CHANNELS);
+        host.setSampleRate(info.sampleRate);
+        host.setBufferSize(settings.blockSize);
+        if (!host.beginOfflineRender(numChannels)) {
+            result.error = L"Could not start the offline render";
+            return;
+        }
+        
+        AudioFileWriter writer;
+        if (!writer.create(job.outputPath, numChannels, info.sampleRate, settings.outputFormat)) {
+            host.endOfflineRender();
+            result.error = writer.getLastError();
+            return;
+        }
+        
+        // The reader decodes every file channel; only the first MAX_CHANNELS are rendered
+        ChunkQueue readFree, readFull, writeFree, writeFull;
+        for (int i = 0; i < settings.readChunks; ++i) {
+            readFree.push(std::make_unique<Chunk>(info.numChannels, settings.chunkFrames));
+        }
+        for (int i = 0; i < settings.writeChunks; ++i) {
+            writeFree.push(std::make_unique<Chunk>(numChannels, settings.chunkFrames));
+        }
+        
+        std::thread readThread([&] {
+            while (auto chunk = readFree.pop()) {
+                chunk->frames = reader.read(chunk->ptrs.data(), settings.chunkFrames);
+                if (chunk->frames == 0) {
+                    break;
+                }
+                readFull.push(std::move(chunk));
+            }
+            readFull.close();
+        });
+        
+        bool writeFailed = false;
+        std::thread writeThread([&] {
+            while (auto chunk = writeFull.pop()) {
+                if (!writeFailed && !writer.write(chunk->ptrs.data(), chunk->frames)) {
+                    writeFailed = true;
+                }
+                writeFree.push(std::move(chunk));
+            }
+        });
+        
+        auto renderChunk = [&](const Chunk& input, int length, Chunk& output) {
+            for (int offset = 0; offset < length; offset += settings.blockSize) {
+                int frames = std::min(settings.blockSize, length - offset);
+                const float* inPtrs[MAX_CHANNELS];
+                float* outPtrs[MAX_CHANNELS];
+                for (int ch = 0; ch < numChannels; ++ch) {
+                    inPtrs[ch] = input.ptrs[ch] + offset;
+                    outPtrs[ch] = output.ptrs[ch] + offset;
+                }
+                host.renderOffline(inPtrs, outPtrs, frames);
+            }
+            output.frames = length;
+        };
+        
+        int64_t inputFrames = 0;
+        while (auto input = readFull.pop()) {
+            auto output = writeFree.pop();
+            renderChunk(*input, input->frames, *output);
+            inputFrames += input->frames;
+            result.frames += input->frames;
+            readFree.push(std::move(input));
+            writeFull.push(std::move(output));
+        }
+        
+        // Past the end of the input the chain still owes its latency and tail;
+        // silence goes in until both are out
+        const Chunk silence(numChannels, settings.chunkFrames);
+        for (int64_t remaining = host.getChainLatencySamples() + int64_t{settings.tailFrames}; remaining > 0;) {
+            auto output = writeFree.pop();
+            const int frames = static_cast<int>(std::min<int64_t>(settings.chunkFrames, remaining));
+            renderChunk(silence, frames, *output);
+            remaining -= frames;
+            result.frames += frames;
+            writeFull.push(std::move(output));
+        }
+        
+        readFree.close();
+        writeFull.close();
+        readThread.join();
+        writeThread.join();
+        host.endOfflineRender();
+        
+        bool closed = writer.close();
+        if (writeFailed || !closed) {
+            result.error = writer.getLastError().empty() ? L"Write failed" : writer.getLastError();
+        } else if (inputFrames < info.lengthFrames) {
+            result.error = L"Input ended early";
+        } else {
+            result.succeeded = true;
+        }
+        
+        result.audioSeconds = result.frames / info.sampleRate;
+        result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        result.realtimeFactor = result.wallSeconds > 0.0 ? result.audioSeconds / result.wallSeconds : 0.0;
+    }
+}
+
+BatchRenderer::BatchRenderer(const EnhancedVSTHost& templateHost, const BatchSettings& settings)
+    : templateHost(templateHost), settings(settings) {
+}
+
+BatchReport BatchRenderer::run(const std::vector<BatchJob>& jobs, FileDoneCallback onFileDone) {
+    BatchReport report;
+    report.files.resize(jobs.size());
+    if (jobs.empty()) {
+        return report;
+    }
+    
+    int numWorkers = settings.numWorkers > 0 ? settings.numWorkers
+                                             : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    numWorkers = std::min(numWorkers, static_cast<int>(jobs.size()));
+    
+    FileSettings fileSettings;
+    fileSettings.blockSize = settings.blockSize > 0 ? settings.blockSize : templateHost.getBufferSize();
+    fileSettings.chunkFrames = std::max(1, 16384 / fileSettings.blockSize) * fileSettings.blockSize;
+    fileSettings.readChunks = std::max(2, settings.readAheadFrames / fileSettings.chunkFrames);
+    fileSettings.writeChunks = std::max(2, settings.writeBehindFrames / fileSettings.chunkFrames);
+    fileSettings.tailFrames = std::max(0, settings.tailFrames);
+    fileSettings.outputFormat = settings.outputFormat;
+    
+    // Chains are copied up front, so a chain that cannot be cloned fails once.
+    // Workers are headless: they report through the file results and leave
+    // the log and blacklist files alone.
+    std::vector<std::unique_ptr<EnhancedVSTHost>> hosts;
+    for (int i = 0; i < numWorkers; ++i) {
+        auto host = std::make_unique<EnhancedVSTHost>(HostMode::Headless);
+        if (!templateHost.cloneChainInto(*host)) {
+            for (size_t j = 0; j < jobs.size(); ++j) {
+                report.files[j].inputPath = jobs[j].inputPath;
+                report.files[j].error = L"Chain could not be copied to a worker";
+            }
+            report.failed = static_cast<int>(jobs.size());
+            return report;
+        }
+        hosts.push_back(std::move(host));
+    }
+    
+    std::vector<size_t> order(jobs.size());
+    std::vector<uintmax_t> sizes(jobs.size());
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        std::error_code error;
+        order[i] = i;
+        sizes[i] = std::filesystem::file_size(std::filesystem::path(jobs[i].inputPath), error);
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return sizes[a] > sizes[b]; });
+    
+    std::atomic<size_t> nextJob{0};
+    std::mutex callbackMutex;
+    auto start = std::chrono::steady_clock::now();
+    
+    std::vector<std::thread> workers;
+    for (int w = 0; w < numWorkers; ++w) {
+        workers.emplace_back([&, w] {
+            for (size_t n = nextJob++; n < order.size(); n = nextJob++) {
+                BatchFileResult& result = report.files[order[n]];
+                result.worker = w;
+                RenderFile(*hosts[w], jobs[order[n]], fileSettings, result);
+                
+                if (onFileDone) {
+                    std::lock_guard<std::mutex> lock(callbackMutex);
+                    onFileDone(result);
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    
+    report.numWorkers = numWorkers;
+    report.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    for (const auto& file : report.files) {
+        report.audioSeconds += file.audioSeconds;
+        report.failed += file.succeeded ? 0 : 1;
+    }
+    report.realtimeFactor = report.wallSeconds > 0.0 ? report.audioSeconds / report.wallSeconds : 0.0;
+    return report;
+}
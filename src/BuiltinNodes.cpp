@@ -0,0 +1,481 @@
+// BuiltinNodes.cpp - Built-in utility processors over the Simd kernels
+#include "EVHNodes.h"
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+namespace EVH {
+namespace Nodes {
+
+namespace {
+    constexpr double PI = 3.14159265358979323846;
+    constexpr float SILENCE_DB = -144.0f;
+    
+    template <int N>
+    using ChannelCount = std::integral_constant<int, N>;
+    
+    // Calls body once with the channel count as a compile-time constant for
+    // the common layouts, or ChannelCount<0> (use the runtime count) for the
+    // rest. The body is a generic lambda, so each case is its own loop.
+    template <typename Body>
+    inline void WithChannelCount(int numChannels, Body&& body) {
+        switch (numChannels) {
+            case 1:
+                body(ChannelCount<1>{});
+                break;
+            case 2:
+                body(ChannelCount<2>{});
+                break;
+            case 6:
+                body(ChannelCount<6>{});
+                break;
+            case 8:
+                body(ChannelCount<8>{});
+                break;
+            default:
+                body(ChannelCount<0>{});
+                break;
+        }
+    }
+    
+    template <int N>
+    constexpr int Count(ChannelCount<N>, int numChannels) {
+        return N > 0 ? N : numChannels;
+    }
+    
+    float DbToGain(float gainDb) {
+        return gainDb <= SILENCE_DB ? 0.0f : std::pow(10.0f, gainDb / 20.0f);
+    }
+    
+    // Constant gain, or a ramp from start reaching target after the block
+    template <typename T>
+    void ApplyGain(T* data, float start, float target, int numSamples) {
+        if (start == target) {
+            if (target != 1.0f) {
+                Simd::multiply(data, T(target), numSamples);
+            }
+        } else {
+            Simd::multiplyRamp(data, T(start), (T(target) - T(start)) / numSamples, numSamples);
+        }
+    }
+}
+
+// GainNode
+GainNode::GainNode(float gainDb)
+    : targetDb(gainDb), targetGain(DbToGain(gainDb)), currentGain(DbToGain(gainDb)) {
+}
+
+bool GainNode::prepare(const ProcessSetup&) {
+    currentGain = targetGain.load(std::memory_order_relaxed);
+    return true;
+}
+
+void GainNode::process(float** channels, int numChannels, int numSamples, const ProcessContext&) {
+    render(channels, numChannels, numSamples);
+}
+
+void GainNode::processDouble(double** channels, int numChannels, int numSamples, const ProcessContext&) {
+    render(channels, numChannels, numSamples);
+}
+
+template <typename T>
+void GainNode::render(T** channels, int numChannels, int numSamples) {
+    if (numSamples <= 0) {
+        return;
+    }
+    
+    const float start = currentGain;
+    const float target = targetGain.load(std::memory_order_relaxed);
+    currentGain = target;
+    if (start == target && target == 1.0f) {
+        return;
+    }
+    
+    WithChannelCount(numChannels, [&](auto fixed) {
+        const int count = Count(fixed, numChannels);
+        for (int ch = 0; ch < count; ++ch) {
+            ApplyGain(channels[ch], start, target, numSamples);
+        }
+    });
+}
+
+std::unique_ptr<AudioProcessor> GainNode::clone() const {
+    return std::make_unique<GainNode>(getGainDb());
+}
+
+float GainNode::getParameter(int index) const {
+    return index == 0 ? getGainDb() : 0.0f;
+}
+
+void GainNode::setParameter(int index, float value) {
+    if (index == 0) {
+        setGainDb(value);
+    }
+}
+
+std::wstring GainNode::getParameterName(int index) const {
+    return index == 0 ? L"Gain (dB)" : L"";
+}
+
+void GainNode::setGainDb(float gainDb) {
+    targetDb.store(gainDb, std::memory_order_relaxed);
+    targetGain.store(DbToGain(gainDb), std::memory_order_relaxed);
+}
+
+// PanNode
+PanNode::PanNode(float pan) : targetPan(std::clamp(pan, -1.0f, 1.0f)) {
+}
+
+bool PanNode::prepare(const ProcessSetup&) {
+    const float pan = getPan();
+    currentLeft = pan > 0.0f ? static_cast<float>(std::cos(pan * PI / 2)) : 1.0f;
+    currentRight = pan < 0.0f ? static_cast<float>(std::cos(-pan * PI / 2)) : 1.0f;
+    return true;
+}
+
+void PanNode::process(float** channels, int numChannels, int numSamples, const ProcessContext&) {
+    render(channels, numChannels, numSamples);
+}
+
+void PanNode::processDouble(double** channels, int numChannels, int numSamples, const ProcessContext&) {
+    render(channels, numChannels, numSamples);
+}
+
+template <typename T>
+void PanNode::render(T** channels, int numChannels, int numSamples) {
+    // Only the first pair is balanced, so there is nothing to specialise
+    if (numChannels < 2 || numSamples <= 0) {
+        return;
+    }
+    
+    const float pan = getPan();
+    const float left = pan > 0.0f ? static_cast<float>(std::cos(pan * PI / 2)) : 1.0f;
+    const float right = pan < 0.0f ? static_cast<float>(std::cos(-pan * PI / 2)) : 1.0f;
+    ApplyGain(channels[0], currentLeft, left, numSamples);
+    ApplyGain(channels[1], currentRight, right, numSamples);
+    currentLeft = left;
+    currentRight = right;
+}
+
+std::unique_ptr<AudioProcessor> PanNode::clone() const {
+    return std::make_unique<PanNode>(getPan());
+}
+
+float PanNode::getParameter(int index) const {
+    return index == 0 ? getPan() : 0.0f;
+}
+
+void PanNode::setParameter(int index, float value) {
+    if (index == 0) {
+        setPan(value);
+    }
+}
+
+std::wstring PanNode::getParameterName(int index) const {
+    return index == 0 ? L"Pan" : L"";
+}
+
+void PanNode::setPan(float pan) {
+    targetPan.store(std::clamp(pan, -1.0f, 1.0f), std::memory_order_relaxed);
+}
+
+// PolarityNode
+bool PolarityNode::prepare(const ProcessSetup&) {
+    return true;
+}
+
+void PolarityNode::process(float** channels, int numChannels, int numSamples, const ProcessContext&) {
+    render(channels, numChannels, numSamples);
+}
+
+void PolarityNode::processDouble(double** channels, int numChannels, int numSamples, const ProcessContext&) {
+    render(channels, numChannels, numSamples);
+}
+
+template <typename T>
+void PolarityNode::render(T** channels, int numChannels, int numSamples) {
+    const uint32_t mask = inverted.load(std::memory_order_relaxed);
+    if (mask == 0) {
+        return;
+    }
+    
+    WithChannelCount(std::min(numChannels, MAX_CHANNELS), [&](auto fixed) {
+        const int count = Count(fixed, std::min(numChannels, MAX_CHANNELS));
+        for (int ch = 0; ch < count; ++ch) {
+            if (mask & (1u << ch)) {
+                Simd::multiply(channels[ch], T(-1), numSamples);
+            }
+        }
+    });
+}
+
+std::unique_ptr<AudioProcessor> PolarityNode::clone() const {
+    return std::make_unique<PolarityNode>(inverted.load(std::memory_order_relaxed));
+}
+
+float PolarityNode::getParameter(int index) const {
+    return isInverted(index) ? 1.0f : 0.0f;
+}
+
+void PolarityNode::setParameter(int index, float value) {
+    setInverted(index, value >= 0.5f);
+}
+
+std::wstring PolarityNode::getParameterName(int index) const {
+    return L"Invert " + std::to_wstring(index + 1);
+}
+
+void PolarityNode::setInverted(int channel, bool invert) {
+    if (channel < 0 || channel >= MAX_CHANNELS) {
+        return;
+    }
+    if (invert) {
+        inverted.fetch_or(1u << channel, std::memory_order_relaxed);
+    } else {
+        inverted.fetch_and(~(1u << channel), std::memory_order_relaxed);
+    }
+}
+
+bool PolarityNode::isInverted(int channel) const {
+    return channel >= 0 && channel < MAX_CHANNELS && (inverted.load(std::memory_order_relaxed) & (1u << channel));
+}
+
+// RoutingNode
+RoutingNode::RoutingNode(int width)
+    : width(std::clamp(width, 1, MAX_CHANNELS)), matrix(new std::atomic<float>[this->width * this->width]) {
+    for (int output = 0; output < this->width; ++output) {
+        for (int input = 0; input < this->width; ++input) {
+            matrix[output * this->width + input].store(output == input ? 1.0f : 0.0f, std::memory_order_relaxed);
+        }
+    }
+}
+
+bool RoutingNode::prepare(const ProcessSetup& setup) {
+    const int channels = std::min(width, setup.numChannels);
+    inputCopies.assign(channels, std::vector<float>(setup.maxBlockSize));
+    if (setup.precision == ProcessPrecision::Double) {
+        doubleInputCopies.assign(channels, std::vector<double>(setup.maxBlockSize));
+    } else {
+        doubleInputCopies.clear();
+    }
+    return true;
+}
+
+void RoutingNode::process(float** channels, int numChannels, int numSamples, const ProcessContext&) {
+    render(channels, numChannels, numSamples);
+}
+
+void RoutingNode::processDouble(double** channels, int numChannels, int numSamples, const ProcessContext&) {
+    render(channels, numChannels, numSamples);
+}
+
+template <typename T>
+void RoutingNode::render(T** channels, int numChannels, int numSamples) {
+    std::vector<std::vector<T>>& copies = [this]() -> std::vector<std::vector<T>>& {
+        if constexpr (std::is_same_v<T, double>) {
+            return doubleInputCopies;
+        } else {
+            return inputCopies;
+        }
+    }();
+    const int active = std::min({width, numChannels, static_cast<int>(copies.size())});
+    if (active == 0 || numSamples <= 0) {
+        return;
+    }
+    
+    // One snapshot per block; the identity matrix costs nothing
+    float gains[MAX_CHANNELS * MAX_CHANNELS];
+    bool identity = true;
+    for (int output = 0; output < active; ++output) {
+        for (int input = 0; input < active; ++input) {
+            float gain = matrix[output * width + input].load(std::memory_order_relaxed);
+            gains[output * active + input] = gain;
+            identity = identity && gain == (output == input ? 1.0f : 0.0f);
+        }
+    }
+    if (identity) {
+        return;
+    }
+    
+    WithChannelCount(active, [&](auto fixed) {
+        const int count = Count(fixed, active);
+        for (int input = 0; input < count; ++input) {
+            std::copy_n(channels[input], numSamples, copies[input].data());
+        }
+        for (int output = 0; output < count; ++output) {
+            T* dest = channels[output];
+            std::fill_n(dest, numSamples, T(0));
+            for (int input = 0; input < count; ++input) {
+                const float gain = gains[output * count + input];
+                if (gain != 0.0f) {
+                    Simd::multiplyAdd(dest, copies[input].data(), T(gain), numSamples);
+                }
+            }
+        }
+    });
+}
+
+std::unique_ptr<AudioProcessor> RoutingNode::clone() const {
+    auto copy = std::make_unique<RoutingNode>(width);
+    for (int i = 0; i < width * width; ++i) {
+        copy->matrix[i].store(matrix[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    return copy;
+}
+
+float RoutingNode::getParameter(int index) const {
+    return index >= 0 && index < width * width ? matrix[index].load(std::memory_order_relaxed) : 0.0f;
+}
+
+void RoutingNode::setParameter(int index, float value) {
+    if (index >= 0 && index < width * width) {
+        matrix[index].store(value, std::memory_order_relaxed);
+    }
+}
+
+std::wstring RoutingNode::getParameterName(int index) const {
+    if (index < 0 || index >= width * width) {
+        return L"";
+    }
+    return L"In " + std::to_wstring(index % width + 1) + L" -> Out " + std::to_wstring(index / width + 1);
+}
+
+void RoutingNode::setGain(int output, int input, float gain) {
+    if (output >= 0 && output < width && input >= 0 && input < width) {
+        matrix[output * width + input].store(gain, std::memory_order_relaxed);
+    }
+}
+
+float RoutingNode::getGain(int output, int input) const {
+    if (output < 0 || output >= width || input < 0 || input >= width) {
+        return 0.0f;
+    }
+    return matrix[output * width + input].load(std::memory_order_relaxed);
+}
+
+void RoutingNode::route(int output, int input) {
+    if (output < 0 || output >= width) {
+        return;
+    }
+    for (int i = 0; i < width; ++i) {
+        setGain(output, i, i == input ? 1.0f : 0.0f);
+    }
+}
+
+// MuteNode
+MuteNode::MuteNode(bool muted) : muted(muted), currentGain(muted ? 0.0f : 1.0f) {
+}
+
+bool MuteNode::prepare(const ProcessSetup&) {
+    currentGain = isMuted() ? 0.0f : 1.0f;
+    return true;
+}
+
+void MuteNode::process(float** channels, int numChannels, int numSamples, const ProcessContext&) {
+    render(channels, numChannels, numSamples);
+}
+
+void MuteNode::processDouble(double** channels, int numChannels, int numSamples, const ProcessContext&) {
+    render(channels, numChannels, numSamples);
+}
+
+template <typename T>
+void MuteNode::render(T** channels, int numChannels, int numSamples) {
+    if (numSamples <= 0) {
+        return;
+    }
+    
+    const float start = currentGain;
+    const float target = isMuted() ? 0.0f : 1.0f;
+    currentGain = target;
+    if (start == 1.0f && target == 1.0f) {
+        return;
+    }
+    
+    WithChannelCount(numChannels, [&](auto fixed) {
+        const int count = Count(fixed, numChannels);
+        for (int ch = 0; ch < count; ++ch) {
+            if (start == 0.0f && target == 0.0f) {
+                std::fill_n(channels[ch], numSamples, T(0));
+            } else {
+                ApplyGain(channels[ch], start, target, numSamples);
+            }
+        }
+    });
+}
+
+std::unique_ptr<AudioProcessor> MuteNode::clone() const {
+    return std::make_unique<MuteNode>(isMuted());
+}
+
+float MuteNode::getParameter(int index) const {
+    return index == 0 && isMuted() ? 1.0f : 0.0f;
+}
+
+void MuteNode::setParameter(int index, float value) {
+    if (index == 0) {
+        setMuted(value >= 0.5f);
+    }
+}
+
+std::wstring MuteNode::getParameterName(int index) const {
+    return index == 0 ? L"Mute" : L"";
+}
+
+// MeterNode
+bool MeterNode::prepare(const ProcessSetup& setup) {
+    numChannels.store(std::min(setup.numChannels, MAX_CHANNELS), std::memory_order_relaxed);
+    for (int ch = 0; ch < MAX_CHANNELS; ++ch) {
+        blockPeak[ch].store(0.0f, std::memory_order_relaxed);
+        blockRms[ch].store(0.0f, std::memory_order_relaxed);
+        heldPeak[ch].store(0.0f, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+void MeterNode::process(float** channels, int numChannels, int numSamples, const ProcessContext&) {
+    render(channels, numChannels, numSamples);
+}
+
+void MeterNode::processDouble(double** channels, int numChannels, int numSamples, const ProcessContext&) {
+    render(channels, numChannels, numSamples);
+}
+
+template <typename T>
+void MeterNode::render(T** channels, int numChannels, int numSamples) {
+    if (numSamples <= 0) {
+        return;
+    }
+    
+    const int metered = std::min(numChannels, MAX_CHANNELS);
+    WithChannelCount(metered, [&](auto fixed) {
+        const int count = Count(fixed, metered);
+        for (int ch = 0; ch < count; ++ch) {
+            const T* data = channels[ch];
+            const float peak = static_cast<float>(Simd::peakAbs(data, numSamples));
+            const float rms = static_cast<float>(std::sqrt(Simd::dotProduct(data, data, numSamples) / numSamples));
+            blockPeak[ch].store(peak, std::memory_order_relaxed);
+            blockRms[ch].store(rms, std::memory_order_relaxed);
+            
+            // Raise the held peak unless a reader reset it in between
+            float held = heldPeak[ch].load(std::memory_order_relaxed);
+            while (peak > held && !heldPeak[ch].compare_exchange_weak(held, peak, std::memory_order_relaxed)) {
+            }
+        }
+    });
+}
+
+float MeterNode::getPeak(int channel) const {
+    return channel >= 0 && channel < MAX_CHANNELS ? blockPeak[channel].load(std::memory_order_relaxed) : 0.0f;
+}
+
+float MeterNode::getRms(int channel) const {
+    return channel >= 0 && channel < MAX_CHANNELS ? blockRms[channel].load(std::memory_order_relaxed) : 0.0f;
+}
+
+float MeterNode::takePeak(int channel) {
+    return channel >= 0 && channel < MAX_CHANNELS ? heldPeak[channel].exchange(0.0f, std::memory_order_relaxed) : 0.0f;
+}
+
+} // namespace Nodes
+} // namespace EVH
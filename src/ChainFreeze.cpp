@@ -0,0 +1,284 @@
+// ChainFreeze.cpp - Chain renders cached on disk and played in place of the chain
+#include "EnhancedVSTHost.h"
+#include <iomanip>
+#include <sstream>
+
+using namespace EVH;
+
+namespace {
+    // FNV-1a; cache names only need to be stable, not secure
+    uint64_t HashText(const std::string& text) {
+        uint64_t hash = 1469598103934665603ull;
+        for (unsigned char c : text) {
+            hash = (hash ^ c) * 1099511628211ull;
+        }
+        return hash;
+    }
+    
+    // Path, size and modification time: a changed file gets a new render
+    bool DescribeInput(const std::wstring& path, std::string& identity) {
+        std::error_code error;
+        std::filesystem::path canonical = std::filesystem::weakly_canonical(path, error);
+        uintmax_t size = std::filesystem::file_size(canonical, error);
+        if (error) {
+            return false;
+        }
+        auto modified = std::filesystem::last_write_time(canonical, error);
+        if (error) {
+            return false;
+        }
+        
+        std::ostringstream text;
+        text << toUtf8(canonical.wstring()) << "\t" << size << "\t" << modified.time_since_epoch().count();
+        identity = text.str();
+        return true;
+    }
+}
+
+// FreezePlayer
+bool FreezePlayer::start(const std::wstring& path, bool loopPlayback) {
+    stop();
+    if (!reader.open(path)) {
+        return false;
+    }
+    
+    info = reader.getInfo();
+    loop = loopPlayback;
+    const int numChannels = std::min(info.numChannels, MAX_CHANNELS);
+    
+    // Half a second ahead absorbs slow disks without holding much memory
+    ring.allocate(numChannels, std::max(static_cast<int>(info.sampleRate / 2), 4 * STREAM_CHUNK_FRAMES));
+    streamBuffers.assign(info.numChannels, std::vector<float>(STREAM_CHUNK_FRAMES));
+    streamPtrs.clear();
+    for (auto& buffer : streamBuffers) {
+        streamPtrs.push_back(buffer.data());
+    }
+    drainBuffers.assign(numChannels, std::vector<float>(STREAM_CHUNK_FRAMES));
+    underruns = 0;
+    finished = false;
+    
+    while (ring.getFreeSpace() >= STREAM_CHUNK_FRAMES && streamChunk()) {
+    }
+    
+    running = true;
+    streamThread = std::thread(&FreezePlayer::streamThreadFunc, this);
+    return true;
+}
+
+void FreezePlayer::stop() {
+    running = false;
+    if (streamThread.joinable()) {
+        streamThread.join();
+    }
+    reader.close();
+}
+
+// Streaming thread: one chunk from the file into the ring; false at the
+// end of a file that does not loop
+bool FreezePlayer::streamChunk() {
+    int frames = reader.read(streamPtrs.data(), STREAM_CHUNK_FRAMES);
+    if (frames == 0) {
+        if (!loop || info.lengthFrames == 0) {
+            finished = true;
+            return false;
+        }
+        reader.seek(0);
+        frames = reader.read(streamPtrs.data(), STREAM_CHUNK_FRAMES);
+    }
+    
+    ring.write(streamPtrs.data(), frames);
+    return frames > 0;
+}
+
+void FreezePlayer::streamThreadFunc() {
+    while (running.load()) {
+        if (ring.getFreeSpace() < STREAM_CHUNK_FRAMES || !streamChunk()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+}
+
+void FreezePlayer::read(float** outputs, int numChannels, int numFrames) {
+    const int ringChannels = ring.getNumChannels();
+    float* dest[MAX_CHANNELS];
+    
+    for (int offset = 0; offset < numFrames;) {
+        int frames = std::min(numFrames - offset, STREAM_CHUNK_FRAMES);
+        for (int ch = 0; ch < ringChannels; ++ch) {
+            dest[ch] = ch < numChannels ? outputs[ch] + offset : drainBuffers[ch].data();
+        }
+        
+        int got = ring.read(dest, frames);
+        if (got < frames) {
+            for (int ch = 0; ch < std::min(numChannels, ringChannels); ++ch) {
+                std::fill_n(outputs[ch] + offset + got, numFrames - offset - got, 0.0f);
+            }
+            if (!finished.load(std::memory_order_relaxed)) {
+                underruns.fetch_add(1, std::memory_order_relaxed);
+            }
+            break;
+        }
+        offset += frames;
+    }
+    
+    // Like FileCaptureSource: extra outputs repeat the last file channel
+    for (int ch = ringChannels; ch < numChannels; ++ch) {
+        if (ringChannels > 0) {
+            std::copy_n(outputs[ringChannels - 1], numFrames, outputs[ch]);
+        } else {
+            std::fill_n(outputs[ch], numFrames, 0.0f);
+        }
+    }
+}
+
+// Host
+std::string EnhancedVSTHost::describeChain() const {
+    std::ostringstream text;
+    text << std::setprecision(9) << "rate\t" << currentSampleRate << "\n";
+    for (int pluginId : pluginChain) {
+        auto it = loadedPlugins.find(pluginId);
+        if (it == loadedPlugins.end()) {
+            continue;
+        }
+        
+        const PluginInstance& plugin = *it->second;
+        text << (plugin.isNative() ? "processor\t" : "plugin\t") << toUtf8(plugin.getInfo().path) << "\t"
+             << toUtf8(plugin.getInfo().name) << "\t" << (plugin.isBypassed() ? 1 : 0);
+        for (int i = 0; i < plugin.getParameterCount(); ++i) {
+            text << "\t" << plugin.getParameter(i);
+        }
+        text << "\n";
+    }
+    return text.str();
+}
+
+bool EnhancedVSTHost::freezeChain(const std::wstring& inputPath, const FreezeSettings& settings) {
+    unfreezeChain();
+    
+    AudioFileReader input;
+    if (!input.open(inputPath)) {
+        logError(L"Freeze: " + input.getLastError());
+        return false;
+    }
+    if (input.getInfo().sampleRate != currentSampleRate) {
+        logError(L"Freeze: input sample rate does not match the session: " + inputPath);
+        return false;
+    }
+    input.close();
+    
+    std::string description;
+    {
+        std::lock_guard<std::mutex> reconfigLock(reconfigureMutex);
+        std::lock_guard<std::mutex> lock(pluginMutex);
+        description = describeChain();
+    }
+    
+    std::string inputIdentity;
+    if (!DescribeInput(inputPath, inputIdentity)) {
+        logError(L"Freeze: cannot stat " + inputPath);
+        return false;
+    }
+    
+    std::error_code error;
+    std::filesystem::path directory = settings.cacheDirectory.empty()
+        ? std::filesystem::temp_directory_path(error) / "evh_freeze"
+        : std::filesystem::path(settings.cacheDirectory);
+    std::filesystem::create_directories(directory, error);
+    
+    // The render runs past the input by the chain latency and the tail
+    const int tailFrames = std::max(0, settings.tailFrames);
+    description += "tail\t" + std::to_string(tailFrames) + "\n";
+    
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.wav",
+                  static_cast<unsigned long long>(HashText(description + "\n" + inputIdentity)));
+    const std::filesystem::path cachePath = directory / name;
+    
+    FreezeStats stats;
+    stats.cachePath = cachePath.wstring();
+    stats.cacheHit = std::filesystem::exists(cachePath, error);
+    
+    // Render into a temporary name so a cancelled run never looks cached
+    if (!stats.cacheHit) {
+        std::filesystem::path partialPath = cachePath;
+        partialPath += ".partial";
+        
+        // The renderer's worker host is headless, so the session's log and
+        // blacklist files stay untouched
+        EVH::BatchSettings batchSettings;
+        batchSettings.numWorkers = 1;
+        batchSettings.tailFrames = tailFrames;
+        BatchRenderer renderer(*this, batchSettings);
+        BatchReport report = renderer.run({{inputPath, partialPath.wstring()}});
+        
+        const BatchFileResult& result = report.files.front();
+        if (!result.succeeded) {
+            std::filesystem::remove(partialPath, error);
+            logError(L"Freeze: render failed: " + result.error);
+            return false;
+        }
+        std::filesystem::rename(partialPath, cachePath, error);
+        if (error) {
+            logError(L"Freeze: cannot store " + cachePath.wstring());
+            return false;
+        }
+        stats.renderSeconds = result.wallSeconds;
+        stats.realtimeFactor = result.realtimeFactor;
+    }
+    
+    auto player = std::make_unique<FreezePlayer>();
+    if (!player->start(cachePath.wstring(), settings.loop)) {
+        logError(L"Freeze: " + player->getLastError());
+        return false;
+    }
+    stats.lengthFrames = player->getInfo().lengthFrames;
+    stats.frozen = true;
+    
+    // The plugins stay loaded and prepared, just idle
+    std::lock_guard<std::mutex> reconfigLock(reconfigureMutex);
+    std::lock_guard<std::mutex> lock(pluginMutex);
+    for (int pluginId : pluginChain) {
+        auto it = loadedPlugins.find(pluginId);
+        if (it != loadedPlugins.end() && it->second->getState() == PluginState::Active) {
+            it->second->suspend();
+            frozenPluginIds.push_back(pluginId);
+        }
+    }
+    freezePlayer = std::move(player);
+    freezeStats = stats;
+    chainFrozen = true;
+    return true;
+}
+
+void EnhancedVSTHost::unfreezeChain() {
+    std::unique_ptr<FreezePlayer> player;
+    {
+        std::lock_guard<std::mutex> reconfigLock(reconfigureMutex);
+        std::lock_guard<std::mutex> lock(pluginMutex);
+        if (!freezePlayer) {
+            return;
+        }
+        
+        for (int pluginId : frozenPluginIds) {
+            auto it = loadedPlugins.find(pluginId);
+            if (it != loadedPlugins.end() && it->second->getState() == PluginState::Loaded) {
+                it->second->resume();
+            }
+        }
+        frozenPluginIds.clear();
+        player = std::move(freezePlayer);
+        freezeStats.underruns = player->getUnderruns();
+        freezeStats.frozen = false;
+        chainFrozen = false;
+    }
+    // Joined outside the locks; the audio thread no longer sees the player
+}
+
+FreezeStats EnhancedVSTHost::getFreezeStats() const {
+    std::lock_guard<std::mutex> reconfigLock(reconfigureMutex);
+    FreezeStats stats = freezeStats;
+    if (freezePlayer) {
+        stats.underruns = freezePlayer->getUnderruns();
+    }
+    return stats;
+}
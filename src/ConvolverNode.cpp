@@ -0,0 +1,440 @@
+// ConvolverNode.cpp - Zero-latency partitioned FFT convolution
+#include "EVHNodes.h"
+#include <algorithm>
+#include <cmath>
+
+namespace EVH {
+namespace Nodes {
+
+namespace {
+    constexpr int READ_CHUNK_FRAMES = 65536;
+    constexpr int RESAMPLE_CHUNK_FRAMES = 4096;
+    constexpr int64_t STOP_REQUEST = -2;
+    
+    int NextPowerOfTwo(int value) {
+        int result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+    
+    int PowerOfTwoAtMost(int value) {
+        int result = 1;
+        while (result * 2 <= value) {
+            result <<= 1;
+        }
+        return result;
+    }
+    
+    // Offline conversion of the whole impulse (the converter's pre-roll keeps
+    // it aligned), scaled so the filter keeps its gain at the new rate
+    std::vector<std::vector<float>> ResampleImpulse(const std::vector<std::vector<float>>& channels,
+                                                    double fromRate, double toRate) {
+        const int numChannels = static_cast<int>(channels.size());
+        size_t length = 0;
+        for (const auto& channel : channels) {
+            length = std::max(length, channel.size());
+        }
+        
+        SampleRateConverter converter(numChannels, fromRate, toRate, ResamplerQuality::High, RESAMPLE_CHUNK_FRAMES);
+        const size_t outputLength = static_cast<size_t>(std::ceil(length * toRate / fromRate));
+        const float scale = static_cast<float>(fromRate / toRate);
+        const int maxOutput = converter.getMaxOutputFrames(RESAMPLE_CHUNK_FRAMES);
+        
+        std::vector<std::vector<float>> in(numChannels, std::vector<float>(RESAMPLE_CHUNK_FRAMES));
+        std::vector<std::vector<float>> out(numChannels, std::vector<float>(maxOutput));
+        std::vector<const float*> inPtrs;
+        std::vector<float*> outPtrs;
+        for (int ch = 0; ch < numChannels; ++ch) {
+            inPtrs.push_back(in[ch].data());
+            outPtrs.push_back(out[ch].data());
+        }
+        
+        std::vector<std::vector<float>> result(numChannels);
+        for (size_t read = 0; result[0].size() < outputLength; read += RESAMPLE_CHUNK_FRAMES) {
+            // Past the end the converter is fed silence to flush its delay
+            for (int ch = 0; ch < numChannels; ++ch) {
+                const std::vector<float>& source = channels[ch];
+                for (int i = 0; i < RESAMPLE_CHUNK_FRAMES; ++i) {
+                    in[ch][i] = read + i < source.size() ? source[read + i] : 0.0f;
+                }
+            }
+            
+            int frames = converter.process(inPtrs.data(), RESAMPLE_CHUNK_FRAMES, outPtrs.data(), maxOutput);
+            int count = static_cast<int>(std::min<size_t>(frames, outputLength - result[0].size()));
+            for (int ch = 0; ch < numChannels; ++ch) {
+                for (int i = 0; i < count; ++i) {
+                    result[ch].push_back(out[ch][i] * scale);
+                }
+            }
+        }
+        return result;
+    }
+}
+
+// One partition size. The audio thread fills input[fillIndex] and plays
+// output[playIndex]; the job for a finished frame reads input[jobIndex] and
+// writes output[jobIndex], on a worker or inline.
+struct ConvolverNode::Level {
+    int partitionSize{0};
+    int numPartitions{0};
+    int numBins{0};
+    bool deferred{false};     // Block plays one period after its frame (all but the first level)
+    bool background{false};   // Job runs on the worker thread
+    RealFft fft;
+    
+    // Partition spectra per impulse channel, scaled by 1 / FFT size
+    std::vector<std::vector<float>> filterRe;
+    std::vector<std::vector<float>> filterIm;
+    const std::vector<int>* impulseChannel{nullptr};
+    
+    // Job state: ring of input spectra (newest at delayHead) per channel
+    std::vector<std::vector<float>> delayRe;
+    std::vector<std::vector<float>> delayIm;
+    std::vector<std::vector<float>> previousInput;
+    std::vector<float> frame;
+    std::vector<float> accRe;
+    std::vector<float> accIm;
+    std::vector<float> result;
+    int delayHead{0};
+    int64_t lastFrame{-1};
+    
+    // Hand-over
+    std::vector<std::vector<float>> input[2];
+    std::vector<std::vector<float>> output[2];
+    int fillIndex{0};
+    int jobIndex{0};
+    int playIndex{-1};          // -1: nothing to play this period
+    int64_t submitted{-1};
+    std::atomic<int64_t> requested{-1};
+    std::atomic<int64_t> completed{-1};
+    std::thread worker;
+    
+    void run(int64_t frameIndex);
+    void workerThreadFunc();
+};
+
+void ConvolverNode::Level::run(int64_t frameIndex) {
+    const int numChannels = static_cast<int>(delayRe.size());
+    const int size = partitionSize;
+    
+    // Frames dropped after a late block enter the delay line as silence
+    if (lastFrame >= 0 && frameIndex > lastFrame + 1) {
+        const int64_t missing = std::min<int64_t>(frameIndex - lastFrame - 1, numPartitions);
+        for (int64_t m = 0; m < missing; ++m) {
+            delayHead = (delayHead + 1) % numPartitions;
+            for (int ch = 0; ch < numChannels; ++ch) {
+                std::fill_n(delayRe[ch].data() + delayHead * numBins, numBins, 0.0f);
+                std::fill_n(delayIm[ch].data() + delayHead * numBins, numBins, 0.0f);
+            }
+        }
+        for (auto& previous : previousInput) {
+            std::fill(previous.begin(), previous.end(), 0.0f);
+        }
+    }
+    lastFrame = frameIndex;
+    delayHead = (delayHead + 1) % numPartitions;
+    
+    for (int ch = 0; ch < numChannels; ++ch) {
+        // Overlap-save: the previous frame and this one, keep the second half
+        const std::vector<float>& current = input[jobIndex][ch];
+        std::copy_n(previousInput[ch].data(), size, frame.data());
+        std::copy_n(current.data(), size, frame.data() + size);
+        std::copy_n(current.data(), size, previousInput[ch].data());
+        fft.forward(frame.data(), delayRe[ch].data() + delayHead * numBins, delayIm[ch].data() + delayHead * numBins);
+        
+        const int source = (*impulseChannel)[ch];
+        const float* hRe = filterRe[source].data();
+        const float* hIm = filterIm[source].data();
+        std::fill(accRe.begin(), accRe.end(), 0.0f);
+        std::fill(accIm.begin(), accIm.end(), 0.0f);
+        for (int j = 0; j < numPartitions; ++j) {
+            const int slot = (delayHead - j + numPartitions) % numPartitions;
+            Simd::complexMultiplyAdd(accRe.data(), accIm.data(),
+                                     delayRe[ch].data() + slot * numBins, delayIm[ch].data() + slot * numBins,
+                                     hRe + j * numBins, hIm + j * numBins, numBins);
+        }
+        
+        fft.inverse(accRe.data(), accIm.data(), result.data());
+        std::copy_n(result.data() + size, size, output[jobIndex][ch].data());
+    }
+}
+
+void ConvolverNode::Level::workerThreadFunc() {
+    ScopedDenormalDisable noDenormals;
+    int64_t seen = -1;
+    
+    while (true) {
+        requested.wait(seen, std::memory_order_acquire);
+        const int64_t frameIndex = requested.load(std::memory_order_acquire);
+        if (frameIndex == STOP_REQUEST) {
+            return;
+        }
+        if (frameIndex == seen) {
+            continue;
+        }
+        
+        seen = frameIndex;
+        run(frameIndex);
+        completed.store(frameIndex, std::memory_order_release);
+        completed.notify_all();
+    }
+}
+
+// ConvolverNode
+ConvolverNode::ConvolverNode(const ConvolverSettings& settings) : settings(settings) {
+}
+
+ConvolverNode::~ConvolverNode() {
+    releaseLevels();
+}
+
+bool ConvolverNode::loadImpulseResponse(const std::wstring& path) {
+    AudioFileReader reader;
+    if (!reader.open(path)) {
+        lastError = reader.getLastError();
+        return false;
+    }
+    
+    const AudioFileInfo& info = reader.getInfo();
+    if (info.numChannels == 0 || info.lengthFrames == 0) {
+        lastError = L"Impulse response is empty: " + path;
+        return false;
+    }
+    
+    auto loaded = std::make_shared<Impulse>();
+    loaded->sampleRate = info.sampleRate;
+    loaded->channels.assign(info.numChannels, std::vector<float>(static_cast<size_t>(info.lengthFrames)));
+    std::vector<float*> dest(info.numChannels);
+    for (int64_t done = 0; done < info.lengthFrames;) {
+        for (int ch = 0; ch < info.numChannels; ++ch) {
+            dest[ch] = loaded->channels[ch].data() + done;
+        }
+        int frames = reader.read(dest.data(), static_cast<int>(std::min<int64_t>(READ_CHUNK_FRAMES,
+                                                                                 info.lengthFrames - done)));
+        if (frames == 0) {
+            lastError = L"Impulse response is truncated: " + path;
+            return false;
+        }
+        done += frames;
+    }
+    
+    impulse = std::move(loaded);
+    return true;
+}
+
+void ConvolverNode::setImpulseResponse(std::vector<std::vector<float>> channels, double sampleRate) {
+    auto replacement = std::make_shared<Impulse>();
+    replacement->channels = std::move(channels);
+    replacement->sampleRate = sampleRate;
+    impulse = std::move(replacement);
+}
+
+bool ConvolverNode::prepare(const ProcessSetup& setup) {
+    releaseLevels();
+    position = 0;
+    preparedChannels = setup.numChannels;
+    headSize = settings.headSize > 0 ? NextPowerOfTwo(settings.headSize)
+                                     : NextPowerOfTwo(std::clamp(setup.maxBlockSize, 64, 1024));
+    const int maxPartition = std::max(headSize, PowerOfTwoAtMost(settings.maxPartitionSize));
+    
+    // The impulse at the session rate; none is a unit impulse
+    static const std::vector<std::vector<float>> unitImpulse{{1.0f}};
+    std::vector<std::vector<float>> resampled;
+    const std::vector<std::vector<float>>* taps = &unitImpulse;
+    if (impulse && !impulse->channels.empty()) {
+        taps = &impulse->channels;
+        if (impulse->sampleRate > 0.0 && impulse->sampleRate != setup.sampleRate) {
+            resampled = ResampleImpulse(impulse->channels, impulse->sampleRate, setup.sampleRate);
+            taps = &resampled;
+        }
+    }
+    
+    const int numImpulseChannels = static_cast<int>(taps->size());
+    impulseLength = 0;
+    for (const auto& channel : *taps) {
+        impulseLength = std::max<int64_t>(impulseLength, channel.size());
+    }
+    impulseChannel.resize(preparedChannels);
+    for (int ch = 0; ch < preparedChannels; ++ch) {
+        impulseChannel[ch] = std::min(ch, numImpulseChannels - 1);
+    }
+    
+    headTaps.assign(numImpulseChannels, std::vector<float>(headSize, 0.0f));
+    for (int source = 0; source < numImpulseChannels; ++source) {
+        const std::vector<float>& channel = (*taps)[source];
+        for (int k = 0; k < headSize && k < static_cast<int>(channel.size()); ++k) {
+            headTaps[source][headSize - 1 - k] = channel[k];
+        }
+    }
+    headLines.assign(preparedChannels, std::vector<float>(2 * headSize - 1, 0.0f));
+    
+    // Levels of partitions 4x larger each; a level of partition P ends
+    // where the next one's 2P lead-in is covered, the largest takes the rest
+    int64_t start = headSize;
+    int size = headSize;
+    bool deferred = false;
+    while (start < impulseLength) {
+        const int next = std::min(size * 4, maxPartition);
+        const int64_t end = std::min<int64_t>(next > size ? 2 * static_cast<int64_t>(next) : impulseLength,
+                                              impulseLength);
+        
+        auto level = std::make_unique<Level>();
+        level->partitionSize = size;
+        level->numPartitions = static_cast<int>((end - start + size - 1) / size);
+        level->numBins = size + 1;
+        level->deferred = deferred;
+        level->background = deferred && settings.backgroundTail;
+        level->fft.setSize(2 * size);
+        level->impulseChannel = &impulseChannel;
+        level->frame.assign(2 * size, 0.0f);
+        level->result.assign(2 * size, 0.0f);
+        level->accRe.assign(level->numBins, 0.0f);
+        level->accIm.assign(level->numBins, 0.0f);
+        
+        const float scale = 1.0f / (2 * size);
+        const size_t spectrumSize = static_cast<size_t>(level->numPartitions) * level->numBins;
+        level->filterRe.assign(numImpulseChannels, std::vector<float>(spectrumSize));
+        level->filterIm.assign(numImpulseChannels, std::vector<float>(spectrumSize));
+        for (int source = 0; source < numImpulseChannels; ++source) {
+            const std::vector<float>& channel = (*taps)[source];
+            for (int j = 0; j < level->numPartitions; ++j) {
+                std::fill(level->frame.begin(), level->frame.end(), 0.0f);
+                for (int k = 0; k < size; ++k) {
+                    const int64_t tap = start + static_cast<int64_t>(j) * size + k;
+                    if (tap < end && tap < static_cast<int64_t>(channel.size())) {
+                        level->frame[k] = channel[tap] * scale;
+                    }
+                }
+                level->fft.forward(level->frame.data(), level->filterRe[source].data() + j * level->numBins,
+                                   level->filterIm[source].data() + j * level->numBins);
+            }
+        }
+        
+        level->delayRe.assign(preparedChannels, std::vector<float>(spectrumSize, 0.0f));
+        level->delayIm.assign(preparedChannels, std::vector<float>(spectrumSize, 0.0f));
+        level->previousInput.assign(preparedChannels, std::vector<float>(size, 0.0f));
+        for (int b = 0; b < 2; ++b) {
+            level->input[b].assign(preparedChannels, std::vector<float>(size, 0.0f));
+            level->output[b].assign(preparedChannels, std::vector<float>(size, 0.0f));
+        }
+        
+        if (level->background) {
+            level->worker = std::thread(&Level::workerThreadFunc, level.get());
+        }
+        levels.push_back(std::move(level));
+        
+        start = end;
+        size = next;
+        deferred = true;
+    }
+    return true;
+}
+
+void ConvolverNode::releaseLevels() {
+    for (auto& level : levels) {
+        if (level->worker.joinable()) {
+            level->requested.store(STOP_REQUEST, std::memory_order_release);
+            level->requested.notify_all();
+            level->worker.join();
+        }
+    }
+    levels.clear();
+}
+
+void ConvolverNode::process(float** channels, int numChannels, int numSamples, const ProcessContext& context) {
+    const int active = std::min(numChannels, preparedChannels);
+    if (headSize == 0) {
+        return;
+    }
+    
+    // Chunks end on head-size boundaries, where every level's frames end
+    for (int offset = 0; offset < numSamples;) {
+        const int frames = std::min(numSamples - offset, headSize - static_cast<int>(position % headSize));
+        processChunk(channels, active, offset, frames);
+        offset += frames;
+        position += frames;
+        
+        if (position % headSize == 0) {
+            for (auto& level : levels) {
+                if (position % level->partitionSize == 0) {
+                    completeFrame(*level, context.offline);
+                }
+            }
+        }
+    }
+}
+
+void ConvolverNode::processChunk(float** channels, int numChannels, int offset, int numSamples) {
+    const int history = headSize - 1;
+    
+    for (int ch = 0; ch < numChannels; ++ch) {
+        float* data = channels[ch] + offset;
+        float* line = headLines[ch].data();
+        std::copy_n(data, numSamples, line + history);
+        for (auto& level : levels) {
+            float* fill = level->input[level->fillIndex][ch].data();
+            std::copy_n(data, numSamples, fill + position % level->partitionSize);
+        }
+        
+        const float* taps = headTaps[impulseChannel[ch]].data();
+        for (int i = 0; i < numSamples; ++i) {
+            data[i] = Simd::dotProduct(line + i, taps, headSize);
+        }
+        std::copy_n(line + numSamples, history, line);
+        
+        for (auto& level : levels) {
+            if (level->playIndex >= 0) {
+                const float* tail = level->output[level->playIndex][ch].data() + position % level->partitionSize;
+                Simd::multiplyAdd(data, tail, 1.0f, numSamples);
+            }
+        }
+    }
+}
+
+// At the end of one of the level's frames: take the finished block, then
+// hand the new frame to the job
+void ConvolverNode::completeFrame(Level& level, bool offline) {
+    const int64_t frameIndex = position / level.partitionSize - 1;
+    
+    if (level.deferred) {
+        int64_t done = level.completed.load(std::memory_order_acquire);
+        if (level.submitted >= 0 && done != level.submitted) {
+            if (!offline) {
+                // Keep filling the same frame; the job still owns the other
+                lateBlocks.fetch_add(1, std::memory_order_relaxed);
+                level.playIndex = -1;
+                return;
+            }
+            while (done != level.submitted) {
+                level.completed.wait(done, std::memory_order_acquire);
+                done = level.completed.load(std::memory_order_acquire);
+            }
+        }
+        level.playIndex = level.submitted >= 0 && level.submitted == frameIndex - 1 ? level.jobIndex : -1;
+    }
+    
+    level.jobIndex = level.fillIndex;
+    level.fillIndex ^= 1;
+    level.submitted = frameIndex;
+    if (level.background) {
+        level.requested.store(frameIndex, std::memory_order_release);
+        level.requested.notify_one();
+    } else {
+        level.run(frameIndex);
+        level.completed.store(frameIndex, std::memory_order_relaxed);
+        if (!level.deferred) {
+            level.playIndex = level.jobIndex;
+        }
+    }
+}
+
+std::unique_ptr<AudioProcessor> ConvolverNode::clone() const {
+    auto copy = std::make_unique<ConvolverNode>(settings);
+    copy->impulse = impulse;
+    return copy;
+}
+
+} // namespace Nodes
+} // namespace EVH
@@ -0,0 +1,453 @@
+// DspKernels.cpp - Vectorised DSP inner loops
+#include "EVHDsp.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX__)
+    #include <immintrin.h>
+    #define EVH_SIMD_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define EVH_SIMD_SSE 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define EVH_SIMD_NEON 1
+#endif
+
+namespace EVH {
+namespace Simd {
+
+float dotProduct(const float* a, const float* b, int n) {
+    int i = 0;
+    float sum = 0.0f;
+    
+#if defined(EVH_SIMD_AVX)
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+        acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8)));
+    }
+    acc0 = _mm256_add_ps(acc0, acc1);
+    __m128 acc = _mm_add_ps(_mm256_castps256_ps128(acc0), _mm256_extractf128_ps(acc0, 1));
+    for (; i + 4 <= n; i += 4) {
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+    acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+    acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+    sum = _mm_cvtss_f32(acc);
+#elif defined(EVH_SIMD_SSE)
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    __m128 acc = _mm_add_ps(acc0, acc1);
+    for (; i + 4 <= n; i += 4) {
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+    acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+    acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+    sum = _mm_cvtss_f32(acc);
+#elif defined(EVH_SIMD_NEON)
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    for (; i + 8 <= n; i += 8) {
+        acc0 = vmlaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+        acc1 = vmlaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    }
+    float32x4_t acc = vaddq_f32(acc0, acc1);
+    float32x2_t half = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+    sum = vget_lane_f32(vpadd_f32(half, half), 0);
+#endif
+    
+    // Scalar tail (or whole loop without SIMD)
+    for (; i < n; ++i) {
+        sum += a[i] * b[i];
+    }
+    
+    return sum;
+}
+
+void multiply(float* data, float gain, int n) {
+    int i = 0;
+    
+#if defined(EVH_SIMD_AVX)
+    const __m256 g = _mm256_set1_ps(gain);
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(data + i, _mm256_mul_ps(_mm256_loadu_ps(data + i), g));
+    }
+#elif defined(EVH_SIMD_SSE)
+    const __m128 g = _mm_set1_ps(gain);
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(data + i, _mm_mul_ps(_mm_loadu_ps(data + i), g));
+    }
+#elif defined(EVH_SIMD_NEON)
+    for (; i + 4 <= n; i += 4) {
+        vst1q_f32(data + i, vmulq_n_f32(vld1q_f32(data + i), gain));
+    }
+#endif
+    
+    for (; i < n; ++i) {
+        data[i] *= gain;
+    }
+}
+
+void multiplyRamp(float* data, float start, float step, int n) {
+    int i = 0;
+    
+    // Gains are recomputed from the index rather than accumulated, so
+    // long ramps land exactly on their end value
+#if defined(EVH_SIMD_AVX)
+    const __m256 lanes = _mm256_mul_ps(_mm256_set_ps(7, 6, 5, 4, 3, 2, 1, 0), _mm256_set1_ps(step));
+    for (; i + 8 <= n; i += 8) {
+        __m256 g = _mm256_add_ps(_mm256_set1_ps(start + step * i), lanes);
+        _mm256_storeu_ps(data + i, _mm256_mul_ps(_mm256_loadu_ps(data + i), g));
+    }
+#elif defined(EVH_SIMD_SSE)
+    const __m128 lanes = _mm_mul_ps(_mm_set_ps(3, 2, 1, 0), _mm_set1_ps(step));
+    for (; i + 4 <= n; i += 4) {
+        __m128 g = _mm_add_ps(_mm_set1_ps(start + step * i), lanes);
+        _mm_storeu_ps(data + i, _mm_mul_ps(_mm_loadu_ps(data + i), g));
+    }
+#elif defined(EVH_SIMD_NEON)
+    const float laneValues[4] = {0.0f, step, 2.0f * step, 3.0f * step};
+    const float32x4_t lanes = vld1q_f32(laneValues);
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t g = vaddq_f32(vdupq_n_f32(start + step * i), lanes);
+        vst1q_f32(data + i, vmulq_f32(vld1q_f32(data + i), g));
+    }
+#endif
+    
+    for (; i < n; ++i) {
+        data[i] *= start + step * i;
+    }
+}
+
+void multiplyAdd(float* dest, const float* source, float gain, int n) {
+    int i = 0;
+    
+#if defined(EVH_SIMD_AVX)
+    const __m256 g = _mm256_set1_ps(gain);
+    for (; i + 8 <= n; i += 8) {
+        __m256 scaled = _mm256_mul_ps(_mm256_loadu_ps(source + i), g);
+        _mm256_storeu_ps(dest + i, _mm256_add_ps(_mm256_loadu_ps(dest + i), scaled));
+    }
+#elif defined(EVH_SIMD_SSE)
+    const __m128 g = _mm_set1_ps(gain);
+    for (; i + 4 <= n; i += 4) {
+        __m128 scaled = _mm_mul_ps(_mm_loadu_ps(source + i), g);
+        _mm_storeu_ps(dest + i, _mm_add_ps(_mm_loadu_ps(dest + i), scaled));
+    }
+#elif defined(EVH_SIMD_NEON)
+    for (; i + 4 <= n; i += 4) {
+        vst1q_f32(dest + i, vmlaq_n_f32(vld1q_f32(dest + i), vld1q_f32(source + i), gain));
+    }
+#endif
+    
+    for (; i < n; ++i) {
+        dest[i] += source[i] * gain;
+    }
+}
+
+float peakAbs(const float* data, int n) {
+    int i = 0;
+    float peak = 0.0f;
+    
+#if defined(EVH_SIMD_AVX)
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    __m256 acc = _mm256_setzero_ps();
+    for (; i + 8 <= n; i += 8) {
+        acc = _mm256_max_ps(acc, _mm256_andnot_ps(signMask, _mm256_loadu_ps(data + i)));
+    }
+    __m128 half = _mm_max_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    half = _mm_max_ps(half, _mm_movehl_ps(half, half));
+    half = _mm_max_ss(half, _mm_shuffle_ps(half, half, 1));
+    peak = _mm_cvtss_f32(half);
+#elif defined(EVH_SIMD_SSE)
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    __m128 acc = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4) {
+        acc = _mm_max_ps(acc, _mm_andnot_ps(signMask, _mm_loadu_ps(data + i)));
+    }
+    acc = _mm_max_ps(acc, _mm_movehl_ps(acc, acc));
+    acc = _mm_max_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+    peak = _mm_cvtss_f32(acc);
+#elif defined(EVH_SIMD_NEON)
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    for (; i + 4 <= n; i += 4) {
+        acc = vmaxq_f32(acc, vabsq_f32(vld1q_f32(data + i)));
+    }
+    float32x2_t half = vmax_f32(vget_low_f32(acc), vget_high_f32(acc));
+    peak = vget_lane_f32(vpmax_f32(half, half), 0);
+#endif
+    
+    for (; i < n; ++i) {
+        peak = std::max(peak, std::fabs(data[i]));
+    }
+    
+    return peak;
+}
+
+void complexMultiplyAdd(float* accRe, float* accIm, const float* aRe, const float* aIm,
+                        const float* bRe, const float* bIm, int n) {
+    int i = 0;
+    
+#if defined(EVH_SIMD_AVX)
+    for (; i + 8 <= n; i += 8) {
+        __m256 ar = _mm256_loadu_ps(aRe + i);
+        __m256 ai = _mm256_loadu_ps(aIm + i);
+        __m256 br = _mm256_loadu_ps(bRe + i);
+        __m256 bi = _mm256_loadu_ps(bIm + i);
+        __m256 re = _mm256_sub_ps(_mm256_mul_ps(ar, br), _mm256_mul_ps(ai, bi));
+        __m256 im = _mm256_add_ps(_mm256_mul_ps(ar, bi), _mm256_mul_ps(ai, br));
+        _mm256_storeu_ps(accRe + i, _mm256_add_ps(_mm256_loadu_ps(accRe + i), re));
+        _mm256_storeu_ps(accIm + i, _mm256_add_ps(_mm256_loadu_ps(accIm + i), im));
+    }
+#elif defined(EVH_SIMD_SSE)
+    for (; i + 4 <= n; i += 4) {
+        __m128 ar = _mm_loadu_ps(aRe + i);
+        __m128 ai = _mm_loadu_ps(aIm + i);
+        __m128 br = _mm_loadu_ps(bRe + i);
+        __m128 bi = _mm_loadu_ps(bIm + i);
+        __m128 re = _mm_sub_ps(_mm_mul_ps(ar, br), _mm_mul_ps(ai, bi));
+        __m128 im = _mm_add_ps(_mm_mul_ps(ar, bi), _mm_mul_ps(ai, br));
+        _mm_storeu_ps(accRe + i, _mm_add_ps(_mm_loadu_ps(accRe + i), re));
+        _mm_storeu_ps(accIm + i, _mm_add_ps(_mm_loadu_ps(accIm + i), im));
+    }
+#elif defined(EVH_SIMD_NEON)
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t ar = vld1q_f32(aRe + i);
+        float32x4_t ai = vld1q_f32(aIm + i);
+        float32x4_t br = vld1q_f32(bRe + i);
+        float32x4_t bi = vld1q_f32(bIm + i);
+        float32x4_t re = vmlsq_f32(vmlaq_f32(vld1q_f32(accRe + i), ar, br), ai, bi);
+        float32x4_t im = vmlaq_f32(vmlaq_f32(vld1q_f32(accIm + i), ar, bi), ai, br);
+        vst1q_f32(accRe + i, re);
+        vst1q_f32(accIm + i, im);
+    }
+#endif
+    
+    for (; i < n; ++i) {
+        const float re = aRe[i] * bRe[i] - aIm[i] * bIm[i];
+        const float im = aRe[i] * bIm[i] + aIm[i] * bRe[i];
+        accRe[i] += re;
+        accIm[i] += im;
+    }
+}
+
+// Double precision: half the lanes per vector, same structure. 32-bit
+// ARM NEON has no double lanes, so only AArch64 gets a vector path there.
+double dotProduct(const double* a, const double* b, int n) {
+    int i = 0;
+    double sum = 0.0;
+    
+#if defined(EVH_SIMD_AVX)
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+        acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4)));
+    }
+    acc0 = _mm256_add_pd(acc0, acc1);
+    __m128d acc = _mm_add_pd(_mm256_castpd256_pd128(acc0), _mm256_extractf128_pd(acc0, 1));
+    acc = _mm_add_sd(acc, _mm_unpackhi_pd(acc, acc));
+    sum = _mm_cvtsd_f64(acc);
+#elif defined(EVH_SIMD_SSE)
+    __m128d acc0 = _mm_setzero_pd();
+    __m128d acc1 = _mm_setzero_pd();
+    for (; i + 4 <= n; i += 4) {
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+    }
+    __m128d acc = _mm_add_pd(acc0, acc1);
+    acc = _mm_add_sd(acc, _mm_unpackhi_pd(acc, acc));
+    sum = _mm_cvtsd_f64(acc);
+#elif defined(EVH_SIMD_NEON) && defined(__aarch64__)
+    float64x2_t acc0 = vdupq_n_f64(0.0);
+    float64x2_t acc1 = vdupq_n_f64(0.0);
+    for (; i + 4 <= n; i += 4) {
+        acc0 = vfmaq_f64(acc0, vld1q_f64(a + i), vld1q_f64(b + i));
+        acc1 = vfmaq_f64(acc1, vld1q_f64(a + i + 2), vld1q_f64(b + i + 2));
+    }
+    sum = vaddvq_f64(vaddq_f64(acc0, acc1));
+#endif
+    
+    for (; i < n; ++i) {
+        sum += a[i] * b[i];
+    }
+    
+    return sum;
+}
+
+void multiply(double* data, double gain, int n) {
+    int i = 0;
+    
+#if defined(EVH_SIMD_AVX)
+    const __m256d g = _mm256_set1_pd(gain);
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(data + i, _mm256_mul_pd(_mm256_loadu_pd(data + i), g));
+    }
+#elif defined(EVH_SIMD_SSE)
+    const __m128d g = _mm_set1_pd(gain);
+    for (; i + 2 <= n; i += 2) {
+        _mm_storeu_pd(data + i, _mm_mul_pd(_mm_loadu_pd(data + i), g));
+    }
+#elif defined(EVH_SIMD_NEON) && defined(__aarch64__)
+    for (; i + 2 <= n; i += 2) {
+        vst1q_f64(data + i, vmulq_n_f64(vld1q_f64(data + i), gain));
+    }
+#endif
+    
+    for (; i < n; ++i) {
+        data[i] *= gain;
+    }
+}
+
+void multiplyRamp(double* data, double start, double step, int n) {
+    int i = 0;
+    
+#if defined(EVH_SIMD_AVX)
+    const __m256d lanes = _mm256_mul_pd(_mm256_set_pd(3, 2, 1, 0), _mm256_set1_pd(step));
+    for (; i + 4 <= n; i += 4) {
+        __m256d g = _mm256_add_pd(_mm256_set1_pd(start + step * i), lanes);
+        _mm256_storeu_pd(data + i, _mm256_mul_pd(_mm256_loadu_pd(data + i), g));
+    }
+#elif defined(EVH_SIMD_SSE)
+    const __m128d lanes = _mm_set_pd(step, 0.0);
+    for (; i + 2 <= n; i += 2) {
+        __m128d g = _mm_add_pd(_mm_set1_pd(start + step * i), lanes);
+        _mm_storeu_pd(data + i, _mm_mul_pd(_mm_loadu_pd(data + i), g));
+    }
+#elif defined(EVH_SIMD_NEON) && defined(__aarch64__)
+    const double laneValues[2] = {0.0, step};
+    const float64x2_t lanes = vld1q_f64(laneValues);
+    for (; i + 2 <= n; i += 2) {
+        float64x2_t g = vaddq_f64(vdupq_n_f64(start + step * i), lanes);
+        vst1q_f64(data + i, vmulq_f64(vld1q_f64(data + i), g));
+    }
+#endif
+    
+    for (; i < n; ++i) {
+        data[i] *= start + step * i;
+    }
+}
+
+void multiplyAdd(double* dest, const double* source, double gain, int n) {
+    int i = 0;
+    
+#if defined(EVH_SIMD_AVX)
+    const __m256d g = _mm256_set1_pd(gain);
+    for (; i + 4 <= n; i += 4) {
+        __m256d scaled = _mm256_mul_pd(_mm256_loadu_pd(source + i), g);
+        _mm256_storeu_pd(dest + i, _mm256_add_pd(_mm256_loadu_pd(dest + i), scaled));
+    }
+#elif defined(EVH_SIMD_SSE)
+    const __m128d g = _mm_set1_pd(gain);
+    for (; i + 2 <= n; i += 2) {
+        __m128d scaled = _mm_mul_pd(_mm_loadu_pd(source + i), g);
+        _mm_storeu_pd(dest + i, _mm_add_pd(_mm_loadu_pd(dest + i), scaled));
+    }
+#elif defined(EVH_SIMD_NEON) && defined(__aarch64__)
+    for (; i + 2 <= n; i += 2) {
+        vst1q_f64(dest + i, vfmaq_n_f64(vld1q_f64(dest + i), vld1q_f64(source + i), gain));
+    }
+#endif
+    
+    for (; i < n; ++i) {
+        dest[i] += source[i] * gain;
+    }
+}
+
+double peakAbs(const double* data, int n) {
+    int i = 0;
+    double peak = 0.0;
+    
+#if defined(EVH_SIMD_AVX)
+    const __m256d signMask = _mm256_set1_pd(-0.0);
+    __m256d acc = _mm256_setzero_pd();
+    for (; i + 4 <= n; i += 4) {
+        acc = _mm256_max_pd(acc, _mm256_andnot_pd(signMask, _mm256_loadu_pd(data + i)));
+    }
+    __m128d half = _mm_max_pd(_mm256_castpd256_pd128(acc), _mm256_extractf128_pd(acc, 1));
+    half = _mm_max_sd(half, _mm_unpackhi_pd(half, half));
+    peak = _mm_cvtsd_f64(half);
+#elif defined(EVH_SIMD_SSE)
+    const __m128d signMask = _mm_set1_pd(-0.0);
+    __m128d acc = _mm_setzero_pd();
+    for (; i + 2 <= n; i += 2) {
+        acc = _mm_max_pd(acc, _mm_andnot_pd(signMask, _mm_loadu_pd(data + i)));
+    }
+    acc = _mm_max_sd(acc, _mm_unpackhi_pd(acc, acc));
+    peak = _mm_cvtsd_f64(acc);
+#elif defined(EVH_SIMD_NEON) && defined(__aarch64__)
+    float64x2_t acc = vdupq_n_f64(0.0);
+    for (; i + 2 <= n; i += 2) {
+        acc = vmaxq_f64(acc, vabsq_f64(vld1q_f64(data + i)));
+    }
+    peak = vmaxvq_f64(acc);
+#endif
+    
+    for (; i < n; ++i) {
+        peak = std::max(peak, std::fabs(data[i]));
+    }
+    
+    return peak;
+}
+
+void convert(const float* source, double* dest, int n) {
+    int i = 0;
+    
+#if defined(EVH_SIMD_AVX)
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_pd(dest + i, _mm256_cvtps_pd(_mm_loadu_ps(source + i)));
+        _mm256_storeu_pd(dest + i + 4, _mm256_cvtps_pd(_mm_loadu_ps(source + i + 4)));
+    }
+#elif defined(EVH_SIMD_SSE)
+    for (; i + 4 <= n; i += 4) {
+        __m128 v = _mm_loadu_ps(source + i);
+        _mm_storeu_pd(dest + i, _mm_cvtps_pd(v));
+        _mm_storeu_pd(dest + i + 2, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+    }
+#elif defined(EVH_SIMD_NEON) && defined(__aarch64__)
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t v = vld1q_f32(source + i);
+        vst1q_f64(dest + i, vcvt_f64_f32(vget_low_f32(v)));
+        vst1q_f64(dest + i + 2, vcvt_high_f64_f32(v));
+    }
+#endif
+    
+    for (; i < n; ++i) {
+        dest[i] = source[i];
+    }
+}
+
+void convert(const double* source, float* dest, int n) {
+    int i = 0;
+    
+#if defined(EVH_SIMD_AVX)
+    for (; i + 8 <= n; i += 8) {
+        _mm_storeu_ps(dest + i, _mm256_cvtpd_ps(_mm256_loadu_pd(source + i)));
+        _mm_storeu_ps(dest + i + 4, _mm256_cvtpd_ps(_mm256_loadu_pd(source + i + 4)));
+    }
+#elif defined(EVH_SIMD_SSE)
+    for (; i + 4 <= n; i += 4) {
+        __m128 low = _mm_cvtpd_ps(_mm_loadu_pd(source + i));
+        __m128 high = _mm_cvtpd_ps(_mm_loadu_pd(source + i + 2));
+        _mm_storeu_ps(dest + i, _mm_movelh_ps(low, high));
+    }
+#elif defined(EVH_SIMD_NEON) && defined(__aarch64__)
+    for (; i + 4 <= n; i += 4) {
+        float32x2_t low = vcvt_f32_f64(vld1q_f64(source + i));
+        vst1q_f32(dest + i, vcvt_high_f32_f64(low, vld1q_f64(source + i + 2)));
+    }
+#endif
+    
+    for (; i < n; ++i) {
+        dest[i] = static_cast<float>(source[i]);
+    }
+}
+
+} // namespace Simd
+} // namespace EVH
@@ -1,488 +1,1817 @@
-// EnhancedVSTHost.cpp - Main implementation
-#include "EnhancedVSTHost.h"
-#include <shlwapi.h>
-#include <shellapi.h>
-#include <comdef.h>
-#include <wrl/client.h>
-#include <sstream>
-#include <fstream>
-#include <chrono>
-#include <algorithm>
-#include <VersionHelpers.h>
-
-#pragma comment(lib, "shlwapi.lib")
-#pragma comment(lib, "shell32.lib")
-#pragma comment(lib, "ole32.lib")
-#pragma comment(lib, "uuid.lib")
-
-using namespace EVH;
-using namespace Microsoft::WRL;
-
-// Helper functions
-namespace {
-    std::wstring GetErrorMessage(DWORD errorCode) {
-        LPWSTR messageBuffer = nullptr;
-        size_t size = FormatMessageW(
-            FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS,
-            NULL, errorCode, MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT),
-            (LPWSTR)&messageBuffer, 0, NULL);
-        
-        std::wstring message(messageBuffer, size);
-        LocalFree(messageBuffer);
-        
-        // Remove trailing newlines
-        message.erase(message.find_last_not_of(L"\r\n") + 1);
-        return message;
-    }
-    
-    bool IsWaves32BitPlugin(const std::wstring& path) {
-        // Special handling for Waves plugins which are notoriously problematic
-        return path.find(L"Waves") != std::wstring::npos && 
-               path.find(L"WaveShell") != std::wstring::npos;
-    }
-}
-
-// EnhancedVSTHost Implementation
-EnhancedVSTHost::EnhancedVSTHost() {
-    scanner = std::make_unique<PluginScanner>();
-    notificationMgr = std::make_unique<NotificationManager>(nullptr);
-    errorLogger = std::make_unique<ErrorLogger>(L"VSTHost.log");
-    bridge32 = std::make_unique<PluginBridge32>();
-}
-
-EnhancedVSTHost::~EnhancedVSTHost() {
-    shutdown();
-}
-
-bool EnhancedVSTHost::initialize(HWND parentWindow) {
-    this->parentWindow = parentWindow;
-    
-    // Setup high DPI support
-    setupHighDPI();
-    
-    // Initialize COM for WASAPI
-    HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
-    if (FAILED(hr) && hr != RPC_E_CHANGED_MODE) {
-        logError(L"Failed to initialize COM");
-        return false;
-    }
-    
-    // Initialize 32-bit bridge
-    if (!bridge32->initialize()) {
-        logError(L"Failed to initialize 32-bit plugin bridge");
-        // Don't fail completely, just disable 32-bit support
-    }
-    
-    // Load blacklist from file
-    std::wifstream blacklistFile(L"blacklist.txt");
-    if (blacklistFile.is_open()) {
-        std::wstring line;
-        while (std::getline(blacklistFile, line)) {
-            if (!line.empty()) {
-                blacklistedPlugins.insert(line);
-            }
-        }
-        blacklistFile.close();
-    }
-    
-    return true;
-}
-
-void EnhancedVSTHost::shutdown() {
-    // Stop audio first
-    stopAudio();
-    
-    // Unload all plugins
-    unloadAllPlugins();
-    
-    // Shutdown components
-    if (bridge32) {
-        bridge32->shutdown();
-    }
-    
-    // Save blacklist
-    std::wofstream blacklistFile(L"blacklist.txt");
-    if (blacklistFile.is_open()) {
-        for (const auto& plugin : blacklistedPlugins) {
-            blacklistFile << plugin << L"\n";
-        }
-        blacklistFile.close();
-    }
-    
-    CoUninitialize();
-}
-
-void EnhancedVSTHost::scanPlugins(const std::vector<std::wstring>& searchPaths) {
-    std::vector<PluginInfo> foundPlugins;
-    int totalScanned = 0;
-    
-    auto onPluginFound = [&](const PluginInfo& info) {
-        if (!isBlacklisted(info.path)) {
-            foundPlugins.push_back(info);
-        }
-    };
-    
-    auto onProgress = [&](int current, int total, const std::wstring& currentPlugin) {
-        totalScanned = total;
-        if (scanProgressCb) {
-            scanProgressCb(current, total, currentPlugin);
-        }
-    };
-    
-    for (const auto& path : searchPaths) {
-        scanner->scanDirectory(path, onPluginFound, onProgress);
-    }
-    
-    // Store found plugins (in real implementation, would store in a database)
-    errorLogger->logError(L"Plugin scan complete. Found " + 
-                         std::to_wstring(foundPlugins.size()) + 
-                         L" plugins out of " + 
-                         std::to_wstring(totalScanned) + L" scanned.");
-}
-
-bool EnhancedVSTHost::loadPlugin(const std::wstring& path) {
-    if (isBlacklisted(path)) {
-        logError(L"Plugin is blacklisted: " + path);
-        return false;
-    }
-    
-    // Validate plugin first
-    if (!validatePlugin(path)) {
-        logError(L"Plugin validation failed: " + path);
-        return false;
-    }
-    
-    // Get plugin info
-    PluginInfo info;
-    if (!scanner->scanPluginInProcess(path, info)) {
-        logError(L"Failed to scan plugin: " + path);
-        return false;
-    }
-    
-    // Create plugin instance
-    auto instance = createPluginInstance(info);
-    if (!instance) {
-        logError(L"Failed to create plugin instance: " + path);
-        return false;
-    }
-    
-    // Load the plugin
-    try {
-        if (!instance->load()) {
-            logError(L"Failed to load plugin: " + path);
-            return false;
-        }
-    } catch (const std::exception& e) {
-        logError(L"Exception loading plugin: " + 
-                std::wstring(e.what(), e.what() + strlen(e.what())));
-        return false;
-    }
-    
-    // Add to loaded plugins
-    int pluginId = nextPluginId++;
-    {
-        std::lock_guard<std::mutex> lock(pluginMutex);
-        loadedPlugins[pluginId] = std::move(instance);
-    }
-    
-    return true;
-}
-
-void EnhancedVSTHost::unloadPlugin(int pluginId) {
-    std::lock_guard<std::mutex> lock(pluginMutex);
-    
-    auto it = loadedPlugins.find(pluginId);
-    if (it != loadedPlugins.end()) {
-        try {
-            it->second->unload();
-        } catch (const std::exception& e) {
-            logError(L"Exception unloading plugin: " + 
-                    std::wstring(e.what(), e.what() + strlen(e.what())));
-        }
-        loadedPlugins.erase(it);
-    }
-    
-    // Remove from chain
-    auto chainIt = std::find(pluginChain.begin(), pluginChain.end(), pluginId);
-    if (chainIt != pluginChain.end()) {
-        pluginChain.erase(chainIt);
-    }
-}
-
-void EnhancedVSTHost::unloadAllPlugins() {
-    std::lock_guard<std::mutex> lock(pluginMutex);
-    
-    for (auto& [id, plugin] : loadedPlugins) {
-        try {
-            plugin->unload();
-        } catch (...) {
-            // Ignore exceptions during shutdown
-        }
-    }
-    
-    loadedPlugins.clear();
-    pluginChain.clear();
-}
-
-bool EnhancedVSTHost::startAudio(AudioDriverType driverType) {
-    if (audioRunning.load()) {
-        return true;
-    }
-    
-    // For now, only support WASAPI
-    if (driverType != AudioDriverType::WASAPI) {
-        logError(L"Only WASAPI audio driver is currently supported");
-        return false;
-    }
-    
-    // Create audio engine
-    audioEngine = std::make_unique<WASAPIEngine>();
-    
-    // Initialize audio engine
-    if (!audioEngine->initialize(currentSampleRate, currentBufferSize)) {
-        logError(L"Failed to initialize audio engine");
-        audioEngine.reset();
-        return false;
-    }
-    
-    // Set audio callback
-    audioEngine->setAudioCallback([this](const float** inputs, float** outputs, int numSamples) {
-        // Process audio through plugin chain
-        std::lock_guard<std::mutex> lock(pluginMutex);
-        
-        // Clear output buffers
-        for (int ch = 0; ch < 2; ++ch) {
-            std::fill_n(outputs[ch], numSamples, 0.0f);
-        }
-        
-        // Copy input to output for now (pass-through)
-        for (int ch = 0; ch < 2; ++ch) {
-            if (inputs && inputs[ch]) {
-                std::copy_n(inputs[ch], numSamples, outputs[ch]);
-            }
-        }
-        
-        // Process through each plugin in chain
-        for (int pluginId : pluginChain) {
-            auto it = loadedPlugins.find(pluginId);
-            if (it != loadedPlugins.end() && !it->second->isBypassed()) {
-                try {
-                    it->second->processReplacing(
-                        const_cast<float**>(outputs),  // Use output as input for chain
-                        outputs, 
-                        numSamples
-                    );
-                } catch (const std::exception& e) {
-                    handlePluginCrash(pluginId);
-                }
-            }
-        }
-    });
-    
-    // Start audio
-    if (!audioEngine->start()) {
-        logError(L"Failed to start audio engine");
-        audioEngine.reset();
-        return false;
-    }
-    
-    audioRunning = true;
-    currentDriverType = driverType;
-    return true;
-}
-
-void EnhancedVSTHost::stopAudio() {
-    if (!audioRunning.load()) {
-        return;
-    }
-    
-    audioRunning = false;
-    
-    if (audioEngine) {
-        audioEngine->stop();
-        audioEngine->shutdown();
-        audioEngine.reset();
-    }
-}
-
-void EnhancedVSTHost::addPluginToChain(int pluginId) {
-    std::lock_guard<std::mutex> lock(pluginMutex);
-    
-    if (loadedPlugins.find(pluginId) != loadedPlugins.end()) {
-        // Check if already in chain
-        if (std::find(pluginChain.begin(), pluginChain.end(), pluginId) == pluginChain.end()) {
-            pluginChain.push_back(pluginId);
-        }
-    }
-}
-
-void EnhancedVSTHost::removePluginFromChain(int pluginId) {
-    std::lock_guard<std::mutex> lock(pluginMutex);
-    
-    auto it = std::find(pluginChain.begin(), pluginChain.end(), pluginId);
-    if (it != pluginChain.end()) {
-        pluginChain.erase(it);
-    }
-}
-
-void EnhancedVSTHost::movePluginInChain(int pluginId, int newPosition) {
-    std::lock_guard<std::mutex> lock(pluginMutex);
-    
-    auto it = std::find(pluginChain.begin(), pluginChain.end(), pluginId);
-    if (it != pluginChain.end()) {
-        pluginChain.erase(it);
-        
-        if (newPosition >= 0 && newPosition <= static_cast<int>(pluginChain.size())) {
-            pluginChain.insert(pluginChain.begin() + newPosition, pluginId);
-        } else {
-            pluginChain.push_back(pluginId);
-        }
-    }
-}
-
-void EnhancedVSTHost::bypassPlugin(int pluginId, bool bypass) {
-    std::lock_guard<std::mutex> lock(pluginMutex);
-    
-    auto it = loadedPlugins.find(pluginId);
-    if (it != loadedPlugins.end()) {
-        it->second->setBypass(bypass);
-    }
-}
-
-void EnhancedVSTHost::setSampleRate(double rate) {
-    if (audioRunning.load()) {
-        stopAudio();
-        currentSampleRate = rate;
-        startAudio(currentDriverType);
-    } else {
-        currentSampleRate = rate;
-    }
-}
-
-void EnhancedVSTHost::setBufferSize(int size) {
-    if (audioRunning.load()) {
-        stopAudio();
-        currentBufferSize = size;
-        startAudio(currentDriverType);
-    } else {
-        currentBufferSize = size;
-    }
-}
-
-void EnhancedVSTHost::addToBlacklist(const std::wstring& pluginPath) {
-    std::lock_guard<std::mutex> lock(blacklistMutex);
-    blacklistedPlugins.insert(pluginPath);
-}
-
-void EnhancedVSTHost::removeFromBlacklist(const std::wstring& pluginPath) {
-    std::lock_guard<std::mutex> lock(blacklistMutex);
-    blacklistedPlugins.erase(pluginPath);
-}
-
-bool EnhancedVSTHost::isBlacklisted(const std::wstring& pluginPath) const {
-    std::lock_guard<std::mutex> lock(blacklistMutex);
-    return blacklistedPlugins.find(pluginPath) != blacklistedPlugins.end();
-}
-
-std::vector<std::wstring> EnhancedVSTHost::getRecentErrors() const {
-    return errorLogger->getRecentErrors();
-}
-
-void EnhancedVSTHost::clearErrors() {
-    errorLogger->clearLog();
-}
-
-void EnhancedVSTHost::setupHighDPI() {
-    if (IsWindows8Point1OrGreater()) {
-        // SetProcessDpiAwareness would be better but requires Windows 8.1 SDK
-        SetProcessDPIAware();
-        highDpiAware = true;
-    } else {
-        SetProcessDPIAware();
-    }
-}
-
-void EnhancedVSTHost::handlePluginCrash(int pluginId) {
-    auto it = loadedPlugins.find(pluginId);
-    if (it != loadedPlugins.end()) {
-        std::wstring pluginName = it->second->getInfo().name;
-        
-        // Log the crash
-        errorLogger->logPluginCrash(pluginName, L"Plugin crashed during audio processing");
-        
-        // Show notification
-        notificationMgr->showPluginCrashNotification(pluginName);
-        
-        // Remove from chain
-        removePluginFromChain(pluginId);
-        
-        // Call crash callback
-        if (crashCb) {
-            crashCb(pluginId, pluginName);
-        }
-    }
-}
-
-void EnhancedVSTHost::logError(const std::wstring& error) {
-    errorLogger->logError(error);
-    
-    if (errorCb) {
-        errorCb(error);
-    }
-}
-
-bool EnhancedVSTHost::validatePlugin(const std::wstring& path) {
-    // Check if file exists
-    if (!PathFileExistsW(path.c_str())) {
-        return false;
-    }
-    
-    // Check if it's a DLL or VST3
-    std::wstring ext = PathFindExtensionW(path.c_str());
-    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
-    if (ext != L".dll" && ext != L".vst3") {
-        return false;
-    }
-    
-    // Try to load the DLL to check for corruption
-    HMODULE hModule = LoadLibraryExW(path.c_str(), nullptr, 
-                                     DONT_RESOLVE_DLL_REFERENCES | 
-                                     LOAD_LIBRARY_AS_DATAFILE);
-    if (!hModule) {
-        return false;
-    }
-    
-    FreeLibrary(hModule);
-    return true;
-}
-
-std::unique_ptr<PluginInstance> EnhancedVSTHost::createPluginInstance(const PluginInfo& info) {
-    return std::make_unique<PluginInstance>(info);
-}
-
-std::vector<EVH::PluginInfo> EnhancedVSTHost::getAvailablePlugins() const {
-    // This would return the list of scanned plugins from a database
-    // For now, return empty vector
-    return std::vector<EVH::PluginInfo>();
-}
-
-EVH::PluginInfo EnhancedVSTHost::getPluginInfo(int pluginId) const {
-    std::lock_guard<std::mutex> lock(pluginMutex);
-    
-    auto it = loadedPlugins.find(pluginId);
-    if (it != loadedPlugins.end()) {
-        return it->second->getInfo();
-    }
-    
-    return EVH::PluginInfo();
-}
-
-void EnhancedVSTHost::setAudioDriver(AudioDriverType type) {
-    if (audioRunning) {
-        stopAudio();
-        currentDriverType = type;
-        startAudio(type);
-    } else {
-        currentDriverType = type;
-    }
+// EnhancedVSTHost.cpp - Main implementation
+#include "EnhancedVSTHost.h"
+#include <sstream>
+#include <fstream>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <cwctype>
+#include <future>
+#include <deque>
+#include <cstdio>
+
+#ifdef _WIN32
+#include <shellapi.h>
+#include <comdef.h>
+#include <VersionHelpers.h>
+
+#pragma comment(lib, "shell32.lib")
+#pragma comment(lib, "ole32.lib")
+#pragma comment(lib, "uuid.lib")
+#endif
+
+using namespace EVH;
+
+namespace fs = std::filesystem;
+
+// Helper functions
+namespace {
+    bool IsWaves32BitPlugin(const std::wstring& path) {
+        // Special handling for Waves plugins which are notoriously problematic
+        return path.find(L"Waves") != std::wstring::npos && 
+               path.find(L"WaveShell") != std::wstring::npos;
+    }
+    
+    // Histogram bucket bounds for scrapes (50 us .. 100 ms)
+    constexpr uint64_t METRICS_BUCKETS_NS[] = {
+        50000, 100000, 250000, 500000, 1000000, 2500000,
+        5000000, 10000000, 25000000, 50000000, 100000000
+    };
+    constexpr int NUM_METRICS_BUCKETS = sizeof(METRICS_BUCKETS_NS) / sizeof(METRICS_BUCKETS_NS[0]);
+    
+    // Prometheus text exposition format, one metric family at a time
+    class MetricsWriter {
+    public:
+        void family(const char* name, const char* type, const char* help) {
+            text += std::string("# HELP ") + name + " " + help + "\n";
+            text += std::string("# TYPE ") + name + " " + type + "\n";
+        }
+        
+        void sample(const std::string& name, double value, const std::string& labels = {}) {
+            char number[32];
+            std::snprintf(number, sizeof(number), "%.9g", value);
+            line(name, labels, number);
+        }
+        
+        void sample(const std::string& name, uint64_t value, const std::string& labels = {}) {
+            line(name, labels, std::to_string(value));
+        }
+        
+        // Lifetime histogram in seconds
+        void histogram(const char* name, const char* help, const LatencyHistogram& histogram) {
+            family(name, "histogram", help);
+            
+            uint64_t cumulative[NUM_METRICS_BUCKETS];
+            uint64_t count = histogram.getTotalCount();
+            uint64_t sumNs = histogram.getTotalNs();
+            histogram.cumulativeCounts(METRICS_BUCKETS_NS, NUM_METRICS_BUCKETS, cumulative);
+            
+            for (int i = 0; i < NUM_METRICS_BUCKETS; ++i) {
+                char bound[32];
+                std::snprintf(bound, sizeof(bound), "%g", METRICS_BUCKETS_NS[i] / 1e9);
+                // Recorded concurrently: never report more than the total
+                sample(std::string(name) + "_bucket", std::min(cumulative[i], count), std::string("le=\"") + bound + "\"");
+            }
+            sample(std::string(name) + "_bucket", count, "le=\"+Inf\"");
+            sample(std::string(name) + "_sum", sumNs / 1e9);
+            sample(std::string(name) + "_count", count);
+        }
+        
+        static std::string label(const char* key, const std::string& value) {
+            std::string escaped;
+            for (char c : value) {
+                if (c == '\\' || c == '"') {
+                    escaped += '\\';
+                    escaped += c;
+                } else if (c == '\n') {
+                    escaped += "\\n";
+                } else {
+                    escaped += c;
+                }
+            }
+            return std::string(key) + "=\"" + escaped + "\"";
+        }
+        
+        const std::string& getText() const { return text; }
+        
+    private:
+        std::string text;
+        
+        void line(const std::string& name, const std::string& labels, const std::string& value) {
+            text += name;
+            if (!labels.empty()) {
+                text += "{" + labels + "}";
+            }
+            text += " " + value + "\n";
+        }
+    };
+}
+
+// EnhancedVSTHost Implementation
+EnhancedVSTHost::EnhancedVSTHost(EVH::HostMode mode)
+    : hostMode(mode) {
+    scanner = std::make_unique<PluginScanner>();
+    notificationMgr = std::make_unique<NotificationManager>(nullptr);
+    errorLogger = std::make_unique<ErrorLogger>(mode == EVH::HostMode::Headless ? L"" : L"VSTHost.log");
+    bridge32 = std::make_unique<PluginBridge32>();
+}
+
+EnhancedVSTHost::~EnhancedVSTHost() {
+    shutdown();
+}
+
+bool EnhancedVSTHost::initialize(EVH::WindowHandle parentWindow) {
+    this->parentWindow = parentWindow;
+    
+#ifdef _WIN32
+    // Setup high DPI support
+    setupHighDPI();
+    
+    // Initialize COM for WASAPI
+    HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+    if (FAILED(hr) && hr != RPC_E_CHANGED_MODE) {
+        logError(L"Failed to initialize COM");
+        return false;
+    }
+    
+    // Initialize 32-bit bridge
+    if (!bridge32->initialize()) {
+        logError(L"Failed to initialize 32-bit plugin bridge");
+        // Don't fail completely, just disable 32-bit support
+    }
+#endif
+    
+    // Load blacklist from file
+    std::wifstream blacklistFile;
+    if (hostMode == EVH::HostMode::Application) {
+        blacklistFile.open(fs::path(L"blacklist.txt"));
+        blacklistLoaded = true;
+    }
+    if (blacklistFile.is_open()) {
+        std::wstring line;
+        while (std::getline(blacklistFile, line)) {
+            if (!line.empty()) {
+                blacklistedPlugins.insert(line);
+            }
+        }
+        blacklistFile.close();
+    }
+    
+    return true;
+}
+
+void EnhancedVSTHost::shutdown() {
+    // Stop audio first
+    stopMetricsServer();
+    setAdaptiveBufferSize(false);
+    stopAudio();
+    stopSpectrumThread();
+    unfreezeChain();
+    
+    // Unload all plugins
+    unloadAllPlugins();
+    
+    // Shutdown components
+    if (bridge32) {
+        bridge32->shutdown();
+    }
+    
+    // Save blacklist, only over the file initialize() read; a host that never
+    // loaded it would replace the user's list with an empty one
+    std::wofstream blacklistFile;
+    if (blacklistLoaded) {
+        blacklistFile.open(fs::path(L"blacklist.txt"));
+    }
+    if (blacklistFile.is_open()) {
+        for (const auto& plugin : blacklistedPlugins) {
+            blacklistFile << plugin << L"\n";
+        }
+        blacklistFile.close();
+    }
+    
+#ifdef _WIN32
+    CoUninitialize();
+#endif
+}
+
+void EnhancedVSTHost::scanPlugins(const std::vector<std::wstring>& searchPaths) {
+    std::vector<PluginInfo> foundPlugins;
+    int totalScanned = 0;
+    
+    uint64_t filesBefore = scannedFiles.load();
+    auto scanStart = std::chrono::steady_clock::now();
+    scanRunning = true;
+    
+    auto onPluginFound = [&](const PluginInfo& info) {
+        if (!isBlacklisted(info.path)) {
+            foundPlugins.push_back(info);
+            scanPluginsFound.fetch_add(1);
+        }
+    };
+    
+    auto onProgress = [&](int current, int total, const std::wstring& currentPlugin) {
+        totalScanned = total;
+        scanPosition = current;
+        scanDirectoryFiles = total;
+        scannedFiles.fetch_add(1);
+        if (scanProgressCb) {
+            scanProgressCb(current, total, currentPlugin);
+        }
+    };
+    
+    for (const auto& path : searchPaths) {
+        scanner->scanDirectory(path, onPluginFound, onProgress);
+    }
+    
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - scanStart).count();
+    scanSeconds = scanSeconds.load() + seconds;
+    if (seconds > 0.0) {
+        lastScanFilesPerSecond = (scannedFiles.load() - filesBefore) / seconds;
+    }
+    scanRunning = false;
+    
+    // Store found plugins (in real implementation, would store in a database)
+    errorLogger->logError(L"Plugin scan complete. Found " + 
+                         std::to_wstring(foundPlugins.size()) + 
+                         L" plugins out of " + 
+                         std::to_wstring(totalScanned) + L" scanned.");
+}
+
+bool EnhancedVSTHost::loadPlugin(const std::wstring& path) {
+    return loadPluginFile(path) != 0;
+}
+
+int EnhancedVSTHost::loadPluginFile(const std::wstring& path) {
+    if (isBlacklisted(path)) {
+        logError(L"Plugin is blacklisted: " + path);
+        return 0;
+    }
+    
+    // Validate plugin first
+    if (!validatePlugin(path)) {
+        logError(L"Plugin validation failed: " + path);
+        return 0;
+    }
+    
+    // Get plugin info
+    PluginInfo info;
+    if (!scanner->scanPluginInProcess(path, info)) {
+        logError(L"Failed to scan plugin: " + path);
+        return 0;
+    }
+    
+    // Create plugin instance
+    auto instance = createPluginInstance(info);
+    if (!instance) {
+        logError(L"Failed to create plugin instance: " + path);
+        return 0;
+    }
+    
+    // Load the plugin
+    try {
+        if (!instance->load()) {
+            logError(L"Failed to load plugin: " + path);
+            return 0;
+        }
+    } catch (const std::exception& e) {
+        logError(L"Exception loading plugin: " + 
+                std::wstring(e.what(), e.what() + strlen(e.what())));
+        return 0;
+    }
+    
+    // Add to loaded plugins, prepared for the current setup
+    int pluginId = nextPluginId++;
+    {
+        std::lock_guard<std::mutex> reconfigLock(reconfigureMutex);
+        instance->prepare({currentSampleRate, currentBufferSize, numChainChannels, processPrecision});
+        instance->commitPreparedSetup();
+        
+        std::lock_guard<std::mutex> lock(pluginMutex);
+        loadedPlugins[pluginId] = std::move(instance);
+        recordSessionEvent({SessionEvent::Type::Load, 0, pluginId, 0, 0.0, info.path});
+    }
+    
+    return pluginId;
+}
+
+int EnhancedVSTHost::loadProcessor(std::unique_ptr<EVH::AudioProcessor> processor) {
+    if (!processor) {
+        return 0;
+    }
+    
+    PluginInfo info;
+    info.name = processor->getName();
+    info.path = L"processor:" + info.name;
+    info.vendor = L"EnhancedVSTHost";
+    info.type = PluginType::Unknown;
+    info.is64Bit = (sizeof(void*) == 8);
+    info.hasCustomEditor = false;
+    info.numInputs = numChainChannels;
+    info.numOutputs = numChainChannels;
+    info.uniqueId = 0;
+    info.isInstrument = false;
+    info.validated = true;
+    
+    auto instance = std::make_unique<PluginInstance>(info, std::move(processor));
+    if (!instance->load()) {
+        logError(L"Failed to load processor: " + info.name);
+        return 0;
+    }
+    
+    // Add to loaded plugins, prepared for the current setup
+    int pluginId = nextPluginId++;
+    {
+        std::lock_guard<std::mutex> reconfigLock(reconfigureMutex);
+        if (!instance->prepare({currentSampleRate, currentBufferSize, numChainChannels, processPrecision})) {
+            logError(L"Failed to prepare processor: " + info.name);
+            return 0;
+        }
+        instance->commitPreparedSetup();
+        
+        std::lock_guard<std::mutex> lock(pluginMutex);
+        loadedPlugins[pluginId] = std::move(instance);
+        recordSessionEvent({SessionEvent::Type::Load, 0, pluginId, 0, 0.0, info.path});
+    }
+    
+    return pluginId;
+}
+
+void EnhancedVSTHost::unloadPlugin(int pluginId) {
+    std::lock_guard<std::mutex> reconfigLock(reconfigureMutex);
+    std::lock_guard<std::mutex> lock(pluginMutex);
+    recordSessionEvent({SessionEvent::Type::Unload, 0, pluginId});
+    
+    auto it = loadedPlugins.find(pluginId);
+    if (it != loadedPlugins.end()) {
+        try {
+            it->second->unload();
+        } catch (const std::exception& e) {
+            logError(L"Exception unloading plugin: " + 
+                    std::wstring(e.what(), e.what() + strlen(e.what())));
+        }
+        loadedPlugins.erase(it);
+    }
+    
+    // Remove from chain
+    auto chainIt = std::find(pluginChain.begin(), pluginChain.end(), pluginId);
+    if (chainIt != pluginChain.end()) {
+        pluginChain.erase(chainIt);
+    }
+}
+
+void EnhancedVSTHost::unloadAllPlugins() {
+    std::lock_guard<std::mutex> reconfigLock(reconfigureMutex);
+    std::lock_guard<std::mutex> lock(pluginMutex);
+    recordSessionEvent({SessionEvent::Type::UnloadAll});
+    
+    for (auto& [id, plugin] : loadedPlugins) {
+        try {
+            plugin->unload();
+        } catch (...) {
+            // Ignore exceptions during shutdown
+        }
+    }
+    
+    loadedPlugins.clear();
+    pluginChain.clear();
+}
+
+bool EnhancedVSTHost::startAudio(AudioDriverType driverType) {
+    if (audioRunning.load()) {
+        return true;
+    }
+    
+    // Create audio engine
+    if (!startAudio(createAudioEngine(driverType))) {
+        return false;
+    }
+    
+    currentDriverType = driverType;
+    return true;
+}
+
+bool EnhancedVSTHost::startAudio(std::unique_ptr<AudioEngine> engine) {
+    if (audioRunning.load() || offlineRendering.load() || !engine) {
+        return false;
+    }
+    
+    // Like a driver switch, so readers of the engine see it whole
+    std::lock_guard<std::mutex> reconfigLock(reconfigureMutex);
+    audioEngine = std::move(engine);
+    audioEngine->setThreadPolicy(audioThreadPolicy);
+    chainPosition = 0;
+    
+    // Initialize audio engine
+    if (!audioEngine->initialize(currentSampleRate, currentBufferSize)) {
+        logError(L"Failed to initialize audio engine");
+        audioEngine.reset();
+        return false;
+    }
+    
+    // Set audio callback
+    installAudioCallback(*audioEngine);
+    renderAhead = createRenderAheadFifo(audioEngine->getBufferSize());
+    
+    // The device may use larger blocks or more channels than plugins were
+    // loaded with; nothing is processing yet, so commit right away
+    int maxBlockSize = std::max(currentBufferSize.load(), audioEngine->getBufferSize());
+    preparePluginsInParallel({currentSampleRate, maxBlockSize, numChainChannels, processPrecision});
+    commitPreparedPlugins();
+    allocatePrecisionBuffers(maxBlockSize);
+    resetLatencyWindow();
+    
+    // Start audio
+    if (!audioEngine->start()) {
+        logError(L"Failed to start audio engine");
+        audioEngine.reset();
+        renderAhead.reset();
+        return false;
+    }
+    
+    audioRunning = true;
+    startRenderAhead();
+    return true;
+}
+
+std::unique_ptr<AudioEngine> EnhancedVSTHost::createAudioEngine(AudioDriverType driverType) {
+    std::unique_ptr<AudioEngine> engine;
+    
+    switch (driverType) {
+#ifdef _WIN32
+        case AudioDriverType::WASAPI:
+            engine = std::make_unique<WASAPIEngine>();
+            break;
+#endif
+        case AudioDriverType::Null:
+            engine = std::make_unique<NullEngine>();
+            break;
+#ifdef _WIN32
+        case AudioDriverType::Aggregate: {
+            if (aggregateDevices.empty()) {
+                logError(L"No devices configured for the aggregate driver");
+                return nullptr;
+            }
+            
+            auto aggregate = std::make_unique<AggregateEngine>(aggregateRouting);
+            for (const auto& name : aggregateDevices) {
+                auto device = std::make_unique<WASAPIEngine>();
+                if (!name.empty()) {
+                    device->selectDevice(name);
+                }
+                aggregate->addDevice(std::move(device));
+            }
+            engine = std::move(aggregate);
+            break;
+        }
+        default:
+            logError(L"Only WASAPI, Null and Aggregate audio drivers are currently supported");
+            return nullptr;
+#else
+        default:
+            logError(L"Only the Null audio driver is available on this platform");
+            return nullptr;
+#endif
+    }
+    
+    // Device input when enabled; the null engine takes the capture source
+    engine->setThreadPolicy(audioThreadPolicy);
+    engine->setCaptureEnabled(inputEnabled);
+    if (driverType == AudioDriverType::Null) {
+        engine->setCaptureSource(captureSource);
+    }
+    
+    return engine;
+}
+
+void EnhancedVSTHost::installAudioCallback(AudioEngine& engine) {
+    // Aggregate engines expose more than the stereo pair
+    numChainChannels = std::min(engine.getNumOutputChannels(), EVH::MAX_CHANNELS);
+    
+    // The chain always runs at the session rate; convert if the device differs
+    resampler = createResampler(engine);
+    
+    engine.setAudioCallback(RenderCallback::bind<&EnhancedVSTHost::handleAudioBlock>(this));
+}
+
+void EnhancedVSTHost::handleAudioBlock(const float** inputs, float** outputs, int numSamples,
+                                       const EVH::ProcessContext& context) {
+    auto callbackStart = std::chrono::steady_clock::now();
+    deviceClockRatio.store(context.clockRatio, std::memory_order_relaxed);
+    
+    // Lateness against one block period after the previous wakeup. The
+    // engine's smoothed clock lags for seconds after a phase jump, so it is
+    // not the reference; discontinuities (start, switch, xrun) are skipped.
+    int64_t startNs = std::chrono::duration_cast<std::chrono::nanoseconds>(callbackStart.time_since_epoch()).count();
+    if (context.samplePosition == expectedDevicePosition) {
+        wakeupHistogram.record(static_cast<uint64_t>(std::max<int64_t>(0, startNs - expectedWakeupNs)));
+    }
+    expectedDevicePosition = context.samplePosition + numSamples;
+    expectedWakeupNs = startNs + static_cast<int64_t>(numSamples * 1e9 / context.sampleRate);
+    
+    ScopedRealtimeSection realtime;
+    ScopedDenormalDisable noDenormals(denormalProtection.load(std::memory_order_relaxed));
+    
+    if (renderAhead) {
+        pullRenderAhead(*renderAhead, outputs, numSamples);
+    } else {
+        renderDeviceBlock(inputs, outputs, numSamples, context);
+    }
+    
+    // Took longer than the audio it produced
+    auto elapsed = std::chrono::steady_clock::now() - callbackStart;
+    callbackHistogram.record(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    if (std::chrono::duration<double>(elapsed).count() * context.sampleRate > numSamples) {
+        callbackOverruns.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void EnhancedVSTHost::renderDeviceBlock(const float** inputs, float** outputs, int numSamples,
+                                        const EVH::ProcessContext& deviceContext) {
+    if (resampler) {
+        // The chain runs at the session rate and is heard after the converters
+        EVH::ProcessContext context = deviceContext;
+        context.sampleRate = currentSampleRate;
+        context.outputLatencySamples = static_cast<int>(
+            (deviceContext.outputLatencySamples + resampler->getLatencyFrames()) *
+            currentSampleRate / deviceContext.sampleRate);
+        
+        resampler->process(inputs, outputs, numSamples,
+            [this, &context](const float** in, float** out, int n) { processChain(in, out, n, context); });
+    } else {
+        processChain(inputs, outputs, numSamples, deviceContext);
+    }
+}
+
+std::unique_ptr<EVH::ResamplingAdapter> EnhancedVSTHost::createResampler(const AudioEngine& engine) {
+    double deviceRate = engine.getSampleRate();
+    if (std::abs(deviceRate - currentSampleRate) < 0.5) {
+        return nullptr;
+    }
+    
+    logError(L"Device runs at " + std::to_wstring(static_cast<int>(deviceRate)) +
+        L" Hz, resampling from session rate " + std::to_wstring(static_cast<int>(currentSampleRate)) + L" Hz");
+    
+    return std::make_unique<EVH::ResamplingAdapter>(numChainChannels, currentSampleRate, deviceRate,
+                                                    currentBufferSize, engine.getBufferSize(),
+                                                    resamplerQuality);
+}
+
+void EnhancedVSTHost::processChain(const float** inputs, float** outputs, int numSamples,
+                                   const EVH::ProcessContext& context) {
+    // Process audio through plugin chain
+    std::lock_guard<std::mutex> lock(pluginMutex);
+    
+    // Positions count session frames; timing comes from the device block
+    EVH::ProcessContext chainContext = context;
+    chainContext.samplePosition = chainPosition;
+    chainPosition += numSamples;
+    framesProcessed.store(framesProcessed.load(std::memory_order_relaxed) + numSamples, std::memory_order_relaxed);
+    
+    const bool diagnose = denormalDiagnostics.load(std::memory_order_relaxed);
+    auto chainStart = diagnose ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+    
+    // Clear output buffers
+    for (int ch = 0; ch < numChainChannels; ++ch) {
+        std::fill_n(outputs[ch], numSamples, 0.0f);
+    }
+    
+    // A frozen chain plays its render instead; its plugins are suspended
+    if (freezePlayer) {
+        freezePlayer->read(outputs, numChainChannels, numSamples);
+        runTaps(EVH::MeterTap::Point::ChainOutput, 0, outputs, numSamples);
+        return;
+    }
+    
+    if (processPrecision == EVH::ProcessPrecision::Double && doubleChain &&
+        doubleChain->getNumChannels() >= numChainChannels) {
+        processChainDouble(inputs, outputs, numSamples, chainContext);
+    } else {
+        processChainSingle(inputs, outputs, numSamples, chainContext);
+    }
+    
+    if (diagnose) {
+        std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - chainStart;
+        updateDenormalDiagnostics(outputs, numSamples, elapsed.count());
+    }
+}
+
+void EnhancedVSTHost::processChainSingle(const float** inputs, float** outputs, int numSamples,
+                                         const EVH::ProcessContext& chainContext) {
+    // Copy input to output for now (pass-through); input is stereo
+    for (int ch = 0; ch < std::min(numChainChannels, 2); ++ch) {
+        if (inputs && inputs[ch]) {
+            std::copy_n(inputs[ch], numSamples, outputs[ch]);
+        }
+    }
+    runTaps(EVH::MeterTap::Point::ChainInput, 0, outputs, numSamples);
+    
+    // Process through each plugin in chain; each is timed on its own, without
+    // the taps around it
+    for (int pluginId : pluginChain) {
+        auto it = loadedPlugins.find(pluginId);
+        if (it != loadedPlugins.end() && !it->second->isBypassed()) {
+            auto pluginStart = std::chrono::steady_clock::now();
+            try {
+                it->second->setProcessContext(chainContext);
+                it->second->processReplacing(
+                    const_cast<float**>(outputs),  // Use output as input for chain
+                    outputs, 
+                    numSamples
+                );
+            } catch (const std::exception& e) {
+                handlePluginCrash(pluginId);
+            }
+            
+            auto pluginEnd = std::chrono::steady_clock::now();
+            it->second->getProcessHistogram().record(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(pluginEnd - pluginStart).count());
+        }
+        runTaps(EVH::MeterTap::Point::AfterPlugin, pluginId, outputs, numSamples);
+    }
+    runTaps(EVH::MeterTap::Point::ChainOutput, 0, outputs, numSamples);
+}
+    
+// The device side stays float: inputs are widened on the way in and the
+// outputs narrowed on the way out. In between, 64-bit plugins and nodes run
+// on the double buffers and the rest on a converted float copy.
+void EnhancedVSTHost::processChainDouble(const float** inputs, float** outputs, int numSamples,
+                                         const EVH::ProcessContext& chainContext) {
+    double** chain = doubleChain->getWritePointer();
+    float** scratch = floatScratch->getWritePointer();
+    const int capacity = doubleChain->getNumSamples();
+    
+    // Taps read float; only blocks somebody taps are converted
+    auto tapChain = [&](EVH::MeterTap::Point point, int pluginId, int length) {
+        if (hasTap(point, pluginId)) {
+            for (int ch = 0; ch < numChainChannels; ++ch) {
+                EVH::Simd::convert(chain[ch], scratch[ch], length);
+            }
+            runTaps(point, pluginId, scratch, length);
+        }
+    };
+    
+    // Blocks beyond the buffers (after a switch to a larger size) go in pieces
+    for (int offset = 0; offset < numSamples; offset += capacity) {
+        const int length = std::min(capacity, numSamples - offset);
+        EVH::ProcessContext pieceContext = chainContext;
+        pieceContext.samplePosition += offset;
+        
+        // Input is stereo, like the float chain's
+        for (int ch = 0; ch < numChainChannels; ++ch) {
+            if (ch < 2 && inputs && inputs[ch]) {
+                EVH::Simd::convert(inputs[ch] + offset, chain[ch], length);
+            } else {
+                std::fill_n(chain[ch], length, 0.0);
+            }
+        }
+        tapChain(EVH::MeterTap::Point::ChainInput, 0, length);
+        
+        // Each plugin is timed on its own, boundary conversions included but
+        // not the taps around it
+        for (int pluginId : pluginChain) {
+            auto it = loadedPlugins.find(pluginId);
+            if (it != loadedPlugins.end() && !it->second->isBypassed()) {
+                PluginInstance& plugin = *it->second;
+                auto pluginStart = std::chrono::steady_clock::now();
+                try {
+                    plugin.setProcessContext(pieceContext);
+                    if (plugin.supportsDoublePrecision()) {
+                        plugin.processReplacingDouble(chain, length);
+                    } else {
+                        // 32-bit plugin boundary
+                        for (int ch = 0; ch < numChainChannels; ++ch) {
+                            EVH::Simd::convert(chain[ch], scratch[ch], length);
+                        }
+                        plugin.processReplacing(scratch, scratch, length);
+                        for (int ch = 0; ch < numChainChannels; ++ch) {
+                            EVH::Simd::convert(scratch[ch], chain[ch], length);
+                        }
+                    }
+                } catch (const std::exception& e) {
+                    handlePluginCrash(pluginId);
+                }
+                
+                auto pluginEnd = std::chrono::steady_clock::now();
+                plugin.getProcessHistogram().record(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(pluginEnd - pluginStart).count());
+            }
+            tapChain(EVH::MeterTap::Point::AfterPlugin, pluginId, length);
+        }
+        tapChain(EVH::MeterTap::Point::ChainOutput, 0, length);
+        
+        for (int ch = 0; ch < numChainChannels; ++ch) {
+            EVH::Simd::convert(chain[ch], outputs[ch] + offset, length);
+        }
+    }
+}
+
+// Audio is stopped here, so the chain buffers can be swapped freely
+void EnhancedVSTHost::allocatePrecisionBuffers(int maxBlockSize) {
+    std::lock_guard<std::mutex> lock(pluginMutex);
+    if (processPrecision != EVH::ProcessPrecision::Double) {
+        doubleChain.reset();
+        floatScratch.reset();
+        return;
+    }
+    
+    doubleChain = std::make_unique<EVH::AudioBuffer<double>>(numChainChannels, maxBlockSize);
+    floatScratch = std::make_unique<EVH::AudioBuffer<float>>(numChainChannels, maxBlockSize);
+}
+
+void EnhancedVSTHost::updateDenormalDiagnostics(float** outputs, int numSamples, double microseconds) {
+    constexpr float quietLevel = 1e-5f;      // -100 dBFS
+    constexpr double suspectRatio = 4.0;
+    constexpr double minJumpUsPerFrame = 0.01;
+    
+    float peak = 0.0f;
+    for (int ch = 0; ch < numChainChannels; ++ch) {
+        for (int i = 0; i < numSamples; ++i) {
+            peak = std::max(peak, std::abs(outputs[ch][i]));
+        }
+    }
+    
+    double perFrame = microseconds / numSamples;
+    double baseline = chainBaselineUsPerFrame.load(std::memory_order_relaxed);
+    
+    if (peak >= quietLevel) {
+        // Audible blocks set the expected cost
+        baseline = (baseline == 0.0) ? perFrame : baseline + 0.05 * (perFrame - baseline);
+        chainBaselineUsPerFrame.store(baseline, std::memory_order_relaxed);
+        return;
+    }
+    
+    quietBlocks.fetch_add(1, std::memory_order_relaxed);
+    if (baseline <= 0.0) {
+        return;
+    }
+    
+    // Silence should cost no more than signal; a jump means denormal tails
+    double ratio = perFrame / baseline;
+    if (ratio > worstQuietRatio.load(std::memory_order_relaxed)) {
+        worstQuietRatio.store(ratio, std::memory_order_relaxed);
+    }
+    if (ratio > suspectRatio && perFrame - baseline > minJumpUsPerFrame) {
+        denormalSuspectBlocks.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void EnhancedVSTHost::setDenormalDiagnostics(bool enable) {
+    if (enable && !denormalDiagnostics.load()) {
+        quietBlocks = 0;
+        denormalSuspectBlocks = 0;
+        chainBaselineUsPerFrame = 0.0;
+        worstQuietRatio = 0.0;
+    }
+    denormalDiagnostics = enable;
+}
+
+DenormalStats EnhancedVSTHost::getDenormalStats() const {
+    DenormalStats stats;
+    stats.protectionEnabled = denormalProtection.load() && ScopedDenormalDisable::isSupported();
+    stats.diagnosticsEnabled = denormalDiagnostics.load();
+    stats.quietBlocks = quietBlocks.load();
+    stats.suspectBlocks = denormalSuspectBlocks.load();
+    stats.baselineUsPerFrame = chainBaselineUsPerFrame.load();
+    stats.worstQuietRatio = worstQuietRatio.load();
+    return stats;
+}
+
+LatencyStats EnhancedVSTHost::getLatencyStats() const {
+    // reconfigureMutex keeps plugins loaded; pluginMutex is only held to
+    // walk the chain, never while summarizing
+    std::lock_guard<std::mutex> reconfigLock(reconfigureMutex);
+    std::lock_guard<std::mutex> latencyLock(latencyMutex);
+    
+    std::vector<std::pair<int, PluginInstance*>> chain;
+    {
+        std::lock_guard<std::mutex> lock(pluginMutex);
+        for (int pluginId : pluginChain) {
+            auto it = loadedPlugins.find(pluginId);
+            if (it != loadedPlugins.end()) {
+                chain.emplace_back(pluginId, it->second.get());
+            }
+        }
+    }
+    
+    LatencyStats stats;
+    stats.windowSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - latencyWindowStart).count();
+    stats.wakeupLateness = wakeupHistogram.summarize();
+    stats.callback = callbackHistogram.summarize();
+    for (auto& [pluginId, plugin] : chain) {
+        stats.plugins.push_back({pluginId, plugin->getInfo().name, plugin->getProcessHistogram().summarize()});
+    }
+    return stats;
+}
+
+void EnhancedVSTHost::resetLatencyStats() {
+    std::lock_guard<std::mutex> reconfigLock(reconfigureMutex);
+    resetLatencyWindow();
+}
+
+void EnhancedVSTHost::resetLatencyWindow() {
+    std::lock_guard<std::mutex> latencyLock(latencyMutex);
+    
+    std::vector<PluginInstance*> plugins;
+    {
+        std::lock_guard<std::mutex> lock(pluginMutex);
+        for (auto& [id, plugin] : loadedPlugins) {
+            plugins.push_back(plugin.get());
+        }
+    }
+    
+    wakeupHistogram.resetWindow();
+    callbackHistogram.resetWindow();
+    for (PluginInstance* plugin : plugins) {
+        plugin->getProcessHistogram().resetWindow();
+    }
+    latencyWindowStart = std::chrono::steady_clock::now();
+}
+
+bool EnhancedVSTHost::startMetricsServer(const MetricsServerSettings& settings) {
+    stopMetricsServer();
+    
+    auto server = std::make_unique<MetricsServer>();
+    if (!server->start(settings, [this] { return getMetricsText(); })) {
+        logError(L"Failed to start metrics server: " + server->getLastError());
+        return false;
+    }
+    
+    metricsServer = std::move(server);
+    return true;
+}
+
+void EnhancedVSTHost::stopMetricsServer() {
+    if (metricsServer) {
+        metricsServer->stop();
+        metricsServer.reset();
+    }
+}
+
+std::string EnhancedVSTHost::getMetricsAddress() const {
+    return metricsServer ? metricsServer->getAddress() : std::string();
+}
+
+std::string EnhancedVSTHost::getMetricsText() const {
+    MetricsWriter writer;
+    
+    {
+        // reconfigureMutex keeps the engine and plugins alive; everything
+        // the audio thread writes is read from atomics, and pluginMutex is
+        // never taken
+        std::lock_guard<std::mutex> reconfigLock(reconfigureMutex);
+        
+        writer.family("evh_audio_running", "gauge", "1 while an audio engine is running.");
+        writer.sample("evh_audio_running", static_cast<uint64_t>(audioRunning.load() ? 1 : 0));
+        writer.family("evh_sample_rate_hertz", "gauge", "Session sample rate.");
+        writer.sample("evh_sample_rate_hertz", currentSampleRate);
+        writer.family("evh_device_sample_rate_hertz", "gauge", "Sample rate the device runs at.");
+        writer.sample("evh_device_sample_rate_hertz", audioEngine ? audioEngine->getSampleRate() : currentSampleRate.load());
+        writer.family("evh_buffer_size_frames", "gauge", "Session block size.");
+        writer.sample("evh_buffer_size_frames", static_cast<uint64_t>(currentBufferSize));
+        
+        writer.histogram("evh_callback_duration_seconds", "Time spent in the device callback.", callbackHistogram);
+        writer.histogram("evh_wakeup_lateness_seconds",
+                         "Device callback start after one block period from the previous one.", wakeupHistogram);
+        
+        writer.family("evh_xruns_total", "counter", "Xruns reported by the current engine.");
+        writer.sample("evh_xruns_total", audioEngine ? audioEngine->getXrunCount() : 0);
+        writer.family("evh_callback_overruns_total", "counter", "Callbacks that took longer than their block.");
+        writer.sample("evh_callback_overruns_total", callbackOverruns.load());
+        writer.family("evh_render_ahead_underruns_total", "counter", "Device blocks that found the render-ahead FIFO short.");
+        writer.sample("evh_render_ahead_underruns_total", renderAhead ? renderAhead->underruns.load() : 0);
+        writer.family("evh_denormal_suspect_blocks_total", "counter", "Quiet blocks whose chain cost jumped.");
+        writer.sample("evh_denormal_suspect_blocks_total", denormalSuspectBlocks.load());
+        
+        // Per-plugin CPU is rate(evh_plugin_process_seconds_total)
+        writer.family("evh_plugins_loaded", "gauge", "Plugins currently loaded.");
+        writer.sample("evh_plugins_loaded", static_cast<uint64_t>(loadedPlugins.size()));
+        writer.family("evh_plugin_process_seconds_total", "counter", "Time spent in each plugin's process().");
+        for (const auto& [pluginId, plugin] : loadedPlugins) {
+            std::string labels = MetricsWriter::label("plugin_id", std::to_string(pluginId)) + "," +
+                                 MetricsWriter::label("name", toUtf8(plugin->getInfo().name));
+            writer.sample("evh_plugin_process_seconds_total", plugin->getProcessHistogram().getTotalNs() / 1e9, labels);
+        }
+        writer.family("evh_plugin_process_calls_total", "counter", "Blocks each plugin processed.");
+        for (const auto& [pluginId, plugin] : loadedPlugins) {
+            std::string labels = MetricsWriter::label("plugin_id", std::to_string(pluginId)) + "," +
+                                 MetricsWriter::label("name", toUtf8(plugin->getInfo().name));
+            writer.sample("evh_plugin_process_calls_total", plugin->getProcessHistogram().getTotalCount(), labels);
+        }
+    }
+    
+    writer.family("evh_scan_running", "gauge", "1 while a plugin scan is in progress.");
+    writer.sample("evh_scan_running", static_cast<uint64_t>(scanRunning.load() ? 1 : 0));
+    writer.family("evh_scan_directory_position", "gauge", "Files scanned in the current directory.");
+    writer.sample("evh_scan_directory_position", static_cast<uint64_t>(scanPosition.load()));
+    writer.family("evh_scan_directory_files", "gauge", "Candidate files in the current directory.");
+    writer.sample("evh_scan_directory_files", static_cast<uint64_t>(scanDirectoryFiles.load()));
+    writer.family("evh_scan_files_total", "counter", "Candidate plugin files scanned.");
+    writer.sample("evh_scan_files_total", scannedFiles.load());
+    writer.family("evh_scan_plugins_found_total", "counter", "Plugins found by scans, blacklist excluded.");
+    writer.sample("evh_scan_plugins_found_total", scanPluginsFound.load());
+    writer.family("evh_scan_seconds_total", "counter", "Time spent scanning.");
+    writer.sample("evh_scan_seconds_total", scanSeconds.load());
+    writer.family("evh_scan_last_files_per_second", "gauge", "Throughput of the most recent completed scan.");
+    writer.sample("evh_scan_last_files_per_second", lastScanFilesPerSecond.load());
+    
+    writer.family("evh_log_errors_total", "counter", "Errors written to the log.");
+    writer.sample("evh_log_errors_total", errorLogger->getErrorCount());
+    writer.family("evh_log_queue_depth", "gauge", "Entries held in the recent-errors queue.");
+    writer.sample("evh_log_queue_depth", static_cast<uint64_t>(errorLogger->getQueueDepth()));
+    
+    ProcessMemory memory = getProcessMemory();
+    writer.family("process_resident_memory_bytes", "gauge", "Resident memory size in bytes.");
+    writer.sample("process_resident_memory_bytes", memory.residentBytes);
+    writer.family("process_virtual_memory_bytes", "gauge", "Virtual memory size in bytes.");
+    writer.sample("process_virtual_memory_bytes", memory.virtualBytes);
+    
+    return writer.getText();
+}
+
+void EnhancedVSTHost::startSessionRecording() {
+    auto recording = std::make_unique<SessionRecording>();
+    
+    // Chain edits hold pluginMutex, so the snapshot and the first event agree
+    std::lock_guard<std::mutex> reconfigLock(reconfigureMutex);
+    std::lock_guard<std::mutex> lock(pluginMutex);
+    
+    recording->sampleRate = currentSampleRate;
+    recording->bufferSize = currentBufferSize;
+    recording->numChannels = numChainChannels;
+    for (const auto& [pluginId, plugin] : loadedPlugins) {
+        recording->plugins.push_back({pluginId, plugin->getInfo().path, plugin->isBypassed()});
+    }
+    std::sort(recording->plugins.begin(), recording->plugins.end(),
+              [](const SessionPluginState& a, const SessionPluginState& b) { return a.pluginId < b.pluginId; });
+    recording->chain = pluginChain;
+    
+    std::lock_guard<std::mutex> sessionLock(sessionMutex);
+    sessionRecording = std::move(recording);
+    sessionStartFrame = framesProcessed.load();
+}
+
+SessionRecording EnhancedVSTHost::stopSessionRecording() {
+    std::lock_guard<std::mutex> lock(pluginMutex);
+    std::lock_guard<std::mutex> sessionLock(sessionMutex);
+    
+    if (!sessionRecording) {
+        return {};
+    }
+    
+    SessionRecording recording = std::move(*sessionRecording);
+    sessionRecording.reset();
+    recording.lengthFrames = framesProcessed.load() - sessionStartFrame;
+    return recording;
+}
+
+bool EnhancedVSTHost::isRecordingSession() const {
+    std::lock_guard<std::mutex> sessionLock(sessionMutex);
+    return sessionRecording != nullptr;
+}
+
+void EnhancedVSTHost::recordSessionEvent(SessionEvent event) {
+    std::lock_guard<std::mutex> sessionLock(sessionMutex);
+    if (!sessionRecording) {
+        return;
+    }
+    
+    // Exact for calls holding pluginMutex: no block can start in between
+    event.samplePosition = framesProcessed.load() - sessionStartFrame;
+    sessionRecording->events.push_back(std::move(event));
+}
+
+void EnhancedVSTHost::setResamplerQuality(EVH::ResamplerQuality quality) {
+    resamplerQuality = quality;
+    
+    // Takes effect the next time the engine is (re)configured
+}
+
+int EnhancedVSTHost::getInputLatencySamples() const {
+    return audioEngine ? audioEngine->getInputLatencySamples() : 0;
+}
+
+void EnhancedVSTHost::setAggregateDevices(const std::vector<std::wstring>& deviceNames,
+                                          AggregateRouting routing) {
+    aggregateDevices = deviceNames;
+    aggregateRouting = routing;
+    
+    // Takes effect the next time the aggregate driver is started
+}
+
+double EnhancedVSTHost::getDeviceSampleRate() const {
+    return audioEngine ? audioEngine->getSampleRate() : currentSampleRate.load();
+}
+
+void EnhancedVSTHost::stopAudio() {
+    if (!audioRunning.load()) {
+        return;
+    }
+    
+    audioRunning = false;
+    
+    std::lock_guard<std::mutex> reconfigLock(reconfigureMutex);
+    stopRenderAhead();
+    
+    if (audioEngine) {
+        audioEngine->stop();
+        audioEngine->shutdown();
+        audioEngine.reset();
+    }
+    
+    resampler.reset();
+    renderAhead.reset();
+}
+
+bool EnhancedVSTHost::beginOfflineRender(int numChannels) {
+    std::lock_guard<std::mutex> reconfigLock(reconfigureMutex);
+    
+    if (audioRunning.load() || offlineRendering.load()) {
+        return false;
+    }
+    
+    numChainChannels = std::clamp(numChannels, 1, EVH::MAX_CHANNELS);
+    offlineInputPtrs.assign(numChainChannels, nullptr);
+    offlineOutputPtrs.assign(numChainChannels, nullptr);
+    
+    preparePluginsInParallel({currentSampleRate, currentBufferSize, numChainChannels, processPrecision});
+    commitPreparedPlugins();
+    allocatePrecisionBuffers(currentBufferSize);
+    resetLatencyWindow();
+    
+    chainPosition = 0;
+    offlineRendering = true;
+    return true;
+}
+
+int EnhancedVSTHost::renderOffline(const float** inputs, float** outputs, int numFrames) {
+    if (!offlineRendering.load() || !outputs || numFrames <= 0) {
+        return 0;
+    }
+    
+    ScopedRealtimeSection realtime;
+    ScopedDenormalDisable noDenormals(denormalProtection.load(std::memory_order_relaxed));
+    
+    // Media time rather than wall time, so renders are repeatable
+    EVH::ProcessContext context;
+    context.sampleRate = currentSampleRate;
+    context.offline = true;
+    
+    // Plugins are prepared for the session block size; split longer requests
+    int rendered = 0;
+    while (rendered < numFrames) {
+        int blockSize = std::min(currentBufferSize.load(), numFrames - rendered);
+        
+        for (int ch = 0; ch < numChainChannels; ++ch) {
+            offlineInputPtrs[ch] = (inputs && inputs[ch]) ? inputs[ch] + rendered : nullptr;
+            offlineOutputPtrs[ch] = outputs[ch] + rendered;
+        }
+        
+        context.hostTimeNs = static_cast<int64_t>(chainPosition * 1e9 / currentSampleRate);
+        processChain(inputs ? offlineInputPtrs.data() : nullptr, offlineOutputPtrs.data(), blockSize, context);
+        rendered += blockSize;
+    }
+    
+    return rendered;
+}
+
+void EnhancedVSTHost::endOfflineRender() {
+    offlineRendering = false;
+}
+
+void EnhancedVSTHost::setRenderAheadBlocks(int blocks) {
+    blocks = std::clamp(blocks, 0, 64);
+    if (blocks == renderAheadBlocks) {
+        return;
+    }
+    
+    renderAheadBlocks = blocks;
+    if (blocks > 0 && inputEnabled) {
+        logError(L"Live input is not available while rendering ahead");
+    }
+    
+    // Switch modes at a block boundary
+    if (audioRunning.load()) {
+        reconfigureAudio(currentSampleRate, currentBufferSize);
+    }
+}
+
+RenderAheadStats EnhancedVSTHost::getRenderAheadStats() const {
+    RenderAheadStats stats;
+    stats.depthBlocks = renderAheadBlocks;
+    
+    std::lock_guard<std::mutex> reconfigLock(reconfigureMutex);
+    if (!renderAhead) {
+        return stats;
+    }
+    
+    stats.active = true;
+    stats.targetFrames = renderAhead->targetFrames.load();
+    stats.fillFrames = renderAhead->ring.getNumReady();
+    stats.minFillFrames = renderAhead->minFill.exchange(stats.fillFrames);
+    stats.blocksRendered = renderAhead->blocksRendered.load();
+    stats.underruns = renderAhead->underruns.load();
+    stats.silentFrames = renderAhead->silentFrames.load();
+    return stats;
+}
+
+void EnhancedVSTHost::setAdaptiveBufferSize(bool enable, const AdaptiveBufferSettings& settings) {
+    if (adaptiveThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(adaptiveMutex);
+            adaptiveStop = true;
+        }
+        adaptiveCv.notify_all();
+        adaptiveThread.join();
+    }
+    
+    if (!enable) {
+        return;
+    }
+    
+    adaptiveSettings = settings;
+    adaptiveSettings.minBufferSize = std::max(16, settings.minBufferSize);
+    adaptiveSettings.maxBufferSize = std::max(adaptiveSettings.minBufferSize, settings.maxBufferSize);
+    adaptiveStepsUp = 0;
+    adaptiveStepsDown = 0;
+    adaptiveShrinkHold = adaptiveSettings.quietSecondsToShrink;
+    adaptiveStop = false;
+    adaptiveThread = std::thread(&EnhancedVSTHost::adaptiveBufferThreadFunc, this);
+}
+
+AdaptiveBufferStats EnhancedVSTHost::getAdaptiveBufferStats() const {
+    AdaptiveBufferStats stats;
+    stats.enabled = adaptiveThread.joinable();
+    stats.bufferSize = currentBufferSize;
+    stats.xruns = getXrunCount();
+    stats.callbackOverruns = callbackOverruns.load();
+    stats.stepsUp = adaptiveStepsUp.load();
+    stats.stepsDown = adaptiveStepsDown.load();
+    stats.shrinkHoldSeconds = adaptiveShrinkHold.load();
+    return stats;
+}
+
+uint64_t EnhancedVSTHost::getXrunCount() const {
+    std::lock_guard<std::mutex> reconfigLock(reconfigureMutex);
+    return audioEngine ? audioEngine->getXrunCount() : 0;
+}
+
+void EnhancedVSTHost::adaptiveBufferThreadFunc() {
+    using Clock = std::chrono::steady_clock;
+    using Seconds = std::chrono::duration<double>;
+    
+    const AdaptiveBufferSettings settings = adaptiveSettings;
+    const auto pollInterval = std::chrono::duration<double, std::milli>(settings.pollIntervalMs);
+    
+    std::deque<Clock::time_point> recentXruns;
+    uint64_t lastXruns = getXrunCount();
+    uint64_t lastOverruns = callbackOverruns.load();
+    auto lastEvent = Clock::now();   // Last xrun or size change
+    auto lastShrink = Clock::time_point{};
+    bool afterShrink = false;        // No growth since the last shrink yet
+    double shrinkHold = settings.quietSecondsToShrink;
+    
+    std::unique_lock<std::mutex> lock(adaptiveMutex);
+    while (!adaptiveCv.wait_for(lock, pollInterval, [this] { return adaptiveStop; })) {
+        if (!audioRunning.load()) {
+            continue;
+        }
+        lock.unlock();
+        
+        // A late callback usually shows up in both counters; take the larger
+        // delta rather than the sum. Counters restart with a new engine.
+        uint64_t xruns = getXrunCount();
+        uint64_t overruns = callbackOverruns.load();
+        uint64_t events = std::max(xruns >= lastXruns ? xruns - lastXruns : xruns, overruns - lastOverruns);
+        lastXruns = xruns;
+        lastOverruns = overruns;
+        
+        auto now = Clock::now();
+        for (uint64_t i = 0; i < std::min<uint64_t>(events, settings.xrunsToGrow); ++i) {
+            recentXruns.push_back(now);
+        }
+        while (!recentXruns.empty() && Seconds(now - recentXruns.front()).count() > settings.growWindowSeconds) {
+            recentXruns.pop_front();
+        }
+        if (events > 0) {
+            lastEvent = now;
+        }
+        
+        int size = currentBufferSize;
+        if (static_cast<int>(recentXruns.size()) >= settings.xrunsToGrow && size < settings.maxBufferSize) {
+            // Xruns soon after shrinking: that size was too small, wait longer
+            // before trying it again. Only the first step back counts, however
+            // many it takes to recover.
+            if (afterShrink && Seconds(now - lastShrink).count() < shrinkHold) {
+                shrinkHold = std::min(shrinkHold * 2.0, 3600.0);
+                adaptiveShrinkHold = shrinkHold;
+            }
+            afterShrink = false;
+            
+            setBufferSize(std::min(size * 2, settings.maxBufferSize));
+            adaptiveStepsUp++;
+            recentXruns.clear();
+            lastEvent = Clock::now();
+            
+            // Xruns the old size ran into while the switch was pending are
+            // not the new size's
+            lastXruns = getXrunCount();
+            lastOverruns = callbackOverruns.load();
+        } else if (Seconds(now - lastEvent).count() >= shrinkHold && size > settings.minBufferSize) {
+            setBufferSize(std::max(size / 2, settings.minBufferSize));
+            adaptiveStepsDown++;
+            lastShrink = lastEvent = Clock::now();
+            afterShrink = true;
+        }
+        
+        lock.lock();
+    }
+}
+
+void EnhancedVSTHost::setThreadPolicy(const ThreadPolicy& audioPolicy, const ThreadPolicy& workerPolicy) {
+    std::lock_guard<std::mutex> lock(policyMutex);
+    audioThreadPolicy = audioPolicy;
+    workerThreadPolicy = workerPolicy;
+    
+    // Takes effect the next time the engine or worker threads start
+}
+
+ThreadPolicyResult EnhancedVSTHost::getAudioThreadPolicyResult() const {
+    std::lock_guard<std::mutex> reconfigLock(reconfigureMutex);
+    return audioEngine ? audioEngine->getThreadPolicyResult() : ThreadPolicyResult{};
+}
+
+ThreadPolicyResult EnhancedVSTHost::getWorkerThreadPolicyResult() const {
+    std::lock_guard<std::mutex> lock(policyMutex);
+    return workerPolicyResult;
+}
+
+MemoryLockResult EnhancedVSTHost::lockMemory() {
+    MemoryLockResult result = EVH::lockProcessMemory();
+    if (!result.locked) {
+        logError(result.note);
+    }
+    return result;
+}
+
+std::unique_ptr<EnhancedVSTHost::RenderAheadFifo> EnhancedVSTHost::createRenderAheadFifo(int blockSize) const {
+    if (renderAheadBlocks <= 0) {
+        return nullptr;
+    }
+    
+    // Room for the target depth plus one block in flight; sized generously
+    // because a restarted device may come back with a different period
+    auto fifo = std::make_unique<RenderAheadFifo>();
+    int maxBlock = std::max({blockSize, currentBufferSize.load(), 1024});
+    fifo->ring.allocate(numChainChannels, (renderAheadBlocks + 2) * maxBlock);
+    return fifo;
+}
+
+void EnhancedVSTHost::startRenderAhead() {
+    if (!renderAhead || !audioEngine || renderAheadThread.joinable()) {
+        return;
+    }
+    
+    // The worker renders device-sized blocks, so it owns the resampler too
+    int blockSize = std::min(audioEngine->getBufferSize(), renderAhead->ring.getCapacity() / 2);
+    renderAhead->scratch.assign(numChainChannels, std::vector<float>(blockSize, 0.0f));
+    renderAhead->scratchPtrs.resize(numChainChannels);
+    for (int ch = 0; ch < numChainChannels; ++ch) {
+        renderAhead->scratchPtrs[ch] = renderAhead->scratch[ch].data();
+    }
+    
+    int target = std::min(renderAheadBlocks * blockSize, renderAhead->ring.getCapacity() - blockSize);
+    renderAhead->targetFrames = target;
+    renderAhead->minFill = renderAhead->ring.getNumReady();
+    
+    renderAheadStop = false;
+    renderAheadThread = std::thread(&EnhancedVSTHost::renderAheadThreadFunc, this);
+}
+
+void EnhancedVSTHost::stopRenderAhead() {
+    renderAheadStop = true;
+    if (renderAheadThread.joinable()) {
+        renderAheadThread.join();
+    }
+}
+
+void EnhancedVSTHost::renderAheadThreadFunc() {
+    {
+        std::unique_lock<std::mutex> lock(policyMutex);
+        ThreadPolicy policy = workerThreadPolicy;
+        lock.unlock();
+        
+        ThreadPolicyResult result = EVH::applyThreadPolicy(policy);
+        lock.lock();
+        workerPolicyResult = result;
+    }
+    
+    RenderAheadFifo& fifo = *renderAhead;
+    const int blockSize = static_cast<int>(fifo.scratch[0].size());
+    const int target = fifo.targetFrames.load();
+    const auto idleWait = std::chrono::duration<double>(blockSize / audioEngine->getSampleRate() * 0.25);
+    
+    while (!renderAheadStop.load()) {
+        if (fifo.ring.getNumReady() + blockSize > target) {
+            // Full: poll rather than have the device thread signal us
+            std::this_thread::sleep_for(idleWait);
+            continue;
+        }
+        
+        // Heard once everything queued ahead of it has played
+        EVH::ProcessContext context;
+        context.sampleRate = audioEngine->getSampleRate();
+        context.hostTimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        context.outputLatencySamples = fifo.ring.getNumReady() + audioEngine->getBufferSize();
+        context.clockRatio = deviceClockRatio.load(std::memory_order_relaxed);
+        
+        ScopedRealtimeSection realtime;
+        ScopedDenormalDisable noDenormals(denormalProtection.load(std::memory_order_relaxed));
+        renderDeviceBlock(nullptr, fifo.scratchPtrs.data(), blockSize, context);
+        fifo.ring.write(fifo.scratchPtrs.data(), blockSize);
+        fifo.blocksRendered.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void EnhancedVSTHost::pullRenderAhead(RenderAheadFifo& fifo, float** outputs, int numSamples) {
+    // After an underrun, stay silent until the worker is a full depth ahead
+    // again rather than stuttering on every block
+    if (fifo.recovering.load(std::memory_order_relaxed)) {
+        if (fifo.ring.getNumReady() < fifo.targetFrames.load(std::memory_order_relaxed)) {
+            for (int ch = 0; ch < numChainChannels; ++ch) {
+                std::fill_n(outputs[ch], numSamples, 0.0f);
+            }
+            fifo.silentFrames.fetch_add(numSamples, std::memory_order_relaxed);
+            return;
+        }
+        fifo.recovering.store(false, std::memory_order_relaxed);
+    }
+    
+    int got = fifo.ring.read(outputs, numSamples);
+    if (got < numSamples) {
+        for (int ch = 0; ch < numChainChannels; ++ch) {
+            std::fill(outputs[ch] + got, outputs[ch] + numSamples, 0.0f);
+        }
+        fifo.underruns.fetch_add(1, std::memory_order_relaxed);
+        fifo.silentFrames.fetch_add(numSamples - got, std::memory_order_relaxed);
+        fifo.recovering.store(true, std::memory_order_relaxed);
+    }
+    
+    int fill = fifo.ring.getNumReady();
+    if (fill < fifo.minFill.load(std::memory_order_relaxed)) {
+        fifo.minFill.store(fill, std::memory_order_relaxed);
+    }
+}
+
+void EnhancedVSTHost::addPluginToChain(int pluginId) {
+    std::lock_guard<std::mutex> lock(pluginMutex);
+    recordSessionEvent({SessionEvent::Type::AddToChain, 0, pluginId});
+    
+    if (loadedPlugins.find(pluginId) != loadedPlugins.end()) {
+        // Check if already in chain
+        if (std::find(pluginChain.begin(), pluginChain.end(), pluginId) == pluginChain.end()) {
+            pluginChain.push_back(pluginId);
+        }
+    }
+}
+
+void EnhancedVSTHost::removePluginFromChain(int pluginId) {
+    std::lock_guard<std::mutex> lock(pluginMutex);
+    recordSessionEvent({SessionEvent::Type::RemoveFromChain, 0, pluginId});
+    
+    auto it = std::find(pluginChain.begin(), pluginChain.end(), pluginId);
+    if (it != pluginChain.end()) {
+        pluginChain.erase(it);
+    }
+}
+
+void EnhancedVSTHost::movePluginInChain(int pluginId, int newPosition) {
+    std::lock_guard<std::mutex> lock(pluginMutex);
+    recordSessionEvent({SessionEvent::Type::Move, 0, pluginId, newPosition});
+    
+    auto it = std::find(pluginChain.begin(), pluginChain.end(), pluginId);
+    if (it != pluginChain.end()) {
+        pluginChain.erase(it);
+        
+        if (newPosition >= 0 && newPosition <= static_cast<int>(pluginChain.size())) {
+            pluginChain.insert(pluginChain.begin() + newPosition, pluginId);
+        } else {
+            pluginChain.push_back(pluginId);
+        }
+    }
+}
+
+void EnhancedVSTHost::bypassPlugin(int pluginId, bool bypass) {
+    std::lock_guard<std::mutex> lock(pluginMutex);
+    recordSessionEvent({SessionEvent::Type::Bypass, 0, pluginId, bypass ? 1 : 0});
+    
+    auto it = loadedPlugins.find(pluginId);
+    if (it != loadedPlugins.end()) {
+        it->second->setBypass(bypass);
+    }
+}
+
+bool EnhancedVSTHost::cloneChainInto(EnhancedVSTHost& target) const {
+    struct Node {
+        std::wstring path;
+        std::wstring name;
+        std::unique_ptr<AudioProcessor> processor;
+        std::vector<float> parameters;
+        bool bypassed{false};
+    };
+    
+    // Copy under the locks, load without them: loading can take a while
+    std::vector<Node> nodes;
+    double rate;
+    int size;
+    ProcessPrecision precision;
+    {
+        std::lock_guard<std::mutex> reconfigLock(reconfigureMutex);
+        std::lock_guard<std::mutex> lock(pluginMutex);
+        rate = currentSampleRate;
+        size = currentBufferSize;
+        precision = processPrecision;
+        
+        for (int pluginId : pluginChain) {
+            auto it = loadedPlugins.find(pluginId);
+            if (it == loadedPlugins.end()) {
+                continue;
+            }
+            
+            const PluginInstance& plugin = *it->second;
+            Node node{plugin.getInfo().path, plugin.getInfo().name, plugin.cloneProcessor(), {}, plugin.isBypassed()};
+            for (int i = 0; i < plugin.getParameterCount(); ++i) {
+                node.parameters.push_back(plugin.getParameter(i));
+            }
+            if (plugin.isNative() && !node.processor) {
+                node.path.clear();   // Reported below
+            }
+            nodes.push_back(std::move(node));
+        }
+    }
+    
+    target.setSampleRate(rate);
+    target.setBufferSize(size);
+    target.setProcessPrecision(precision);
+    for (auto& node : nodes) {
+        if (!node.processor && node.path.empty()) {
+            target.logError(L"Processor cannot be cloned: " + node.name);
+            return false;
+        }
+        
+        int pluginId = node.processor ? target.loadProcessor(std::move(node.processor))
+                                      : target.loadPluginFile(node.path);
+        if (pluginId == 0) {
+            return false;
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(target.pluginMutex);
+            PluginInstance& plugin = *target.loadedPlugins[pluginId];
+            for (size_t i = 0; i < node.parameters.size(); ++i) {
+                plugin.setParameter(static_cast<int>(i), node.parameters[i]);
+            }
+        }
+        target.bypassPlugin(pluginId, node.bypassed);
+        target.addPluginToChain(pluginId);
+    }
+    return true;
+}
+
+bool EnhancedVSTHost::setProcessPrecision(EVH::ProcessPrecision precision) {
+    std::lock_guard<std::mutex> reconfigLock(reconfigureMutex);
+    if (audioRunning.load() || offlineRendering.load()) {
+        logError(L"Processing precision can only change while audio is stopped");
+        return false;
+    }
+    
+    // Plugins and buffers follow when audio or a render starts
+    processPrecision = precision;
+    return true;
+}
+
+void EnhancedVSTHost::setSampleRate(double rate) {
+    recordSessionEvent({SessionEvent::Type::SetSampleRate, 0, 0, 0, rate});
+    if (chainFrozen.load() && rate != currentSampleRate) {
+        unfreezeChain();   // The render is only valid at its own rate
+    }
+    if (audioRunning.load()) {
+        reconfigureAudio(rate, currentBufferSize);
+    } else {
+        currentSampleRate = rate;
+    }
+}
+
+void EnhancedVSTHost::setBufferSize(int size) {
+    recordSessionEvent({SessionEvent::Type::SetBufferSize, 0, 0, size});
+    if (audioRunning.load()) {
+        reconfigureAudio(currentSampleRate, size);
+    } else {
+        currentBufferSize = size;
+    }
+}
+
+EVH::ReconfigureStats EnhancedVSTHost::getLastReconfigureStats() const {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return lastReconfigureStats;
+}
+
+int EnhancedVSTHost::preparePluginsInParallel(const ProcessSetup& setup) {
+    std::vector<PluginInstance*> targets;
+    {
+        std::lock_guard<std::mutex> lock(pluginMutex);
+        for (auto& [id, plugin] : loadedPlugins) {
+            targets.push_back(plugin.get());
+        }
+    }
+    
+    // One worker per plugin; the audio callback keeps running the old setup
+    std::vector<std::future<bool>> jobs;
+    jobs.reserve(targets.size());
+    for (PluginInstance* plugin : targets) {
+        jobs.push_back(std::async(std::launch::async, [plugin, setup] {
+            return plugin->prepare(setup);
+        }));
+    }
+    
+    int prepared = 0;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        try {
+            if (jobs[i].get()) {
+                prepared++;
+            } else {
+                logError(L"Failed to prepare plugin: " + targets[i]->getInfo().name);
+            }
+        } catch (const std::exception& e) {
+            logError(L"Exception preparing plugin: " + 
+                    std::wstring(e.what(), e.what() + strlen(e.what())));
+        }
+    }
+    
+    return prepared;
+}
+
+void EnhancedVSTHost::commitPreparedPlugins() {
+    std::lock_guard<std::mutex> lock(pluginMutex);
+    for (auto& [id, plugin] : loadedPlugins) {
+        plugin->commitPreparedSetup();
+    }
+}
+
+bool EnhancedVSTHost::reconfigureAudio(double rate, int size) {
+    using Clock = std::chrono::steady_clock;
+    auto toMs = [](Clock::duration d) {
+        return std::chrono::duration<double, std::milli>(d).count();
+    };
+    
+    std::lock_guard<std::mutex> reconfigLock(reconfigureMutex);
+    
+    if (!audioEngine) {
+        return false;
+    }
+    
+    ReconfigureStats stats;
+    auto requestTime = Clock::now();
+    
+    // Phase 1: prepare every plugin for the new setup while audio keeps playing
+    stats.pluginsPrepared = preparePluginsInParallel({rate, size, numChainChannels, processPrecision});
+    auto nextRenderAhead = createRenderAheadFifo(size);
+    std::unique_ptr<RenderAheadFifo> retiredRenderAhead;
+    auto preparedTime = Clock::now();
+    
+    // The render-ahead worker pauses; the device drains what is queued
+    stopRenderAhead();
+    
+    // Phase 2: switch engine and plugins together at a block boundary
+    Clock::time_point switchTime = preparedTime;
+    stats.deviceRestarted = !audioEngine->supportsHotReconfigure();
+    stats.succeeded = audioEngine->reconfigure(rate, size,
+        [this, rate, size, &switchTime, &nextRenderAhead, &retiredRenderAhead] {
+        // On the audio thread when the engine switches in place
+        ScopedRealtimeSection realtime(audioEngine->supportsHotReconfigure());
+        commitPreparedPlugins();
+        currentSampleRate = rate;
+        currentBufferSize = size;
+        
+        // Hot-switching engines run at the requested rate, so this only
+        // allocates after a device restart (off the audio thread)
+        resampler = createResampler(*audioEngine);
+        
+        // The old FIFO is freed after the switch, not on the audio thread
+        retiredRenderAhead = std::move(renderAhead);
+        renderAhead = std::move(nextRenderAhead);
+        switchTime = Clock::now();
+    });
+    
+    startRenderAhead();
+    
+    if (!stats.succeeded) {
+        logError(L"Failed to reconfigure audio engine");
+    }
+    
+    stats.prepareMs = toMs(preparedTime - requestTime);
+    stats.switchMs = toMs(switchTime - preparedTime);
+    stats.totalMs = toMs(Clock::now() - requestTime);
+    
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        lastReconfigureStats = stats;
+    }
+    
+    return stats.succeeded;
+}
+
+bool EnhancedVSTHost::switchAudioDriver(AudioDriverType type) {
+    using Clock = std::chrono::steady_clock;
+    auto toMs = [](Clock::duration d) {
+        return std::chrono::duration<double, std::milli>(d).count();
+    };
+    
+    std::lock_guard<std::mutex> reconfigLock(reconfigureMutex);
+    
+    ReconfigureStats stats;
+    stats.deviceRestarted = true;
+    auto requestTime = Clock::now();
+    
+    // Bring up the new engine while the old one keeps playing
+    auto newEngine = createAudioEngine(type);
+    if (!newEngine || !newEngine->initialize(currentSampleRate, currentBufferSize)) {
+        logError(L"Failed to initialize audio engine");
+        return false;
+    }
+    
+    // The chain stays at the session rate; the device may use larger blocks
+    int maxBlockSize = std::max(currentBufferSize.load(), newEngine->getBufferSize());
+    int numChannels = std::min(newEngine->getNumOutputChannels(), EVH::MAX_CHANNELS);
+    stats.pluginsPrepared = preparePluginsInParallel({currentSampleRate, maxBlockSize, numChannels, processPrecision});
+    auto preparedTime = Clock::now();
+    
+    // Only the stop/start of the devices is silent
+    stopRenderAhead();
+    audioEngine->stop();
+    audioEngine->shutdown();
+    commitPreparedPlugins();
+    installAudioCallback(*newEngine);
+    allocatePrecisionBuffers(maxBlockSize);
+    renderAhead = createRenderAheadFifo(newEngine->getBufferSize());
+    stats.succeeded = newEngine->start();
+    auto switchTime = Clock::now();
+    
+    audioEngine = std::move(newEngine);
+    currentDriverType = type;
+    
+    if (!stats.succeeded) {
+        logError(L"Failed to start audio engine");
+        audioEngine.reset();
+        renderAhead.reset();
+        audioRunning = false;
+    } else {
+        startRenderAhead();
+    }
+    
+    stats.prepareMs = toMs(preparedTime - requestTime);
+    stats.switchMs = toMs(switchTime - preparedTime);
+    stats.totalMs = toMs(Clock::now() - requestTime);
+    
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        lastReconfigureStats = stats;
+    }
+    
+    return stats.succeeded;
+}
+
+void EnhancedVSTHost::addToBlacklist(const std::wstring& pluginPath) {
+    std::lock_guard<std::mutex> lock(blacklistMutex);
+    blacklistedPlugins.insert(pluginPath);
+}
+
+void EnhancedVSTHost::removeFromBlacklist(const std::wstring& pluginPath) {
+    std::lock_guard<std::mutex> lock(blacklistMutex);
+    blacklistedPlugins.erase(pluginPath);
+}
+
+bool EnhancedVSTHost::isBlacklisted(const std::wstring& pluginPath) const {
+    std::lock_guard<std::mutex> lock(blacklistMutex);
+    return blacklistedPlugins.find(pluginPath) != blacklistedPlugins.end();
+}
+
+std::vector<std::wstring> EnhancedVSTHost::getRecentErrors() const {
+    return errorLogger->getRecentErrors();
+}
+
+void EnhancedVSTHost::clearErrors() {
+    errorLogger->clearLog();
+}
+
+void EnhancedVSTHost::setupHighDPI() {
+#ifdef _WIN32
+    if (IsWindows8Point1OrGreater()) {
+        // SetProcessDpiAwareness would be better but requires Windows 8.1 SDK
+        SetProcessDPIAware();
+        highDpiAware = true;
+    } else {
+        SetProcessDPIAware();
+    }
+#endif
+}
+
+void EnhancedVSTHost::handlePluginCrash(int pluginId) {
+    auto it = loadedPlugins.find(pluginId);
+    if (it != loadedPlugins.end()) {
+        std::wstring pluginName = it->second->getInfo().name;
+        
+        // Log the crash
+        errorLogger->logPluginCrash(pluginName, L"Plugin crashed during audio processing");
+        
+        // Show notification
+        notificationMgr->showPluginCrashNotification(pluginName);
+        
+        // Remove from chain
+        removePluginFromChain(pluginId);
+        
+        // Call crash callback
+        if (crashCb) {
+            crashCb(pluginId, pluginName);
+        }
+    }
+}
+
+void EnhancedVSTHost::logError(const std::wstring& error) {
+    errorLogger->logError(error);
+    
+    if (errorCb) {
+        errorCb(error);
+    }
+}
+
+bool EnhancedVSTHost::validatePlugin(const std::wstring& path) {
+    // Check if file exists
+    std::error_code ec;
+    if (!fs::exists(path, ec)) {
+        return false;
+    }
+    
+    // Check if it's a native module or VST3
+    std::wstring ext = fs::path(path).extension().wstring();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::towlower);
+    if (ext != EVH::NATIVE_MODULE_EXTENSION && ext != L".vst3") {
+        return false;
+    }
+    
+    // Check the module image for corruption without running it
+    return EVH::isLoadableModule(EVH::resolvePluginModulePath(path));
+}
+
+std::unique_ptr<PluginInstance> EnhancedVSTHost::createPluginInstance(const PluginInfo& info) {
+    return std::make_unique<PluginInstance>(info);
+}
+
+std::vector<EVH::PluginInfo> EnhancedVSTHost::getAvailablePlugins() const {
+    // This would return the list of scanned plugins from a database
+    // For now, return empty vector
+    return std::vector<EVH::PluginInfo>();
+}
+
+EVH::PluginInfo EnhancedVSTHost::getPluginInfo(int pluginId) const {
+    std::lock_guard<std::mutex> lock(pluginMutex);
+    
+    auto it = loadedPlugins.find(pluginId);
+    if (it != loadedPlugins.end()) {
+        return it->second->getInfo();
+    }
+    
+    return EVH::PluginInfo();
+}
+
+int EnhancedVSTHost::getPluginLatencySamples(int pluginId) const {
+    std::lock_guard<std::mutex> lock(pluginMutex);
+    
+    auto it = loadedPlugins.find(pluginId);
+    return it != loadedPlugins.end() ? it->second->getLatencySamples() : 0;
+}
+
+int EnhancedVSTHost::getChainLatencySamples() const {
+    std::lock_guard<std::mutex> lock(pluginMutex);
+    
+    int latency = 0;
+    for (int pluginId : pluginChain) {
+        auto it = loadedPlugins.find(pluginId);
+        if (it != loadedPlugins.end() && !it->second->isBypassed() &&
+            it->second->getState() == EVH::PluginState::Active) {
+            latency += it->second->getLatencySamples();
+        }
+    }
+    return latency;
+}
+
+void EnhancedVSTHost::setAudioDriver(AudioDriverType type) {
+    if (audioRunning) {
+        if (type != currentDriverType) {
+            switchAudioDriver(type);
+        }
+    } else {
+        currentDriverType = type;
+    }
 }
\ No newline at end of file
@@ -0,0 +1,123 @@
+// Fft.cpp - Radix-2 real FFT on split spectra
+#include "EVHDsp.h"
+#include <cmath>
+
+namespace {
+    constexpr double PI = 3.14159265358979323846;
+}
+
+namespace EVH {
+
+RealFft::RealFft(int size) {
+    if (size > 0) {
+        setSize(size);
+    }
+}
+
+void RealFft::setSize(int newSize) {
+    size = newSize;
+    half = size / 2;
+
+    int bits = 0;
+    while ((1 << bits) < half) {
+        ++bits;
+    }
+    bitReverse.resize(half);
+    for (int i = 0; i < half; ++i) {
+        int reversed = 0;
+        for (int b = 0; b < bits; ++b) {
+            reversed |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        bitReverse[i] = reversed;
+    }
+
+    // Stage of length len keeps its len / 2 twiddles contiguous at len / 2 - 1
+    twiddleRe.resize(std::max(half - 1, 1));
+    twiddleIm.resize(std::max(half - 1, 1));
+    for (int len = 2; len <= half; len <<= 1) {
+        for (int j = 0; j < len / 2; ++j) {
+            twiddleRe[len / 2 - 1 + j] = static_cast<float>(std::cos(-2.0 * PI * j / len));
+            twiddleIm[len / 2 - 1 + j] = static_cast<float>(std::sin(-2.0 * PI * j / len));
+        }
+    }
+
+    splitCos.resize(half + 1);
+    splitSin.resize(half + 1);
+    for (int k = 0; k <= half; ++k) {
+        splitCos[k] = static_cast<float>(std::cos(2.0 * PI * k / size));
+        splitSin[k] = static_cast<float>(std::sin(2.0 * PI * k / size));
+    }
+
+    workRe.assign(half, 0.0f);
+    workIm.assign(half, 0.0f);
+}
+
+// Iterative decimation in time. Each stage's butterflies run over
+// contiguous twiddles so the inner loop vectorises.
+void RealFft::transform() {
+    float* re = workRe.data();
+    float* im = workIm.data();
+
+    for (int len = 2; len <= half; len <<= 1) {
+        const int h = len / 2;
+        const float* wr = twiddleRe.data() + h - 1;
+        const float* wi = twiddleIm.data() + h - 1;
+        for (int start = 0; start < half; start += len) {
+            float* ar = re + start;
+            float* ai = im + start;
+            float* br = ar + h;
+            float* bi = ai + h;
+            for (int j = 0; j < h; ++j) {
+                const float tr = br[j] * wr[j] - bi[j] * wi[j];
+                const float ti = br[j] * wi[j] + bi[j] * wr[j];
+                br[j] = ar[j] - tr;
+                bi[j] = ai[j] - ti;
+                ar[j] += tr;
+                ai[j] += ti;
+            }
+        }
+    }
+}
+
+// Even samples as the real part and odd as the imaginary part of a
+// half-length complex FFT, then split into the real spectrum
+void RealFft::forward(const float* input, float* re, float* im) {
+    for (int n = 0; n < half; ++n) {
+        workRe[bitReverse[n]] = input[2 * n];
+        workIm[bitReverse[n]] = input[2 * n + 1];
+    }
+    transform();
+
+    for (int k = 0; k <= half; ++k) {
+        const int a = k % half;
+        const int b = (half - k) % half;
+        const float evenRe = 0.5f * (workRe[a] + workRe[b]);
+        const float evenIm = 0.5f * (workIm[a] - workIm[b]);
+        const float oddRe = 0.5f * (workIm[a] + workIm[b]);
+        const float oddIm = -0.5f * (workRe[a] - workRe[b]);
+        re[k] = evenRe + splitCos[k] * oddRe + splitSin[k] * oddIm;
+        im[k] = evenIm + splitCos[k] * oddIm - splitSin[k] * oddRe;
+    }
+}
+
+// Reverses the split, then runs the complex FFT on the conjugate
+void RealFft::inverse(const float* re, const float* im, float* output) {
+    for (int k = 0; k < half; ++k) {
+        const float sumRe = re[k] + re[half - k];
+        const float sumIm = im[k] - im[half - k];
+        const float diffRe = re[k] - re[half - k];
+        const float diffIm = im[k] + im[half - k];
+        const float zRe = sumRe - diffRe * splitSin[k] - diffIm * splitCos[k];
+        const float zIm = sumIm + diffRe * splitCos[k] - diffIm * splitSin[k];
+        workRe[bitReverse[k]] = zRe;
+        workIm[bitReverse[k]] = -zIm;
+    }
+    transform();
+
+    for (int n = 0; n < half; ++n) {
+        output[2 * n] = workRe[n];
+        output[2 * n + 1] = -workIm[n];
+    }
+}
+
+}
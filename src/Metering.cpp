@@ -0,0 +1,474 @@
+// Metering.cpp - Level, loudness and spectrum meters at chain tap points
+#include "EnhancedVSTHost.h"
+
+using namespace EVH;
+
+namespace {
+    constexpr double PI = 3.14159265358979323846;
+    
+    // -20 dB per second for the falling peak and true-peak readouts
+    constexpr double PEAK_FALL_DB_PER_SECOND = 20.0;
+    constexpr double RMS_SECONDS = 0.3;
+    
+    float ToLufs(double meanSquare) {
+        return meanSquare > 1e-20 ? static_cast<float>(-0.691 + 10.0 * std::log10(meanSquare)) : -HUGE_VALF;
+    }
+    
+    bool TapMatches(const MeterTap& tap, MeterTap::Point point, int pluginId) {
+        return tap.point == point && (point != MeterTap::Point::AfterPlugin || tap.pluginId == pluginId);
+    }
+}
+
+// LevelMeter
+LevelMeter::LevelMeter() {
+    // 4x interpolator: windowed sinc cut at the input Nyquist, split into
+    // phases so output 4i + p is phase p over the last TRUE_PEAK_TAPS inputs
+    constexpr int length = TRUE_PEAK_PHASES * TRUE_PEAK_TAPS;
+    const double centre = (length - 1) * 0.5;
+    for (int p = 0; p < TRUE_PEAK_PHASES; ++p) {
+        double sum = 0.0;
+        for (int k = 0; k < TRUE_PEAK_TAPS; ++k) {
+            const int m = k * TRUE_PEAK_PHASES + p;
+            const double x = (m - centre) / TRUE_PEAK_PHASES;
+            const double sinc = std::sin(PI * x) / (PI * x);
+            const double window = 0.42 - 0.5 * std::cos(2.0 * PI * (m + 0.5) / length) +
+                                  0.08 * std::cos(4.0 * PI * (m + 0.5) / length);
+            truePeakTaps[p][k] = static_cast<float>(sinc * window);
+            sum += sinc * window;
+        }
+        // Unity gain at DC on every phase
+        for (int k = 0; k < TRUE_PEAK_TAPS; ++k) {
+            truePeakTaps[p][k] = static_cast<float>(truePeakTaps[p][k] / sum);
+        }
+    }
+}
+
+void LevelMeter::restart(int channels, double rate) {
+    sampleRate = rate;
+    numChannels = channels;
+    
+    // BS.1770 K-weighting: a high shelf for the head, then a high-pass,
+    // derived for this rate from their analogue prototypes
+    double k = std::tan(PI * 1681.974450955533 / rate);
+    const double shelfQ = 0.7071752369554196;
+    const double vh = std::pow(10.0, 3.999843853973347 / 20.0);
+    const double vb = std::pow(vh, 0.4996667741545416);
+    double a0 = 1.0 + k / shelfQ + k * k;
+    shelf.b0 = (vh + vb * k / shelfQ + k * k) / a0;
+    shelf.b1 = 2.0 * (k * k - vh) / a0;
+    shelf.b2 = (vh - vb * k / shelfQ + k * k) / a0;
+    shelf.a1 = 2.0 * (k * k - 1.0) / a0;
+    shelf.a2 = (1.0 - k / shelfQ + k * k) / a0;
+    
+    k = std::tan(PI * 38.13547087602444 / rate);
+    const double highPassQ = 0.5003270373238773;
+    a0 = 1.0 + k / highPassQ + k * k;
+    highPass.b0 = 1.0;
+    highPass.b1 = -2.0;
+    highPass.b2 = 1.0;
+    highPass.a1 = 2.0 * (k * k - 1.0) / a0;
+    highPass.a2 = (1.0 - k / highPassQ + k * k) / a0;
+    
+    // Surround channels (L R C LFE Ls Rs) weigh 1.41, the LFE nothing
+    for (int ch = 0; ch < MAX_CHANNELS; ++ch) {
+        state[ch] = ChannelState{};
+        channelWeight[ch] = 1.0f;
+    }
+    if (channels == 6) {
+        channelWeight[3] = 0.0f;
+        channelWeight[4] = 1.41f;
+        channelWeight[5] = 1.41f;
+    }
+    
+    stepFrames = std::max(1, static_cast<int>(std::lround(rate * 0.1)));
+    stepPosition = 0;
+    stepIndex = 0;
+    std::fill(std::begin(stepEnergies), std::end(stepEnergies), 0.0);
+    momentaryLufs = -HUGE_VALF;
+    shortTermLufs = -HUGE_VALF;
+    maxMomentaryLufs = -HUGE_VALF;
+}
+
+void LevelMeter::process(const float* const* channels, int channelCount, int numSamples, double rate) {
+    channelCount = std::min(channelCount, MAX_CHANNELS);
+    if (numSamples <= 0 || channelCount <= 0 || rate <= 0.0) {
+        return;
+    }
+    if (rate != sampleRate || channelCount != numChannels) {
+        restart(channelCount, rate);
+    }
+    
+    if (resetRequested.exchange(false, std::memory_order_relaxed)) {
+        for (int ch = 0; ch < numChannels; ++ch) {
+            state[ch].peakHold = 0.0f;
+            state[ch].truePeakHold = 0.0f;
+        }
+        maxMomentaryLufs = -HUGE_VALF;
+    }
+    
+    // Block-rate ballistics, so cost does not depend on the block size
+    const float fall = static_cast<float>(std::pow(10.0, -PEAK_FALL_DB_PER_SECOND / 20.0 * numSamples / rate));
+    const double rmsCoefficient = 1.0 - std::exp(-numSamples / (RMS_SECONDS * rate));
+    for (int ch = 0; ch < numChannels; ++ch) {
+        ChannelState& channel = state[ch];
+        const float* samples = channels[ch];
+        
+        const float blockPeak = Simd::peakAbs(samples, numSamples);
+        channel.peak = std::max(blockPeak, channel.peak * fall);
+        channel.peakHold = std::max(channel.peakHold, blockPeak);
+        channel.truePeak *= fall;
+        
+        const double meanSquare = Simd::dotProduct(samples, samples, numSamples) / numSamples;
+        channel.meanSquare += rmsCoefficient * (meanSquare - channel.meanSquare);
+    }
+    
+    // Chunks end at loudness step boundaries and fit the scratch buffers
+    for (int offset = 0; offset < numSamples; ) {
+        const int n = std::min({numSamples - offset, TRUE_PEAK_CHUNK, stepFrames - stepPosition});
+        meterChunk(channels, offset, n);
+        offset += n;
+        stepPosition += n;
+        if (stepPosition == stepFrames) {
+            finishStep();
+        }
+    }
+    ++blocks;
+    
+    MeterSnapshot snapshot;
+    snapshot.numChannels = numChannels;
+    snapshot.blocks = blocks;
+    for (int ch = 0; ch < numChannels; ++ch) {
+        const ChannelState& channel = state[ch];
+        snapshot.peak[ch] = channel.peak;
+        snapshot.peakHold[ch] = channel.peakHold;
+        snapshot.rms[ch] = static_cast<float>(std::sqrt(channel.meanSquare));
+        snapshot.truePeak[ch] = channel.truePeak;
+        snapshot.truePeakHold[ch] = channel.truePeakHold;
+    }
+    snapshot.momentaryLufs = momentaryLufs;
+    snapshot.shortTermLufs = shortTermLufs;
+    snapshot.maxMomentaryLufs = maxMomentaryLufs;
+    published.publish(snapshot);
+}
+
+void LevelMeter::meterChunk(const float* const* channels, int offset, int numSamples) {
+    constexpr int historyLength = TRUE_PEAK_TAPS - 1;
+    
+    for (int ch = 0; ch < numChannels; ++ch) {
+        ChannelState& channel = state[ch];
+        const float* samples = channels[ch] + offset;
+        
+        // K-weighted energy; the filters are recursive, so scalar in double
+        double shelfZ1 = channel.shelfZ1, shelfZ2 = channel.shelfZ2;
+        double highPassZ1 = channel.highPassZ1, highPassZ2 = channel.highPassZ2;
+        for (int i = 0; i < numSamples; ++i) {
+            const double x = samples[i];
+            const double shelved = shelf.b0 * x + shelfZ1;
+            shelfZ1 = shelf.b1 * x - shelf.a1 * shelved + shelfZ2;
+            shelfZ2 = shelf.b2 * x - shelf.a2 * shelved;
+            const double y = highPass.b0 * shelved + highPassZ1;
+            highPassZ1 = highPass.b1 * shelved - highPass.a1 * y + highPassZ2;
+            highPassZ2 = highPass.b2 * shelved - highPass.a2 * y;
+            weighted[i] = static_cast<float>(y);
+        }
+        channel.shelfZ1 = shelfZ1;
+        channel.shelfZ2 = shelfZ2;
+        channel.highPassZ1 = highPassZ1;
+        channel.highPassZ2 = highPassZ2;
+        channel.stepEnergy += Simd::dotProduct(weighted, weighted, numSamples);
+        
+        // True peak: each phase of the interpolator is a sum of shifted
+        // copies of the input, so it runs as vector multiply-adds
+        std::copy_n(channel.history, historyLength, line);
+        std::copy_n(samples, numSamples, line + historyLength);
+        float truePeak = 0.0f;
+        for (int p = 0; p < TRUE_PEAK_PHASES; ++p) {
+            std::fill_n(upsampled, numSamples, 0.0f);
+            for (int k = 0; k < TRUE_PEAK_TAPS; ++k) {
+                Simd::multiplyAdd(upsampled, line + historyLength - k, truePeakTaps[p][k], numSamples);
+            }
+            truePeak = std::max(truePeak, Simd::peakAbs(upsampled, numSamples));
+        }
+        std::copy_n(line + numSamples, historyLength, channel.history);
+        
+        channel.truePeak = std::max(channel.truePeak, truePeak);
+        channel.truePeakHold = std::max(channel.truePeakHold, truePeak);
+    }
+}
+
+// One 100 ms step of channel-weighted energy into the ring; momentary
+// loudness averages the last 4 steps and short-term all 30
+void LevelMeter::finishStep() {
+    double energy = 0.0;
+    for (int ch = 0; ch < numChannels; ++ch) {
+        energy += channelWeight[ch] * state[ch].stepEnergy;
+        state[ch].stepEnergy = 0.0;
+    }
+    stepEnergies[stepIndex] = energy / stepFrames;
+    stepIndex = (stepIndex + 1) % LOUDNESS_STEPS;
+    stepPosition = 0;
+    
+    double momentary = 0.0;
+    double shortTerm = 0.0;
+    for (int i = 0; i < LOUDNESS_STEPS; ++i) {
+        const double step = stepEnergies[(stepIndex + LOUDNESS_STEPS - 1 - i) % LOUDNESS_STEPS];
+        if (i < 4) {
+            momentary += step;
+        }
+        shortTerm += step;
+    }
+    momentaryLufs = ToLufs(momentary / 4);
+    shortTermLufs = ToLufs(shortTerm / LOUDNESS_STEPS);
+    maxMomentaryLufs = std::max(maxMomentaryLufs, momentaryLufs);
+}
+
+// SpectrumAnalyzer
+SpectrumAnalyzer::SpectrumAnalyzer(const SpectrumSettings& requested) : settings(requested) {
+    int size = 256;
+    while (size < std::min(settings.fftSize, 32768)) {
+        size <<= 1;
+    }
+    settings.fftSize = size;
+    settings.overlap = std::clamp(settings.overlap, 1, size / 4);
+    settings.smoothing = std::clamp(settings.smoothing, 0.0f, 0.99f);
+    settings.maxChannels = std::clamp(settings.maxChannels, 1, MAX_CHANNELS);
+    hopSize = size / settings.overlap;
+    numBins = size / 2 + 1;
+    
+    // A few FFTs of slack for the worker's polling
+    ring.allocate(settings.maxChannels, std::max(4 * size, 16384));
+    
+    // Periodic Hann; the scale makes a full-scale bin-centred sine read 1
+    fft.setSize(size);
+    window.resize(size);
+    double windowSum = 0.0;
+    for (int i = 0; i < size; ++i) {
+        window[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * PI * i / size));
+        windowSum += window[i];
+    }
+    magnitudeScale = static_cast<float>(2.0 / windowSum);
+    
+    history.assign(settings.maxChannels, std::vector<float>(size, 0.0f));
+    hopPointers.resize(settings.maxChannels);
+    windowed.resize(size);
+    spectrumRe.resize(numBins);
+    spectrumIm.resize(numBins);
+    smoothedPower.assign(static_cast<size_t>(settings.maxChannels) * numBins, 0.0f);
+}
+
+void SpectrumAnalyzer::push(const float* const* channels, int numChannels, int numSamples, double sampleRate) {
+    // Channels past the chain's are written as silence and not analyzed
+    const int width = std::min(numChannels, settings.maxChannels);
+    for (int ch = 0; ch < settings.maxChannels; ++ch) {
+        pushPointers[ch] = ch < width ? channels[ch] : nullptr;
+    }
+    activeChannels.store(width, std::memory_order_relaxed);
+    activeSampleRate.store(sampleRate, std::memory_order_relaxed);
+    
+    int written = ring.write(pushPointers, numSamples);
+    if (written < numSamples) {
+        droppedFrames.fetch_add(static_cast<uint64_t>(numSamples - written), std::memory_order_relaxed);
+    }
+}
+
+bool SpectrumAnalyzer::analyze() {
+    const int size = settings.fftSize;
+    bool analyzed = false;
+    
+    while (ring.getNumReady() >= hopSize) {
+        // Slide every window along by one hop
+        for (int ch = 0; ch < settings.maxChannels; ++ch) {
+            std::copy(history[ch].begin() + hopSize, history[ch].end(), history[ch].begin());
+            hopPointers[ch] = history[ch].data() + size - hopSize;
+        }
+        ring.read(hopPointers.data(), hopSize);
+        
+        // A new chain width or rate starts the smoothing over
+        const int channels = activeChannels.load(std::memory_order_relaxed);
+        const double rate = activeSampleRate.load(std::memory_order_relaxed);
+        if (channels != analyzedChannels || rate != analyzedRate) {
+            std::fill(smoothedPower.begin(), smoothedPower.end(), 0.0f);
+            analyzedChannels = channels;
+            analyzedRate = rate;
+        }
+        
+        const float keep = settings.smoothing;
+        for (int ch = 0; ch < analyzedChannels; ++ch) {
+            const float* samples = history[ch].data();
+            for (int i = 0; i < size; ++i) {
+                windowed[i] = samples[i] * window[i];
+            }
+            fft.forward(windowed.data(), spectrumRe.data(), spectrumIm.data());
+            
+            float* power = smoothedPower.data() + static_cast<size_t>(ch) * numBins;
+            for (int k = 0; k < numBins; ++k) {
+                const float binPower = spectrumRe[k] * spectrumRe[k] + spectrumIm[k] * spectrumIm[k];
+                power[k] = keep * power[k] + (1.0f - keep) * binPower;
+            }
+        }
+        ++frameIndex;
+        analyzed = true;
+    }
+    
+    if (!analyzed) {
+        return false;
+    }
+    
+    // Only the newest frame of a backlog is published
+    SpectrumFrame& frame = published.back();
+    frame.numChannels = analyzedChannels;
+    frame.numBins = numBins;
+    frame.sampleRate = analyzedRate;
+    frame.frameIndex = frameIndex;
+    frame.magnitudes.resize(static_cast<size_t>(analyzedChannels) * numBins);
+    for (size_t i = 0; i < frame.magnitudes.size(); ++i) {
+        frame.magnitudes[i] = std::sqrt(smoothedPower[i]) * magnitudeScale;
+    }
+    published.publish();
+    return true;
+}
+
+// Host
+int EnhancedVSTHost::addMeter(const MeterTap& tap) {
+    auto meter = std::make_shared<LevelMeter>();
+    int meterId = nextMeterId++;
+    {
+        std::lock_guard<std::mutex> lock(pluginMutex);
+        chainMeters.push_back({meterId, tap, meter});
+    }
+    
+    std::lock_guard<std::mutex> lock(meterMutex);
+    meterLookup[meterId] = std::move(meter);
+    return meterId;
+}
+
+void EnhancedVSTHost::removeMeter(int meterId) {
+    {
+        std::lock_guard<std::mutex> lock(pluginMutex);
+        chainMeters.erase(std::remove_if(chainMeters.begin(), chainMeters.end(),
+                                         [meterId](const ChainMeter& m) { return m.id == meterId; }),
+                          chainMeters.end());
+    }
+    
+    std::lock_guard<std::mutex> lock(meterMutex);
+    meterLookup.erase(meterId);
+}
+
+std::shared_ptr<LevelMeter> EnhancedVSTHost::getMeter(int meterId) const {
+    std::lock_guard<std::mutex> lock(meterMutex);
+    auto it = meterLookup.find(meterId);
+    return it != meterLookup.end() ? it->second : nullptr;
+}
+
+bool EnhancedVSTHost::readMeter(int meterId, MeterSnapshot& snapshot) const {
+    std::shared_ptr<LevelMeter> meter = getMeter(meterId);
+    if (!meter) {
+        return false;
+    }
+    snapshot = meter->read();
+    return true;
+}
+
+int EnhancedVSTHost::addSpectrumAnalyzer(const MeterTap& tap, const SpectrumSettings& settings) {
+    auto analyzer = std::make_shared<SpectrumAnalyzer>(settings);
+    int analyzerId = nextSpectrumId++;
+    {
+        std::lock_guard<std::mutex> lock(pluginMutex);
+        chainSpectra.push_back({analyzerId, tap, analyzer});
+    }
+    
+    std::lock_guard<std::mutex> lock(spectrumMutex);
+    spectrumLookup[analyzerId] = std::move(analyzer);
+    if (!spectrumThread.joinable()) {
+        spectrumStop = false;
+        spectrumThread = std::thread(&EnhancedVSTHost::spectrumThreadFunc, this);
+    }
+    return analyzerId;
+}
+
+void EnhancedVSTHost::removeSpectrumAnalyzer(int analyzerId) {
+    {
+        std::lock_guard<std::mutex> lock(pluginMutex);
+        chainSpectra.erase(std::remove_if(chainSpectra.begin(), chainSpectra.end(),
+                                          [analyzerId](const ChainSpectrum& s) { return s.id == analyzerId; }),
+                           chainSpectra.end());
+    }
+    
+    std::lock_guard<std::mutex> lock(spectrumMutex);
+    spectrumLookup.erase(analyzerId);
+}
+
+std::shared_ptr<SpectrumAnalyzer> EnhancedVSTHost::getSpectrumAnalyzer(int analyzerId) const {
+    std::lock_guard<std::mutex> lock(spectrumMutex);
+    auto it = spectrumLookup.find(analyzerId);
+    return it != spectrumLookup.end() ? it->second : nullptr;
+}
+
+bool EnhancedVSTHost::readSpectrum(int analyzerId, SpectrumFrame& frame) const {
+    std::shared_ptr<SpectrumAnalyzer> analyzer = getSpectrumAnalyzer(analyzerId);
+    return analyzer && analyzer->read(frame);
+}
+
+void EnhancedVSTHost::stopSpectrumThread() {
+    {
+        std::lock_guard<std::mutex> lock(spectrumMutex);
+        spectrumStop = true;
+    }
+    spectrumCv.notify_all();
+    if (spectrumThread.joinable()) {
+        spectrumThread.join();
+    }
+}
+
+// Polls every 5 ms, well inside a ring's capacity (at least 16384 frames);
+// the FFTs run outside the lock so lookups never wait on them
+void EnhancedVSTHost::spectrumThreadFunc() {
+    std::unique_lock<std::mutex> lock(spectrumMutex);
+    while (!spectrumStop) {
+        spectrumWork.clear();
+        for (const auto& entry : spectrumLookup) {
+            spectrumWork.push_back(entry.second);
+        }
+        
+        lock.unlock();
+        for (const auto& analyzer : spectrumWork) {
+            analyzer->analyze();
+        }
+        lock.lock();
+        
+        spectrumCv.wait_for(lock, std::chrono::milliseconds(5), [this] { return spectrumStop; });
+    }
+    spectrumWork.clear();
+}
+
+// Audio thread, under pluginMutex: one ring copy per analyzer and one
+// metered block per meter at this point
+void EnhancedVSTHost::runTaps(MeterTap::Point point, int pluginId, float** buffers, int numSamples) {
+    auto matches = [point, pluginId](const MeterTap& tap) { return TapMatches(tap, point, pluginId); };
+    
+    for (ChainMeter& chainMeter : chainMeters) {
+        if (matches(chainMeter.tap)) {
+            chainMeter.meter->process(buffers, numChainChannels, numSamples, currentSampleRate);
+        }
+    }
+    for (ChainSpectrum& chainSpectrum : chainSpectra) {
+        if (matches(chainSpectrum.tap)) {
+            chainSpectrum.analyzer->push(buffers, numChainChannels, numSamples, currentSampleRate);
+        }
+    }
+}
+
+// Lets the double-precision chain skip converting blocks nobody taps
+bool EnhancedVSTHost::hasTap(MeterTap::Point point, int pluginId) const {
+    for (const ChainMeter& chainMeter : chainMeters) {
+        if (TapMatches(chainMeter.tap, point, pluginId)) {
+            return true;
+        }
+    }
+    for (const ChainSpectrum& chainSpectrum : chainSpectra) {
+        if (TapMatches(chainSpectrum.tap, point, pluginId)) {
+            return true;
+        }
+    }
+    return false;
+}
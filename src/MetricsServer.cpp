@@ -0,0 +1,246 @@
+// MetricsServer.cpp - Localhost HTTP endpoint for Prometheus scrapes
+#ifdef _WIN32
+// Ahead of windows.h, which would otherwise pull in the old winsock.h
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#endif
+
+#include "EnhancedVSTHost.h"
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+#ifdef _WIN32
+    using Socket = SOCKET;
+    const Socket NO_SOCKET = INVALID_SOCKET;
+    
+    void CloseSocket(Socket socket) { closesocket(socket); }
+    
+    int PollSocket(Socket socket, int timeoutMs) {
+        WSAPOLLFD fd{socket, POLLRDNORM, 0};
+        return WSAPoll(&fd, 1, timeoutMs);
+    }
+#else
+    using Socket = int;
+    const Socket NO_SOCKET = -1;
+    
+    void CloseSocket(Socket socket) { close(socket); }
+    
+    int PollSocket(Socket socket, int timeoutMs) {
+        pollfd fd{socket, POLLIN, 0};
+        return poll(&fd, 1, timeoutMs);
+    }
+#endif
+    
+    // A scraper that hangs up early must not raise SIGPIPE
+#ifdef MSG_NOSIGNAL
+    const int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+    const int SEND_FLAGS = 0;
+#endif
+    
+    const int ACCEPT_POLL_MS = 200;     // Bounds how long stop() waits
+    const int REQUEST_TIMEOUT_MS = 2000;
+    const size_t MAX_REQUEST_BYTES = 8192;
+    
+    void SendAll(Socket socket, const std::string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            int chunk = static_cast<int>(std::min<size_t>(data.size() - sent, 1 << 20));
+            int result = send(socket, data.data() + sent, chunk, SEND_FLAGS);
+            if (result <= 0) {
+                return;
+            }
+            sent += static_cast<size_t>(result);
+        }
+    }
+    
+    std::string Response(const char* status, const char* contentType, const std::string& body) {
+        return std::string("HTTP/1.1 ") + status + "\r\n"
+            "Content-Type: " + contentType + "\r\n"
+            "Content-Length: " + std::to_string(body.size()) + "\r\n"
+            "Connection: close\r\n\r\n" + body;
+    }
+}
+
+MetricsServer::~MetricsServer() {
+    stop();
+}
+
+bool MetricsServer::start(const EVH::MetricsServerSettings& settings, RenderCallback renderCallback) {
+    if (isRunning() || !renderCallback) {
+        return false;
+    }
+
+#ifdef _WIN32
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+        lastError = L"Winsock is not available";
+        return false;
+    }
+#endif
+    
+    Socket server = NO_SOCKET;
+    if (!settings.unixSocketPath.empty()) {
+#ifdef _WIN32
+        WSACleanup();
+        lastError = L"Unix domain sockets are not supported on this platform";
+        return false;
+#else
+        sockaddr_un addr{};
+        if (settings.unixSocketPath.size() >= sizeof(addr.sun_path)) {
+            lastError = L"Socket path is too long";
+            return false;
+        }
+        addr.sun_family = AF_UNIX;
+        std::memcpy(addr.sun_path, settings.unixSocketPath.c_str(), settings.unixSocketPath.size() + 1);
+        
+        // A stale socket file from an earlier run blocks bind()
+        unlink(settings.unixSocketPath.c_str());
+        server = socket(AF_UNIX, SOCK_STREAM, 0);
+        listenSocket = static_cast<std::intptr_t>(server);
+        if (server == NO_SOCKET) {
+            return fail(L"socket");
+        }
+        if (bind(server, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            return fail(L"bind");
+        }
+        unixSocketPath = settings.unixSocketPath;
+        address = unixSocketPath;
+#endif
+    } else {
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(std::clamp(settings.port, 0, 65535)));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        
+        server = socket(AF_INET, SOCK_STREAM, 0);
+        listenSocket = static_cast<std::intptr_t>(server);
+        if (server == NO_SOCKET) {
+            return fail(L"socket");
+        }
+        
+        int reuse = 1;
+        setsockopt(server, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+        if (bind(server, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            return fail(L"bind");
+        }
+        
+        // Report the port actually bound when 0 was asked for
+        socklen_t length = sizeof(addr);
+        getsockname(server, reinterpret_cast<sockaddr*>(&addr), &length);
+        address = "127.0.0.1:" + std::to_string(ntohs(addr.sin_port));
+    }
+    
+    if (listen(server, 8) != 0) {
+        return fail(L"listen");
+    }
+    
+    render = std::move(renderCallback);
+    stopRequested = false;
+    serverThread = std::thread(&MetricsServer::serverThreadFunc, this);
+    return true;
+}
+
+void MetricsServer::stop() {
+    if (!isRunning()) {
+        return;
+    }
+    
+    stopRequested = true;
+    serverThread.join();
+    
+    CloseSocket(static_cast<Socket>(listenSocket));
+    listenSocket = -1;
+#ifdef _WIN32
+    WSACleanup();
+#else
+    if (!unixSocketPath.empty()) {
+        unlink(unixSocketPath.c_str());
+        unixSocketPath.clear();
+    }
+#endif
+    address.clear();
+    render = nullptr;
+}
+
+bool MetricsServer::fail(const std::wstring& what) {
+    lastError = what + L": " + EVH::getLastErrorMessage();
+    if (listenSocket != -1) {
+        CloseSocket(static_cast<Socket>(listenSocket));
+        listenSocket = -1;
+    }
+#ifdef _WIN32
+    WSACleanup();
+#endif
+    address.clear();
+    unixSocketPath.clear();
+    return false;
+}
+
+void MetricsServer::serverThreadFunc() {
+    Socket server = static_cast<Socket>(listenSocket);
+    
+    while (!stopRequested.load()) {
+        if (PollSocket(server, ACCEPT_POLL_MS) <= 0) {
+            continue;
+        }
+        
+        Socket connection = accept(server, nullptr, nullptr);
+        if (connection == NO_SOCKET) {
+            continue;
+        }
+        serveConnection(static_cast<std::intptr_t>(connection));
+        CloseSocket(connection);
+    }
+}
+
+void MetricsServer::serveConnection(std::intptr_t handle) {
+    Socket connection = static_cast<Socket>(handle);
+    
+    // Only the request line matters; read up to the end of the headers
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < MAX_REQUEST_BYTES) {
+        if (PollSocket(connection, REQUEST_TIMEOUT_MS) <= 0) {
+            return;
+        }
+        int received = recv(connection, buffer, sizeof(buffer), 0);
+        if (received <= 0) {
+            break;
+        }
+        request.append(buffer, static_cast<size_t>(received));
+    }
+    
+    std::string requestLine = request.substr(0, request.find("\r\n"));
+    size_t methodEnd = requestLine.find(' ');
+    size_t pathEnd = requestLine.find(' ', methodEnd + 1);
+    if (methodEnd == std::string::npos || pathEnd == std::string::npos) {
+        SendAll(connection, Response("400 Bad Request", "text/plain", "Bad request\n"));
+        return;
+    }
+    
+    std::string method = requestLine.substr(0, methodEnd);
+    std::string path = requestLine.substr(methodEnd + 1, pathEnd - methodEnd - 1);
+    path = path.substr(0, path.find('?'));
+    
+    if (method != "GET") {
+        SendAll(connection, Response("405 Method Not Allowed", "text/plain", "Only GET is supported\n"));
+    } else if (path != "/metrics" && path != "/") {
+        SendAll(connection, Response("404 Not Found", "text/plain", "Metrics are served at /metrics\n"));
+    } else {
+        scrapeCount.fetch_add(1);
+        SendAll(connection, Response("200 OK", "text/plain; version=0.0.4; charset=utf-8", render()));
+    }
+}
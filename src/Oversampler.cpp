@@ -0,0 +1,162 @@
+// Oversampler.cpp - Cascaded 2x polyphase half-band up/down sampling
+#include "EVHDsp.h"
+#include <cmath>
+
+namespace {
+    constexpr double PI = 3.14159265358979323846;
+
+    // Branch taps per stage. The first stage sets the passband (flat to
+    // ~20 kHz at 44.1/48 kHz); later ones only have to reject images of an
+    // already band-limited signal, so they get much shorter.
+    constexpr int STAGE_HALF_TAPS[] = {32, 12, 6};
+
+    // Even taps h[2k] of a 4T - 1 tap half-band lowpass (Blackman-Harris
+    // windowed sinc). The odd taps are zero apart from the centre, 0.5.
+    std::vector<float> DesignHalfBand(int halfTaps) {
+        const int length = 4 * halfTaps - 1;
+        const int centre = 2 * halfTaps - 1;
+        std::vector<float> branch(2 * halfTaps);
+        double sum = 0.0;
+        for (int k = 0; k < 2 * halfTaps; ++k) {
+            const int n = 2 * k;
+            const double x = (n - centre) * 0.5;
+            const double sinc = std::sin(PI * x) / (PI * x);
+            const double phase = 2.0 * PI * (n + 1) / (length + 1);
+            const double window = 0.35875 - 0.48829 * std::cos(phase) + 0.14128 * std::cos(2.0 * phase) -
+                                  0.01168 * std::cos(3.0 * phase);
+            branch[k] = static_cast<float>(0.5 * sinc * window);
+            sum += 0.5 * sinc * window;
+        }
+        // The branch carries half the DC gain, the centre tap the other half
+        for (float& tap : branch) {
+            tap = static_cast<float>(tap * 0.5 / sum);
+        }
+        return branch;
+    }
+}
+
+namespace EVH {
+
+bool Oversampler::prepare(int channels, int blockSize, int newFactor) {
+    int numStages = newFactor == 2 ? 1 : newFactor == 4 ? 2 : newFactor == 8 ? 3 : 0;
+    if (numStages == 0 || channels <= 0 || blockSize <= 0) {
+        return false;
+    }
+
+    numChannels = channels;
+    maxBlockSize = blockSize;
+    factor = newFactor;
+    stages.assign(numStages, Stage{});
+
+    // Stage s runs at 2^s times the base rate; its up and down filters
+    // each delay by (2T - 1) / 2^(s + 1) base frames
+    double delay = 0.0;
+    int stageInput = blockSize;
+    for (int s = 0; s < numStages; ++s) {
+        Stage& stage = stages[s];
+        stage.halfTaps = STAGE_HALF_TAPS[s];
+        stage.branch = DesignHalfBand(stage.halfTaps);
+
+        const int history = 2 * stage.halfTaps - 1;
+        stage.upLine.assign(channels, std::vector<float>(history + stageInput, 0.0f));
+        stage.evenLine.assign(channels, std::vector<float>(history + stageInput, 0.0f));
+        stage.oddLine.assign(channels, std::vector<float>(stage.halfTaps + stageInput, 0.0f));
+        stage.buffers.assign(channels, std::vector<float>(2 * stageInput, 0.0f));
+        stage.bufferPtrs.resize(channels);
+        for (int ch = 0; ch < channels; ++ch) {
+            stage.bufferPtrs[ch] = stage.buffers[ch].data();
+        }
+
+        delay += static_cast<double>(history) / (1 << s);
+        stageInput *= 2;
+    }
+    latency = static_cast<int>(std::lround(delay));
+    scratch.assign(stageInput / 2, 0.0f);
+    return true;
+}
+
+void Oversampler::reset() {
+    for (Stage& stage : stages) {
+        for (int ch = 0; ch < numChannels; ++ch) {
+            std::fill(stage.upLine[ch].begin(), stage.upLine[ch].end(), 0.0f);
+            std::fill(stage.evenLine[ch].begin(), stage.evenLine[ch].end(), 0.0f);
+            std::fill(stage.oddLine[ch].begin(), stage.oddLine[ch].end(), 0.0f);
+        }
+    }
+}
+
+float** Oversampler::upsample(const float* const* input, int channels, int numSamples) {
+    channels = std::min(channels, numChannels);
+    const float* const* stageInput = input;
+    for (Stage& stage : stages) {
+        upStage(stage, stageInput, channels, numSamples);
+        stageInput = stage.bufferPtrs.data();
+        numSamples *= 2;
+    }
+    return stages.back().bufferPtrs.data();
+}
+
+void Oversampler::downsample(float** output, int channels, int numSamples) {
+    channels = std::min(channels, numChannels);
+    for (int s = static_cast<int>(stages.size()) - 1; s >= 0; --s) {
+        float** stageOutput = s > 0 ? stages[s - 1].bufferPtrs.data() : output;
+        downStage(stages[s], stageOutput, channels, numSamples << s);
+    }
+}
+
+// Even outputs are the branch over the input, odd ones the input delayed
+// by T - 1 (the centre tap doubled by the zero stuffing)
+void Oversampler::upStage(Stage& stage, const float* const* input, int channels, int numSamples) {
+    const int taps = 2 * stage.halfTaps;
+    const int history = taps - 1;
+    float* even = scratch.data();
+
+    for (int ch = 0; ch < channels; ++ch) {
+        float* line = stage.upLine[ch].data();
+        std::copy_n(input[ch], numSamples, line + history);
+
+        std::fill_n(even, numSamples, 0.0f);
+        for (int k = 0; k < taps; ++k) {
+            Simd::multiplyAdd(even, line + history - k, 2.0f * stage.branch[k], numSamples);
+        }
+
+        const float* odd = line + history - (stage.halfTaps - 1);
+        float* out = stage.buffers[ch].data();
+        for (int i = 0; i < numSamples; ++i) {
+            out[2 * i] = even[i];
+            out[2 * i + 1] = odd[i];
+        }
+
+        std::copy_n(line + numSamples, history, line);
+    }
+}
+
+// numSamples is the stage's output length; the input is twice that. The
+// branch runs over the even inputs and the centre tap takes the odd ones
+// T frames back.
+void Oversampler::downStage(Stage& stage, float** output, int channels, int numSamples) {
+    const int taps = 2 * stage.halfTaps;
+    const int history = taps - 1;
+
+    for (int ch = 0; ch < channels; ++ch) {
+        float* evenLine = stage.evenLine[ch].data();
+        float* oddLine = stage.oddLine[ch].data();
+        const float* in = stage.buffers[ch].data();
+        for (int i = 0; i < numSamples; ++i) {
+            evenLine[history + i] = in[2 * i];
+            oddLine[stage.halfTaps + i] = in[2 * i + 1];
+        }
+
+        float* out = output[ch];
+        std::copy_n(oddLine, numSamples, out);
+        Simd::multiply(out, 0.5f, numSamples);
+        for (int k = 0; k < taps; ++k) {
+            Simd::multiplyAdd(out, evenLine + history - k, stage.branch[k], numSamples);
+        }
+
+        std::copy_n(evenLine + numSamples, history, evenLine);
+        std::copy_n(oddLine + numSamples, stage.halfTaps, oddLine);
+    }
+}
+
+}
@@ -0,0 +1,135 @@
+// OversamplingNode.cpp - Runs a processor or plugin at a multiple of the chain rate
+#include "EVHNodes.h"
+#include <algorithm>
+#include <cmath>
+
+namespace EVH {
+namespace Nodes {
+
+namespace {
+    // 2, 4 or 8; anything else rounds up to the next of those
+    int ValidFactor(int factor) {
+        return factor <= 2 ? 2 : factor <= 4 ? 4 : 8;
+    }
+}
+
+OversamplingNode::OversamplingNode(std::unique_ptr<AudioProcessor> wrapped, int factor)
+    : processor(std::move(wrapped)), factor(ValidFactor(factor)) {
+}
+
+OversamplingNode::OversamplingNode(std::unique_ptr<PluginInstance> wrapped, int factor)
+    : plugin(std::move(wrapped)), factor(ValidFactor(factor)) {
+    if (plugin && plugin->getState() == PluginState::Unloaded) {
+        plugin->load();
+    }
+}
+
+OversamplingNode::~OversamplingNode() = default;
+
+std::wstring OversamplingNode::getName() const {
+    std::wstring inner = processor ? processor->getName() : plugin ? plugin->getInfo().name : L"Empty";
+    return inner + L" (" + std::to_wstring(factor) + L"x)";
+}
+
+bool OversamplingNode::prepare(const ProcessSetup& setup) {
+    prepared = false;
+    if (!oversampler.prepare(setup.numChannels, setup.maxBlockSize, factor)) {
+        return false;
+    }
+    
+    ProcessSetup inner = setup;
+    inner.sampleRate = setup.sampleRate * factor;
+    inner.maxBlockSize = setup.maxBlockSize * factor;
+    if (processor) {
+        prepared = processor->prepare(inner);
+    } else if (plugin && plugin->prepare(inner)) {
+        // Not running yet, so the switch can happen right here
+        plugin->commitPreparedSetup();
+        if (plugin->getState() == PluginState::Loaded) {
+            plugin->resume();
+        }
+        prepared = true;
+    }
+    return prepared;
+}
+
+void OversamplingNode::process(float** channels, int numChannels, int numSamples, const ProcessContext& context) {
+    if (!prepared || numSamples <= 0) {
+        return;
+    }
+    
+    float** high = oversampler.upsample(channels, numChannels, numSamples);
+    const int highSamples = numSamples * factor;
+    
+    ProcessContext highContext = context;
+    highContext.samplePosition = context.samplePosition * factor;
+    highContext.sampleRate = context.sampleRate * factor;
+    highContext.outputLatencySamples = context.outputLatencySamples * factor;
+    if (processor) {
+        processor->process(high, std::min(numChannels, oversampler.getNumChannels()), highSamples, highContext);
+    } else {
+        plugin->setProcessContext(highContext);
+        plugin->processReplacing(high, high, highSamples);
+    }
+    
+    oversampler.downsample(channels, numChannels, numSamples);
+}
+
+// Plugins are reloaded from their module with the same parameter values,
+// as cloneChainInto() does
+std::unique_ptr<AudioProcessor> OversamplingNode::clone() const {
+    if (processor) {
+        std::unique_ptr<AudioProcessor> copy = processor->clone();
+        return copy ? std::make_unique<OversamplingNode>(std::move(copy), factor) : nullptr;
+    }
+    if (!plugin) {
+        return nullptr;
+    }
+    
+    std::unique_ptr<PluginInstance> copy;
+    if (plugin->isNative()) {
+        std::unique_ptr<AudioProcessor> inner = plugin->cloneProcessor();
+        if (!inner) {
+            return nullptr;
+        }
+        copy = std::make_unique<PluginInstance>(plugin->getInfo(), std::move(inner));
+    } else {
+        copy = std::make_unique<PluginInstance>(plugin->getInfo());
+    }
+    if (!copy->load()) {
+        return nullptr;
+    }
+    for (int i = 0; i < plugin->getParameterCount(); ++i) {
+        copy->setParameter(i, plugin->getParameter(i));
+    }
+    return std::make_unique<OversamplingNode>(std::move(copy), factor);
+}
+
+int OversamplingNode::getParameterCount() const {
+    return processor ? processor->getParameterCount() : plugin ? plugin->getParameterCount() : 0;
+}
+
+float OversamplingNode::getParameter(int index) const {
+    return processor ? processor->getParameter(index) : plugin ? plugin->getParameter(index) : 0.0f;
+}
+
+void OversamplingNode::setParameter(int index, float value) {
+    if (processor) {
+        processor->setParameter(index, value);
+    } else if (plugin) {
+        plugin->setParameter(index, value);
+    }
+}
+
+std::wstring OversamplingNode::getParameterName(int index) const {
+    return processor ? processor->getParameterName(index) : plugin ? plugin->getParameterName(index) : L"";
+}
+
+// The wrapped processor's latency is in high-rate frames
+int OversamplingNode::getLatencySamples() const {
+    const int inner = processor ? processor->getLatencySamples() : plugin ? plugin->getLatencySamples() : 0;
+    return oversampler.getLatencySamples() + static_cast<int>(std::lround(static_cast<double>(inner) / factor));
+}
+
+}
+}
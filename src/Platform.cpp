@@ -0,0 +1,366 @@
+// Platform.cpp - Module loading, strings and error text per OS
+#include "EVHPlatform.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#ifdef _WIN32
+#include <psapi.h>
+#else
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+    // Bundle subdirectory holding the module for this build's architecture
+    const wchar_t* BundleArchitecture() {
+#if defined(_WIN32) && (defined(_M_ARM64) || defined(__aarch64__))
+        return L"arm64-win";
+#elif defined(_WIN32) && (defined(_M_X64) || defined(__x86_64__))
+        return L"x86_64-win";
+#elif defined(_WIN32)
+        return L"x86-win";
+#elif defined(__aarch64__)
+        return L"aarch64-linux";
+#elif defined(__x86_64__)
+        return L"x86_64-linux";
+#else
+        return L"i386-linux";
+#endif
+    }
+}
+
+namespace EVH {
+
+bool DynamicLibrary::open(const std::wstring& path) {
+    close();
+    lastError.clear();
+
+#ifdef _WIN32
+    handle = LoadLibraryW(path.c_str());
+    if (!handle) {
+        lastError = getLastErrorMessage();
+    }
+#else
+    // Local symbols so two plugins exporting the same names don't collide
+    handle = dlopen(fs::path(path).c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!handle) {
+        const char* error = dlerror();
+        lastError = error ? fromUtf8(error) : L"dlopen failed";
+    }
+#endif
+
+    return handle != nullptr;
+}
+
+void DynamicLibrary::close() {
+    if (!handle) {
+        return;
+    }
+
+#ifdef _WIN32
+    FreeLibrary(static_cast<HMODULE>(handle));
+#else
+    dlclose(handle);
+#endif
+    handle = nullptr;
+}
+
+void* DynamicLibrary::getSymbol(const char* name) const {
+    if (!handle) {
+        return nullptr;
+    }
+
+#ifdef _WIN32
+    return reinterpret_cast<void*>(GetProcAddress(static_cast<HMODULE>(handle), name));
+#else
+    return dlsym(handle, name);
+#endif
+}
+
+bool MappedFile::open(const std::wstring& path) {
+    close();
+    lastError.clear();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        lastError = getLastErrorMessage();
+        return false;
+    }
+
+    LARGE_INTEGER fileSize{};
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0) {
+        mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    }
+    if (mapping) {
+        data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    }
+    if (!data) {
+        lastError = fileSize.QuadPart > 0 ? getLastErrorMessage() : L"File is empty";
+    }
+    CloseHandle(file);   // The mapping keeps the file open
+    size = data ? static_cast<uint64_t>(fileSize.QuadPart) : 0;
+#else
+    int fd = ::open(fs::path(path).c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        lastError = getLastErrorMessage();
+        return false;
+    }
+
+    struct stat status{};
+    if (fstat(fd, &status) == 0 && status.st_size > 0) {
+        void* address = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        if (address != MAP_FAILED) {
+            data = static_cast<const uint8_t*>(address);
+            size = static_cast<uint64_t>(status.st_size);
+        } else {
+            lastError = getLastErrorMessage();
+        }
+    } else {
+        lastError = L"File is empty";
+    }
+    ::close(fd);   // The mapping keeps the file open
+#endif
+
+    if (!data) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close() {
+#ifdef _WIN32
+    if (data) {
+        UnmapViewOfFile(data);
+    }
+    if (mapping) {
+        CloseHandle(mapping);
+        mapping = nullptr;
+    }
+#else
+    if (data) {
+        munmap(const_cast<uint8_t*>(data), static_cast<size_t>(size));
+    }
+#endif
+    data = nullptr;
+    size = 0;
+}
+
+void MappedFile::adviseSequential() {
+#ifndef _WIN32
+    advise(0, size, MADV_SEQUENTIAL);
+#endif
+}
+
+void MappedFile::adviseWillNeed(uint64_t offset, uint64_t length) {
+#ifndef _WIN32
+    advise(offset, length, MADV_WILLNEED);
+#else
+    (void)offset;
+    (void)length;
+#endif
+}
+
+void MappedFile::adviseDontNeed(uint64_t offset, uint64_t length) {
+#ifndef _WIN32
+    advise(offset, length, MADV_DONTNEED);
+#else
+    (void)offset;
+    (void)length;
+#endif
+}
+
+void MappedFile::advise(uint64_t offset, uint64_t length, int advice) {
+#ifndef _WIN32
+    if (!data || offset >= size) {
+        return;
+    }
+
+    // madvise wants a page-aligned start
+    static const uint64_t pageSize = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    uint64_t start = offset - offset % pageSize;
+    uint64_t end = std::min(size, offset + length);
+    madvise(const_cast<uint8_t*>(data) + start, static_cast<size_t>(end - start), advice);
+#else
+    (void)offset;
+    (void)length;
+    (void)advice;
+#endif
+}
+
+bool isLoadableModule(const std::wstring& path) {
+#ifdef _WIN32
+    // Map as a data file: no DllMain, no dependency resolution
+    HMODULE module = LoadLibraryExW(path.c_str(), nullptr,
+                                    DONT_RESOLVE_DLL_REFERENCES | LOAD_LIBRARY_AS_DATAFILE);
+    if (!module) {
+        return false;
+    }
+    FreeLibrary(module);
+    return true;
+#else
+    // dlopen would run static constructors, so only check the image header
+    std::ifstream file(fs::path(path), std::ios::binary);
+    unsigned char magic[4] = {};
+    if (!file.read(reinterpret_cast<char*>(magic), sizeof(magic))) {
+        return false;
+    }
+
+#ifdef __APPLE__
+    const uint32_t word = magic[0] | (magic[1] << 8) | (magic[2] << 16) | (static_cast<uint32_t>(magic[3]) << 24);
+    return word == 0xFEEDFACF || word == 0xCAFEBABE || word == 0xBEBAFECA;
+#else
+    return magic[0] == 0x7F && magic[1] == 'E' && magic[2] == 'L' && magic[3] == 'F';
+#endif
+#endif
+}
+
+std::wstring resolvePluginModulePath(const std::wstring& path) {
+    std::error_code ec;
+    fs::path bundle(path);
+    if (!fs::is_directory(bundle, ec)) {
+        return path;
+    }
+
+    // name.vst3/Contents/<arch>/name.vst3 on Windows, name.so on Linux
+    fs::path module = bundle / L"Contents" / BundleArchitecture() / bundle.stem();
+#ifdef _WIN32
+    module += L".vst3";
+#else
+    module += L".so";
+#endif
+    return module.wstring();
+}
+
+std::wstring getLastErrorMessage() {
+#ifdef _WIN32
+    DWORD errorCode = GetLastError();
+    LPWSTR messageBuffer = nullptr;
+    size_t size = FormatMessageW(
+        FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS,
+        NULL, errorCode, MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT),
+        (LPWSTR)&messageBuffer, 0, NULL);
+
+    std::wstring message(messageBuffer, size);
+    LocalFree(messageBuffer);
+
+    // Remove trailing newlines
+    message.erase(message.find_last_not_of(L"\r\n") + 1);
+    return message;
+#else
+    return fromUtf8(std::strerror(errno));
+#endif
+}
+
+std::string toUtf8(const std::wstring& text) {
+#ifdef _WIN32
+    int size = WideCharToMultiByte(CP_UTF8, 0, text.c_str(), static_cast<int>(text.size()),
+                                   nullptr, 0, nullptr, nullptr);
+    std::string result(size, '\0');
+    WideCharToMultiByte(CP_UTF8, 0, text.c_str(), static_cast<int>(text.size()),
+                        result.data(), size, nullptr, nullptr);
+    return result;
+#else
+    // wchar_t holds UTF-32 code points here
+    std::string result;
+    result.reserve(text.size());
+    for (wchar_t wc : text) {
+        uint32_t cp = static_cast<uint32_t>(wc);
+        if (cp < 0x80) {
+            result += static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            result += static_cast<char>(0xC0 | (cp >> 6));
+            result += static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            result += static_cast<char>(0xE0 | (cp >> 12));
+            result += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            result += static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            result += static_cast<char>(0xF0 | (cp >> 18));
+            result += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            result += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            result += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+    return result;
+#endif
+}
+
+std::wstring fromUtf8(const std::string& text) {
+#ifdef _WIN32
+    int size = MultiByteToWideChar(CP_UTF8, 0, text.c_str(), static_cast<int>(text.size()), nullptr, 0);
+    std::wstring result(size, L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, text.c_str(), static_cast<int>(text.size()), result.data(), size);
+    return result;
+#else
+    std::wstring result;
+    result.reserve(text.size());
+    for (size_t i = 0; i < text.size(); ) {
+        unsigned char lead = static_cast<unsigned char>(text[i]);
+        int extra = lead < 0x80 ? 0 : lead < 0xE0 ? 1 : lead < 0xF0 ? 2 : 3;
+        uint32_t cp = extra == 0 ? lead : lead & (0x3F >> extra);
+        if (extra > 0 && i + extra >= text.size()) {
+            break;   // Truncated sequence
+        }
+        for (int k = 1; k <= extra; ++k) {
+            cp = (cp << 6) | (static_cast<unsigned char>(text[i + k]) & 0x3F);
+        }
+        result += static_cast<wchar_t>(cp);
+        i += extra + 1;
+    }
+    return result;
+#endif
+}
+
+std::tm localTime(std::time_t time) {
+    std::tm result{};
+#ifdef _WIN32
+    localtime_s(&result, &time);
+#else
+    localtime_r(&time, &result);
+#endif
+    return result;
+}
+
+ProcessMemory getProcessMemory() {
+    ProcessMemory memory;
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS_EX counters{};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&counters),
+                             sizeof(counters))) {
+        memory.residentBytes = counters.WorkingSetSize;
+        memory.virtualBytes = counters.PrivateUsage;
+    }
+#elif defined(__linux__)
+    // Sizes in pages: total program size, then resident set
+    std::ifstream statm("/proc/self/statm");
+    uint64_t sizePages = 0;
+    uint64_t residentPages = 0;
+    if (statm >> sizePages >> residentPages) {
+        uint64_t pageSize = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+        memory.residentBytes = residentPages * pageSize;
+        memory.virtualBytes = sizePages * pageSize;
+    }
+#else
+    // Peak rather than current resident size, in bytes on macOS
+    struct rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        memory.residentBytes = static_cast<uint64_t>(usage.ru_maxrss);
+    }
+#endif
+    return memory;
+}
+
+}
\ No newline at end of file
@@ -1,359 +1,428 @@
-// PluginScanner.cpp - Plugin scanner with crash isolation
-#include "EnhancedVSTHost.h"
-#include <windows.h>
-#include <shlwapi.h>
-#include <filesystem>
-#include <chrono>
-#include <sstream>
-
-namespace fs = std::filesystem;
-
-// Helper process for scanning plugins in isolation
-const wchar_t* SCANNER_PROCESS_NAME = L"VSTScanner.exe";
-
-PluginScanner::PluginScanner() {
-}
-
-PluginScanner::~PluginScanner() {
-    // Terminate any remaining scanner processes
-    for (auto& job : activeJobs) {
-        if (job.processHandle != INVALID_HANDLE_VALUE) {
-            TerminateProcess(job.processHandle, 1);
-            CloseHandle(job.processHandle);
-        }
-        if (job.pipeHandle != INVALID_HANDLE_VALUE) {
-            CloseHandle(job.pipeHandle);
-        }
-    }
-}
-
-void PluginScanner::scanDirectory(const std::wstring& path,
-                                 std::function<void(const EVH::PluginInfo&)> onPluginFound,
-                                 std::function<void(int, int, const std::wstring&)> onProgress) {
-    
-    std::vector<std::wstring> pluginFiles;
-    
-    // Find all DLL and VST3 files in the directory
-    try {
-        for (const auto& entry : fs::recursive_directory_iterator(path)) {
-            if (entry.is_regular_file()) {
-                auto ext = entry.path().extension().wstring();
-                std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
-                
-                if (ext == L".dll" || ext == L".vst3") {
-                    pluginFiles.push_back(entry.path().wstring());
-                }
-            }
-        }
-    } catch (const std::exception&) {
-        // Directory access error
-        return;
-    }
-    
-    // Scan each plugin
-    int current = 0;
-    for (const auto& pluginPath : pluginFiles) {
-        current++;
-        
-        if (onProgress) {
-            onProgress(current, static_cast<int>(pluginFiles.size()), pluginPath);
-        }
-        
-        EVH::PluginInfo info;
-        if (scanPluginInProcess(pluginPath, info)) {
-            if (onPluginFound) {
-                onPluginFound(info);
-            }
-        }
-        
-        // Check for hung processes periodically
-        if (current % 10 == 0) {
-            terminateHungProcesses();
-        }
-    }
-    
-    // Final cleanup
-    terminateHungProcesses();
-}
-
-bool PluginScanner::scanPluginInProcess(const std::wstring& path, EVH::PluginInfo& info) {
-    // For now, do a simple in-process scan
-    // In a production system, this should launch a separate process
-    
-    // Basic info
-    info.path = path;
-    info.validated = false;
-    
-    // Check file extension
-    std::wstring ext = PathFindExtensionW(path.c_str());
-    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
-    
-    if (ext == L".vst3") {
-        info.type = EVH::PluginType::VST3;
-    } else if (ext == L".dll") {
-        // Could be VST2 or VST3
-        info.type = EVH::PluginType::Unknown;
-    } else {
-        return false;
-    }
-    
-    // Extract plugin name from filename
-    wchar_t filename[MAX_PATH];
-    wcscpy_s(filename, PathFindFileNameW(path.c_str()));
-    PathRemoveExtensionW(filename);
-    info.name = filename;
-    
-    // Set default values
-    info.vendor = L"Unknown";
-    info.is64Bit = (sizeof(void*) == 8);
-    info.hasCustomEditor = true;  // Assume true
-    info.numInputs = 2;
-    info.numOutputs = 2;
-    info.uniqueId = 0;
-    info.isInstrument = false;
-    
-    // In a real implementation, we would launch a separate process here
-    // For now, just do basic validation
-    HMODULE hModule = LoadLibraryExW(path.c_str(), nullptr, 
-                                     DONT_RESOLVE_DLL_REFERENCES | 
-                                     LOAD_LIBRARY_AS_DATAFILE);
-    if (hModule) {
-        FreeLibrary(hModule);
-        info.validated = true;
-        return true;
-    }
-    
-    info.errorMsg = L"Failed to load plugin module";
-    return false;
-}
-
-bool PluginScanner::launchScannerProcess(const std::wstring& pluginPath, ScanJob& job) {
-    // Create pipe for communication
-    SECURITY_ATTRIBUTES sa = { sizeof(SECURITY_ATTRIBUTES), nullptr, TRUE };
-    
-    HANDLE hReadPipe, hWritePipe;
-    if (!CreatePipe(&hReadPipe, &hWritePipe, &sa, 0)) {
-        return false;
-    }
-    
-    // Make read handle non-inheritable
-    SetHandleInformation(hReadPipe, HANDLE_FLAG_INHERIT, 0);
-    
-    // Prepare command line
-    std::wstringstream cmdLine;
-    cmdLine << L"\"" << SCANNER_PROCESS_NAME << L"\" \"" << pluginPath << L"\"";
-    
-    // Setup startup info
-    STARTUPINFOW si = { sizeof(STARTUPINFOW) };
-    si.dwFlags = STARTF_USESTDHANDLES | STARTF_USESHOWWINDOW;
-    si.hStdOutput = hWritePipe;
-    si.hStdError = hWritePipe;
-    si.wShowWindow = SW_HIDE;
-    
-    // Create process
-    PROCESS_INFORMATION pi;
-    BOOL success = CreateProcessW(
-        nullptr,
-        const_cast<LPWSTR>(cmdLine.str().c_str()),
-        nullptr,
-        nullptr,
-        TRUE,  // Inherit handles
-        CREATE_NO_WINDOW | CREATE_NEW_PROCESS_GROUP,
-        nullptr,
-        nullptr,
-        &si,
-        &pi
-    );
-    
-    // Close write end of pipe in parent process
-    CloseHandle(hWritePipe);
-    
-    if (!success) {
-        CloseHandle(hReadPipe);
-        return false;
-    }
-    
-    // Close thread handle (not needed)
-    CloseHandle(pi.hThread);
-    
-    // Store handles
-    job.processHandle = pi.hProcess;
-    job.pipeHandle = hReadPipe;
-    job.startTime = std::chrono::steady_clock::now();
-    
-    return true;
-}
-
-bool PluginScanner::readScanResult(HANDLE pipe, EVH::PluginInfo& info) {
-    std::string buffer;
-    char readBuffer[4096];
-    DWORD bytesRead;
-    
-    // Read all data from pipe
-    while (ReadFile(pipe, readBuffer, sizeof(readBuffer) - 1, &bytesRead, nullptr) && bytesRead > 0) {
-        readBuffer[bytesRead] = '\0';
-        buffer += readBuffer;
-    }
-    
-    // Parse the result (simple key-value format)
-    std::istringstream stream(buffer);
-    std::string line;
-    
-    while (std::getline(stream, line)) {
-        size_t pos = line.find('=');
-        if (pos != std::string::npos) {
-            std::string key = line.substr(0, pos);
-            std::string value = line.substr(pos + 1);
-            
-            if (key == "path") {
-                int len = MultiByteToWideChar(CP_UTF8, 0, value.c_str(), -1, nullptr, 0);
-                if (len > 0) {
-                    info.path.resize(len - 1);
-                    MultiByteToWideChar(CP_UTF8, 0, value.c_str(), -1, &info.path[0], len);
-                }
-            } else if (key == "name") {
-                int len = MultiByteToWideChar(CP_UTF8, 0, value.c_str(), -1, nullptr, 0);
-                if (len > 0) {
-                    info.name.resize(len - 1);
-                    MultiByteToWideChar(CP_UTF8, 0, value.c_str(), -1, &info.name[0], len);
-                }
-            } else if (key == "vendor") {
-                int len = MultiByteToWideChar(CP_UTF8, 0, value.c_str(), -1, nullptr, 0);
-                if (len > 0) {
-                    info.vendor.resize(len - 1);
-                    MultiByteToWideChar(CP_UTF8, 0, value.c_str(), -1, &info.vendor[0], len);
-                }
-            } else if (key == "type") {
-                if (value == "VST3") {
-                    info.type = EVH::PluginType::VST3;
-                } else if (value == "VST2") {
-                    info.type = EVH::PluginType::VST2;
-                } else {
-                    info.type = EVH::PluginType::Unknown;
-                }
-            } else if (key == "is64Bit") {
-                info.is64Bit = (value == "true");
-            } else if (key == "hasEditor") {
-                info.hasCustomEditor = (value == "true");
-            } else if (key == "numInputs") {
-                info.numInputs = std::stoi(value);
-            } else if (key == "numOutputs") {
-                info.numOutputs = std::stoi(value);
-            } else if (key == "uniqueId") {
-                info.uniqueId = static_cast<uint32_t>(std::stoul(value));
-            } else if (key == "isInstrument") {
-                info.isInstrument = (value == "true");
-            } else if (key == "validated") {
-                info.validated = (value == "true");
-            } else if (key == "error") {
-                int len = MultiByteToWideChar(CP_UTF8, 0, value.c_str(), -1, nullptr, 0);
-                if (len > 0) {
-                    info.errorMsg.resize(len - 1);
-                    MultiByteToWideChar(CP_UTF8, 0, value.c_str(), -1, &info.errorMsg[0], len);
-                }
-                return false;
-            }
-        }
-    }
-    
-    return info.validated;
-}
-
-void PluginScanner::terminateHungProcesses() {
-    std::lock_guard<std::mutex> lock(jobMutex);
-    
-    auto now = std::chrono::steady_clock::now();
-    
-    for (auto it = activeJobs.begin(); it != activeJobs.end(); ) {
-        auto elapsed = now - it->startTime;
-        if (std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() > 
-            EVH::MAX_PLUGIN_SCAN_TIME_MS) {
-            
-            // Terminate hung process
-            TerminateProcess(it->processHandle, 1);
-            CloseHandle(it->processHandle);
-            CloseHandle(it->pipeHandle);
-            
-            it = activeJobs.erase(it);
-        } else {
-            ++it;
-        }
-    }
-}
-
-// Scanner process implementation (separate executable)
-// This would be compiled as a separate VSTScanner.exe
-#ifdef BUILD_SCANNER_PROCESS
-
-#include <iostream>
-#include <windows.h>
-#include <string>
-
-// Simple VST3 scanner entry point
-int wmain(int argc, wchar_t* argv[]) {
-    if (argc != 2) {
-        std::wcerr << L"Usage: VSTScanner.exe <plugin_path>" << std::endl;
-        return 1;
-    }
-    
-    const wchar_t* pluginPath = argv[1];
-    
-    // Set up structured exception handling
-    __try {
-        // Load the plugin
-        HMODULE hModule = LoadLibraryW(pluginPath);
-        if (!hModule) {
-            std::cout << "error=Failed to load plugin DLL" << std::endl;
-            return 1;
-        }
-        
-        // Convert path to UTF-8 for output
-        int pathLen = WideCharToMultiByte(CP_UTF8, 0, pluginPath, -1, nullptr, 0, nullptr, nullptr);
-        std::string utf8Path(pathLen - 1, '\0');
-        WideCharToMultiByte(CP_UTF8, 0, pluginPath, -1, &utf8Path[0], pathLen, nullptr, nullptr);
-        
-        std::cout << "path=" << utf8Path << std::endl;
-        
-        // Check for VST3 entry point
-        typedef void* (*GetPluginFactory)();
-        GetPluginFactory getFactory = (GetPluginFactory)GetProcAddress(hModule, "GetPluginFactory");
-        
-        if (getFactory) {
-            // VST3 plugin
-            std::cout << "type=VST3" << std::endl;
-            std::cout << "is64Bit=" << (sizeof(void*) == 8 ? "true" : "false") << std::endl;
-            
-            // Try to get factory
-            void* factory = getFactory();
-            if (factory) {
-                // In a real implementation, would query the factory for plugin info
-                std::cout << "name=VST3 Plugin" << std::endl;
-                std::cout << "vendor=Unknown" << std::endl;
-                std::cout << "numInputs=2" << std::endl;
-                std::cout << "numOutputs=2" << std::endl;
-                std::cout << "hasEditor=true" << std::endl;
-                std::cout << "isInstrument=false" << std::endl;
-                std::cout << "uniqueId=0" << std::endl;
-                std::cout << "validated=true" << std::endl;
-            } else {
-                std::cout << "error=Failed to get plugin factory" << std::endl;
-                FreeLibrary(hModule);
-                return 1;
-            }
-        } else {
-            // Not a VST3 plugin
-            std::cout << "error=Not a VST3 plugin (GetPluginFactory not found)" << std::endl;
-            FreeLibrary(hModule);
-            return 1;
-        }
-        
-        FreeLibrary(hModule);
-        return 0;
-        
-    } __except(EXCEPTION_EXECUTE_HANDLER) {
-        std::cout << "error=Plugin crashed during scanning" << std::endl;
-        return 1;
-    }
-}
-
+// PluginScanner.cpp - Plugin scanner with crash isolation
+#include "EnhancedVSTHost.h"
+#include <filesystem>
+#include <chrono>
+#include <sstream>
+#include <cwctype>
+
+#ifndef _WIN32
+#include <csignal>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+#endif
+
+namespace fs = std::filesystem;
+
+// Helper process for scanning plugins in isolation
+#ifdef _WIN32
+const wchar_t* SCANNER_PROCESS_NAME = L"VSTScanner.exe";
+#else
+const wchar_t* SCANNER_PROCESS_NAME = L"VSTScanner";
+#endif
+
+namespace {
+    bool IsPluginExtension(const fs::path& path) {
+        std::wstring ext = path.extension().wstring();
+        std::transform(ext.begin(), ext.end(), ext.begin(), ::towlower);
+        return ext == L".vst3" || ext == EVH::NATIVE_MODULE_EXTENSION;
+    }
+    
+    void KillScanner(EVH::ProcessHandle process, EVH::PipeHandle pipe) {
+#ifdef _WIN32
+        if (process != INVALID_HANDLE_VALUE) {
+            TerminateProcess(process, 1);
+            CloseHandle(process);
+        }
+        if (pipe != INVALID_HANDLE_VALUE) {
+            CloseHandle(pipe);
+        }
+#else
+        if (process > 0) {
+            kill(process, SIGKILL);
+            waitpid(process, nullptr, 0);
+        }
+        if (pipe >= 0) {
+            close(pipe);
+        }
+#endif
+    }
+}
+
+PluginScanner::PluginScanner() {
+}
+
+PluginScanner::~PluginScanner() {
+    // Terminate any remaining scanner processes
+    for (auto& job : activeJobs) {
+        KillScanner(job.processHandle, job.pipeHandle);
+    }
+}
+
+void PluginScanner::scanDirectory(const std::wstring& path,
+                                 std::function<void(const EVH::PluginInfo&)> onPluginFound,
+                                 std::function<void(int, int, const std::wstring&)> onProgress) {
+    
+    std::vector<std::wstring> pluginFiles;
+    
+    // Find all native modules and VST3 files/bundles in the directory
+    try {
+        for (auto it = fs::recursive_directory_iterator(path); it != fs::recursive_directory_iterator(); ++it) {
+            if (!IsPluginExtension(it->path())) {
+                continue;
+            }
+            
+            if (it->is_directory()) {
+                // VST3 bundle: the module inside is resolved at load time
+                pluginFiles.push_back(it->path().wstring());
+                it.disable_recursion_pending();
+            } else if (it->is_regular_file()) {
+                pluginFiles.push_back(it->path().wstring());
+            }
+        }
+    } catch (const std::exception&) {
+        // Directory access error
+        return;
+    }
+    
+    // Scan each plugin
+    int current = 0;
+    for (const auto& pluginPath : pluginFiles) {
+        current++;
+        
+        if (onProgress) {
+            onProgress(current, static_cast<int>(pluginFiles.size()), pluginPath);
+        }
+        
+        EVH::PluginInfo info;
+        if (scanPluginInProcess(pluginPath, info)) {
+            if (onPluginFound) {
+                onPluginFound(info);
+            }
+        }
+        
+        // Check for hung processes periodically
+        if (current % 10 == 0) {
+            terminateHungProcesses();
+        }
+    }
+    
+    // Final cleanup
+    terminateHungProcesses();
+}
+
+bool PluginScanner::scanPluginInProcess(const std::wstring& path, EVH::PluginInfo& info) {
+    // For now, do a simple in-process scan
+    // In a production system, this should launch a separate process
+    
+    // Basic info
+    info.path = path;
+    info.validated = false;
+    
+    // Check file extension
+    fs::path pluginPath(path);
+    std::wstring ext = pluginPath.extension().wstring();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::towlower);
+    
+    if (ext == L".vst3") {
+        info.type = EVH::PluginType::VST3;
+    } else if (ext == EVH::NATIVE_MODULE_EXTENSION) {
+        // Could be VST2 or VST3
+        info.type = EVH::PluginType::Unknown;
+    } else {
+        return false;
+    }
+    
+    // Extract plugin name from filename
+    info.name = pluginPath.stem().wstring();
+    
+    // Set default values
+    info.vendor = L"Unknown";
+    info.is64Bit = (sizeof(void*) == 8);
+    info.hasCustomEditor = true;  // Assume true
+    info.numInputs = 2;
+    info.numOutputs = 2;
+    info.uniqueId = 0;
+    info.isInstrument = false;
+    
+    // In a real implementation, we would launch a separate process here
+    // For now, just check the module image without running its code
+    if (EVH::isLoadableModule(EVH::resolvePluginModulePath(path))) {
+        info.validated = true;
+        return true;
+    }
+    
+    info.errorMsg = L"Failed to load plugin module";
+    return false;
+}
+
+#ifdef _WIN32
+bool PluginScanner::launchScannerProcess(const std::wstring& pluginPath, ScanJob& job) {
+    // Create pipe for communication
+    SECURITY_ATTRIBUTES sa = { sizeof(SECURITY_ATTRIBUTES), nullptr, TRUE };
+    
+    HANDLE hReadPipe, hWritePipe;
+    if (!CreatePipe(&hReadPipe, &hWritePipe, &sa, 0)) {
+        return false;
+    }
+    
+    // Make read handle non-inheritable
+    SetHandleInformation(hReadPipe, HANDLE_FLAG_INHERIT, 0);
+    
+    // Prepare command line
+    std::wstringstream cmdLine;
+    cmdLine << L"\"" << SCANNER_PROCESS_NAME << L"\" \"" << pluginPath << L"\"";
+    
+    // Setup startup info
+    STARTUPINFOW si = { sizeof(STARTUPINFOW) };
+    si.dwFlags = STARTF_USESTDHANDLES | STARTF_USESHOWWINDOW;
+    si.hStdOutput = hWritePipe;
+    si.hStdError = hWritePipe;
+    si.wShowWindow = SW_HIDE;
+    
+    // Create process
+    PROCESS_INFORMATION pi;
+    BOOL success = CreateProcessW(
+        nullptr,
+        const_cast<LPWSTR>(cmdLine.str().c_str()),
+        nullptr,
+        nullptr,
+        TRUE,  // Inherit handles
+        CREATE_NO_WINDOW | CREATE_NEW_PROCESS_GROUP,
+        nullptr,
+        nullptr,
+        &si,
+        &pi
+    );
+    
+    // Close write end of pipe in parent process
+    CloseHandle(hWritePipe);
+    
+    if (!success) {
+        CloseHandle(hReadPipe);
+        return false;
+    }
+    
+    // Close thread handle (not needed)
+    CloseHandle(pi.hThread);
+    
+    // Store handles
+    job.processHandle = pi.hProcess;
+    job.pipeHandle = hReadPipe;
+    job.startTime = std::chrono::steady_clock::now();
+    
+    return true;
+}
+#else
+bool PluginScanner::launchScannerProcess(const std::wstring& pluginPath, ScanJob& job) {
+    // Create pipe for communication; the read end stays in the parent
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return false;
+    }
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    
+    // Child writes its result to stdout/stderr
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, fds[1], STDERR_FILENO);
+    posix_spawn_file_actions_addclose(&actions, fds[1]);
+    
+    std::string program = EVH::toUtf8(SCANNER_PROCESS_NAME);
+    std::string argument = EVH::toUtf8(pluginPath);
+    char* argv[] = { program.data(), argument.data(), nullptr };
+    
+    pid_t pid = 0;
+    int result = posix_spawnp(&pid, program.c_str(), &actions, nullptr, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    
+    // Close write end of pipe in parent process
+    close(fds[1]);
+    
+    if (result != 0) {
+        close(fds[0]);
+        return false;
+    }
+    
+    job.processHandle = pid;
+    job.pipeHandle = fds[0];
+    job.startTime = std::chrono::steady_clock::now();
+    
+    return true;
+}
+#endif
+
+bool PluginScanner::readScanResult(EVH::PipeHandle pipe, EVH::PluginInfo& info) {
+    std::string buffer;
+    char readBuffer[4096];
+    
+    // Read all data from pipe
+#ifdef _WIN32
+    DWORD bytesRead;
+    while (ReadFile(pipe, readBuffer, sizeof(readBuffer) - 1, &bytesRead, nullptr) && bytesRead > 0) {
+        buffer.append(readBuffer, bytesRead);
+    }
+#else
+    ssize_t bytesRead;
+    while ((bytesRead = read(pipe, readBuffer, sizeof(readBuffer))) > 0) {
+        buffer.append(readBuffer, static_cast<size_t>(bytesRead));
+    }
+#endif
+    
+    // Parse the result (simple key-value format)
+    std::istringstream stream(buffer);
+    std::string line;
+    
+    while (std::getline(stream, line)) {
+        size_t pos = line.find('=');
+        if (pos != std::string::npos) {
+            std::string key = line.substr(0, pos);
+            std::string value = line.substr(pos + 1);
+            
+            if (key == "path") {
+                info.path = EVH::fromUtf8(value);
+            } else if (key == "name") {
+                info.name = EVH::fromUtf8(value);
+            } else if (key == "vendor") {
+                info.vendor = EVH::fromUtf8(value);
+            } else if (key == "type") {
+                if (value == "VST3") {
+                    info.type = EVH::PluginType::VST3;
+                } else if (value == "VST2") {
+                    info.type = EVH::PluginType::VST2;
+                } else {
+                    info.type = EVH::PluginType::Unknown;
+                }
+            } else if (key == "is64Bit") {
+                info.is64Bit = (value == "true");
+            } else if (key == "hasEditor") {
+                info.hasCustomEditor = (value == "true");
+            } else if (key == "numInputs") {
+                info.numInputs = std::stoi(value);
+            } else if (key == "numOutputs") {
+                info.numOutputs = std::stoi(value);
+            } else if (key == "uniqueId") {
+                info.uniqueId = static_cast<uint32_t>(std::stoul(value));
+            } else if (key == "isInstrument") {
+                info.isInstrument = (value == "true");
+            } else if (key == "validated") {
+                info.validated = (value == "true");
+            } else if (key == "error") {
+                info.errorMsg = EVH::fromUtf8(value);
+                return false;
+            }
+        }
+    }
+    
+    return info.validated;
+}
+
+void PluginScanner::terminateHungProcesses() {
+    std::lock_guard<std::mutex> lock(jobMutex);
+    
+    auto now = std::chrono::steady_clock::now();
+    
+    for (auto it = activeJobs.begin(); it != activeJobs.end(); ) {
+        auto elapsed = now - it->startTime;
+        if (std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() >
+            EVH::MAX_PLUGIN_SCAN_TIME_MS) {
+            
+            // Terminate hung process
+            KillScanner(it->processHandle, it->pipeHandle);
+            
+            it = activeJobs.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+// Scanner process implementation (separate executable)
+// This would be compiled as a separate VSTScanner executable
+#ifdef BUILD_SCANNER_PROCESS
+
+#include <iostream>
+#include <string>
+
+namespace {
+    int ScanModule(const std::wstring& pluginPath) {
+        // Load the plugin
+        EVH::DynamicLibrary module;
+        if (!module.open(EVH::resolvePluginModulePath(pluginPath))) {
+            std::cout << "error=Failed to load plugin module: " << EVH::toUtf8(module.getLastError()) << std::endl;
+            return 1;
+        }
+        
+        std::cout << "path=" << EVH::toUtf8(pluginPath) << std::endl;
+        
+        // Check for VST3 entry point
+        typedef void* (*GetPluginFactory)();
+        GetPluginFactory getFactory = reinterpret_cast<GetPluginFactory>(module.getSymbol("GetPluginFactory"));
+        
+        if (!getFactory) {
+            // Not a VST3 plugin
+            std::cout << "error=Not a VST3 plugin (GetPluginFactory not found)" << std::endl;
+            return 1;
+        }
+        
+        // VST3 plugin
+        std::cout << "type=VST3" << std::endl;
+        std::cout << "is64Bit=" << (sizeof(void*) == 8 ? "true" : "false") << std::endl;
+        
+        // Try to get factory
+        void* factory = getFactory();
+        if (!factory) {
+            std::cout << "error=Failed to get plugin factory" << std::endl;
+            return 1;
+        }
+        
+        // In a real implementation, would query the factory for plugin info
+        std::cout << "name=VST3 Plugin" << std::endl;
+        std::cout << "vendor=Unknown" << std::endl;
+        std::cout << "numInputs=2" << std::endl;
+        std::cout << "numOutputs=2" << std::endl;
+        std::cout << "hasEditor=true" << std::endl;
+        std::cout << "isInstrument=false" << std::endl;
+        std::cout << "uniqueId=0" << std::endl;
+        std::cout << "validated=true" << std::endl;
+        return 0;
+    }
+    
+    // Kept free of objects with destructors so MSVC accepts the SEH guard
+    int GuardedScan(const std::wstring& pluginPath) {
+        EVH_PLUGIN_TRY {
+            return ScanModule(pluginPath);
+        } EVH_PLUGIN_CATCH {
+            std::cout << "error=Plugin crashed during scanning" << std::endl;
+            return 1;
+        }
+    }
+}
+
+// Simple VST3 scanner entry point
+#ifdef _WIN32
+int wmain(int argc, wchar_t* argv[]) {
+    if (argc != 2) {
+        std::wcerr << L"Usage: VSTScanner.exe <plugin_path>" << std::endl;
+        return 1;
+    }
+    
+    return GuardedScan(argv[1]);
+}
+#else
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        std::cerr << "Usage: VSTScanner <plugin_path>" << std::endl;
+        return 1;
+    }
+    
+    // Crashes end this process only; the host reads no result
+    return GuardedScan(EVH::fromUtf8(argv[1]));
+}
+#endif
+
 #endif // BUILD_SCANNER_PROCESS
\ No newline at end of file
@@ -0,0 +1,316 @@
+// SampleRateConverter.cpp - Polyphase resampler and device rate adapter
+#include "EVHDsp.h"
+#include <cmath>
+
+namespace {
+    constexpr double PI = 3.14159265358979323846;
+
+    struct QualitySpec {
+        int taps;
+        int phases;
+        double passband;  // Fraction of the lower Nyquist frequency kept flat
+        double beta;      // Kaiser window shape
+    };
+
+    QualitySpec GetQualitySpec(EVH::ResamplerQuality quality) {
+        switch (quality) {
+            case EVH::ResamplerQuality::Draft:     return { 16,  64, 0.80,  6.0 };
+            case EVH::ResamplerQuality::Normal:    return { 32, 128, 0.88,  8.0 };
+            case EVH::ResamplerQuality::High:      return { 64, 256, 0.92, 10.0 };
+            case EVH::ResamplerQuality::Mastering: return {128, 512, 0.95, 12.5 };
+        }
+        return { 64, 256, 0.92, 10.0 };
+    }
+
+    // Zeroth-order modified Bessel function (series expansion)
+    double BesselI0(double x) {
+        double sum = 1.0;
+        double term = 1.0;
+        double halfX = x * 0.5;
+        for (int k = 1; k < 64; ++k) {
+            term *= (halfX / k) * (halfX / k);
+            sum += term;
+            if (term < sum * 1e-12) {
+                break;
+            }
+        }
+        return sum;
+    }
+}
+
+namespace EVH {
+
+// Sample Rate Converter Implementation
+SampleRateConverter::SampleRateConverter(int numChannels, double inputRate, double outputRate,
+                                         ResamplerQuality quality, int maxInputBlock)
+    : numChannels(numChannels), inputRate(inputRate), outputRate(outputRate) {
+
+    QualitySpec spec = GetQualitySpec(quality);
+    numTaps = spec.taps;
+    numPhases = spec.phases;
+    nominalStep = inputRate / outputRate;
+    step = nominalStep;
+
+    // Cut off below the lower of the two Nyquist frequencies
+    double cutoff = std::min(1.0, outputRate / inputRate) * spec.passband;
+    designFilter(cutoff, spec.beta);
+
+    capacity = numTaps + std::max(1, maxInputBlock) + static_cast<int>(std::ceil(step)) + 1;
+    history.assign(numChannels, std::vector<float>(capacity, 0.0f));
+
+    reset();
+}
+
+void SampleRateConverter::designFilter(double cutoff, double beta) {
+    coefficients.assign(static_cast<size_t>(numPhases + 1) * numTaps, 0.0f);
+
+    const double center = numTaps / 2 - 1;
+    const double halfLength = numTaps / 2.0;
+    const double windowNorm = BesselI0(beta);
+
+    for (int phase = 0; phase <= numPhases; ++phase) {
+        float* row = coefficients.data() + static_cast<size_t>(phase) * numTaps;
+        double fraction = static_cast<double>(phase) / numPhases;
+        double sum = 0.0;
+
+        std::vector<double> taps(numTaps);
+        for (int t = 0; t < numTaps; ++t) {
+            double u = t - center - fraction;
+            double x = cutoff * u;
+            double sinc = (std::abs(x) < 1e-12) ? 1.0 : std::sin(PI * x) / (PI * x);
+            double r = u / halfLength;
+            double window = (std::abs(r) >= 1.0) ? 0.0 : BesselI0(beta * std::sqrt(1.0 - r * r)) / windowNorm;
+            taps[t] = cutoff * sinc * window;
+            sum += taps[t];
+        }
+
+        // Unity DC gain for every branch
+        for (int t = 0; t < numTaps; ++t) {
+            row[t] = static_cast<float>(taps[t] / sum);
+        }
+    }
+}
+
+void SampleRateConverter::reset() {
+    for (auto& channel : history) {
+        std::fill(channel.begin(), channel.end(), 0.0f);
+    }
+
+    // Pre-roll so the first output lines up with the first input frame
+    numBuffered = numTaps / 2 - 1;
+    position = 0.0;
+}
+
+int SampleRateConverter::getMaxOutputFrames(int numInput) const {
+    // Allows for up to 1% of drift trim on top of the nominal ratio
+    return static_cast<int>(std::ceil(numInput / (nominalStep * 0.99))) + 2;
+}
+
+int SampleRateConverter::getInputFramesNeeded(int numOutput) const {
+    return static_cast<int>(std::ceil(numOutput * step)) + 1;
+}
+
+double SampleRateConverter::getLatencyFrames() const {
+    return numTaps / 2.0;
+}
+
+int SampleRateConverter::process(const float* const* inputs, int numInput, float** outputs, int maxOutput) {
+    int consumed = 0;
+    int produced = 0;
+
+    while (true) {
+        // Append as much input as fits behind the filter history
+        int toCopy = std::min(capacity - numBuffered, numInput - consumed);
+        for (int ch = 0; ch < numChannels; ++ch) {
+            float* dest = history[ch].data() + numBuffered;
+            if (inputs && inputs[ch]) {
+                std::memcpy(dest, inputs[ch] + consumed, toCopy * sizeof(float));
+            } else {
+                std::memset(dest, 0, toCopy * sizeof(float));
+            }
+        }
+        numBuffered += toCopy;
+        consumed += toCopy;
+
+        // Produce every output whose filter window is complete
+        while (produced < maxOutput) {
+            int index = static_cast<int>(position);
+            if (index + numTaps > numBuffered) {
+                break;
+            }
+
+            double phasePosition = (position - index) * numPhases;
+            int phase = static_cast<int>(phasePosition);
+            float mu = static_cast<float>(phasePosition - phase);
+            const float* row0 = phaseRow(phase);
+            const float* row1 = phaseRow(phase + 1);
+
+            for (int ch = 0; ch < numChannels; ++ch) {
+                const float* x = history[ch].data() + index;
+                float a = Simd::dotProduct(row0, x, numTaps);
+                float b = Simd::dotProduct(row1, x, numTaps);
+                outputs[ch][produced] = a + mu * (b - a);
+            }
+
+            produced++;
+            position += step;
+        }
+
+        // Discard frames that no future output can reach
+        int drop = std::min(static_cast<int>(position), numBuffered);
+        if (drop > 0) {
+            for (int ch = 0; ch < numChannels; ++ch) {
+                std::memmove(history[ch].data(), history[ch].data() + drop,
+                             (numBuffered - drop) * sizeof(float));
+            }
+            numBuffered -= drop;
+            position -= drop;
+        }
+
+        if (consumed >= numInput || (toCopy == 0 && drop == 0)) {
+            break;
+        }
+    }
+
+    return produced;
+}
+
+// Drift Controller Implementation
+DriftController::DriftController(double targetFill, double timeConstantSeconds, double maxDeviationPpm)
+    : targetFill(targetFill), timeConstant(timeConstantSeconds), maxDeviation(maxDeviationPpm * 1e-6) {
+}
+
+void DriftController::reset() {
+    smoothedFill = targetFill;
+    integral = 0.0;
+    ratio = 1.0;
+    primed = false;
+}
+
+double DriftController::update(double fillFrames, int elapsedFrames, double sampleRate) {
+    double dt = elapsedFrames / sampleRate;
+
+    // The raw fill is a sawtooth at the block rate; average it over ~1/8 of
+    // the loop time constant before using it as the error signal
+    if (!primed) {
+        smoothedFill = fillFrames;
+        primed = true;
+    }
+    double alpha = std::min(1.0, dt / (timeConstant * 0.125));
+    smoothedFill += alpha * (fillFrames - smoothedFill);
+
+    // Critically damped second-order loop: the proportional term sets the
+    // time constant, the integrator converges on the actual drift
+    double error = (smoothedFill - targetFill) / sampleRate;  // Seconds of excess buffering
+    double kp = 1.0 / timeConstant;
+    double ki = kp * kp * 0.25;
+
+    double correction = kp * error + integral;
+    if (std::abs(correction) < maxDeviation) {
+        // No integration while saturated (anti-windup)
+        integral = std::clamp(integral + ki * error * dt, -maxDeviation, maxDeviation);
+    }
+    ratio = 1.0 + std::clamp(kp * error + integral, -maxDeviation, maxDeviation);
+
+    return ratio;
+}
+
+// Resampling Adapter Implementation
+ResamplingAdapter::ResamplingAdapter(int numChannels, double sessionRate, double deviceRate,
+                                     int sessionBlockSize, int maxDeviceBlockSize,
+                                     ResamplerQuality quality)
+    : numChannels(numChannels),
+      sessionBlockSize(sessionBlockSize),
+      maxDeviceBlockSize(maxDeviceBlockSize),
+      inputConverter(numChannels, deviceRate, sessionRate, quality, maxDeviceBlockSize),
+      outputConverter(numChannels, sessionRate, deviceRate, quality, sessionBlockSize) {
+
+    int inputCapacity = inputConverter.getMaxOutputFrames(maxDeviceBlockSize) + 2 * sessionBlockSize;
+    int outputCapacity = outputConverter.getMaxOutputFrames(sessionBlockSize) + maxDeviceBlockSize;
+
+    inputFifo.assign(numChannels, std::vector<float>(inputCapacity, 0.0f));
+    outputFifo.assign(numChannels, std::vector<float>(outputCapacity, 0.0f));
+    sessionInput.assign(numChannels, std::vector<float>(sessionBlockSize, 0.0f));
+    sessionOutput.assign(numChannels, std::vector<float>(sessionBlockSize, 0.0f));
+    sessionInputPtrs.resize(numChannels);
+    sessionOutputPtrs.resize(numChannels);
+    fifoWritePtrs.resize(numChannels);
+
+    for (int ch = 0; ch < numChannels; ++ch) {
+        sessionInputPtrs[ch] = sessionInput[ch].data();
+        sessionOutputPtrs[ch] = sessionOutput[ch].data();
+    }
+}
+
+int ResamplingAdapter::getLatencyFrames() const {
+    double deviceToSession = outputConverter.getOutputRate() / outputConverter.getInputRate();
+    double frames = inputConverter.getLatencyFrames() +
+                    (outputConverter.getLatencyFrames() + sessionBlockSize) * deviceToSession;
+    return static_cast<int>(std::ceil(frames));
+}
+
+void ResamplingAdapter::pushInput(const float** deviceInputs, int numFrames) {
+    if (!deviceInputs) {
+        return;
+    }
+
+    // Keep the newest input if the chain fell behind
+    int capacity = static_cast<int>(inputFifo[0].size());
+    int needed = inputConverter.getMaxOutputFrames(numFrames);
+    int overflow = inputFifoFrames + needed - capacity;
+    if (overflow > 0) {
+        for (int ch = 0; ch < numChannels; ++ch) {
+            std::memmove(inputFifo[ch].data(), inputFifo[ch].data() + overflow,
+                         (inputFifoFrames - overflow) * sizeof(float));
+        }
+        inputFifoFrames -= overflow;
+    }
+
+    for (int ch = 0; ch < numChannels; ++ch) {
+        fifoWritePtrs[ch] = inputFifo[ch].data() + inputFifoFrames;
+    }
+    inputFifoFrames += inputConverter.process(deviceInputs, numFrames, fifoWritePtrs.data(),
+                                              capacity - inputFifoFrames);
+}
+
+void ResamplingAdapter::pullSessionInput() {
+    int available = std::min(inputFifoFrames, sessionBlockSize);
+
+    for (int ch = 0; ch < numChannels; ++ch) {
+        std::memcpy(sessionInput[ch].data(), inputFifo[ch].data(), available * sizeof(float));
+        std::fill(sessionInput[ch].begin() + available, sessionInput[ch].end(), 0.0f);
+        std::memmove(inputFifo[ch].data(), inputFifo[ch].data() + available,
+                     (inputFifoFrames - available) * sizeof(float));
+    }
+    inputFifoFrames -= available;
+}
+
+void ResamplingAdapter::clearSessionOutput() {
+    for (auto& channel : sessionOutput) {
+        std::fill(channel.begin(), channel.end(), 0.0f);
+    }
+}
+
+void ResamplingAdapter::pushSessionOutput() {
+    int capacity = static_cast<int>(outputFifo[0].size());
+
+    for (int ch = 0; ch < numChannels; ++ch) {
+        fifoWritePtrs[ch] = outputFifo[ch].data() + outputFifoFrames;
+    }
+    outputFifoFrames += outputConverter.process(sessionOutputPtrs.data(), sessionBlockSize,
+                                                fifoWritePtrs.data(), capacity - outputFifoFrames);
+}
+
+void ResamplingAdapter::popOutput(float** deviceOutputs, int numFrames) {
+    int available = std::min(outputFifoFrames, numFrames);
+
+    for (int ch = 0; ch < numChannels; ++ch) {
+        std::memcpy(deviceOutputs[ch], outputFifo[ch].data(), available * sizeof(float));
+        std::fill(deviceOutputs[ch] + available, deviceOutputs[ch] + numFrames, 0.0f);
+        std::memmove(outputFifo[ch].data(), outputFifo[ch].data() + available,
+                     (outputFifoFrames - available) * sizeof(float));
+    }
+    outputFifoFrames -= available;
+}
+
+} // namespace EVH
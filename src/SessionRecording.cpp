@@ -0,0 +1,173 @@
+// SessionRecording.cpp - Text format for recorded control sessions
+#include "EnhancedVSTHost.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace {
+    constexpr int FORMAT_VERSION = 1;
+    
+    constexpr EVH::SessionEvent::Type ALL_EVENT_TYPES[] = {
+        EVH::SessionEvent::Type::Load, EVH::SessionEvent::Type::Unload, EVH::SessionEvent::Type::UnloadAll,
+        EVH::SessionEvent::Type::AddToChain, EVH::SessionEvent::Type::RemoveFromChain,
+        EVH::SessionEvent::Type::Move, EVH::SessionEvent::Type::Bypass,
+        EVH::SessionEvent::Type::SetSampleRate, EVH::SessionEvent::Type::SetBufferSize
+    };
+    
+    // Paths may hold spaces but never tabs, so the last field takes the rest
+    std::vector<std::string> SplitFields(const std::string& line, size_t maxFields) {
+        std::vector<std::string> fields;
+        size_t start = 0;
+        while (fields.size() + 1 < maxFields) {
+            size_t tab = line.find('\t', start);
+            if (tab == std::string::npos) {
+                break;
+            }
+            fields.push_back(line.substr(start, tab - start));
+            start = tab + 1;
+        }
+        fields.push_back(line.substr(start));
+        return fields;
+    }
+    
+    std::string FormatRate(double rate) {
+        char text[32];
+        std::snprintf(text, sizeof(text), "%.17g", rate);
+        return text;
+    }
+}
+
+namespace EVH {
+
+const char* getSessionEventName(SessionEvent::Type type) {
+    switch (type) {
+        case SessionEvent::Type::Load: return "load";
+        case SessionEvent::Type::Unload: return "unload";
+        case SessionEvent::Type::UnloadAll: return "unload-all";
+        case SessionEvent::Type::AddToChain: return "add";
+        case SessionEvent::Type::RemoveFromChain: return "remove";
+        case SessionEvent::Type::Move: return "move";
+        case SessionEvent::Type::Bypass: return "bypass";
+        case SessionEvent::Type::SetSampleRate: return "rate";
+        case SessionEvent::Type::SetBufferSize: return "buffer";
+    }
+    return "unknown";
+}
+
+bool SessionRecording::save(const std::wstring& path) const {
+    std::ofstream file(std::filesystem::path(path), std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+    
+    file << "evh-session\t" << FORMAT_VERSION << "\n";
+    file << "rate\t" << FormatRate(sampleRate) << "\n";
+    file << "buffer\t" << bufferSize << "\n";
+    file << "channels\t" << numChannels << "\n";
+    file << "length\t" << lengthFrames << "\n";
+    
+    for (const auto& plugin : plugins) {
+        file << "plugin\t" << plugin.pluginId << "\t" << (plugin.bypassed ? 1 : 0) << "\t"
+             << toUtf8(plugin.path) << "\n";
+    }
+    
+    file << "chain";
+    for (int pluginId : chain) {
+        file << "\t" << pluginId;
+    }
+    file << "\n";
+    
+    // event <position> <type> <plugin> <value> <rate> <path>
+    for (const auto& event : events) {
+        file << "event\t" << event.samplePosition << "\t" << getSessionEventName(event.type) << "\t"
+             << event.pluginId << "\t" << event.value << "\t" << FormatRate(event.rate) << "\t"
+             << toUtf8(event.path) << "\n";
+    }
+    
+    return file.good();
+}
+
+bool SessionRecording::load(const std::wstring& path) {
+    std::ifstream file(std::filesystem::path(path), std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    
+    std::string line;
+    if (!std::getline(file, line) || line.rfind("evh-session\t", 0) != 0 ||
+        std::atoi(line.c_str() + 12) != FORMAT_VERSION) {
+        return false;
+    }
+    
+    *this = SessionRecording();
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty()) {
+            continue;
+        }
+        
+        std::string key = line.substr(0, line.find('\t'));
+        if (key == "rate" || key == "buffer" || key == "channels" || key == "length") {
+            auto fields = SplitFields(line, 2);
+            if (fields.size() != 2) {
+                return false;
+            }
+            
+            const char* value = fields[1].c_str();
+            if (key == "rate") {
+                sampleRate = std::atof(value);
+            } else if (key == "buffer") {
+                bufferSize = std::atoi(value);
+            } else if (key == "channels") {
+                numChannels = std::atoi(value);
+            } else {
+                lengthFrames = std::atoll(value);
+            }
+        } else if (key == "plugin") {
+            auto fields = SplitFields(line, 4);
+            if (fields.size() != 4) {
+                return false;
+            }
+            plugins.push_back({std::atoi(fields[1].c_str()), fromUtf8(fields[3]), fields[2] == "1"});
+        } else if (key == "chain") {
+            std::istringstream ids(line.substr(5));
+            int pluginId = 0;
+            while (ids >> pluginId) {
+                chain.push_back(pluginId);
+            }
+        } else if (key == "event") {
+            auto fields = SplitFields(line, 7);
+            if (fields.size() != 7) {
+                return false;
+            }
+            
+            SessionEvent event;
+            bool known = false;
+            for (SessionEvent::Type type : ALL_EVENT_TYPES) {
+                if (fields[2] == getSessionEventName(type)) {
+                    event.type = type;
+                    known = true;
+                }
+            }
+            if (!known) {
+                return false;
+            }
+            
+            event.samplePosition = std::atoll(fields[1].c_str());
+            event.pluginId = std::atoi(fields[3].c_str());
+            event.value = std::atoi(fields[4].c_str());
+            event.rate = std::atof(fields[5].c_str());
+            event.path = fromUtf8(fields[6]);
+            events.push_back(std::move(event));
+        } else {
+            return false;
+        }
+    }
+    
+    return sampleRate > 0.0 && bufferSize > 0 && numChannels > 0;
+}
+
+}
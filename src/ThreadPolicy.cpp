@@ -0,0 +1,235 @@
+// ThreadPolicy.cpp - Realtime scheduling, affinity and memory locking
+#include "EVHRealtime.h"
+#include <cerrno>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#endif
+
+namespace {
+    constexpr size_t PREFAULT_STACK_BYTES = 256 * 1024;
+    constexpr size_t PAGE_BYTES = 4096;
+
+    std::wstring Widen(const char* text) {
+        return std::wstring(text, text + strlen(text));
+    }
+
+    // Separate frame so the touched region lies below the caller's stack
+#if defined(__GNUC__)
+    __attribute__((noinline))
+#elif defined(_MSC_VER)
+    __declspec(noinline)
+#endif
+    void PrefaultStack() {
+        unsigned char block[PREFAULT_STACK_BYTES];
+        volatile unsigned char* touch = block;
+        for (size_t i = 0; i < PREFAULT_STACK_BYTES; i += PAGE_BYTES) {
+            touch[i] = 0;
+        }
+    }
+
+#if defined(__linux__)
+    // glibc has no wrapper for sched_setattr
+    struct SchedAttr {
+        uint32_t size;
+        uint32_t schedPolicy;
+        uint64_t schedFlags;
+        int32_t schedNice;
+        uint32_t schedPriority;
+        uint64_t schedRuntime;
+        uint64_t schedDeadline;
+        uint64_t schedPeriod;
+    };
+
+    constexpr uint32_t SCHED_DEADLINE_POLICY = 6;
+
+    bool SetDeadline(uint64_t runtimeNs, uint64_t periodNs, std::wstring& note) {
+        SchedAttr attr{};
+        attr.size = sizeof(attr);
+        attr.schedPolicy = SCHED_DEADLINE_POLICY;
+        attr.schedRuntime = runtimeNs;
+        attr.schedDeadline = periodNs;
+        attr.schedPeriod = periodNs;
+
+        if (syscall(SYS_sched_setattr, 0, &attr, 0) == 0) {
+            return true;
+        }
+
+        note = L"SCHED_DEADLINE refused: " + Widen(strerror(errno));
+        if (errno == EBUSY) {
+            note += L" (admission control, or a restricted affinity mask)";
+        }
+        return false;
+    }
+#endif
+
+#ifndef _WIN32
+    bool SetFifo(int priority, std::wstring& note) {
+        int clamped = std::clamp(priority, sched_get_priority_min(SCHED_FIFO), sched_get_priority_max(SCHED_FIFO));
+
+        sched_param param{};
+        param.sched_priority = clamped;
+        int error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (error == 0) {
+            return true;
+        }
+
+        note = L"SCHED_FIFO refused: " + Widen(strerror(error));
+        if (error == EPERM) {
+            rlimit limit{};
+            getrlimit(RLIMIT_RTPRIO, &limit);
+            note += L" (needs CAP_SYS_NICE or RLIMIT_RTPRIO >= " + std::to_wstring(clamped) +
+                    L", current " + std::to_wstring(static_cast<long long>(limit.rlim_cur)) + L")";
+        }
+        return false;
+    }
+#endif
+}
+
+namespace EVH {
+
+ThreadPolicyResult applyThreadPolicy(const ThreadPolicy& policy) {
+    ThreadPolicyResult result;
+    result.attempted = true;
+    std::wstring note;
+
+#ifdef _WIN32
+    // MMCSS registration stays with the engine that owns the thread
+    if (policy.scheduling != ThreadPolicy::Scheduling::Normal) {
+        if (SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL)) {
+            result.schedulingApplied = true;
+            result.scheduling = L"THREAD_PRIORITY_TIME_CRITICAL";
+        } else {
+            result.notes.push_back(L"SetThreadPriority failed: " + std::to_wstring(GetLastError()));
+        }
+    }
+
+    if (!policy.cpus.empty()) {
+        DWORD_PTR mask = 0;
+        for (int cpu : policy.cpus) {
+            if (cpu >= 0 && cpu < static_cast<int>(sizeof(DWORD_PTR) * 8)) {
+                mask |= DWORD_PTR(1) << cpu;
+            }
+        }
+        result.affinityApplied = mask && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+        if (!result.affinityApplied) {
+            result.notes.push_back(L"SetThreadAffinityMask failed");
+        }
+    }
+#else
+    // Affinity first: SCHED_DEADLINE refuses threads pinned to a subset of
+    // the root domain, so deadline requests skip pinning
+    if (!policy.cpus.empty()) {
+        if (policy.scheduling == ThreadPolicy::Scheduling::Deadline) {
+            result.notes.push_back(L"Affinity ignored: not allowed with SCHED_DEADLINE");
+        } else {
+#if defined(__linux__)
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            for (int cpu : policy.cpus) {
+                if (cpu >= 0 && cpu < CPU_SETSIZE) {
+                    CPU_SET(cpu, &set);
+                }
+            }
+            int error = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+            result.affinityApplied = (error == 0);
+            if (error != 0) {
+                result.notes.push_back(L"Affinity refused: " + Widen(strerror(error)));
+            }
+#else
+            result.notes.push_back(L"Affinity not supported on this platform");
+#endif
+        }
+    }
+
+    ThreadPolicy::Scheduling scheduling = policy.scheduling;
+
+#if defined(__linux__)
+    if (scheduling == ThreadPolicy::Scheduling::Deadline) {
+        if (policy.runtimeNs > 0 && policy.periodNs >= policy.runtimeNs &&
+            SetDeadline(policy.runtimeNs, policy.periodNs, note)) {
+            result.schedulingApplied = true;
+            result.scheduling = L"SCHED_DEADLINE " + std::to_wstring(policy.runtimeNs / 1000) +
+                                L"/" + std::to_wstring(policy.periodNs / 1000) + L" us";
+        } else {
+            result.notes.push_back(note.empty() ? L"SCHED_DEADLINE needs runtime <= period" : note);
+            scheduling = ThreadPolicy::Scheduling::Fifo;
+        }
+    }
+#else
+    if (scheduling == ThreadPolicy::Scheduling::Deadline) {
+        result.notes.push_back(L"SCHED_DEADLINE not supported on this platform");
+        scheduling = ThreadPolicy::Scheduling::Fifo;
+    }
+#endif
+
+    if (scheduling == ThreadPolicy::Scheduling::Fifo) {
+        if (SetFifo(policy.priority, note)) {
+            sched_param param{};
+            int current = SCHED_OTHER;
+            pthread_getschedparam(pthread_self(), &current, &param);
+            result.schedulingApplied = true;
+            result.scheduling = L"SCHED_FIFO " + std::to_wstring(param.sched_priority);
+        } else {
+            result.notes.push_back(note);
+        }
+    }
+#endif
+
+    if (policy.prefaultStack) {
+        PrefaultStack();
+        result.stackPrefaulted = true;
+    }
+
+    return result;
+}
+
+MemoryLockResult lockProcessMemory() {
+    MemoryLockResult result;
+
+#ifdef _WIN32
+    result.note = L"Process-wide memory locking is not available on Windows";
+#else
+#ifdef __GLIBC__
+    // Keep freed memory in the (locked) heap instead of returning it
+    mallopt(M_TRIM_THRESHOLD, -1);
+    mallopt(M_MMAP_MAX, 0);
+#endif
+
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0) {
+        result.locked = true;
+        return result;
+    }
+
+    result.note = L"mlockall refused: " + Widen(strerror(errno));
+    if (errno == EPERM || errno == ENOMEM) {
+        rlimit limit{};
+        getrlimit(RLIMIT_MEMLOCK, &limit);
+        result.note += L" (needs CAP_IPC_LOCK or a larger RLIMIT_MEMLOCK, current " +
+                       (limit.rlim_cur == RLIM_INFINITY ? std::wstring(L"unlimited")
+                                                        : std::to_wstring(limit.rlim_cur / 1024) + L" KiB") + L")";
+    }
+#endif
+
+    return result;
+}
+
+void prefaultBuffer(void* data, size_t bytes) {
+    volatile unsigned char* touch = static_cast<unsigned char*>(data);
+    for (size_t i = 0; i < bytes; i += PAGE_BYTES) {
+        touch[i] = touch[i];
+    }
+}
+
+} // namespace EVH
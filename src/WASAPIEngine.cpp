@@ -0,0 +1,577 @@
+// WASAPIEngine.cpp - WASAPI shared-mode engine (Windows only)
+#include "EnhancedVSTHost.h"
+#include <mmdeviceapi.h>
+#include <audioclient.h>
+#include <functiondiscoverykeys_devpkey.h>
+#include <avrt.h>
+#include <algorithm>
+#include <cmath>
+
+#pragma comment(lib, "avrt.lib")
+
+// WASAPI Engine Implementation
+WASAPIEngine::WASAPIEngine() {
+    CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+}
+
+WASAPIEngine::~WASAPIEngine() {
+    shutdown();
+    CoUninitialize();
+}
+
+bool WASAPIEngine::initialize(double sampleRate, int bufferSize) {
+    this->sampleRate = sampleRate;
+    this->bufferSize = bufferSize;
+    
+    HRESULT hr;
+    
+    // Create device enumerator
+    hr = CoCreateInstance(__uuidof(MMDeviceEnumerator), nullptr,
+                         CLSCTX_ALL, __uuidof(IMMDeviceEnumerator),
+                         (void**)&deviceEnumerator);
+    if (FAILED(hr)) {
+        return false;
+    }
+    
+    // Use the selected endpoint, or the default one
+    renderClient.Reset();
+    audioClient.Reset();
+    if (requestedDeviceName.empty() || !selectDevice(requestedDeviceName)) {
+        hr = deviceEnumerator->GetDefaultAudioEndpoint(eRender, eConsole, &audioDevice);
+        if (FAILED(hr)) {
+            return false;
+        }
+    }
+    
+    // Activate audio client
+    hr = audioDevice->Activate(__uuidof(IAudioClient), CLSCTX_ALL,
+                              nullptr, (void**)&audioClient);
+    if (FAILED(hr)) {
+        return false;
+    }
+    
+    // Get mix format
+    WAVEFORMATEX* pWaveformat = nullptr;
+    hr = audioClient->GetMixFormat(&pWaveformat);
+    if (FAILED(hr)) {
+        return false;
+    }
+    
+    // Set up our desired format
+    WAVEFORMATEXTENSIBLE waveFormat = {};
+    waveFormat.Format.wFormatTag = WAVE_FORMAT_EXTENSIBLE;
+    waveFormat.Format.nChannels = 2;
+    waveFormat.Format.nSamplesPerSec = static_cast<DWORD>(sampleRate);
+    waveFormat.Format.wBitsPerSample = 32;
+    waveFormat.Format.nBlockAlign = waveFormat.Format.nChannels * waveFormat.Format.wBitsPerSample / 8;
+    waveFormat.Format.nAvgBytesPerSec = waveFormat.Format.nSamplesPerSec * waveFormat.Format.nBlockAlign;
+    waveFormat.Format.cbSize = sizeof(WAVEFORMATEXTENSIBLE) - sizeof(WAVEFORMATEX);
+    waveFormat.Samples.wValidBitsPerSample = 32;
+    waveFormat.dwChannelMask = SPEAKER_FRONT_LEFT | SPEAKER_FRONT_RIGHT;
+    waveFormat.SubFormat = KSDATAFORMAT_SUBTYPE_IEEE_FLOAT;
+    
+    // Calculate buffer duration (in 100-nanosecond units)
+    REFERENCE_TIME requestedDuration = static_cast<REFERENCE_TIME>(
+        (double)bufferSize / sampleRate * 10000000.0
+    );
+    
+    // Initialize audio client
+    hr = audioClient->Initialize(
+        AUDCLNT_SHAREMODE_SHARED,
+        AUDCLNT_STREAMFLAGS_EVENTCALLBACK | AUDCLNT_STREAMFLAGS_NOPERSIST,
+        requestedDuration,
+        0,
+        (WAVEFORMATEX*)&waveFormat,
+        nullptr
+    );
+    
+    deviceChannels = waveFormat.Format.nChannels;
+    
+    if (FAILED(hr)) {
+        // Try with the mix format if our format failed. The shared-mode mix
+        // format is float; the host resamples if its rate differs.
+        this->sampleRate = pWaveformat->nSamplesPerSec;
+        deviceChannels = pWaveformat->nChannels;
+        
+        hr = audioClient->Initialize(
+            AUDCLNT_SHAREMODE_SHARED,
+            AUDCLNT_STREAMFLAGS_EVENTCALLBACK | AUDCLNT_STREAMFLAGS_NOPERSIST,
+            requestedDuration,
+            0,
+            pWaveformat,
+            nullptr
+        );
+    }
+    
+    CoTaskMemFree(pWaveformat);
+    
+    if (FAILED(hr)) {
+        return false;
+    }
+    
+    // Create event for buffer notification
+    bufferEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    if (!bufferEvent) {
+        return false;
+    }
+    
+    hr = audioClient->SetEventHandle(bufferEvent);
+    if (FAILED(hr)) {
+        CloseHandle(bufferEvent);
+        bufferEvent = nullptr;
+        return false;
+    }
+    
+    // Get render client
+    hr = audioClient->GetService(__uuidof(IAudioRenderClient), (void**)&renderClient);
+    if (FAILED(hr)) {
+        CloseHandle(bufferEvent);
+        bufferEvent = nullptr;
+        return false;
+    }
+    
+    // Get actual buffer size
+    UINT32 bufferFrameCount;
+    hr = audioClient->GetBufferSize(&bufferFrameCount);
+    if (FAILED(hr)) {
+        CloseHandle(bufferEvent);
+        bufferEvent = nullptr;
+        return false;
+    }
+    
+    this->bufferSize = bufferFrameCount;
+    
+    REFERENCE_TIME streamLatency = 0;
+    audioClient->GetStreamLatency(&streamLatency);
+    renderStreamLatency = static_cast<int>(streamLatency * this->sampleRate / 10000000.0);
+    
+    // Optional capture stream; render-only if it cannot be opened
+    captureActive = captureEnabled && initializeCapture();
+    if (captureActive) {
+        prepareCaptureRing(2);
+    }
+    
+    return true;
+}
+
+bool WASAPIEngine::initializeCapture() {
+    HRESULT hr = deviceEnumerator->GetDefaultAudioEndpoint(eCapture, eConsole, &captureDevice);
+    if (FAILED(hr)) {
+        return false;
+    }
+    
+    hr = captureDevice->Activate(__uuidof(IAudioClient), CLSCTX_ALL,
+                                 nullptr, (void**)&captureClient);
+    if (FAILED(hr)) {
+        captureDevice.Reset();
+        return false;
+    }
+    
+    // Shared-mode capture uses the (float) mix format of the input device
+    WAVEFORMATEX* pCaptureFormat = nullptr;
+    hr = captureClient->GetMixFormat(&pCaptureFormat);
+    if (FAILED(hr)) {
+        captureClient.Reset();
+        captureDevice.Reset();
+        return false;
+    }
+    
+    REFERENCE_TIME requestedDuration = static_cast<REFERENCE_TIME>(
+        (double)bufferSize / sampleRate * 10000000.0
+    );
+    
+    hr = captureClient->Initialize(
+        AUDCLNT_SHAREMODE_SHARED,
+        AUDCLNT_STREAMFLAGS_NOPERSIST,
+        requestedDuration,
+        0,
+        pCaptureFormat,
+        nullptr
+    );
+    
+    double captureRate = pCaptureFormat->nSamplesPerSec;
+    captureChannels = pCaptureFormat->nChannels;
+    CoTaskMemFree(pCaptureFormat);
+    
+    if (FAILED(hr)) {
+        captureClient.Reset();
+        captureDevice.Reset();
+        return false;
+    }
+    
+    hr = captureClient->GetService(__uuidof(IAudioCaptureClient), (void**)&captureService);
+    UINT32 captureBufferFrames = 0;
+    if (SUCCEEDED(hr)) {
+        hr = captureClient->GetBufferSize(&captureBufferFrames);
+    }
+    if (FAILED(hr)) {
+        captureService.Reset();
+        captureClient.Reset();
+        captureDevice.Reset();
+        return false;
+    }
+    
+    // Scratch for one full device buffer, plus conversion to the render rate
+    captureScratch.assign(2, std::vector<float>(captureBufferFrames, 0.0f));
+    captureConverter.reset();
+    if (std::abs(captureRate - sampleRate) >= 0.5) {
+        captureConverter = std::make_unique<EVH::SampleRateConverter>(
+            2, captureRate, sampleRate, EVH::ResamplerQuality::Normal, captureBufferFrames);
+        captureConverted.assign(2, std::vector<float>(
+            captureConverter->getMaxOutputFrames(captureBufferFrames), 0.0f));
+    }
+    
+    REFERENCE_TIME streamLatency = 0;
+    captureClient->GetStreamLatency(&streamLatency);
+    captureDeviceLatency = static_cast<int>(streamLatency * sampleRate / 10000000.0) + captureBufferFrames;
+    
+    // Shared-mode capture arrives one device period at a time
+    REFERENCE_TIME capturePeriod = 0;
+    captureClient->GetDevicePeriod(&capturePeriod, nullptr);
+    capturePacketFrames = static_cast<int>(std::ceil(capturePeriod * sampleRate / 10000000.0));
+    
+    return true;
+}
+
+void WASAPIEngine::shutdown() {
+    stop();
+    
+    if (bufferEvent) {
+        CloseHandle(bufferEvent);
+        bufferEvent = nullptr;
+    }
+    
+    renderClient.Reset();
+    audioClient.Reset();
+    audioDevice.Reset();
+    
+    captureService.Reset();
+    captureClient.Reset();
+    captureDevice.Reset();
+    captureConverter.reset();
+    captureActive = false;
+    
+    deviceEnumerator.Reset();
+}
+
+bool WASAPIEngine::start() {
+    if (!audioClient) {
+        return false;
+    }
+    
+    // Start audio thread
+    shouldStop = false;
+    resetProcessContext();
+    audioThread = std::thread(&WASAPIEngine::audioThreadFunc, this);
+    
+    if (captureActive) {
+        captureClient->Start();
+    }
+    
+    // Start audio client
+    HRESULT hr = audioClient->Start();
+    if (FAILED(hr)) {
+        shouldStop = true;
+        if (audioThread.joinable()) {
+            audioThread.join();
+        }
+        return false;
+    }
+    
+    return true;
+}
+
+void WASAPIEngine::stop() {
+    if (audioClient) {
+        audioClient->Stop();
+    }
+    if (captureClient) {
+        captureClient->Stop();
+    }
+    
+    shouldStop = true;
+    if (audioThread.joinable()) {
+        audioThread.join();
+    }
+}
+
+std::vector<std::wstring> WASAPIEngine::getDeviceList() const {
+    std::vector<std::wstring> devices;
+    
+    if (!deviceEnumerator) {
+        return devices;
+    }
+    
+    IMMDeviceCollection* pCollection = nullptr;
+    HRESULT hr = deviceEnumerator->EnumAudioEndpoints(
+        eRender, DEVICE_STATE_ACTIVE, &pCollection
+    );
+    
+    if (SUCCEEDED(hr)) {
+        UINT count;
+        hr = pCollection->GetCount(&count);
+        
+        if (SUCCEEDED(hr)) {
+            for (UINT i = 0; i < count; i++) {
+                IMMDevice* pDevice = nullptr;
+                hr = pCollection->Item(i, &pDevice);
+                
+                if (SUCCEEDED(hr)) {
+                    IPropertyStore* pProps = nullptr;
+                    hr = pDevice->OpenPropertyStore(STGM_READ, &pProps);
+                    
+                    if (SUCCEEDED(hr)) {
+                        PROPVARIANT varName;
+                        PropVariantInit(&varName);
+                        
+                        hr = pProps->GetValue(PKEY_Device_FriendlyName, &varName);
+                        if (SUCCEEDED(hr) && varName.vt == VT_LPWSTR) {
+                            devices.push_back(varName.pwszVal);
+                            PropVariantClear(&varName);
+                        }
+                        
+                        pProps->Release();
+                    }
+                    
+                    pDevice->Release();
+                }
+            }
+        }
+        
+        pCollection->Release();
+    }
+    
+    return devices;
+}
+
+bool WASAPIEngine::selectDevice(const std::wstring& deviceName) {
+    if (!deviceEnumerator) {
+        // Not initialized yet: remember the choice for initialize()
+        requestedDeviceName = deviceName;
+        return true;
+    }
+    
+    // Stop current audio if running
+    bool wasRunning = (audioClient != nullptr);
+    if (wasRunning) {
+        stop();
+    }
+    
+    // Find and select the device
+    IMMDeviceCollection* pCollection = nullptr;
+    HRESULT hr = deviceEnumerator->EnumAudioEndpoints(
+        eRender, DEVICE_STATE_ACTIVE, &pCollection
+    );
+    
+    if (SUCCEEDED(hr)) {
+        UINT count;
+        hr = pCollection->GetCount(&count);
+        
+        if (SUCCEEDED(hr)) {
+            for (UINT i = 0; i < count; i++) {
+                IMMDevice* pDevice = nullptr;
+                hr = pCollection->Item(i, &pDevice);
+                
+                if (SUCCEEDED(hr)) {
+                    IPropertyStore* pProps = nullptr;
+                    hr = pDevice->OpenPropertyStore(STGM_READ, &pProps);
+                    
+                    if (SUCCEEDED(hr)) {
+                        PROPVARIANT varName;
+                        PropVariantInit(&varName);
+                        
+                        hr = pProps->GetValue(PKEY_Device_FriendlyName, &varName);
+                        if (SUCCEEDED(hr) && varName.vt == VT_LPWSTR) {
+                            if (deviceName == varName.pwszVal) {
+                                // Found the device
+                                requestedDeviceName = deviceName;
+                                audioDevice.Reset();
+                                audioDevice = pDevice;
+                                pDevice = nullptr;  // Don't release since we're keeping it
+                                
+                                PropVariantClear(&varName);
+                                pProps->Release();
+                                
+                                // Re-initialize with new device
+                                if (wasRunning) {
+                                    initialize(sampleRate, bufferSize);
+                                    start();
+                                }
+                                
+                                pCollection->Release();
+                                return true;
+                            }
+                            PropVariantClear(&varName);
+                        }
+                        
+                        pProps->Release();
+                    }
+                    
+                    if (pDevice) {
+                        pDevice->Release();
+                    }
+                }
+            }
+        }
+        
+        pCollection->Release();
+    }
+    
+    return false;
+}
+
+void WASAPIEngine::audioThreadFunc() {
+    // Set thread priority
+    DWORD taskIndex = 0;
+    HANDLE hTask = AvSetMmThreadCharacteristics(L"Pro Audio", &taskIndex);
+    
+    if (hTask) {
+        AvSetMmThreadPriority(hTask, AVRT_PRIORITY_HIGH);
+    }
+    
+    // MMCSS owns the priority; the policy adds affinity and prefaulting
+    EVH::ThreadPolicy policy = threadPolicy;
+    policy.scheduling = EVH::ThreadPolicy::Scheduling::Normal;
+    EVH::ThreadPolicyResult policyResult = applyEngineThreadPolicy(policy);
+    if (hTask) {
+        policyResult.schedulingApplied = true;
+        policyResult.scheduling = L"MMCSS Pro Audio";
+    }
+    setThreadPolicyResult(policyResult);
+    
+    // Prepare buffers (host side is stereo; extra device channels get silence)
+    const int numChannels = 2;
+    std::vector<float> interleavedBuffer(bufferSize * numChannels, 0.0f);
+    std::vector<std::vector<float>> inputBuffers(numChannels, std::vector<float>(bufferSize, 0.0f));
+    std::vector<std::vector<float>> outputBuffers(numChannels, std::vector<float>(bufferSize, 0.0f));
+    
+    std::vector<const float*> inputPtrs(numChannels);
+    std::vector<float*> inputWritePtrs(numChannels);
+    std::vector<float*> outputPtrs(numChannels);
+    
+    for (int ch = 0; ch < numChannels; ++ch) {
+        inputPtrs[ch] = inputBuffers[ch].data();
+        inputWritePtrs[ch] = inputBuffers[ch].data();
+        outputPtrs[ch] = outputBuffers[ch].data();
+    }
+    
+    bool primed = false;
+    
+    while (!shouldStop) {
+        // Wait for buffer event
+        DWORD waitResult = WaitForSingleObject(bufferEvent, 2000);
+        if (waitResult != WAIT_OBJECT_0) {
+            if (waitResult == WAIT_TIMEOUT) {
+                continue;
+            }
+            break;  // Error occurred
+        }
+        
+        // Get buffer
+        UINT32 numFramesAvailable;
+        HRESULT hr = audioClient->GetCurrentPadding(&numFramesAvailable);
+        if (FAILED(hr)) {
+            continue;
+        }
+        
+        UINT32 numFramesToWrite = bufferSize - numFramesAvailable;
+        if (numFramesToWrite == 0) {
+            continue;
+        }
+        
+        // Nothing left queued on the device: it ran dry before this wakeup
+        if (primed && numFramesAvailable == 0) {
+            xrunCount.fetch_add(1, std::memory_order_relaxed);
+        }
+        primed = true;
+        
+        BYTE* pData;
+        hr = renderClient->GetBuffer(numFramesToWrite, &pData);
+        if (FAILED(hr)) {
+            continue;
+        }
+        
+        // Move newly captured input into the ring, then take one block
+        if (captureActive) {
+            drainCapture();
+            readCapturedInput(inputWritePtrs.data(), numFramesToWrite);
+        }
+        
+        // The block plays after what is already queued
+        const auto& context = beginBlock(numFramesToWrite, numFramesAvailable + renderStreamLatency);
+        
+        // Call audio callback
+        if (audioCallback) {
+            // Clear output buffers
+            for (auto& buffer : outputBuffers) {
+                std::fill(buffer.begin(), buffer.begin() + numFramesToWrite, 0.0f);
+            }
+            
+            // Process audio
+            audioCallback(inputPtrs.data(), outputPtrs.data(), numFramesToWrite, context);
+            
+            // Interleave output
+            float* pOut = reinterpret_cast<float*>(pData);
+            for (UINT32 frame = 0; frame < numFramesToWrite; ++frame) {
+                for (int ch = 0; ch < deviceChannels; ++ch) {
+                    *pOut++ = (ch < numChannels) ? outputBuffers[ch][frame] : 0.0f;
+                }
+            }
+        } else {
+            // Fill with silence
+            memset(pData, 0, numFramesToWrite * deviceChannels * sizeof(float));
+        }
+        
+        // Release buffer
+        hr = renderClient->ReleaseBuffer(numFramesToWrite, 0);
+    }
+    
+    if (hTask) {
+        AvRevertMmThreadCharacteristics(hTask);
+    }
+}
+
+void WASAPIEngine::drainCapture() {
+    UINT32 packetFrames = 0;
+    
+    while (SUCCEEDED(captureService->GetNextPacketSize(&packetFrames)) && packetFrames > 0) {
+        BYTE* pData = nullptr;
+        UINT32 numFrames = 0;
+        DWORD flags = 0;
+        
+        if (FAILED(captureService->GetBuffer(&pData, &numFrames, &flags, nullptr, nullptr))) {
+            break;
+        }
+        
+        const UINT32 packetSize = numFrames;
+        numFrames = std::min<UINT32>(numFrames, static_cast<UINT32>(captureScratch[0].size()));
+        
+        // Deinterleave; mono inputs feed both channels
+        const float* pIn = reinterpret_cast<const float*>(pData);
+        for (int ch = 0; ch < 2; ++ch) {
+            float* dest = captureScratch[ch].data();
+            int srcCh = std::min(ch, captureChannels - 1);
+            
+            if (flags & AUDCLNT_BUFFERFLAGS_SILENT) {
+                std::fill_n(dest, numFrames, 0.0f);
+            } else {
+                for (UINT32 frame = 0; frame < numFrames; ++frame) {
+                    dest[frame] = pIn[frame * captureChannels + srcCh];
+                }
+            }
+        }
+        
+        const float* scratchPtrs[2] = { captureScratch[0].data(), captureScratch[1].data() };
+        if (captureConverter) {
+            float* convertedPtrs[2] = { captureConverted[0].data(), captureConverted[1].data() };
+            int converted = captureConverter->process(scratchPtrs, numFrames, convertedPtrs,
+                                                      static_cast<int>(captureConverted[0].size()));
+            const float* readPtrs[2] = { convertedPtrs[0], convertedPtrs[1] };
+            captureRing.write(readPtrs, converted);
+        } else {
+            captureRing.write(scratchPtrs, numFrames);
+        }
+        
+        captureService->ReleaseBuffer(packetSize);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,205 @@
+// BatchMain.cpp - evh_batch: renders many WAV files through one chain on every core
+#include "EnhancedVSTHost.h"
+#include "BenchReport.h"
+#include "SyntheticPlugins.h"
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+using namespace EVH;
+
+namespace {
+    struct Options {
+        std::string chain{"gain,fir,iir"};
+        std::vector<std::string> inputs;
+        std::string outputDir{"rendered"};
+        std::string makeDir;                  // Generate test stems instead of rendering
+        int makeCount{8};
+        double makeSeconds{30.0};
+        BatchSettings batch;
+    };
+    
+    bool ParseFormat(const std::string& name, SampleFormat& format) {
+        if (name == "f32") {
+            format = SampleFormat::Float32;
+        } else if (name == "pcm16") {
+            format = SampleFormat::Pcm16;
+        } else if (name == "pcm24") {
+            format = SampleFormat::Pcm24;
+        } else if (name == "pcm32") {
+            format = SampleFormat::Pcm32;
+        } else {
+            return false;
+        }
+        return true;
+    }
+    
+    // Stereo noise through a slow sweep, so every stem differs
+    bool MakeTestFiles(const Options& options) {
+        std::error_code error;
+        std::filesystem::create_directories(options.makeDir, error);
+        
+        const double sampleRate = 48000.0;
+        const int blockFrames = 4096;
+        std::vector<float> left(blockFrames), right(blockFrames);
+        const float* channels[] = {left.data(), right.data()};
+        
+        for (int n = 0; n < options.makeCount; ++n) {
+            char name[32];
+            std::snprintf(name, sizeof(name), "stem%03d.wav", n);
+            std::filesystem::path path = std::filesystem::path(options.makeDir) / name;
+            
+            AudioFileWriter writer;
+            if (!writer.create(path.wstring(), 2, sampleRate, SampleFormat::Pcm24)) {
+                std::wcerr << writer.getLastError() << std::endl;
+                return false;
+            }
+            
+            uint32_t noiseState = 0x9E3779B9u * (n + 1);
+            double phase = 0.0;
+            const double hz = 110.0 * (n + 1);
+            int64_t remaining = static_cast<int64_t>(options.makeSeconds * sampleRate);
+            while (remaining > 0) {
+                int frames = static_cast<int>(std::min<int64_t>(blockFrames, remaining));
+                for (int i = 0; i < frames; ++i) {
+                    noiseState = noiseState * 1664525u + 1013904223u;
+                    float noise = ((noiseState >> 8) / 16777216.0f - 0.5f) * 0.2f;
+                    float tone = static_cast<float>(std::sin(phase)) * 0.5f;
+                    phase += 2.0 * 3.14159265358979323846 * hz / sampleRate;
+                    left[i] = tone + noise;
+                    right[i] = tone - noise;
+                }
+                if (!writer.write(channels, frames)) {
+                    std::wcerr << writer.getLastError() << std::endl;
+                    return false;
+                }
+                remaining -= frames;
+            }
+            if (!writer.close()) {
+                std::wcerr << writer.getLastError() << std::endl;
+                return false;
+            }
+        }
+        
+        std::cerr << "Wrote " << options.makeCount << " test file(s) to " << options.makeDir << std::endl;
+        return true;
+    }
+    
+    bool BuildChain(EnhancedVSTHost& host, const Options& options) {
+        std::stringstream names(options.chain);
+        std::string name;
+        while (std::getline(names, name, ',')) {
+            if (name.empty()) {
+                continue;
+            }
+            
+            Synthetic::Settings settings;
+            if (!Synthetic::parseKind(name, settings.kind)) {
+                std::cerr << "Unknown synthetic plugin: " << name << std::endl;
+                return false;
+            }
+            int pluginId = host.loadProcessor(Synthetic::create(settings));
+            host.addPluginToChain(pluginId);
+        }
+        return true;
+    }
+    
+    void PrintUsage() {
+        std::cerr <<
+            "Usage: evh_batch [options] <input.wav>...\n"
+            "       evh_batch --make-test-files DIR [--count N] [--seconds S]\n"
+            "  --chain a,b,c       Synthetic plugins in order (default gain,fir,iir)\n"
+            "  --workers N         Worker threads, each with its own chain (default: all cores)\n"
+            "  --block N           Frames per process call (default 512)\n"
+            "  --format f32|pcm16|pcm24|pcm32  Output encoding (default f32)\n"
+            "  --output-dir DIR    Where rendered files go (default rendered)\n"
+            "Exits 1 when any file fails, 2 when the batch cannot start.\n";
+    }
+    
+    bool ParseOptions(int argc, char* argv[], Options& options) {
+        options.batch.blockSize = 512;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto value = [&]() -> std::string { return (i + 1 < argc) ? argv[++i] : std::string(); };
+            
+            if (arg == "--chain") {
+                options.chain = value();
+            } else if (arg == "--workers") {
+                options.batch.numWorkers = std::max(0, std::atoi(value().c_str()));
+            } else if (arg == "--block") {
+                options.batch.blockSize = std::clamp(std::atoi(value().c_str()), 16, 8192);
+            } else if (arg == "--format") {
+                if (!ParseFormat(value(), options.batch.outputFormat)) {
+                    PrintUsage();
+                    return false;
+                }
+            } else if (arg == "--output-dir") {
+                options.outputDir = value();
+            } else if (arg == "--make-test-files") {
+                options.makeDir = value();
+            } else if (arg == "--count") {
+                options.makeCount = std::max(1, std::atoi(value().c_str()));
+            } else if (arg == "--seconds") {
+                options.makeSeconds = std::max(0.1, std::atof(value().c_str()));
+            } else if (!arg.empty() && arg[0] != '-') {
+                options.inputs.push_back(arg);
+            } else {
+                PrintUsage();
+                return false;
+            }
+        }
+        
+        if (options.makeDir.empty() && options.inputs.empty()) {
+            PrintUsage();
+            return false;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        return 2;
+    }
+    
+    if (!options.makeDir.empty()) {
+        return MakeTestFiles(options) ? 0 : 2;
+    }
+    
+    EnhancedVSTHost templateHost(HostMode::Headless);
+    templateHost.setBufferSize(options.batch.blockSize);
+    if (!BuildChain(templateHost, options)) {
+        return 2;
+    }
+    
+    std::error_code error;
+    std::filesystem::create_directories(options.outputDir, error);
+    
+    std::vector<BatchJob> jobs;
+    for (const auto& input : options.inputs) {
+        std::filesystem::path inputPath(input);
+        std::filesystem::path outputPath = std::filesystem::path(options.outputDir) / inputPath.filename();
+        jobs.push_back({inputPath.wstring(), outputPath.wstring()});
+    }
+    
+    BatchRenderer renderer(templateHost, options.batch);
+    BatchReport report = renderer.run(jobs, [](const BatchFileResult& result) {
+        if (result.succeeded) {
+            std::printf("[worker %d] %s: %s s audio in %s s (%sx realtime)\n", result.worker,
+                        toUtf8(result.inputPath).c_str(), Bench::formatNumber(result.audioSeconds).c_str(),
+                        Bench::formatNumber(result.wallSeconds).c_str(),
+                        Bench::formatNumber(result.realtimeFactor).c_str());
+        } else {
+            std::printf("[worker %d] %s: FAILED (%s)\n", result.worker, toUtf8(result.inputPath).c_str(),
+                        toUtf8(result.error).c_str());
+        }
+        std::fflush(stdout);
+    });
+    
+    std::printf("%zu file(s), %d failed, %d worker(s)\n", report.files.size(), report.failed, report.numWorkers);
+    std::printf("%s s of audio in %s s: %sx realtime\n", Bench::formatNumber(report.audioSeconds).c_str(),
+                Bench::formatNumber(report.wallSeconds).c_str(), Bench::formatNumber(report.realtimeFactor).c_str());
+    return report.failed > 0 ? 1 : 0;
+}
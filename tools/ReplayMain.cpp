@@ -0,0 +1,411 @@
+// ReplayMain.cpp - evh_replay: re-runs a recorded control session offline and times every block
+#include "EnhancedVSTHost.h"
+#include "BenchReport.h"
+#include "SyntheticPlugins.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <cwchar>
+#include <iostream>
+#include <thread>
+#include <unordered_map>
+
+using namespace EVH;
+
+namespace {
+    struct Options {
+        std::wstring sessionPath;
+        std::wstring recordPath;      // Write a demo recording instead of replaying
+        std::string outputPath;       // Per-block CSV
+        std::string input{"noise"};
+        int repeat{3};
+        int top{10};
+    };
+    
+    // Timing of one rendered block across all repeats
+    struct BlockTiming {
+        int64_t position{0};
+        int frames{0};
+        int eventsBefore{0};        // Control calls applied right before the block
+        std::vector<double> us;
+    };
+    
+    // Native processors are recorded as "processor:<name>"; the synthetic
+    // plugins are the ones that can be rebuilt from the name alone
+    std::unique_ptr<AudioProcessor> CreateProcessor(const std::wstring& name) {
+        for (Synthetic::Kind kind : Synthetic::ALL_KINDS) {
+            Synthetic::Settings settings;
+            settings.kind = kind;
+            if (kind == Synthetic::Kind::Fir && name.rfind(L"Fir", 0) == 0) {
+                settings.firTaps = std::max(1, static_cast<int>(std::wcstol(name.c_str() + 3, nullptr, 10)));
+            }
+            
+            auto processor = Synthetic::create(settings);
+            if (processor->getName() == name) {
+                return processor;
+            }
+        }
+        return nullptr;
+    }
+    
+    class SessionReplayer {
+    public:
+        SessionReplayer(const SessionRecording& recording, const Options& options)
+            : recording(recording), options(options) {}
+        
+        // Renders the whole session once; timings[i] gets block i
+        bool run(std::vector<BlockTiming>& timings, uint64_t& outputHash) {
+            EnhancedVSTHost host(HostMode::Headless);
+            host.setSampleRate(recording.sampleRate);
+            host.setBufferSize(recording.bufferSize);
+            ids.clear();
+            nextId = 1;
+            bufferSize = recording.bufferSize;
+            
+            // State at the start of the recording
+            for (const auto& plugin : recording.plugins) {
+                if (!load(host, plugin.pluginId, plugin.path)) {
+                    return false;
+                }
+                host.bypassPlugin(mapId(plugin.pluginId), plugin.bypassed);
+            }
+            for (int pluginId : recording.chain) {
+                host.addPluginToChain(mapId(pluginId));
+            }
+            
+            const int numChannels = recording.numChannels;
+            if (!host.beginOfflineRender(numChannels)) {
+                std::cerr << "Could not start the offline render" << std::endl;
+                return false;
+            }
+            
+            std::vector<std::vector<float>> inputs(numChannels);
+            std::vector<std::vector<float>> outputs(numChannels);
+            std::vector<const float*> inputPtrs(numChannels);
+            std::vector<float*> outputPtrs(numChannels);
+            uint32_t noiseState = 0x12345678u;
+            outputHash = 1469598103934665603ull;
+            
+            int64_t position = 0;
+            size_t nextEvent = 0;
+            size_t block = 0;
+            while (position < recording.lengthFrames) {
+                int applied = 0;
+                while (nextEvent < recording.events.size() &&
+                       recording.events[nextEvent].samplePosition <= position) {
+                    if (!apply(host, recording.events[nextEvent++], numChannels)) {
+                        host.endOfflineRender();
+                        return false;
+                    }
+                    applied++;
+                }
+                
+                // Split blocks so every edit lands on the frame it was recorded at
+                int64_t until = recording.lengthFrames;
+                if (nextEvent < recording.events.size()) {
+                    until = std::min(until, recording.events[nextEvent].samplePosition);
+                }
+                int frames = static_cast<int>(std::min<int64_t>(bufferSize, until - position));
+                
+                for (int ch = 0; ch < numChannels; ++ch) {
+                    inputs[ch].resize(frames);
+                    outputs[ch].resize(frames);
+                    for (float& sample : inputs[ch]) {
+                        noiseState = noiseState * 1664525u + 1013904223u;
+                        sample = (options.input == "noise") ? ((noiseState >> 8) / 16777216.0f - 0.5f) * 0.5f : 0.0f;
+                    }
+                    inputPtrs[ch] = inputs[ch].data();
+                    outputPtrs[ch] = outputs[ch].data();
+                }
+                
+                auto start = std::chrono::steady_clock::now();
+                host.renderOffline(inputPtrs.data(), outputPtrs.data(), frames);
+                std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+                
+                if (block == timings.size()) {
+                    timings.push_back({position, frames, applied, {}});
+                }
+                timings[block++].us.push_back(elapsed.count());
+                
+                // FNV-1a over the output bits: equal hashes mean an identical render
+                for (int ch = 0; ch < numChannels; ++ch) {
+                    for (float sample : outputs[ch]) {
+                        uint32_t bits;
+                        std::memcpy(&bits, &sample, sizeof(bits));
+                        outputHash = (outputHash ^ bits) * 1099511628211ull;
+                    }
+                }
+                position += frames;
+            }
+            
+            host.endOfflineRender();
+            return true;
+        }
+    
+    private:
+        const SessionRecording& recording;
+        const Options& options;
+        std::unordered_map<int, int> ids;   // Recorded id -> replay id
+        int nextId{1};
+        int bufferSize{0};
+        
+        int mapId(int recordedId) const {
+            auto it = ids.find(recordedId);
+            return it != ids.end() ? it->second : 0;   // 0 is never a plugin id
+        }
+        
+        bool load(EnhancedVSTHost& host, int recordedId, const std::wstring& path) {
+            int pluginId = 0;
+            const std::wstring prefix = L"processor:";
+            if (path.rfind(prefix, 0) == 0) {
+                auto processor = CreateProcessor(path.substr(prefix.size()));
+                if (!processor) {
+                    std::wcerr << L"No processor to replay " << path << std::endl;
+                    return false;
+                }
+                pluginId = host.loadProcessor(std::move(processor));
+            } else if (host.loadPlugin(path)) {
+                pluginId = nextId;   // A fresh host numbers successful loads in order
+            }
+            
+            if (pluginId == 0) {
+                std::wcerr << L"Failed to load " << path << std::endl;
+                return false;
+            }
+            ids[recordedId] = pluginId;
+            nextId = pluginId + 1;
+            return true;
+        }
+        
+        bool apply(EnhancedVSTHost& host, const SessionEvent& event, int numChannels) {
+            switch (event.type) {
+                case SessionEvent::Type::Load:
+                    return load(host, event.pluginId, event.path);
+                case SessionEvent::Type::Unload:
+                    host.unloadPlugin(mapId(event.pluginId));
+                    ids.erase(event.pluginId);
+                    break;
+                case SessionEvent::Type::UnloadAll:
+                    host.unloadAllPlugins();
+                    ids.clear();
+                    break;
+                case SessionEvent::Type::AddToChain:
+                    host.addPluginToChain(mapId(event.pluginId));
+                    break;
+                case SessionEvent::Type::RemoveFromChain:
+                    host.removePluginFromChain(mapId(event.pluginId));
+                    break;
+                case SessionEvent::Type::Move:
+                    host.movePluginInChain(mapId(event.pluginId), event.value);
+                    break;
+                case SessionEvent::Type::Bypass:
+                    host.bypassPlugin(mapId(event.pluginId), event.value != 0);
+                    break;
+                case SessionEvent::Type::SetSampleRate:
+                case SessionEvent::Type::SetBufferSize:
+                    // The offline setup is fixed per render; restart it like a device would
+                    host.endOfflineRender();
+                    if (event.type == SessionEvent::Type::SetSampleRate) {
+                        host.setSampleRate(event.rate);
+                    } else {
+                        host.setBufferSize(event.value);
+                        bufferSize = std::max(1, event.value);
+                    }
+                    return host.beginOfflineRender(numChannels);
+            }
+            return true;
+        }
+    };
+    
+    // Edits a short null-engine session: bypass toggles, chain moves and a
+    // plugin loaded and removed under load
+    bool RecordDemo(const Options& options) {
+        EnhancedVSTHost host(HostMode::Headless);
+        host.setSampleRate(48000.0);
+        host.setBufferSize(256);
+        
+        std::vector<int> pluginIds;
+        for (Synthetic::Kind kind : {Synthetic::Kind::Gain, Synthetic::Kind::Fir, Synthetic::Kind::Iir}) {
+            Synthetic::Settings settings;
+            settings.kind = kind;
+            pluginIds.push_back(host.loadProcessor(Synthetic::create(settings)));
+            host.addPluginToChain(pluginIds.back());
+        }
+        
+        host.startSessionRecording();
+        if (!host.startAudio(AudioDriverType::Null)) {
+            std::cerr << "Could not start the null engine" << std::endl;
+            return false;
+        }
+        
+        auto wait = [](int ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); };
+        for (int step = 0; step < 10; ++step) {
+            wait(50);
+            host.bypassPlugin(pluginIds[1], step % 2 == 0);
+        }
+        host.movePluginInChain(pluginIds[2], 0);
+        wait(100);
+        
+        Synthetic::Settings jittery;
+        jittery.kind = Synthetic::Kind::Jittery;
+        int extra = host.loadProcessor(Synthetic::create(jittery));
+        host.addPluginToChain(extra);
+        wait(200);
+        host.removePluginFromChain(extra);
+        host.unloadPlugin(extra);
+        wait(100);
+        
+        host.stopAudio();
+        SessionRecording recording = host.stopSessionRecording();
+        if (!recording.save(options.recordPath)) {
+            std::wcerr << L"Could not write " << options.recordPath << std::endl;
+            return false;
+        }
+        
+        std::wcerr << L"Recorded " << recording.events.size() << L" event(s) over " << recording.lengthFrames
+                   << L" frames to " << options.recordPath << std::endl;
+        return true;
+    }
+    
+    double Median(std::vector<double> values) {
+        std::sort(values.begin(), values.end());
+        return values[values.size() / 2];
+    }
+    
+    void WriteBlocks(std::FILE* out, const std::vector<BlockTiming>& timings) {
+        std::fprintf(out, "block,position,frames,events,median_us,min_us,max_us\n");
+        for (size_t i = 0; i < timings.size(); ++i) {
+            const BlockTiming& timing = timings[i];
+            auto [minUs, maxUs] = std::minmax_element(timing.us.begin(), timing.us.end());
+            std::fprintf(out, "%zu,%lld,%d,%d,%s,%s,%s\n", i, static_cast<long long>(timing.position),
+                         timing.frames, timing.eventsBefore, Bench::formatNumber(Median(timing.us)).c_str(),
+                         Bench::formatNumber(*minUs).c_str(), Bench::formatNumber(*maxUs).c_str());
+        }
+    }
+    
+    void PrintUsage() {
+        std::cerr <<
+            "Usage: evh_replay <session> [options]\n"
+            "       evh_replay --record-demo <session>\n"
+            "  --repeat N          Renders of the session; block times are the median (default 3)\n"
+            "  --input noise|silence  Signal fed to the chain (default noise)\n"
+            "  --output FILE       Per-block timings as CSV\n"
+            "  --top N             Slowest blocks to list (default 10)\n"
+            "Exits 1 when repeated renders differ, 2 when the session cannot be replayed.\n";
+    }
+    
+    bool ParseOptions(int argc, char* argv[], Options& options) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto value = [&]() -> std::string { return (i + 1 < argc) ? argv[++i] : std::string(); };
+            
+            if (arg == "--record-demo") {
+                options.recordPath = fromUtf8(value());
+            } else if (arg == "--repeat") {
+                options.repeat = std::max(1, std::atoi(value().c_str()));
+            } else if (arg == "--input") {
+                options.input = value();
+            } else if (arg == "--output") {
+                options.outputPath = value();
+            } else if (arg == "--top") {
+                options.top = std::max(0, std::atoi(value().c_str()));
+            } else if (!arg.empty() && arg[0] != '-' && options.sessionPath.empty()) {
+                options.sessionPath = fromUtf8(arg);
+            } else {
+                PrintUsage();
+                return false;
+            }
+        }
+        
+        if (options.sessionPath.empty() == options.recordPath.empty() ||
+            (options.input != "noise" && options.input != "silence")) {
+            PrintUsage();
+            return false;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        return 2;
+    }
+    
+    if (!options.recordPath.empty()) {
+        return RecordDemo(options) ? 0 : 2;
+    }
+    
+    SessionRecording recording;
+    if (!recording.load(options.sessionPath)) {
+        std::wcerr << L"Could not read session " << options.sessionPath << std::endl;
+        return 2;
+    }
+    
+    std::vector<BlockTiming> timings;
+    std::vector<uint64_t> hashes;
+    auto start = std::chrono::steady_clock::now();
+    for (int run = 0; run < options.repeat; ++run) {
+        SessionReplayer replayer(recording, options);
+        uint64_t hash = 0;
+        if (!replayer.run(timings, hash)) {
+            return 2;
+        }
+        hashes.push_back(hash);
+    }
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    if (!options.outputPath.empty()) {
+        std::FILE* out = std::fopen(options.outputPath.c_str(), "w");
+        if (!out) {
+            std::cerr << "Could not write " << options.outputPath << std::endl;
+            return 2;
+        }
+        WriteBlocks(out, timings);
+        std::fclose(out);
+    }
+    
+    std::vector<double> medians;
+    for (const auto& timing : timings) {
+        medians.push_back(Median(timing.us));
+    }
+    Bench::TimingSummary summary = Bench::summarize(medians);
+    double audioSeconds = recording.lengthFrames / recording.sampleRate * options.repeat;
+    
+    std::printf("session: %lld frames, %zu events, %zu blocks, %d run(s)\n",
+                static_cast<long long>(recording.lengthFrames), recording.events.size(), timings.size(),
+                options.repeat);
+    std::printf("block us: mean %s  p50 %s  p99 %s  max %s\n", Bench::formatNumber(summary.meanUs).c_str(),
+                Bench::formatNumber(summary.p50Us).c_str(), Bench::formatNumber(summary.p99Us).c_str(),
+                Bench::formatNumber(summary.maxUs).c_str());
+    std::printf("realtime factor: %s\n", Bench::formatNumber(audioSeconds / wallSeconds).c_str());
+    
+    // Slowest blocks, with how far they are from the last control call
+    std::vector<size_t> order(timings.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return medians[a] > medians[b]; });
+    
+    int64_t lastEventBlock = -1;
+    std::vector<int64_t> sinceEvent(timings.size());
+    for (size_t i = 0; i < timings.size(); ++i) {
+        if (timings[i].eventsBefore > 0) {
+            lastEventBlock = static_cast<int64_t>(i);
+        }
+        sinceEvent[i] = lastEventBlock < 0 ? -1 : static_cast<int64_t>(i) - lastEventBlock;
+    }
+    
+    for (size_t n = 0; n < order.size() && n < static_cast<size_t>(options.top); ++n) {
+        size_t i = order[n];
+        std::printf("  block %zu @%lld: %s us (%d frames, %s)\n", i, static_cast<long long>(timings[i].position),
+                    Bench::formatNumber(medians[i]).c_str(), timings[i].frames,
+                    sinceEvent[i] < 0 ? "before any event"
+                                      : (std::to_string(sinceEvent[i]) + " block(s) after an event").c_str());
+    }
+    
+    bool deterministic = std::all_of(hashes.begin(), hashes.end(), [&](uint64_t h) { return h == hashes[0]; });
+    std::printf("output hash: %016llx%s\n", static_cast<unsigned long long>(hashes[0]),
+                deterministic ? "" : " (runs differ)");
+    return deterministic ? 0 : 1;
+}
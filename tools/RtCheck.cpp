@@ -0,0 +1,472 @@
+// RtCheck.cpp - Interposes allocation, locking and blocking calls (Linux/glibc)
+//
+// Linked into the evh_rtcheck executable, these definitions take precedence
+// over libc's for the whole process. Each one forwards to the real function
+// and, while the calling thread is inside an EVH::ScopedRealtimeSection,
+// records a violation with its stack in fixed storage first.
+#undef _FORTIFY_SOURCE   // Fortified inline read() would clash with ours
+
+#include "RtCheck.h"
+#include "EVHRealtime.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdarg>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sys/select.h>
+#include <time.h>
+#include <unistd.h>
+
+// glibc's allocator entry points, callable without going through our malloc
+extern "C" {
+    void* __libc_malloc(size_t size);
+    void* __libc_calloc(size_t count, size_t size);
+    void* __libc_realloc(void* ptr, size_t size);
+    void __libc_free(void* ptr);
+    void* __libc_memalign(size_t alignment, size_t size);
+}
+
+namespace EVH {
+namespace RtCheck {
+
+namespace {
+    constexpr int MAX_FRAMES = 32;
+    constexpr int SKIPPED_FRAMES = 2;      // RecordViolation() and the interposed function
+    constexpr size_t MAX_RECORDS = 4096;
+    
+    struct Record {
+        Violation kind;
+        const char* call;
+        size_t bytes;
+        int depth;
+        void* frames[MAX_FRAMES];
+    };
+    
+    Record records[MAX_RECORDS];
+    std::atomic<uint64_t> violationCount{0};
+    std::atomic<bool> enabled{false};
+    bool reportAllLocks = false;
+    
+    // Set while recording so backtrace()'s own calls pass straight through
+    thread_local bool inHook = false;
+    
+    bool ShouldRecord() {
+        return enabled.load(std::memory_order_relaxed) && !inHook && ScopedRealtimeSection::isActive();
+    }
+    
+    __attribute__((noinline)) void RecordViolation(Violation kind, const char* call, size_t bytes) {
+        inHook = true;
+        uint64_t index = violationCount.fetch_add(1, std::memory_order_relaxed);
+        if (index < MAX_RECORDS) {
+            Record& record = records[index];
+            record.kind = kind;
+            record.call = call;
+            record.bytes = bytes;
+            record.depth = backtrace(record.frames, MAX_FRAMES);
+        }
+        inHook = false;
+    }
+    
+    // Real functions, resolved in install() or on first use
+    template<typename Fn>
+    Fn Real(std::atomic<void*>& slot, const char* name, const char* version = nullptr) {
+        void* fn = slot.load(std::memory_order_acquire);
+        if (!fn) {
+            fn = version ? dlvsym(RTLD_NEXT, name, version) : nullptr;
+            if (!fn) {
+                fn = dlsym(RTLD_NEXT, name);
+            }
+            slot.store(fn, std::memory_order_release);
+        }
+        return reinterpret_cast<Fn>(fn);
+    }
+    
+    // pthread_cond_* has a pre-NPTL default that RTLD_NEXT would otherwise find
+#if defined(__x86_64__)
+    const char* const COND_VERSION = "GLIBC_2.3.2";
+#elif defined(__aarch64__)
+    const char* const COND_VERSION = "GLIBC_2.17";
+#else
+    const char* const COND_VERSION = nullptr;
+#endif
+    
+    std::atomic<void*> realMutexLock{nullptr};
+    std::atomic<void*> realMutexTryLock{nullptr};
+    std::atomic<void*> realCondWait{nullptr};
+    std::atomic<void*> realCondTimedWait{nullptr};
+    std::atomic<void*> realSemWait{nullptr};
+    std::atomic<void*> realJoin{nullptr};
+    std::atomic<void*> realNanosleep{nullptr};
+    std::atomic<void*> realClockNanosleep{nullptr};
+    std::atomic<void*> realUsleep{nullptr};
+    std::atomic<void*> realSleep{nullptr};
+    std::atomic<void*> realPoll{nullptr};
+    std::atomic<void*> realSelect{nullptr};
+    std::atomic<void*> realRead{nullptr};
+    std::atomic<void*> realWrite{nullptr};
+    std::atomic<void*> realOpen{nullptr};
+    std::atomic<void*> realOpenAt{nullptr};
+    std::atomic<void*> realClose{nullptr};
+    std::atomic<void*> realFsync{nullptr};
+    
+    using MutexFn = int (*)(pthread_mutex_t*);
+    using CondWaitFn = int (*)(pthread_cond_t*, pthread_mutex_t*);
+    using CondTimedWaitFn = int (*)(pthread_cond_t*, pthread_mutex_t*, const struct timespec*);
+    using SemWaitFn = int (*)(sem_t*);
+    using JoinFn = int (*)(pthread_t, void**);
+    using NanosleepFn = int (*)(const struct timespec*, struct timespec*);
+    using ClockNanosleepFn = int (*)(clockid_t, int, const struct timespec*, struct timespec*);
+    using UsleepFn = int (*)(useconds_t);
+    using SleepFn = unsigned int (*)(unsigned int);
+    using PollFn = int (*)(struct pollfd*, nfds_t, int);
+    using SelectFn = int (*)(int, fd_set*, fd_set*, fd_set*, struct timeval*);
+    using ReadFn = ssize_t (*)(int, void*, size_t);
+    using WriteFn = ssize_t (*)(int, const void*, size_t);
+    using OpenFn = int (*)(const char*, int, ...);
+    using OpenAtFn = int (*)(int, const char*, int, ...);
+    using CloseFn = int (*)(int);
+    using FsyncFn = int (*)(int);
+    
+    std::string Symbolize(void* frame) {
+        Dl_info info{};
+        char text[64];
+        if (!dladdr(frame, &info)) {
+            std::snprintf(text, sizeof(text), "%p", frame);
+            return text;
+        }
+        
+        std::string result;
+        if (info.dli_sname) {
+            int status = 0;
+            char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+            result = (status == 0 && demangled) ? demangled : info.dli_sname;
+            std::free(demangled);
+            std::snprintf(text, sizeof(text), "+0x%zx",
+                          static_cast<size_t>(static_cast<char*>(frame) - static_cast<char*>(info.dli_saddr)));
+            result += text;
+        } else {
+            std::snprintf(text, sizeof(text), "%p", frame);
+            result = text;
+        }
+        
+        if (info.dli_fname) {
+            const char* slash = std::strrchr(info.dli_fname, '/');
+            result += std::string(" (") + (slash ? slash + 1 : info.dli_fname) + ")";
+        }
+        return result;
+    }
+}
+
+void install(const Options& options) {
+    reportAllLocks = options.reportAllLocks;
+    
+    // backtrace() loads its unwinder on first use; do that here, not on the
+    // audio thread
+    void* warmup[4];
+    backtrace(warmup, 4);
+    
+    Real<MutexFn>(realMutexLock, "pthread_mutex_lock");
+    Real<MutexFn>(realMutexTryLock, "pthread_mutex_trylock");
+    Real<CondWaitFn>(realCondWait, "pthread_cond_wait", COND_VERSION);
+    Real<CondTimedWaitFn>(realCondTimedWait, "pthread_cond_timedwait", COND_VERSION);
+    Real<SemWaitFn>(realSemWait, "sem_wait");
+    Real<JoinFn>(realJoin, "pthread_join");
+    Real<NanosleepFn>(realNanosleep, "nanosleep");
+    Real<ClockNanosleepFn>(realClockNanosleep, "clock_nanosleep");
+    Real<UsleepFn>(realUsleep, "usleep");
+    Real<SleepFn>(realSleep, "sleep");
+    Real<PollFn>(realPoll, "poll");
+    Real<SelectFn>(realSelect, "select");
+    Real<ReadFn>(realRead, "read");
+    Real<WriteFn>(realWrite, "write");
+    Real<OpenFn>(realOpen, "open");
+    Real<OpenAtFn>(realOpenAt, "openat");
+    Real<CloseFn>(realClose, "close");
+    Real<FsyncFn>(realFsync, "fsync");
+    
+    enabled = true;
+}
+
+void setEnabled(bool enable) {
+    enabled = enable;
+}
+
+uint64_t getViolationCount() {
+    return violationCount.load();
+}
+
+uint64_t getDroppedCount() {
+    uint64_t count = violationCount.load();
+    return count > MAX_RECORDS ? count - MAX_RECORDS : 0;
+}
+
+const char* getViolationName(Violation violation) {
+    switch (violation) {
+        case Violation::Allocation:   return "allocation";
+        case Violation::Deallocation: return "deallocation";
+        case Violation::MutexWait:    return "mutex wait";
+        case Violation::MutexLock:    return "mutex lock";
+        case Violation::BlockingCall: return "blocking call";
+    }
+    return "unknown";
+}
+
+void writeReport(std::FILE* out) {
+    const size_t stored = static_cast<size_t>(std::min<uint64_t>(violationCount.load(), MAX_RECORDS));
+    
+    // Same kind, call and stack -> one entry
+    struct Site {
+        const Record* first;
+        uint64_t count;
+        size_t totalBytes;
+    };
+    std::map<std::vector<void*>, Site> sites;
+    std::vector<std::vector<void*>> order;
+    
+    for (size_t i = 0; i < stored; ++i) {
+        const Record& record = records[i];
+        std::vector<void*> key(record.frames + std::min(SKIPPED_FRAMES, record.depth),
+                               record.frames + record.depth);
+        key.push_back(reinterpret_cast<void*>(static_cast<uintptr_t>(record.kind)));
+        key.push_back(const_cast<char*>(record.call));
+        
+        auto [it, inserted] = sites.try_emplace(key, Site{&record, 0, 0});
+        it->second.count++;
+        it->second.totalBytes += record.bytes;
+        if (inserted) {
+            order.push_back(key);
+        }
+    }
+    
+    std::fprintf(out, "evh_rtcheck: %llu violation(s) at %zu call site(s)",
+                 static_cast<unsigned long long>(violationCount.load()), sites.size());
+    if (getDroppedCount() > 0) {
+        std::fprintf(out, ", %llu without stacks", static_cast<unsigned long long>(getDroppedCount()));
+    }
+    std::fprintf(out, "\n");
+    
+    int number = 1;
+    for (const auto& key : order) {
+        const Site& site = sites[key];
+        const Record& record = *site.first;
+        
+        std::fprintf(out, "\n[%d] %s in %s, %llu time(s)", number++, getViolationName(record.kind),
+                     record.call, static_cast<unsigned long long>(site.count));
+        if (site.totalBytes > 0) {
+            std::fprintf(out, ", %zu bytes", site.totalBytes);
+        }
+        std::fprintf(out, "\n");
+        
+        for (int f = std::min(SKIPPED_FRAMES, record.depth); f < record.depth; ++f) {
+            std::fprintf(out, "    #%-2d %s\n", f - SKIPPED_FRAMES, Symbolize(record.frames[f]).c_str());
+        }
+    }
+}
+
+}
+}
+
+using namespace EVH::RtCheck;
+
+// Interposed definitions. Names and signatures follow glibc's declarations.
+extern "C" {
+
+void* malloc(size_t size) noexcept {
+    if (ShouldRecord()) {
+        RecordViolation(Violation::Allocation, "malloc", size);
+    }
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) noexcept {
+    if (ShouldRecord()) {
+        RecordViolation(Violation::Allocation, "calloc", count * size);
+    }
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) noexcept {
+    if (ShouldRecord()) {
+        RecordViolation(Violation::Allocation, "realloc", size);
+    }
+    return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr) noexcept {
+    if (ptr && ShouldRecord()) {
+        RecordViolation(Violation::Deallocation, "free", 0);
+    }
+    __libc_free(ptr);
+}
+
+int posix_memalign(void** result, size_t alignment, size_t size) noexcept {
+    if (ShouldRecord()) {
+        RecordViolation(Violation::Allocation, "posix_memalign", size);
+    }
+    void* ptr = __libc_memalign(alignment, size);
+    if (!ptr) {
+        return ENOMEM;
+    }
+    *result = ptr;
+    return 0;
+}
+
+void* aligned_alloc(size_t alignment, size_t size) noexcept {
+    if (ShouldRecord()) {
+        RecordViolation(Violation::Allocation, "aligned_alloc", size);
+    }
+    return __libc_memalign(alignment, size);
+}
+
+int pthread_mutex_lock(pthread_mutex_t* mutex) noexcept {
+    if (ShouldRecord()) {
+        // Only a lock that would have to wait is reported by default
+        if (Real<MutexFn>(realMutexTryLock, "pthread_mutex_trylock")(mutex) == 0) {
+            if (reportAllLocks) {
+                RecordViolation(Violation::MutexLock, "pthread_mutex_lock", 0);
+            }
+            return 0;
+        }
+        RecordViolation(Violation::MutexWait, "pthread_mutex_lock", 0);
+    }
+    return Real<MutexFn>(realMutexLock, "pthread_mutex_lock")(mutex);
+}
+
+int pthread_cond_wait(pthread_cond_t* cond, pthread_mutex_t* mutex) {
+    if (ShouldRecord()) {
+        RecordViolation(Violation::BlockingCall, "pthread_cond_wait", 0);
+    }
+    return Real<CondWaitFn>(realCondWait, "pthread_cond_wait", COND_VERSION)(cond, mutex);
+}
+
+int pthread_cond_timedwait(pthread_cond_t* cond, pthread_mutex_t* mutex, const struct timespec* time) {
+    if (ShouldRecord()) {
+        RecordViolation(Violation::BlockingCall, "pthread_cond_timedwait", 0);
+    }
+    return Real<CondTimedWaitFn>(realCondTimedWait, "pthread_cond_timedwait", COND_VERSION)(cond, mutex, time);
+}
+
+int sem_wait(sem_t* semaphore) {
+    if (ShouldRecord()) {
+        RecordViolation(Violation::BlockingCall, "sem_wait", 0);
+    }
+    return Real<SemWaitFn>(realSemWait, "sem_wait")(semaphore);
+}
+
+int pthread_join(pthread_t thread, void** result) {
+    if (ShouldRecord()) {
+        RecordViolation(Violation::BlockingCall, "pthread_join", 0);
+    }
+    return Real<JoinFn>(realJoin, "pthread_join")(thread, result);
+}
+
+int nanosleep(const struct timespec* request, struct timespec* remaining) {
+    if (ShouldRecord()) {
+        RecordViolation(Violation::BlockingCall, "nanosleep", 0);
+    }
+    return Real<NanosleepFn>(realNanosleep, "nanosleep")(request, remaining);
+}
+
+int clock_nanosleep(clockid_t clock, int flags, const struct timespec* request, struct timespec* remaining) {
+    if (ShouldRecord()) {
+        RecordViolation(Violation::BlockingCall, "clock_nanosleep", 0);
+    }
+    return Real<ClockNanosleepFn>(realClockNanosleep, "clock_nanosleep")(clock, flags, request, remaining);
+}
+
+int usleep(useconds_t microseconds) {
+    if (ShouldRecord()) {
+        RecordViolation(Violation::BlockingCall, "usleep", 0);
+    }
+    return Real<UsleepFn>(realUsleep, "usleep")(microseconds);
+}
+
+unsigned int sleep(unsigned int seconds) {
+    if (ShouldRecord()) {
+        RecordViolation(Violation::BlockingCall, "sleep", 0);
+    }
+    return Real<SleepFn>(realSleep, "sleep")(seconds);
+}
+
+int poll(struct pollfd* fds, nfds_t count, int timeout) {
+    if (ShouldRecord()) {
+        RecordViolation(Violation::BlockingCall, "poll", 0);
+    }
+    return Real<PollFn>(realPoll, "poll")(fds, count, timeout);
+}
+
+int select(int count, fd_set* readFds, fd_set* writeFds, fd_set* exceptFds, struct timeval* timeout) {
+    if (ShouldRecord()) {
+        RecordViolation(Violation::BlockingCall, "select", 0);
+    }
+    return Real<SelectFn>(realSelect, "select")(count, readFds, writeFds, exceptFds, timeout);
+}
+
+ssize_t read(int fd, void* buffer, size_t size) {
+    if (ShouldRecord()) {
+        RecordViolation(Violation::BlockingCall, "read", size);
+    }
+    return Real<ReadFn>(realRead, "read")(fd, buffer, size);
+}
+
+ssize_t write(int fd, const void* buffer, size_t size) {
+    if (ShouldRecord()) {
+        RecordViolation(Violation::BlockingCall, "write", size);
+    }
+    return Real<WriteFn>(realWrite, "write")(fd, buffer, size);
+}
+
+int open(const char* path, int flags, ...) {
+    mode_t mode = 0;
+    if (flags & (O_CREAT | O_TMPFILE)) {
+        va_list args;
+        va_start(args, flags);
+        mode = static_cast<mode_t>(va_arg(args, int));
+        va_end(args);
+    }
+    if (ShouldRecord()) {
+        RecordViolation(Violation::BlockingCall, "open", 0);
+    }
+    return Real<OpenFn>(realOpen, "open")(path, flags, mode);
+}
+
+int openat(int dirFd, const char* path, int flags, ...) {
+    mode_t mode = 0;
+    if (flags & (O_CREAT | O_TMPFILE)) {
+        va_list args;
+        va_start(args, flags);
+        mode = static_cast<mode_t>(va_arg(args, int));
+        va_end(args);
+    }
+    if (ShouldRecord()) {
+        RecordViolation(Violation::BlockingCall, "openat", 0);
+    }
+    return Real<OpenAtFn>(realOpenAt, "openat")(dirFd, path, flags, mode);
+}
+
+int close(int fd) {
+    if (ShouldRecord()) {
+        RecordViolation(Violation::BlockingCall, "close", 0);
+    }
+    return Real<CloseFn>(realClose, "close")(fd);
+}
+
+int fsync(int fd) {
+    if (ShouldRecord()) {
+        RecordViolation(Violation::BlockingCall, "fsync", 0);
+    }
+    return Real<FsyncFn>(realFsync, "fsync")(fd);
+}
+
+}
\ No newline at end of file
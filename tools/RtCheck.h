@@ -0,0 +1,37 @@
+// RtCheck.h - Realtime-safety violation recorder behind evh_rtcheck
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+
+namespace EVH {
+namespace RtCheck {
+    
+    // What a thread inside a ScopedRealtimeSection must not do
+    enum class Violation {
+        Allocation,     // malloc, calloc, realloc, aligned allocation
+        Deallocation,   // free of a non-null pointer
+        MutexWait,      // pthread_mutex_lock that found the mutex held
+        MutexLock,      // Uncontended lock (only with reportAllLocks)
+        BlockingCall    // Sleeps, waits, file and pipe I/O
+    };
+    
+    struct Options {
+        bool reportAllLocks{false};   // Uncontended locks too: they can wait on a bad day
+    };
+    
+    // Resolves the interposed functions and starts recording. Call from main
+    // before any audio thread starts.
+    void install(const Options& options);
+    void setEnabled(bool enable);
+    
+    uint64_t getViolationCount();
+    uint64_t getDroppedCount();       // Counted but beyond the fixed record storage
+    
+    // Groups violations by call site and writes symbolized stacks. Allocates:
+    // call with recording disabled.
+    void writeReport(std::FILE* out);
+    
+    const char* getViolationName(Violation violation);
+}
+}
\ No newline at end of file
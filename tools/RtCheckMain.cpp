@@ -0,0 +1,224 @@
+// RtCheckMain.cpp - evh_rtcheck: runs the render path with realtime-safety checks
+#include "EnhancedVSTHost.h"
+#include "RtCheck.h"
+#include "SyntheticPlugins.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+using namespace EVH;
+
+namespace {
+    struct Options {
+        std::vector<std::string> scenarios{"offline", "engine", "reconfigure", "renderahead", "input"};
+        std::vector<Synthetic::Kind> chain{Synthetic::Kind::Gain, Synthetic::Kind::Fir, Synthetic::Kind::Iir};
+        double seconds{0.5};
+        ProcessPrecision precision{ProcessPrecision::Single};
+        RtCheck::Options check;
+    };
+    
+    std::vector<std::string> Split(const std::string& text, char separator) {
+        std::vector<std::string> parts;
+        std::stringstream stream(text);
+        std::string part;
+        while (std::getline(stream, part, separator)) {
+            if (!part.empty()) {
+                parts.push_back(part);
+            }
+        }
+        return parts;
+    }
+    
+    void Wait(double seconds) {
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    }
+    
+    // Loading runs on the main thread, outside any realtime section. Meters
+    // at every tap point and a spectrum tap on the output, so their audio
+    // side runs under the checks too.
+    bool BuildChain(EnhancedVSTHost& host, const Options& options) {
+        host.addMeter({MeterTap::Point::ChainInput});
+        host.addMeter({MeterTap::Point::ChainOutput});
+        host.addSpectrumAnalyzer({MeterTap::Point::ChainOutput});
+        for (size_t i = 0; i < options.chain.size(); ++i) {
+            Synthetic::Settings settings;
+            settings.kind = options.chain[i];
+            settings.seed = static_cast<uint32_t>(i + 1);
+            int pluginId = host.loadProcessor(Synthetic::create(settings));
+            if (pluginId == 0) {
+                return false;
+            }
+            host.addPluginToChain(pluginId);
+            host.addMeter({MeterTap::Point::AfterPlugin, pluginId});
+        }
+        return true;
+    }
+    
+    bool RunOffline(EnhancedVSTHost& host, const Options& options) {
+        const int numChannels = 2;
+        const int blockSize = 256;
+        host.setBufferSize(blockSize);
+        if (!host.beginOfflineRender(numChannels)) {
+            return false;
+        }
+        
+        std::vector<std::vector<float>> inputs(numChannels, std::vector<float>(blockSize, 0.25f));
+        std::vector<std::vector<float>> outputs(numChannels, std::vector<float>(blockSize));
+        std::vector<const float*> inputPtrs{inputs[0].data(), inputs[1].data()};
+        std::vector<float*> outputPtrs{outputs[0].data(), outputs[1].data()};
+        
+        const int blocks = static_cast<int>(options.seconds * 48000.0 / blockSize);
+        for (int i = 0; i < blocks; ++i) {
+            host.renderOffline(inputPtrs.data(), outputPtrs.data(), blockSize);
+        }
+        
+        host.endOfflineRender();
+        return true;
+    }
+    
+    bool RunEngine(EnhancedVSTHost& host, const Options& options) {
+        if (!host.startAudio(AudioDriverType::Null)) {
+            return false;
+        }
+        Wait(options.seconds);
+        host.stopAudio();
+        return true;
+    }
+    
+    // Hot switches of size and rate; the switch itself runs on the audio thread
+    bool RunReconfigure(EnhancedVSTHost& host, const Options& options) {
+        if (!host.startAudio(AudioDriverType::Null)) {
+            return false;
+        }
+        
+        const double step = options.seconds / 4;
+        Wait(step);
+        host.setBufferSize(512);
+        Wait(step);
+        host.setSampleRate(44100.0);
+        Wait(step);
+        host.setBufferSize(256);
+        host.setSampleRate(48000.0);
+        Wait(step);
+        
+        host.stopAudio();
+        return true;
+    }
+    
+    bool RunRenderAhead(EnhancedVSTHost& host, const Options& options) {
+        host.setRenderAheadBlocks(2);
+        bool started = host.startAudio(AudioDriverType::Null);
+        if (started) {
+            Wait(options.seconds);
+            host.stopAudio();
+        }
+        host.setRenderAheadBlocks(0);
+        return started;
+    }
+    
+    bool RunInput(EnhancedVSTHost& host, const Options& options) {
+        host.setInputEnabled(true);
+        host.setCaptureSource(std::make_shared<GeneratedCaptureSource>(GeneratedCaptureSource::Signal::Sine));
+        bool started = host.startAudio(AudioDriverType::Null);
+        if (started) {
+            Wait(options.seconds);
+            host.stopAudio();
+        }
+        host.setInputEnabled(false);
+        return started;
+    }
+    
+    void PrintUsage() {
+        std::cerr <<
+            "Usage: evh_rtcheck [options]\n"
+            "  --scenario a,b,...  offline, engine, reconfigure, renderahead, input (default: all)\n"
+            "  --chain a,b,...     Synthetic plugins in the chain (default: gain,fir,iir)\n"
+            "  --seconds N         Run time per scenario (default 0.5)\n"
+            "  --all-locks         Report uncontended mutex locks too\n"
+            "  --double            Run the chain in 64-bit precision\n"
+            "Exits 1 when any violation was recorded.\n";
+    }
+    
+    bool ParseOptions(int argc, char* argv[], Options& options) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto value = [&]() -> std::string { return (i + 1 < argc) ? argv[++i] : std::string(); };
+            
+            if (arg == "--scenario") {
+                options.scenarios = Split(value(), ',');
+            } else if (arg == "--chain") {
+                options.chain.clear();
+                for (const auto& name : Split(value(), ',')) {
+                    Synthetic::Kind kind;
+                    if (!Synthetic::parseKind(name, kind)) {
+                        std::cerr << "Unknown plugin kind: " << name << std::endl;
+                        return false;
+                    }
+                    options.chain.push_back(kind);
+                }
+            } else if (arg == "--seconds") {
+                options.seconds = std::max(0.05, std::atof(value().c_str()));
+            } else if (arg == "--all-locks") {
+                options.check.reportAllLocks = true;
+            } else if (arg == "--double") {
+                options.precision = ProcessPrecision::Double;
+            } else {
+                PrintUsage();
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        return 2;
+    }
+    
+    RtCheck::install(options.check);
+    
+    const std::pair<const char*, bool (*)(EnhancedVSTHost&, const Options&)> scenarios[] = {
+        {"offline", RunOffline},
+        {"engine", RunEngine},
+        {"reconfigure", RunReconfigure},
+        {"renderahead", RunRenderAhead},
+        {"input", RunInput}
+    };
+    
+    bool setupFailed = false;
+    for (const auto& [name, run] : scenarios) {
+        if (std::find(options.scenarios.begin(), options.scenarios.end(), name) == options.scenarios.end()) {
+            continue;
+        }
+        
+        EnhancedVSTHost host(HostMode::Headless);
+        host.setSampleRate(48000.0);
+        host.setBufferSize(256);
+        host.setProcessPrecision(options.precision);
+        if (!BuildChain(host, options)) {
+            std::cerr << name << ": failed to load the chain" << std::endl;
+            setupFailed = true;
+            continue;
+        }
+        
+        uint64_t before = RtCheck::getViolationCount();
+        if (!run(host, options)) {
+            std::cerr << name << ": could not run" << std::endl;
+            setupFailed = true;
+            continue;
+        }
+        std::cerr << name << ": " << (RtCheck::getViolationCount() - before) << " violation(s)" << std::endl;
+    }
+    
+    RtCheck::setEnabled(false);
+    RtCheck::writeReport(stdout);
+    
+    if (RtCheck::getViolationCount() > 0) {
+        return 1;
+    }
+    return setupFailed ? 2 : 0;
+}
\ No newline at end of file